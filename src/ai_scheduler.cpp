@@ -0,0 +1,223 @@
+#include "ai_scheduler.hpp"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/property_info.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "match_manager.hpp"
+#include "test_movement.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::PropertyInfo;
+using godot::Time;
+using godot::Variant;
+
+AIScheduler::AIScheduler() = default;
+
+AIScheduler::~AIScheduler() = default;
+
+void AIScheduler::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_frame_budget_usec", "usec"),
+                       &AIScheduler::set_frame_budget_usec);
+  ClassDB::bind_method(D_METHOD("get_frame_budget_usec"),
+                       &AIScheduler::get_frame_budget_usec);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "frame_budget_usec",
+                            godot::PROPERTY_HINT_RANGE, "50,16000,50"),
+               "set_frame_budget_usec", "get_frame_budget_usec");
+
+  ClassDB::bind_method(
+      D_METHOD("set_deterministic_decisions_per_tick", "count"),
+      &AIScheduler::set_deterministic_decisions_per_tick);
+  ClassDB::bind_method(D_METHOD("get_deterministic_decisions_per_tick"),
+                       &AIScheduler::get_deterministic_decisions_per_tick);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "deterministic_decisions_per_tick",
+                            godot::PROPERTY_HINT_RANGE, "0,1000,1"),
+               "set_deterministic_decisions_per_tick",
+               "get_deterministic_decisions_per_tick");
+
+  ClassDB::bind_method(D_METHOD("get_agent_count"),
+                       &AIScheduler::get_agent_count);
+  ClassDB::bind_method(D_METHOD("get_last_frame_usec"),
+                       &AIScheduler::get_last_frame_usec);
+  ClassDB::bind_method(D_METHOD("get_last_frame_decisions"),
+                       &AIScheduler::get_last_frame_decisions);
+  ClassDB::bind_method(D_METHOD("get_backlog"), &AIScheduler::get_backlog);
+  ClassDB::bind_method(D_METHOD("get_average_frame_usec"),
+                       &AIScheduler::get_average_frame_usec);
+  ClassDB::bind_method(D_METHOD("get_peak_frame_usec"),
+                       &AIScheduler::get_peak_frame_usec);
+  ClassDB::bind_method(D_METHOD("reset_peak"), &AIScheduler::reset_peak);
+}
+
+void AIScheduler::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    set_physics_process(false);
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+}
+
+void AIScheduler::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  tick++;
+  const bool deterministic = match != nullptr && match->is_deterministic();
+  const uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+  int32_t decisions = 0;
+  while (!heap.empty() && heap.front().due_tick <= tick) {
+    if (deterministic) {
+      if (deterministic_decisions_per_tick > 0 &&
+          decisions == deterministic_decisions_per_tick) {
+        break;
+      }
+    } else if (decisions > 0 &&
+               Time::get_singleton()->get_ticks_usec() - start_usec >=
+                   static_cast<uint64_t>(frame_budget_usec)) {
+      break;
+    }
+
+    Entry entry = _pop();
+    const Agent& agent = agents[entry.agent_id];
+    if (agent.serial != entry.serial) {
+      continue;  // Unregistered since it was scheduled
+    }
+    TestMovement* brain = agent.brain;
+    brain->decide();
+    decisions++;
+
+    // The agent may have unregistered itself while deciding.
+    if (agents[entry.agent_id].serial == entry.serial) {
+      entry.due_tick = tick + _interval_ticks(brain);
+      _push(entry);
+    }
+  }
+
+  backlog = 0;
+  for (const Entry& entry : heap) {
+    if (entry.due_tick <= tick &&
+        agents[entry.agent_id].serial == entry.serial) {
+      backlog++;
+    }
+  }
+
+  last_frame_usec =
+      static_cast<int64_t>(Time::get_singleton()->get_ticks_usec() -
+                           start_usec);
+  last_frame_decisions = decisions;
+  peak_frame_usec = std::max(peak_frame_usec, last_frame_usec);
+  average_frame_usec += (last_frame_usec - average_frame_usec) * 0.05;
+}
+
+void AIScheduler::set_frame_budget_usec(int32_t usec) {
+  frame_budget_usec = std::max(usec, 50);
+}
+
+int32_t AIScheduler::get_frame_budget_usec() const {
+  return frame_budget_usec;
+}
+
+void AIScheduler::set_deterministic_decisions_per_tick(int32_t count) {
+  deterministic_decisions_per_tick = std::max(count, 0);
+}
+
+int32_t AIScheduler::get_deterministic_decisions_per_tick() const {
+  return deterministic_decisions_per_tick;
+}
+
+int32_t AIScheduler::register_agent(TestMovement* agent) {
+  int32_t agent_id;
+  if (!free_ids.empty()) {
+    agent_id = free_ids.back();
+    free_ids.pop_back();
+  } else {
+    agent_id = static_cast<int32_t>(agents.size());
+    agents.emplace_back();
+  }
+  agents[agent_id].brain = agent;
+  agent_count++;
+
+  // Consecutive agents land on consecutive ticks of their interval, so N
+  // agents deciding every I ticks cost about N / I decisions per tick.
+  const int32_t interval = _interval_ticks(agent);
+  Entry entry;
+  entry.due_tick = tick + 1 + next_phase % interval;
+  entry.agent_id = agent_id;
+  entry.serial = agents[agent_id].serial;
+  _push(entry);
+  next_phase++;
+  return agent_id;
+}
+
+void AIScheduler::unregister_agent(int32_t agent_id) {
+  if (agent_id < 0 || agent_id >= static_cast<int32_t>(agents.size()) ||
+      agents[agent_id].brain == nullptr) {
+    return;
+  }
+  // Its heap entry is dropped when it comes up.
+  agents[agent_id].brain = nullptr;
+  agents[agent_id].serial++;
+  free_ids.push_back(agent_id);
+  agent_count--;
+}
+
+int32_t AIScheduler::get_agent_count() const {
+  return agent_count;
+}
+
+int64_t AIScheduler::get_last_frame_usec() const {
+  return last_frame_usec;
+}
+
+int32_t AIScheduler::get_last_frame_decisions() const {
+  return last_frame_decisions;
+}
+
+int32_t AIScheduler::get_backlog() const {
+  return backlog;
+}
+
+double AIScheduler::get_average_frame_usec() const {
+  return average_frame_usec;
+}
+
+int64_t AIScheduler::get_peak_frame_usec() const {
+  return peak_frame_usec;
+}
+
+void AIScheduler::reset_peak() {
+  peak_frame_usec = 0;
+}
+
+bool AIScheduler::_later(const Entry& a, const Entry& b) {
+  if (a.due_tick != b.due_tick) {
+    return a.due_tick > b.due_tick;
+  }
+  return a.agent_id > b.agent_id;
+}
+
+void AIScheduler::_push(const Entry& entry) {
+  heap.push_back(entry);
+  std::push_heap(heap.begin(), heap.end(), &AIScheduler::_later);
+}
+
+AIScheduler::Entry AIScheduler::_pop() {
+  std::pop_heap(heap.begin(), heap.end(), &AIScheduler::_later);
+  const Entry entry = heap.back();
+  heap.pop_back();
+  return entry;
+}
+
+int32_t AIScheduler::_interval_ticks(const TestMovement* brain) const {
+  const double ticks = brain->get_interval_seconds() *
+                       Engine::get_singleton()->get_physics_ticks_per_second();
+  return std::max(static_cast<int32_t>(std::lround(ticks)), 1);
+}
@@ -0,0 +1,98 @@
+#ifndef GDEXTENSION_AI_SCHEDULER_H
+#define GDEXTENSION_AI_SCHEDULER_H
+
+#include <godot_cpp/classes/node.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using godot::Node;
+
+class MatchManager;
+class TestMovement;
+
+// Runs the decisions of every AI-controlled unit of a match (TestMovement
+// bots register themselves) so the cost of AI per frame is bounded.
+//
+// Decisions are kept in a min-heap by the tick they are due. Each physics
+// tick the scheduler pops due decisions, most overdue first, until the
+// frame budget is spent; what is left stays due and runs first next frame.
+// New agents are staggered across their decision interval so a wave of
+// bots spawned together does not decide on the same tick.
+//
+// Deterministic matches cap decisions by count instead of time so every
+// peer decides for the same units on the same tick.
+class AIScheduler : public Node {
+  GDCLASS(AIScheduler, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  AIScheduler();
+  ~AIScheduler();
+
+  void _ready() override;
+  void _physics_process(double delta) override;
+
+  // Time per frame spent on decisions. At least one decision runs every
+  // frame so a tiny budget still makes progress.
+  void set_frame_budget_usec(int32_t usec);
+  int32_t get_frame_budget_usec() const;
+
+  // Decisions per tick in deterministic matches; 0 is unlimited.
+  void set_deterministic_decisions_per_tick(int32_t count);
+  int32_t get_deterministic_decisions_per_tick() const;
+
+  // Returns the agent id to unregister with.
+  int32_t register_agent(TestMovement* agent);
+  void unregister_agent(int32_t agent_id);
+  int32_t get_agent_count() const;
+
+  // Metrics of the last physics frame.
+  int64_t get_last_frame_usec() const;
+  int32_t get_last_frame_decisions() const;
+  // Decisions that were due but carried over to the next frame.
+  int32_t get_backlog() const;
+  // Running average of the time per frame, in microseconds.
+  double get_average_frame_usec() const;
+  int64_t get_peak_frame_usec() const;
+  void reset_peak();
+
+ private:
+  struct Agent {
+    TestMovement* brain = nullptr;
+    uint32_t serial = 0;  // Bumped on unregister to void heap entries
+  };
+
+  struct Entry {
+    int64_t due_tick = 0;
+    int32_t agent_id = 0;
+    uint32_t serial = 0;
+  };
+
+  // Orders the heap so the front is the earliest due, then lowest id.
+  static bool _later(const Entry& a, const Entry& b);
+  void _push(const Entry& entry);
+  Entry _pop();
+  int32_t _interval_ticks(const TestMovement* brain) const;
+
+  int32_t frame_budget_usec = 1000;
+  int32_t deterministic_decisions_per_tick = 0;
+
+  MatchManager* match = nullptr;
+  std::vector<Agent> agents;
+  std::vector<int32_t> free_ids;
+  std::vector<Entry> heap;
+  int32_t agent_count = 0;
+  int64_t tick = 0;
+  int32_t next_phase = 0;  // Staggers newly registered agents
+
+  int64_t last_frame_usec = 0;
+  int32_t last_frame_decisions = 0;
+  int32_t backlog = 0;
+  double average_frame_usec = 0.0;
+  int64_t peak_frame_usec = 0;
+};
+
+#endif  // GDEXTENSION_AI_SCHEDULER_H
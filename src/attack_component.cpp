@@ -1,6 +1,7 @@
 #include "attack_component.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/node3d.hpp>
 #include <godot_cpp/core/class_db.hpp>
@@ -9,8 +10,11 @@
 #include <godot_cpp/variant/variant.hpp>
 
 #include "health_component.hpp"
+#include "match_manager.hpp"
 #include "projectile.hpp"
+#include "state_checksum.hpp"
 #include "unit.hpp"
+#include "world_marker_pool.hpp"
 
 using godot::ClassDB;
 using godot::D_METHOD;
@@ -20,6 +24,11 @@ using godot::String;
 using godot::UtilityFunctions;
 using godot::Variant;
 
+namespace {
+// Hit sparks are placed around the chest of the target, not at its feet.
+const Vector3 HIT_FX_OFFSET = Vector3(0, 1, 0);
+}  // namespace
+
 AttackComponent::AttackComponent() = default;
 
 AttackComponent::~AttackComponent() = default;
@@ -108,42 +117,74 @@ void AttackComponent::_physics_process(double delta) {
     return;
   }
 
+  // Deterministic matches advance the timers from Unit::simulate_tick().
+  if (owner_unit != nullptr && owner_unit->is_deterministic()) {
+    return;
+  }
+  advance_timers(delta);
+}
+
+void AttackComponent::advance_timers(double delta) {
+  const bool in_ticks = owner_unit != nullptr && owner_unit->is_deterministic();
+
   // Decrement cooldown timer
-  if (time_until_next_attack > 0.0) {
+  if (in_ticks) {
+    if (ticks_until_next_attack > 0) {
+      ticks_until_next_attack--;
+    }
+  } else if (time_until_next_attack > 0.0) {
     time_until_next_attack -= delta;
   }
 
   // Advance windup timer if in windup
   if (in_attack_windup) {
-    attack_windup_timer += delta;
+    bool attack_point_reached = false;
+    if (in_ticks) {
+      windup_ticks++;
+      attack_point_reached = windup_ticks >= _seconds_to_ticks(attack_point);
+    } else {
+      attack_windup_timer += delta;
+      attack_point_reached = attack_windup_timer >= attack_point;
+    }
 
     // Check if we've reached the attack point
-    if (attack_windup_timer >= attack_point) {
-      if (current_attack_target != nullptr &&
-          current_attack_target->is_inside_tree()) {
-        HealthComponent* target_health = Object::cast_to<HealthComponent>(
-            current_attack_target->get_component_by_class("HealthComponent"));
-
-        if (target_health != nullptr && !target_health->is_dead()) {
-          // Fire the attack
-          if (delivery_type == AttackDelivery::MELEE) {
-            _fire_melee(current_attack_target);
-          } else if (delivery_type == AttackDelivery::PROJECTILE) {
-            _fire_projectile(current_attack_target);
-          }
-
-          emit_signal("attack_point_reached", current_attack_target);
-          time_until_next_attack = get_attack_interval();
+    if (attack_point_reached) {
+      // A stale handle means the target left during the windup.
+      UnitRegistry* registry =
+          owner_unit != nullptr ? owner_unit->get_unit_registry() : nullptr;
+      Unit* target = registry != nullptr &&
+                             registry->is_alive(current_attack_target)
+                         ? registry->resolve(current_attack_target)
+                         : nullptr;
+      if (target != nullptr) {
+        // Fire the attack
+        if (delivery_type == AttackDelivery::MELEE) {
+          _fire_melee(target);
+        } else if (delivery_type == AttackDelivery::PROJECTILE) {
+          _fire_projectile(target);
         }
+
+        emit_signal("attack_point_reached", target);
+        time_until_next_attack = get_attack_interval();
+        ticks_until_next_attack = _seconds_to_ticks(get_attack_interval());
       }
 
       // Exit windup regardless
       in_attack_windup = false;
-      current_attack_target = nullptr;
+      current_attack_target = INVALID_UNIT_HANDLE;
     }
   }
 }
 
+void AttackComponent::reset_state() {
+  time_until_next_attack = 0.0;
+  attack_windup_timer = 0.0;
+  in_attack_windup = false;
+  current_attack_target = INVALID_UNIT_HANDLE;
+  ticks_until_next_attack = 0;
+  windup_ticks = 0;
+}
+
 void AttackComponent::set_base_attack_time(float bat) {
   base_attack_time = std::max(0.1f, bat);
 }
@@ -213,21 +254,29 @@ Ref<PackedScene> AttackComponent::get_projectile_scene() const {
 }
 
 bool AttackComponent::try_fire_at(Unit* target, double delta) {
-  if (target == nullptr || !target->is_inside_tree()) {
+  const UnitHandle target_handle =
+      target != nullptr ? target->get_handle() : INVALID_UNIT_HANDLE;
+  // The handle is resolved in the owner's registry; a unit of another
+  // match could alias one of ours.
+  if (target_handle == INVALID_UNIT_HANDLE || owner_unit == nullptr ||
+      target->get_unit_registry() != owner_unit->get_unit_registry()) {
     return false;
   }
 
+  const bool ready = owner_unit->is_deterministic()
+                         ? ticks_until_next_attack <= 0
+                         : time_until_next_attack <= 0.0;
+
   // If we're not in windup and ready to attack
-  if (!in_attack_windup && time_until_next_attack <= 0.0) {
+  if (!in_attack_windup && ready) {
     // Start windup
     in_attack_windup = true;
     attack_windup_timer = 0.0;
-    current_attack_target = target;
+    windup_ticks = 0;
+    current_attack_target = target_handle;
 
-    if (owner_unit != nullptr) {
-      UtilityFunctions::print("[AttackComponent] " + owner_unit->get_name() +
-                              " started attacking " + target->get_name());
-    }
+    UtilityFunctions::print("[AttackComponent] " + owner_unit->get_name() +
+                            " started attacking " + target->get_name());
 
     emit_signal("attack_started", target);
     return false;  // Attack hasn't landed yet
@@ -236,6 +285,29 @@ bool AttackComponent::try_fire_at(Unit* target, double delta) {
   return false;
 }
 
+uint32_t AttackComponent::get_cooldown_state() const {
+  if (owner_unit != nullptr && owner_unit->is_deterministic()) {
+    return static_cast<uint32_t>(ticks_until_next_attack);
+  }
+  return float_bits(static_cast<float>(time_until_next_attack));
+}
+
+uint32_t AttackComponent::get_windup_state() const {
+  if (!in_attack_windup) {
+    return 0;
+  }
+  if (owner_unit != nullptr && owner_unit->is_deterministic()) {
+    return static_cast<uint32_t>(windup_ticks) + 1u;
+  }
+  return float_bits(static_cast<float>(attack_windup_timer)) | 1u;
+}
+
+int32_t AttackComponent::_seconds_to_ticks(float seconds) {
+  return static_cast<int32_t>(std::lround(
+      static_cast<double>(seconds) *
+      Engine::get_singleton()->get_physics_ticks_per_second()));
+}
+
 float AttackComponent::get_attack_interval() const {
   float attack_speed_factor = attack_speed / 100.0f;
   return base_attack_time / attack_speed_factor;
@@ -255,6 +327,15 @@ void AttackComponent::_fire_melee(Unit* target) {
     return;
   }
 
+  if (!_is_in_reach_in_view(target)) {
+    if (owner_unit != nullptr) {
+      UtilityFunctions::print("[AttackComponent] " + owner_unit->get_name() +
+                              " missed " + target->get_name() +
+                              " (out of reach)");
+    }
+    return;
+  }
+
   if (owner_unit != nullptr) {
     UtilityFunctions::print("[AttackComponent] " + owner_unit->get_name() +
                             " hit " + target->get_name() + " for " +
@@ -262,9 +343,43 @@ void AttackComponent::_fire_melee(Unit* target) {
   }
 
   target_health->apply_damage(attack_damage, owner_unit);
+  WorldMarkerPool::spawn_for(this, MarkerKind::HIT_SPARK,
+                             target->get_global_position() + HIT_FX_OFFSET);
   emit_signal("attack_hit", target, attack_damage);
 }
 
+bool AttackComponent::_is_in_reach_in_view(const Unit* target) const {
+  // Lockstep peers all see the same tick; there is nothing to compensate.
+  if (owner_unit == nullptr || owner_unit->is_deterministic() ||
+      owner_unit->get_match_manager() == nullptr) {
+    return true;
+  }
+
+  const PositionHistory& history =
+      owner_unit->get_match_manager()->get_unit_registry()
+          .get_position_history();
+  // Units without a remote controller see the present, which the caller
+  // already checked.
+  const int32_t slot = owner_unit->get_registry_slot();
+  if (history.get_view_delay(slot) == 0) {
+    return true;
+  }
+  const int64_t view_tick = history.get_view_tick(slot);
+  if (view_tick < 0) {
+    return true;
+  }
+  // The target joined after the tick the client saw; only the present
+  // says anything about it.
+  if (history.sample(target->get_registry_slot(), view_tick) == nullptr) {
+    return true;
+  }
+
+  // The chase buffer is the slack the unit already allows a fleeing target.
+  const float reach = attack_range + owner_unit->get_attack_buffer_range();
+  return history.was_within_range(target->get_registry_slot(), view_tick,
+                                  owner_unit->get_global_position(), reach);
+}
+
 void AttackComponent::_fire_projectile(Unit* target) {
   if (target == nullptr) {
     return;
@@ -6,6 +6,7 @@
 #include <godot_cpp/core/property_info.hpp>
 
 #include "unit_component.hpp"
+#include "unit_registry.hpp"
 
 using godot::List;
 using godot::PackedScene;
@@ -33,7 +34,11 @@ class AttackComponent : public UnitComponent {
   double time_until_next_attack = 0.0;
   double attack_windup_timer = 0.0;
   bool in_attack_windup = false;
-  Unit* current_attack_target = nullptr;
+  UnitHandle current_attack_target = INVALID_UNIT_HANDLE;
+
+  // Same timers counted in physics ticks, used in deterministic matches.
+  int32_t ticks_until_next_attack = 0;
+  int32_t windup_ticks = 0;
 
  public:
   AttackComponent();
@@ -70,11 +75,26 @@ class AttackComponent : public UnitComponent {
   bool try_fire_at(Unit* target, double delta);
   float get_attack_interval() const;
 
+  // Cooldown and windup step; _physics_process() calls it, or the owning
+  // unit in deterministic matches.
+  void advance_timers(double delta);
+  // Timer state for the state checksum: tick counts in deterministic
+  // matches, float bits otherwise. The windup word is 0 when idle.
+  uint32_t get_cooldown_state() const;
+  uint32_t get_windup_state() const;
+
+  // Ready to attack, no windup in progress.
+  void reset_state() override;
+
  private:
   Ref<PackedScene> projectile_scene = nullptr;
 
   void _fire_melee(Unit* target);
+  // Lag compensation: whether the target was in reach at the tick the
+  // owner's controller was looking at. True when no history is kept.
+  bool _is_in_reach_in_view(const Unit* target) const;
   void _fire_projectile(Unit* target);
+  static int32_t _seconds_to_ticks(float seconds);
 };
 
 #endif  // GDEXTENSION_ATTACK_COMPONENT_H
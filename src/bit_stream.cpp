@@ -0,0 +1,131 @@
+#include "bit_stream.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+inline uint32_t bit_mask(int32_t bit_count) {
+  return bit_count >= 32 ? 0xFFFFFFFFu : (1u << bit_count) - 1u;
+}
+}  // namespace
+
+void BitWriter::clear() {
+  bytes.clear();
+  scratch = 0;
+  scratch_bits = 0;
+  bit_count = 0;
+}
+
+void BitWriter::write_bits(uint32_t value, int32_t count) {
+  scratch |= static_cast<uint64_t>(value & bit_mask(count)) << scratch_bits;
+  scratch_bits += count;
+  bit_count += count;
+  while (scratch_bits >= 8) {
+    bytes.push_back(static_cast<uint8_t>(scratch));
+    scratch >>= 8;
+    scratch_bits -= 8;
+  }
+}
+
+void BitWriter::write_bool(bool value) {
+  write_bits(value ? 1u : 0u, 1);
+}
+
+void BitWriter::write_varuint(uint32_t value) {
+  while (value >= 0x80u) {
+    write_bits((value & 0x7Fu) | 0x80u, 8);
+    value >>= 7;
+  }
+  write_bits(value, 8);
+}
+
+void BitWriter::write_quantized(float value,
+                                float min_value,
+                                float max_value,
+                                int32_t count) {
+  write_bits(quantize(value, min_value, max_value, count), count);
+}
+
+int64_t BitWriter::get_bit_count() const {
+  return bit_count;
+}
+
+const std::vector<uint8_t>& BitWriter::get_bytes() {
+  // Pad the partial byte with zeros; later writes start on the next byte.
+  if (scratch_bits > 0) {
+    bytes.push_back(static_cast<uint8_t>(scratch));
+    scratch >>= 8;
+    scratch_bits = 0;
+    bit_count = static_cast<int64_t>(bytes.size()) * 8;
+  }
+  return bytes;
+}
+
+BitReader::BitReader(const uint8_t* data, int64_t size)
+    : data(data), size(size) {}
+
+uint32_t BitReader::read_bits(int32_t count) {
+  if (bit_position + count > size * 8) {
+    overflowed = true;
+    bit_position = size * 8;
+    return 0;
+  }
+
+  uint32_t value = 0;
+  int32_t written = 0;
+  while (written < count) {
+    const int64_t byte_index = bit_position >> 3;
+    const int32_t bit_offset = static_cast<int32_t>(bit_position & 7);
+    const int32_t take = std::min(8 - bit_offset, count - written);
+    const uint32_t bits =
+        (static_cast<uint32_t>(data[byte_index]) >> bit_offset) &
+        bit_mask(take);
+    value |= bits << written;
+    written += take;
+    bit_position += take;
+  }
+  return value;
+}
+
+bool BitReader::read_bool() {
+  return read_bits(1) != 0;
+}
+
+uint32_t BitReader::read_varuint() {
+  uint32_t value = 0;
+  for (int32_t shift = 0; shift < 35; shift += 7) {
+    const uint32_t group = read_bits(8);
+    value |= (group & 0x7Fu) << shift;
+    if ((group & 0x80u) == 0) {
+      break;
+    }
+  }
+  return value;
+}
+
+float BitReader::read_quantized(float min_value,
+                                float max_value,
+                                int32_t count) {
+  return dequantize(read_bits(count), min_value, max_value, count);
+}
+
+bool BitReader::is_overflowed() const {
+  return overflowed;
+}
+
+uint32_t quantize(float value, float min_value, float max_value,
+                  int32_t bit_count) {
+  const float range = max_value - min_value;
+  const float t = std::clamp((value - min_value) / range, 0.0f, 1.0f);
+  return static_cast<uint32_t>(
+      std::lround(t * static_cast<float>(bit_mask(bit_count))));
+}
+
+float dequantize(uint32_t quantized,
+                 float min_value,
+                 float max_value,
+                 int32_t bit_count) {
+  const float t = static_cast<float>(quantized) /
+                  static_cast<float>(bit_mask(bit_count));
+  return min_value + t * (max_value - min_value);
+}
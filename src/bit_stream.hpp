@@ -0,0 +1,64 @@
+#ifndef GDEXTENSION_BIT_STREAM_H
+#define GDEXTENSION_BIT_STREAM_H
+
+#include <cstdint>
+#include <vector>
+
+// Packs values of arbitrary bit width back to back, least significant bit
+// first. Used for network packets where byte alignment would waste most of
+// the payload.
+class BitWriter {
+ public:
+  void clear();
+
+  // Writes the low bit_count bits of value; bit_count is 1 to 32.
+  void write_bits(uint32_t value, int32_t bit_count);
+  void write_bool(bool value);
+  // 7 bits per group with a continuation bit; small values stay small.
+  void write_varuint(uint32_t value);
+  // Maps value from [min_value, max_value] onto bit_count bits.
+  void write_quantized(float value,
+                       float min_value,
+                       float max_value,
+                       int32_t bit_count);
+
+  int64_t get_bit_count() const;
+  // Pads and flushes the partial byte.
+  const std::vector<uint8_t>& get_bytes();
+
+ private:
+  std::vector<uint8_t> bytes;
+  uint64_t scratch = 0;
+  int32_t scratch_bits = 0;
+  int64_t bit_count = 0;
+};
+
+// Reads what BitWriter wrote. Reading past the end yields zeros and sets the
+// overflow flag instead of failing, so decoders check once at the end.
+class BitReader {
+ public:
+  BitReader(const uint8_t* data, int64_t size);
+
+  uint32_t read_bits(int32_t bit_count);
+  bool read_bool();
+  uint32_t read_varuint();
+  float read_quantized(float min_value, float max_value, int32_t bit_count);
+
+  bool is_overflowed() const;
+
+ private:
+  const uint8_t* data = nullptr;
+  int64_t size = 0;
+  int64_t bit_position = 0;
+  bool overflowed = false;
+};
+
+// Quantization helpers shared by both sides of the stream.
+uint32_t quantize(float value, float min_value, float max_value,
+                  int32_t bit_count);
+float dequantize(uint32_t quantized,
+                 float min_value,
+                 float max_value,
+                 int32_t bit_count);
+
+#endif  // GDEXTENSION_BIT_STREAM_H
@@ -0,0 +1,348 @@
+#include "desync_monitor.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "match_manager.hpp"
+#include "state_checksum.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::MethodInfo;
+using godot::PropertyInfo;
+using godot::UtilityFunctions;
+using godot::Variant;
+
+namespace {
+constexpr uint32_t STREAM_MAGIC = 0x43475052;  // "RPGC"
+constexpr uint16_t STREAM_VERSION = 1;
+constexpr uint8_t STREAM_HAS_STATE = 0x01;
+}  // namespace
+
+DesyncMonitor::DesyncMonitor() = default;
+
+DesyncMonitor::~DesyncMonitor() = default;
+
+void DesyncMonitor::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_record_path", "path"),
+                       &DesyncMonitor::set_record_path);
+  ClassDB::bind_method(D_METHOD("get_record_path"),
+                       &DesyncMonitor::get_record_path);
+  ADD_PROPERTY(PropertyInfo(Variant::STRING, "record_path",
+                            godot::PROPERTY_HINT_SAVE_FILE, "*.checksums"),
+               "set_record_path", "get_record_path");
+
+  ClassDB::bind_method(D_METHOD("set_reference_path", "path"),
+                       &DesyncMonitor::set_reference_path);
+  ClassDB::bind_method(D_METHOD("get_reference_path"),
+                       &DesyncMonitor::get_reference_path);
+  ADD_PROPERTY(PropertyInfo(Variant::STRING, "reference_path",
+                            godot::PROPERTY_HINT_FILE, "*.checksums"),
+               "set_reference_path", "get_reference_path");
+
+  ClassDB::bind_method(D_METHOD("set_record_unit_state", "enabled"),
+                       &DesyncMonitor::set_record_unit_state);
+  ClassDB::bind_method(D_METHOD("get_record_unit_state"),
+                       &DesyncMonitor::get_record_unit_state);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "record_unit_state"),
+               "set_record_unit_state", "get_record_unit_state");
+
+  ClassDB::bind_method(D_METHOD("has_desync"), &DesyncMonitor::has_desync);
+  ClassDB::bind_method(D_METHOD("get_desync_tick"),
+                       &DesyncMonitor::get_desync_tick);
+  ClassDB::bind_static_method("DesyncMonitor",
+                              D_METHOD("compare_checksum_streams", "path_a",
+                                       "path_b"),
+                              &DesyncMonitor::compare_checksum_streams);
+
+  ADD_SIGNAL(MethodInfo("desync_detected", PropertyInfo(Variant::INT, "tick"),
+                        PropertyInfo(Variant::INT, "slot"),
+                        PropertyInfo(Variant::DICTIONARY, "report")));
+}
+
+void DesyncMonitor::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+  if (match == nullptr) {
+    UtilityFunctions::push_warning(
+        "[DesyncMonitor] Not part of a match, nothing to monitor.");
+    return;
+  }
+
+  if (!record_path.is_empty()) {
+    record_file = FileAccess::open(record_path, FileAccess::WRITE);
+    if (record_file.is_null()) {
+      UtilityFunctions::push_error("[DesyncMonitor] Cannot write " +
+                                   record_path);
+    } else {
+      record_file->store_32(STREAM_MAGIC);
+      record_file->store_16(STREAM_VERSION);
+      record_file->store_8(record_unit_state ? STREAM_HAS_STATE : 0);
+    }
+  }
+
+  if (!reference_path.is_empty()) {
+    reference_file = _open_stream(reference_path, reference_has_state);
+  }
+}
+
+void DesyncMonitor::_exit_tree() {
+  if (record_file.is_valid()) {
+    record_file->close();
+    record_file.unref();
+  }
+  reference_file.unref();
+}
+
+void DesyncMonitor::set_record_path(const String& path) {
+  record_path = path;
+}
+
+String DesyncMonitor::get_record_path() const {
+  return record_path;
+}
+
+void DesyncMonitor::set_reference_path(const String& path) {
+  reference_path = path;
+}
+
+String DesyncMonitor::get_reference_path() const {
+  return reference_path;
+}
+
+void DesyncMonitor::set_record_unit_state(bool enabled) {
+  record_unit_state = enabled;
+}
+
+bool DesyncMonitor::get_record_unit_state() const {
+  return record_unit_state;
+}
+
+bool DesyncMonitor::has_desync() const {
+  return desync_tick >= 0;
+}
+
+int64_t DesyncMonitor::get_desync_tick() const {
+  return desync_tick;
+}
+
+void DesyncMonitor::on_tick(int64_t tick,
+                            uint64_t checksum,
+                            const StateChecksum& state) {
+  if (record_file.is_null() && reference_file.is_null()) {
+    return;
+  }
+
+  _capture(tick, checksum, state);
+  if (record_file.is_valid()) {
+    if (record_unit_state) {
+      _capture_words(state);
+    }
+    _write_frame();
+  }
+  if (reference_file.is_valid()) {
+    _check_against_reference(state);
+  }
+}
+
+Dictionary DesyncMonitor::compare_checksum_streams(const String& path_a,
+                                                   const String& path_b) {
+  bool state_a = false;
+  bool state_b = false;
+  Ref<FileAccess> stream_a = _open_stream(path_a, state_a);
+  Ref<FileAccess> stream_b = _open_stream(path_b, state_b);
+  if (stream_a.is_null() || stream_b.is_null()) {
+    return Dictionary();
+  }
+
+  // Streams may start at different ticks (a peer that joined late); only
+  // ticks present in both are compared.
+  Frame a;
+  Frame b;
+  bool has_a = _read_frame(stream_a, state_a, a);
+  bool has_b = _read_frame(stream_b, state_b, b);
+  while (has_a && has_b) {
+    if (a.tick < b.tick) {
+      has_a = _read_frame(stream_a, state_a, a);
+    } else if (b.tick < a.tick) {
+      has_b = _read_frame(stream_b, state_b, b);
+    } else if (a.checksum != b.checksum) {
+      return _build_report(a, b, _find_divergent_slot(a, b));
+    } else {
+      has_a = _read_frame(stream_a, state_a, a);
+      has_b = _read_frame(stream_b, state_b, b);
+    }
+  }
+  return Dictionary();
+}
+
+Ref<FileAccess> DesyncMonitor::_open_stream(const String& path,
+                                            bool& with_state) {
+  Ref<FileAccess> stream = FileAccess::open(path, FileAccess::READ);
+  if (stream.is_null()) {
+    UtilityFunctions::push_error("[DesyncMonitor] Cannot read " + path);
+    return stream;
+  }
+  if (stream->get_32() != STREAM_MAGIC ||
+      stream->get_16() != STREAM_VERSION) {
+    UtilityFunctions::push_error("[DesyncMonitor] " + path +
+                                 " is not a checksum stream");
+    return Ref<FileAccess>();
+  }
+  with_state = (stream->get_8() & STREAM_HAS_STATE) != 0;
+  return stream;
+}
+
+bool DesyncMonitor::_read_frame(const Ref<FileAccess>& stream,
+                                bool with_state,
+                                Frame& frame) {
+  frame.tick = stream->get_32();
+  frame.checksum = stream->get_64();
+  frame.slot_count = static_cast<int32_t>(stream->get_32());
+  if (stream->eof_reached() || frame.slot_count < 0) {
+    return false;
+  }
+
+  const int64_t lane_bytes =
+      static_cast<int64_t>(frame.slot_count) * sizeof(uint32_t);
+  PackedByteArray bytes = stream->get_buffer(lane_bytes);
+  if (bytes.size() != lane_bytes) {
+    return false;
+  }
+  frame.lanes.resize(frame.slot_count);
+  std::memcpy(frame.lanes.data(), bytes.ptr(), lane_bytes);
+
+  frame.words.clear();
+  if (with_state) {
+    const int64_t word_bytes = lane_bytes * StateChecksum::WORD_COUNT;
+    bytes = stream->get_buffer(word_bytes);
+    if (bytes.size() != word_bytes) {
+      return false;
+    }
+    frame.words.resize(frame.slot_count * StateChecksum::WORD_COUNT);
+    std::memcpy(frame.words.data(), bytes.ptr(), word_bytes);
+  }
+  return true;
+}
+
+int32_t DesyncMonitor::_find_divergent_slot(const Frame& a, const Frame& b) {
+  const int32_t slot_count = std::max(a.slot_count, b.slot_count);
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    const uint32_t lane_a = slot < a.slot_count ? a.lanes[slot] : 0;
+    const uint32_t lane_b = slot < b.slot_count ? b.lanes[slot] : 0;
+    if (lane_a != lane_b) {
+      return slot;
+    }
+  }
+  return -1;
+}
+
+Dictionary DesyncMonitor::_describe_unit(const Frame& frame, int32_t slot) {
+  Dictionary unit;
+  if (slot < 0 || slot >= frame.slot_count) {
+    return unit;
+  }
+
+  unit["lane_hash"] = static_cast<int64_t>(frame.lanes[slot]);
+  if (frame.words.empty()) {
+    return unit;
+  }
+  for (int32_t word = 0; word < StateChecksum::WORD_COUNT; ++word) {
+    unit[StateChecksum::get_word_name(word)] = static_cast<int64_t>(
+        frame.words[word * frame.slot_count + slot]);
+  }
+  return unit;
+}
+
+Dictionary DesyncMonitor::_build_report(const Frame& a,
+                                        const Frame& b,
+                                        int32_t slot) {
+  Dictionary report;
+  report["tick"] = static_cast<int64_t>(a.tick);
+  report["slot"] = slot;
+  report["checksum_a"] = static_cast<int64_t>(a.checksum);
+  report["checksum_b"] = static_cast<int64_t>(b.checksum);
+  report["state_a"] = _describe_unit(a, slot);
+  report["state_b"] = _describe_unit(b, slot);
+  return report;
+}
+
+void DesyncMonitor::_capture(int64_t tick,
+                             uint64_t checksum,
+                             const StateChecksum& state) {
+  const int32_t slot_count = state.get_slot_count();
+  live_frame.tick = static_cast<uint32_t>(tick);
+  live_frame.checksum = checksum;
+  live_frame.slot_count = slot_count;
+  live_frame.lanes = state.get_lane_hashes();
+  // The state words are only copied when something reads them.
+  live_frame.words.clear();
+}
+
+void DesyncMonitor::_capture_words(const StateChecksum& state) {
+  if (!live_frame.words.empty()) {
+    return;
+  }
+  const int32_t slot_count = live_frame.slot_count;
+  live_frame.words.resize(slot_count * StateChecksum::WORD_COUNT);
+  for (int32_t word = 0; word < StateChecksum::WORD_COUNT; ++word) {
+    uint32_t* out = live_frame.words.data() + word * slot_count;
+    for (int32_t slot = 0; slot < slot_count; ++slot) {
+      out[slot] = state.get_word(slot, word);
+    }
+  }
+}
+
+void DesyncMonitor::_write_frame() {
+  record_file->store_32(live_frame.tick);
+  record_file->store_64(live_frame.checksum);
+  record_file->store_32(static_cast<uint32_t>(live_frame.slot_count));
+  _store_words(live_frame.lanes);
+  if (record_unit_state) {
+    _store_words(live_frame.words);
+  }
+}
+
+void DesyncMonitor::_store_words(const std::vector<uint32_t>& values) {
+  // One buffer store instead of a call per word. Native byte order; every
+  // platform the game ships on is little-endian.
+  const int64_t byte_count =
+      static_cast<int64_t>(values.size()) * sizeof(uint32_t);
+  write_buffer.resize(byte_count);
+  std::memcpy(write_buffer.ptrw(), values.data(), byte_count);
+  record_file->store_buffer(write_buffer);
+}
+
+void DesyncMonitor::_check_against_reference(const StateChecksum& state) {
+  while (reference_frame.tick < live_frame.tick) {
+    if (!_read_frame(reference_file, reference_has_state, reference_frame)) {
+      // Reference ended; nothing left to compare against.
+      reference_file.unref();
+      return;
+    }
+  }
+  if (reference_frame.tick != live_frame.tick ||
+      reference_frame.checksum == live_frame.checksum) {
+    return;
+  }
+
+  _capture_words(state);
+  const int32_t slot = _find_divergent_slot(live_frame, reference_frame);
+  desync_tick = live_frame.tick;
+  Dictionary report = _build_report(live_frame, reference_frame, slot);
+  UtilityFunctions::push_error(
+      "[DesyncMonitor] Desync at tick " + String::num_int64(desync_tick) +
+      ", slot " + String::num_int64(slot) + ": " + Variant(report).stringify());
+  emit_signal("desync_detected", desync_tick, slot, report);
+
+  // Everything after the first divergence differs as well.
+  reference_file.unref();
+}
@@ -0,0 +1,109 @@
+#ifndef GDEXTENSION_DESYNC_MONITOR_H
+#define GDEXTENSION_DESYNC_MONITOR_H
+
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class MatchManager;
+class StateChecksum;
+
+using godot::Dictionary;
+using godot::FileAccess;
+using godot::Node;
+using godot::PackedByteArray;
+using godot::Ref;
+using godot::String;
+
+// Streams the per-tick state checksums of a match to a file and compares
+// them against a stream written earlier: by another peer, or by the same
+// order recording replayed on another build. Every frame also carries one
+// hash per registry slot (and, with record_unit_state, the raw state words),
+// so the first divergent tick is narrowed down to the unit that diverged.
+class DesyncMonitor : public Node {
+  GDCLASS(DesyncMonitor, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  DesyncMonitor();
+  ~DesyncMonitor();
+
+  void _ready() override;
+  void _exit_tree() override;
+
+  // Stream written while the match runs. Empty disables writing.
+  void set_record_path(const String& path);
+  String get_record_path() const;
+
+  // Stream the live match is checked against. Empty disables checking.
+  void set_reference_path(const String& path);
+  String get_reference_path() const;
+
+  // Also store every unit's state words, not only its hash. Needed to see
+  // what diverged, at roughly ten times the file size.
+  void set_record_unit_state(bool enabled);
+  bool get_record_unit_state() const;
+
+  bool has_desync() const;
+  int64_t get_desync_tick() const;
+
+  // Called by the match after each tick's checksum.
+  void on_tick(int64_t tick, uint64_t checksum, const StateChecksum& state);
+
+  // Finds the first tick at which two streams disagree. Returns an empty
+  // dictionary if they match; otherwise tick, slot (-1 when no unit hash
+  // differs, e.g. projectile state) and state_a/state_b with the unit's
+  // state words from each stream.
+  static Dictionary compare_checksum_streams(const String& path_a,
+                                             const String& path_b);
+
+ private:
+  struct Frame {
+    uint32_t tick = 0;
+    uint64_t checksum = 0;
+    int32_t slot_count = 0;
+    std::vector<uint32_t> lanes;
+    std::vector<uint32_t> words;  // Word-major, slot_count per word.
+  };
+
+  static Ref<FileAccess> _open_stream(const String& path, bool& with_state);
+  static bool _read_frame(const Ref<FileAccess>& stream,
+                          bool with_state,
+                          Frame& frame);
+  static int32_t _find_divergent_slot(const Frame& a, const Frame& b);
+  static Dictionary _describe_unit(const Frame& frame, int32_t slot);
+  static Dictionary _build_report(const Frame& a,
+                                  const Frame& b,
+                                  int32_t slot);
+
+  void _capture(int64_t tick, uint64_t checksum, const StateChecksum& state);
+  void _capture_words(const StateChecksum& state);
+  void _write_frame();
+  void _store_words(const std::vector<uint32_t>& values);
+  void _check_against_reference(const StateChecksum& state);
+
+  String record_path;
+  String reference_path;
+  bool record_unit_state = true;
+
+  MatchManager* match = nullptr;
+  Ref<FileAccess> record_file;
+  Ref<FileAccess> reference_file;
+  bool reference_has_state = false;
+  int64_t desync_tick = -1;
+
+  // Reused every tick.
+  Frame live_frame;
+  Frame reference_frame;
+  PackedByteArray write_buffer;
+};
+
+#endif  // GDEXTENSION_DESYNC_MONITOR_H
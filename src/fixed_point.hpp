@@ -0,0 +1,202 @@
+#ifndef GDEXTENSION_FIXED_POINT_H
+#define GDEXTENSION_FIXED_POINT_H
+
+#include <cmath>
+#include <cstdint>
+
+#include <godot_cpp/variant/vector3.hpp>
+
+// Floor of the square root, bit by bit.
+inline uint64_t integer_sqrt(uint64_t value) {
+  uint64_t result = 0;
+  uint64_t bit = uint64_t(1) << 62;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= result + bit) {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return result;
+}
+
+// Q16.16 fixed-point number for the deterministic simulation mode. Every
+// operation is plain integer math, so results are bit-identical on any CPU.
+// Range is about +-32768 with a resolution of 1/65536.
+struct Fixed {
+  static constexpr int32_t FRACTION_BITS = 16;
+  static constexpr int32_t ONE_RAW = 1 << FRACTION_BITS;
+
+  int32_t raw = 0;
+
+  static constexpr Fixed from_raw(int32_t value) {
+    Fixed result;
+    result.raw = value;
+    return result;
+  }
+  static constexpr Fixed from_int(int32_t value) {
+    return from_raw(value * ONE_RAW);
+  }
+  // Rounds to the nearest step. The double product is exact, so the same
+  // float always maps to the same value.
+  static Fixed from_float(double value) {
+    return from_raw(static_cast<int32_t>(
+        std::llround(value * static_cast<double>(ONE_RAW))));
+  }
+
+  float to_float() const {
+    return static_cast<float>(raw) / static_cast<float>(ONE_RAW);
+  }
+
+  Fixed operator+(Fixed other) const { return from_raw(raw + other.raw); }
+  Fixed operator-(Fixed other) const { return from_raw(raw - other.raw); }
+  Fixed operator-() const { return from_raw(-raw); }
+  Fixed operator*(Fixed other) const {
+    return from_raw(static_cast<int32_t>(
+        (static_cast<int64_t>(raw) * other.raw) >> FRACTION_BITS));
+  }
+  Fixed operator/(Fixed other) const {
+    if (other.raw == 0) {
+      return from_raw(0);
+    }
+    return from_raw(static_cast<int32_t>(
+        (static_cast<int64_t>(raw) * ONE_RAW) / other.raw));
+  }
+  Fixed& operator+=(Fixed other) {
+    raw += other.raw;
+    return *this;
+  }
+  Fixed& operator-=(Fixed other) {
+    raw -= other.raw;
+    return *this;
+  }
+
+  bool operator==(Fixed other) const { return raw == other.raw; }
+  bool operator!=(Fixed other) const { return raw != other.raw; }
+  bool operator<(Fixed other) const { return raw < other.raw; }
+  bool operator<=(Fixed other) const { return raw <= other.raw; }
+  bool operator>(Fixed other) const { return raw > other.raw; }
+  bool operator>=(Fixed other) const { return raw >= other.raw; }
+
+  // Integer square root of a non-negative value.
+  Fixed sqrt() const {
+    if (raw <= 0) {
+      return from_raw(0);
+    }
+    return from_raw(static_cast<int32_t>(
+        integer_sqrt(static_cast<uint64_t>(raw) << FRACTION_BITS)));
+  }
+};
+
+struct FixedVector3 {
+  Fixed x;
+  Fixed y;
+  Fixed z;
+
+  static FixedVector3 from_vector3(const godot::Vector3& value) {
+    return {Fixed::from_float(value.x), Fixed::from_float(value.y),
+            Fixed::from_float(value.z)};
+  }
+
+  godot::Vector3 to_vector3() const {
+    return godot::Vector3(x.to_float(), y.to_float(), z.to_float());
+  }
+
+  FixedVector3 operator+(const FixedVector3& other) const {
+    return {x + other.x, y + other.y, z + other.z};
+  }
+  FixedVector3 operator-(const FixedVector3& other) const {
+    return {x - other.x, y - other.y, z - other.z};
+  }
+  FixedVector3 operator*(Fixed scale) const {
+    return {x * scale, y * scale, z * scale};
+  }
+  bool operator==(const FixedVector3& other) const {
+    return x == other.x && y == other.y && z == other.z;
+  }
+
+  // Lengths are computed in 64 bits so they do not overflow before the
+  // square root.
+  Fixed length() const {
+    const int64_t squared = static_cast<int64_t>(x.raw) * x.raw +
+                            static_cast<int64_t>(y.raw) * y.raw +
+                            static_cast<int64_t>(z.raw) * z.raw;
+    return Fixed::from_raw(
+        static_cast<int32_t>(integer_sqrt(static_cast<uint64_t>(squared))));
+  }
+
+  // Length on the XZ plane.
+  Fixed horizontal_length() const {
+    const int64_t squared = static_cast<int64_t>(x.raw) * x.raw +
+                            static_cast<int64_t>(z.raw) * z.raw;
+    return Fixed::from_raw(
+        static_cast<int32_t>(integer_sqrt(static_cast<uint64_t>(squared))));
+  }
+};
+
+// FNV-1a step over the eight bytes of value, for state checksums.
+inline uint64_t hash_mix(uint64_t hash, uint64_t value) {
+  for (int32_t byte = 0; byte < 8; ++byte) {
+    hash ^= (value >> (byte * 8)) & 0xFFu;
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+constexpr uint64_t HASH_SEED = 0xCBF29CE484222325ull;
+
+// Small PCG32 generator. Each unit owns one stream seeded from the match seed
+// and its registry slot, so random choices replay identically everywhere.
+class DeterministicRandom {
+ public:
+  // splitmix64 finalizer, used to derive stream seeds.
+  static uint64_t mix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+  }
+
+  // Seed of a unit's stream. The one formula for live matches, recordings
+  // and replays, so they cannot drift apart.
+  static uint64_t stream_seed(uint64_t match_seed, int32_t slot) {
+    return mix(match_seed ^ (static_cast<uint64_t>(slot) << 32));
+  }
+
+  void seed(uint64_t seed_value) {
+    state = 0;
+    next_u32();
+    state += seed_value;
+    next_u32();
+  }
+
+  uint32_t next_u32() {
+    const uint64_t old_state = state;
+    state = old_state * 6364136223846793005ull + INCREMENT;
+    const uint32_t xorshifted =
+        static_cast<uint32_t>(((old_state >> 18u) ^ old_state) >> 27u);
+    const uint32_t rotation = static_cast<uint32_t>(old_state >> 59u);
+    return (xorshifted >> rotation) | (xorshifted << ((~rotation + 1u) & 31u));
+  }
+
+  // Uniform value in [-range, range].
+  Fixed next_signed(Fixed range) {
+    if (range.raw <= 0) {
+      return Fixed::from_raw(0);
+    }
+    const uint32_t span = static_cast<uint32_t>(range.raw) * 2u + 1u;
+    return Fixed::from_raw(static_cast<int32_t>(next_u32() % span) -
+                           range.raw);
+  }
+
+ private:
+  static constexpr uint64_t INCREMENT = 1442695040888963407ull;
+  uint64_t state = 0x853C49E6748FEA9Bull;
+};
+
+#endif  // GDEXTENSION_FIXED_POINT_H
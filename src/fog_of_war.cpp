@@ -0,0 +1,444 @@
+#include "fog_of_war.hpp"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/navigation_mesh.hpp>
+#include <godot_cpp/classes/navigation_region3d.hpp>
+#include <godot_cpp/classes/physics_direct_space_state3d.hpp>
+#include <godot_cpp/classes/physics_ray_query_parameters3d.hpp>
+#include <godot_cpp/classes/viewport.hpp>
+#include <godot_cpp/classes/world3d.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "match_manager.hpp"
+#include "unit.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Dictionary;
+using godot::Engine;
+using godot::NavigationMesh;
+using godot::NavigationRegion3D;
+using godot::PackedInt32Array;
+using godot::PackedVector3Array;
+using godot::PhysicsDirectSpaceState3D;
+using godot::PhysicsRayQueryParameters3D;
+using godot::PropertyInfo;
+using godot::Ref;
+using godot::Transform3D;
+using godot::UtilityFunctions;
+using godot::Variant;
+using godot::World3D;
+
+namespace {
+
+// Collision baking casts from this far above the map origin to this far
+// below it.
+constexpr float BAKE_RAY_REACH = 1000.0f;
+
+}  // namespace
+
+FogOfWar::FogOfWar() = default;
+
+FogOfWar::~FogOfWar() = default;
+
+void FogOfWar::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_map_origin", "origin"),
+                       &FogOfWar::set_map_origin);
+  ClassDB::bind_method(D_METHOD("get_map_origin"), &FogOfWar::get_map_origin);
+  ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "map_origin"), "set_map_origin",
+               "get_map_origin");
+
+  ClassDB::bind_method(D_METHOD("set_map_size", "size"),
+                       &FogOfWar::set_map_size);
+  ClassDB::bind_method(D_METHOD("get_map_size"), &FogOfWar::get_map_size);
+  ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "map_size"), "set_map_size",
+               "get_map_size");
+
+  ClassDB::bind_method(D_METHOD("set_cell_size", "size"),
+                       &FogOfWar::set_cell_size);
+  ClassDB::bind_method(D_METHOD("get_cell_size"), &FogOfWar::get_cell_size);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "cell_size",
+                            godot::PROPERTY_HINT_RANGE, "0.25,16,0.25"),
+               "set_cell_size", "get_cell_size");
+
+  ClassDB::bind_method(D_METHOD("set_occluder_source", "source"),
+                       &FogOfWar::set_occluder_source);
+  ClassDB::bind_method(D_METHOD("get_occluder_source"),
+                       &FogOfWar::get_occluder_source);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "occluder_source",
+                            godot::PROPERTY_HINT_ENUM,
+                            "None,Navigation Mesh,Collision"),
+               "set_occluder_source", "get_occluder_source");
+
+  ClassDB::bind_method(D_METHOD("set_navigation_region", "region"),
+                       &FogOfWar::set_navigation_region);
+  ClassDB::bind_method(D_METHOD("get_navigation_region"),
+                       &FogOfWar::get_navigation_region);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "navigation_region",
+                            godot::PROPERTY_HINT_NODE_TYPE,
+                            "NavigationRegion3D"),
+               "set_navigation_region", "get_navigation_region");
+
+  ClassDB::bind_method(D_METHOD("set_collision_mask", "mask"),
+                       &FogOfWar::set_collision_mask);
+  ClassDB::bind_method(D_METHOD("get_collision_mask"),
+                       &FogOfWar::get_collision_mask);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_mask",
+                            godot::PROPERTY_HINT_LAYERS_3D_PHYSICS),
+               "set_collision_mask", "get_collision_mask");
+
+  ClassDB::bind_method(D_METHOD("set_sight_step_height", "height"),
+                       &FogOfWar::set_sight_step_height);
+  ClassDB::bind_method(D_METHOD("get_sight_step_height"),
+                       &FogOfWar::get_sight_step_height);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "sight_step_height"),
+               "set_sight_step_height", "get_sight_step_height");
+
+  ClassDB::bind_method(D_METHOD("bake_occluders"), &FogOfWar::bake_occluders);
+
+  ClassDB::bind_method(D_METHOD("set_viewer_faction", "faction"),
+                       &FogOfWar::set_viewer_faction);
+  ClassDB::bind_method(D_METHOD("get_viewer_faction"),
+                       &FogOfWar::get_viewer_faction);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "viewer_faction"),
+               "set_viewer_faction", "get_viewer_faction");
+
+  ClassDB::bind_method(D_METHOD("set_hide_unseen_units", "hide"),
+                       &FogOfWar::set_hide_unseen_units);
+  ClassDB::bind_method(D_METHOD("get_hide_unseen_units"),
+                       &FogOfWar::get_hide_unseen_units);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "hide_unseen_units"),
+               "set_hide_unseen_units", "get_hide_unseen_units");
+
+  ClassDB::bind_method(D_METHOD("is_position_visible", "faction", "position"),
+                       &FogOfWar::is_position_visible);
+  ClassDB::bind_method(D_METHOD("is_unit_visible", "faction", "unit"),
+                       &FogOfWar::is_unit_visible);
+  ClassDB::bind_method(D_METHOD("get_visible_cell_count", "faction"),
+                       &FogOfWar::get_visible_cell_count);
+  ClassDB::bind_method(D_METHOD("get_last_update_stamps"),
+                       &FogOfWar::get_last_update_stamps);
+  ClassDB::bind_method(D_METHOD("get_last_update_sight_passes"),
+                       &FogOfWar::get_last_update_sight_passes);
+}
+
+void FogOfWar::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    set_process(false);
+    set_physics_process(false);
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+  _configure();
+}
+
+void FogOfWar::_exit_tree() {
+  if (match == nullptr) {
+    return;
+  }
+  _clear_fog();
+  match->get_unit_registry().get_visibility_grid().configure(Vector3(), 0, 0,
+                                                             cell_size);
+  match = nullptr;
+}
+
+void FogOfWar::_process(double delta) {
+  if (match == nullptr) {
+    return;
+  }
+
+  UnitRegistry& registry = match->get_unit_registry();
+  const VisibilityGrid& visibility = registry.get_visibility_grid();
+  const int32_t faction = _resolve_viewer_faction();
+  if (!hide_unseen_units || faction < 0) {
+    _clear_fog();
+    return;
+  }
+
+  // set_fogged() is a no-op unless the unit went in or out of sight.
+  const int32_t layer = visibility.find_layer(faction);
+  const int32_t slot_count = registry.get_slot_count();
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    if (registry.get_unit(slot) == nullptr) {
+      continue;
+    }
+    const bool visible =
+        registry.get_faction(slot) == faction ||
+        (layer >= 0 && visibility.is_slot_visible(layer, slot));
+    registry.set_fogged(slot, !visible);
+  }
+}
+
+void FogOfWar::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  // Colliders are only in the physics space from the first physics frame;
+  // this runs before the match's first visibility update.
+  set_physics_process(false);
+  bake_occluders();
+}
+
+void FogOfWar::set_map_origin(const Vector3& origin) {
+  map_origin = origin;
+  _configure();
+}
+
+Vector3 FogOfWar::get_map_origin() const {
+  return map_origin;
+}
+
+void FogOfWar::set_map_size(const Vector2& size) {
+  map_size = size;
+  _configure();
+}
+
+Vector2 FogOfWar::get_map_size() const {
+  return map_size;
+}
+
+void FogOfWar::set_cell_size(float size) {
+  cell_size = size > 0.0f ? size : 2.0f;
+  _configure();
+}
+
+float FogOfWar::get_cell_size() const {
+  return cell_size;
+}
+
+void FogOfWar::set_occluder_source(int32_t source) {
+  occluder_source = source >= OCCLUDERS_NONE && source <= OCCLUDERS_COLLISION
+                        ? source
+                        : OCCLUDERS_NONE;
+}
+
+int32_t FogOfWar::get_occluder_source() const {
+  return occluder_source;
+}
+
+void FogOfWar::set_navigation_region(NavigationRegion3D* region) {
+  navigation_region = region;
+}
+
+NavigationRegion3D* FogOfWar::get_navigation_region() const {
+  return navigation_region;
+}
+
+void FogOfWar::set_collision_mask(int64_t mask) {
+  collision_mask = mask;
+}
+
+int64_t FogOfWar::get_collision_mask() const {
+  return collision_mask;
+}
+
+void FogOfWar::set_sight_step_height(float height) {
+  sight_step_height = height < 0.0f ? 0.0f : height;
+  if (match != nullptr) {
+    VisibilityGrid& visibility =
+        match->get_unit_registry().get_visibility_grid();
+    visibility.get_occluders().set_step_height(sight_step_height);
+    visibility.invalidate_sight();
+  }
+}
+
+float FogOfWar::get_sight_step_height() const {
+  return sight_step_height;
+}
+
+void FogOfWar::bake_occluders() {
+  if (match == nullptr) {
+    return;
+  }
+
+  VisibilityGrid& visibility = match->get_unit_registry().get_visibility_grid();
+  if (!visibility.is_enabled()) {
+    return;
+  }
+  OccluderGrid& occluders = visibility.get_occluders();
+  occluders.reset(visibility.get_width(), visibility.get_depth());
+  occluders.set_step_height(sight_step_height);
+  if (occluder_source == OCCLUDERS_NAVIGATION_MESH) {
+    _bake_from_navigation_mesh(occluders);
+  } else if (occluder_source == OCCLUDERS_COLLISION) {
+    _bake_from_collision(occluders);
+  }
+  visibility.invalidate_sight();
+}
+
+void FogOfWar::set_viewer_faction(int32_t faction) {
+  viewer_faction = faction;
+}
+
+int32_t FogOfWar::get_viewer_faction() const {
+  return viewer_faction;
+}
+
+void FogOfWar::set_hide_unseen_units(bool hide) {
+  hide_unseen_units = hide;
+}
+
+bool FogOfWar::get_hide_unseen_units() const {
+  return hide_unseen_units;
+}
+
+bool FogOfWar::is_position_visible(int32_t faction,
+                                   const Vector3& position) const {
+  if (match == nullptr) {
+    return true;
+  }
+  return match->get_unit_registry().get_visibility_grid().can_see_position(
+      faction, position);
+}
+
+bool FogOfWar::is_unit_visible(int32_t faction, Unit* unit) const {
+  if (match == nullptr || unit == nullptr) {
+    return unit != nullptr;
+  }
+  const int32_t slot = unit->get_registry_slot();
+  const UnitRegistry& registry = match->get_unit_registry();
+  if (registry.get_unit(slot) != unit) {
+    return false;
+  }
+  return registry.get_faction(slot) == faction ||
+         registry.get_visibility_grid().can_see(faction, slot);
+}
+
+int32_t FogOfWar::get_visible_cell_count(int32_t faction) const {
+  if (match == nullptr) {
+    return 0;
+  }
+  return match->get_unit_registry()
+      .get_visibility_grid()
+      .get_visible_cell_count(faction);
+}
+
+int32_t FogOfWar::get_last_update_stamps() const {
+  if (match == nullptr) {
+    return 0;
+  }
+  return match->get_unit_registry()
+      .get_visibility_grid()
+      .get_last_update_stamps();
+}
+
+int32_t FogOfWar::get_last_update_sight_passes() const {
+  if (match == nullptr) {
+    return 0;
+  }
+  return match->get_unit_registry()
+      .get_visibility_grid()
+      .get_last_update_sight_passes();
+}
+
+void FogOfWar::_configure() {
+  if (match == nullptr) {
+    return;
+  }
+  const int32_t width =
+      static_cast<int32_t>(std::ceil(map_size.x / cell_size));
+  const int32_t depth =
+      static_cast<int32_t>(std::ceil(map_size.y / cell_size));
+  match->get_unit_registry().get_visibility_grid().configure(
+      map_origin, width, depth, cell_size);
+  // Occluders are baked again on the next physics frame.
+  set_physics_process(true);
+}
+
+void FogOfWar::_bake_from_navigation_mesh(OccluderGrid& occluders) {
+  if (navigation_region == nullptr) {
+    UtilityFunctions::push_warning(
+        "[FogOfWar] navigation_region is not set; nothing blocks sight.");
+    return;
+  }
+  Ref<NavigationMesh> mesh = navigation_region->get_navigation_mesh();
+  if (mesh.is_null()) {
+    return;
+  }
+
+  // Vertices in cell units on XZ, world height on Y.
+  const Transform3D xform = navigation_region->get_global_transform();
+  const PackedVector3Array vertices = mesh->get_vertices();
+  const int32_t vertex_count = static_cast<int32_t>(vertices.size());
+  std::vector<Vector3> grid_vertices(vertex_count);
+  for (int32_t index = 0; index < vertex_count; ++index) {
+    const Vector3 world = xform.xform(vertices[index]);
+    grid_vertices[index] = Vector3((world.x - map_origin.x) / cell_size,
+                                   world.y,
+                                   (world.z - map_origin.z) / cell_size);
+  }
+
+  occluders.fill(OccluderGrid::WALL);
+  const int32_t polygon_count = mesh->get_polygon_count();
+  for (int32_t polygon = 0; polygon < polygon_count; ++polygon) {
+    const PackedInt32Array indices = mesh->get_polygon(polygon);
+    const int32_t corner_count = static_cast<int32_t>(indices.size());
+    bool valid = corner_count >= 3;
+    for (int32_t corner = 0; valid && corner < corner_count; ++corner) {
+      valid = indices[corner] >= 0 && indices[corner] < vertex_count;
+    }
+    if (!valid) {
+      continue;
+    }
+    // Navigation polygons are convex, so a fan covers them.
+    for (int32_t corner = 1; corner + 1 < corner_count; ++corner) {
+      occluders.add_surface_triangle(grid_vertices[indices[0]],
+                                     grid_vertices[indices[corner]],
+                                     grid_vertices[indices[corner + 1]]);
+    }
+  }
+  occluders.close_surface_gaps(
+      static_cast<int32_t>(std::ceil(mesh->get_agent_radius() / cell_size)));
+}
+
+void FogOfWar::_bake_from_collision(OccluderGrid& occluders) {
+  Ref<World3D> world = get_viewport()->find_world_3d();
+  PhysicsDirectSpaceState3D* space =
+      world.is_valid() ? world->get_direct_space_state() : nullptr;
+  if (space == nullptr) {
+    return;
+  }
+
+  Ref<PhysicsRayQueryParameters3D> query = PhysicsRayQueryParameters3D::create(
+      Vector3(), Vector3(), static_cast<uint32_t>(collision_mask));
+  occluders.fill(OccluderGrid::OPEN);
+  const int32_t width = occluders.get_width();
+  const int32_t depth = occluders.get_depth();
+  for (int32_t z = 0; z < depth; ++z) {
+    for (int32_t x = 0; x < width; ++x) {
+      const Vector3 center =
+          map_origin + Vector3((x + 0.5f) * cell_size, 0.0f,
+                               (z + 0.5f) * cell_size);
+      query->set_from(center + Vector3(0.0f, BAKE_RAY_REACH, 0.0f));
+      query->set_to(center - Vector3(0.0f, BAKE_RAY_REACH, 0.0f));
+      const Dictionary hit = space->intersect_ray(query);
+      if (!hit.is_empty()) {
+        const Vector3 position = hit["position"];
+        occluders.set_height(z * width + x, position.y);
+      }
+    }
+  }
+}
+
+int32_t FogOfWar::_resolve_viewer_faction() const {
+  if (viewer_faction >= 0) {
+    return viewer_faction;
+  }
+  const Unit* main_unit = match->get_main_unit();
+  return main_unit != nullptr ? main_unit->get_faction_id() : -1;
+}
+
+void FogOfWar::_clear_fog() {
+  UnitRegistry& registry = match->get_unit_registry();
+  const int32_t slot_count = registry.get_slot_count();
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    registry.set_fogged(slot, false);
+  }
+}
@@ -0,0 +1,114 @@
+#ifndef GDEXTENSION_FOG_OF_WAR_H
+#define GDEXTENSION_FOG_OF_WAR_H
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/vector2.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+#include <cstdint>
+
+using godot::Node;
+using godot::Vector2;
+using godot::Vector3;
+
+namespace godot {
+class NavigationRegion3D;
+}  // namespace godot
+
+class MatchManager;
+class OccluderGrid;
+class Unit;
+
+// Turns on fog of war for its match. Sets up the registry's VisibilityGrid
+// over the map rectangle; the match then updates it every tick from each
+// unit's faction_id and sight_radius.
+//
+// Auto-acquisition (TestMovement, UtilityAI) only picks targets the unit's
+// faction sees, and units the viewer faction does not see are not drawn.
+// Without a FogOfWar every unit is visible to everyone.
+//
+// Sight is blocked by higher ground and walls, baked into an OccluderGrid
+// on the first physics frame instead of casting rays per unit: either from
+// the navigation mesh (cells it does not cover are walls) or from one
+// downward ray per cell against the collision_mask layers.
+class FogOfWar : public Node {
+  GDCLASS(FogOfWar, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  enum OccluderSource {
+    OCCLUDERS_NONE,
+    OCCLUDERS_NAVIGATION_MESH,
+    OCCLUDERS_COLLISION,
+  };
+
+  FogOfWar();
+  ~FogOfWar();
+
+  void _ready() override;
+  void _exit_tree() override;
+  void _process(double delta) override;
+  void _physics_process(double delta) override;
+
+  // Map rectangle on the ground plane, from its minimum corner. Changing it
+  // or the cell size starts the fog over.
+  void set_map_origin(const Vector3& origin);
+  Vector3 get_map_origin() const;
+  void set_map_size(const Vector2& size);
+  Vector2 get_map_size() const;
+  void set_cell_size(float size);
+  float get_cell_size() const;
+
+  void set_occluder_source(int32_t source);
+  int32_t get_occluder_source() const;
+  // Region whose navigation mesh is baked for OCCLUDERS_NAVIGATION_MESH.
+  void set_navigation_region(godot::NavigationRegion3D* region);
+  godot::NavigationRegion3D* get_navigation_region() const;
+  // Physics layers of the terrain for OCCLUDERS_COLLISION.
+  void set_collision_mask(int64_t mask);
+  int64_t get_collision_mask() const;
+  // Ground up to this much higher than the viewer's does not block.
+  void set_sight_step_height(float height);
+  float get_sight_step_height() const;
+  // Bakes again from the current source, e.g. after the terrain changed.
+  void bake_occluders();
+
+  // Faction whose view is drawn; -1 follows the main unit.
+  void set_viewer_faction(int32_t faction);
+  int32_t get_viewer_faction() const;
+
+  // Off keeps the fog for gameplay but draws every unit (spectators).
+  void set_hide_unseen_units(bool hide);
+  bool get_hide_unseen_units() const;
+
+  bool is_position_visible(int32_t faction, const Vector3& position) const;
+  bool is_unit_visible(int32_t faction, Unit* unit) const;
+  int32_t get_visible_cell_count(int32_t faction) const;
+  // Units re-stamped by the last tick's update, and how many of those moved
+  // to a new cell and recomputed their line of sight.
+  int32_t get_last_update_stamps() const;
+  int32_t get_last_update_sight_passes() const;
+
+ private:
+  void _configure();
+  void _bake_from_navigation_mesh(OccluderGrid& occluders);
+  void _bake_from_collision(OccluderGrid& occluders);
+  int32_t _resolve_viewer_faction() const;
+  void _clear_fog();
+
+  Vector3 map_origin = Vector3(-128, 0, -128);
+  Vector2 map_size = Vector2(256, 256);
+  float cell_size = 2.0f;
+  int32_t viewer_faction = -1;
+  bool hide_unseen_units = true;
+  int32_t occluder_source = OCCLUDERS_NONE;
+  godot::NavigationRegion3D* navigation_region = nullptr;
+  int64_t collision_mask = 1;
+  float sight_step_height = 1.0f;
+
+  MatchManager* match = nullptr;
+};
+
+#endif  // GDEXTENSION_FOG_OF_WAR_H
@@ -0,0 +1,123 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+namespace {
+
+std::atomic<int64_t> total_heap_allocations{0};
+std::atomic<int64_t> peak_high_water_mark{0};
+
+size_t align_up(uintptr_t address, size_t alignment) {
+  return (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+}
+
+}  // namespace
+
+FrameArena::FrameArena(size_t initial_capacity) : capacity(initial_capacity) {
+  buffer = static_cast<uint8_t*>(_heap_allocate(capacity));
+}
+
+FrameArena::~FrameArena() {
+  while (overflow != nullptr) {
+    Overflow* next = overflow->next;
+    std::free(overflow);
+    overflow = next;
+  }
+  std::free(buffer);
+}
+
+FrameArena& FrameArena::get() {
+  thread_local FrameArena arena;
+  return arena;
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+  const uintptr_t base = reinterpret_cast<uintptr_t>(buffer);
+  const size_t start = align_up(base + offset, alignment) - base;
+  if (start + bytes > capacity) {
+    return _allocate_overflow(bytes, alignment);
+  }
+  offset = start + bytes;
+  return buffer + start;
+}
+
+void FrameArena::reset() {
+  last_tick_used = get_used();
+  high_water_mark = std::max(high_water_mark, last_tick_used);
+  int64_t peak = peak_high_water_mark.load(std::memory_order_relaxed);
+  while (static_cast<int64_t>(high_water_mark) > peak &&
+         !peak_high_water_mark.compare_exchange_weak(
+             peak, static_cast<int64_t>(high_water_mark),
+             std::memory_order_relaxed)) {
+  }
+
+  while (overflow != nullptr) {
+    Overflow* next = overflow->next;
+    std::free(overflow);
+    overflow = next;
+  }
+
+  if (overflow_bytes > 0) {
+    // Grow once, with headroom, so the next tick of this size fits.
+    std::free(buffer);
+    capacity = std::max(capacity * 2, high_water_mark + high_water_mark / 2);
+    buffer = static_cast<uint8_t*>(_heap_allocate(capacity));
+    overflow_bytes = 0;
+  } else {
+#ifdef DEBUG_ENABLED
+    std::memset(buffer, POISON, offset);
+#endif
+  }
+  offset = 0;
+}
+
+size_t FrameArena::get_capacity() const {
+  return capacity;
+}
+
+size_t FrameArena::get_used() const {
+  return offset + overflow_bytes;
+}
+
+size_t FrameArena::get_last_tick_used() const {
+  return last_tick_used;
+}
+
+size_t FrameArena::get_high_water_mark() const {
+  return high_water_mark;
+}
+
+int64_t FrameArena::get_heap_allocation_count() const {
+  return heap_allocations;
+}
+
+int64_t FrameArena::get_total_heap_allocations() {
+  return total_heap_allocations.load(std::memory_order_relaxed);
+}
+
+int64_t FrameArena::get_peak_high_water_mark() {
+  return peak_high_water_mark.load(std::memory_order_relaxed);
+}
+
+void* FrameArena::_allocate_overflow(size_t bytes, size_t alignment) {
+  // Header, then the value at its alignment.
+  const size_t header = align_up(sizeof(Overflow), alignment);
+  auto block =
+      static_cast<Overflow*>(_heap_allocate(header + bytes + alignment));
+  block->next = overflow;
+  overflow = block;
+  overflow_bytes += bytes;
+
+  const uintptr_t data =
+      align_up(reinterpret_cast<uintptr_t>(block) + header, alignment);
+  return reinterpret_cast<void*>(data);
+}
+
+void* FrameArena::_heap_allocate(size_t bytes) {
+  void* memory = std::malloc(bytes);
+  heap_allocations++;
+  total_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  return memory;
+}
@@ -0,0 +1,145 @@
+#ifndef GDEXTENSION_FRAME_ARENA_H
+#define GDEXTENSION_FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Linear allocator for transient simulation data whose size changes from
+// tick to tick, such as UtilityAI's scoring arrays. Buffers of a steady size
+// (snapshot encoding, the fog of war scratch) stay members reused across
+// ticks, and spatial queries visit results without a buffer; neither
+// allocates after warm-up. Allocating here is a pointer bump and everything
+// is released at once by reset(), which the match calls at the end of each
+// physics tick. Every thread has its own arena (get()), so matches stepped
+// on worker threads never share one.
+//
+// Memory is valid until the next reset; never keep it past the node
+// callback that allocated it. No destructors run, so only trivially
+// destructible types go in.
+//
+// A tick that needs more than the capacity is served from overflow blocks
+// on the heap, and the arena grows past the high-water mark at the next
+// reset. After warm-up the arena makes no heap allocations, which a flat
+// get_total_heap_allocations() shows; it only counts the arena's own, not
+// the rest of the tick's. Debug builds poison released memory so stale
+// pointers read garbage instead of plausible data.
+class FrameArena {
+ public:
+  static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+  static constexpr uint8_t POISON = 0xcd;
+
+  explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+  ~FrameArena();
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  // The calling thread's arena.
+  static FrameArena& get();
+
+  void* allocate(size_t bytes, size_t alignment);
+  // Uninitialized storage for count values.
+  template <typename T>
+  T* allocate_array(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "FrameArena never runs destructors");
+    return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+  }
+
+  // Releases everything allocated since the last reset.
+  void reset();
+
+  size_t get_capacity() const;
+  // Bytes handed out since the last reset, overflow included.
+  size_t get_used() const;
+  size_t get_last_tick_used() const;
+  size_t get_high_water_mark() const;
+  // Heap allocations made by this arena: the buffer, growth and overflow.
+  int64_t get_heap_allocation_count() const;
+
+  // Totals over every thread's arena, safe to read from any thread. Heap
+  // allocations made outside the arenas are not counted.
+  static int64_t get_total_heap_allocations();
+  static int64_t get_peak_high_water_mark();
+
+ private:
+  // Header of a heap block that serves a tick past the capacity.
+  struct Overflow {
+    Overflow* next;
+  };
+
+  void* _allocate_overflow(size_t bytes, size_t alignment);
+  void* _heap_allocate(size_t bytes);
+
+  uint8_t* buffer = nullptr;
+  size_t capacity = 0;
+  size_t offset = 0;
+  Overflow* overflow = nullptr;
+  size_t overflow_bytes = 0;
+
+  size_t last_tick_used = 0;
+  size_t high_water_mark = 0;
+  int64_t heap_allocations = 0;
+};
+
+// Growable array in the frame arena, for result lists of unknown length.
+// Growing moves the values to a larger block; the old one is reclaimed at
+// the reset like everything else.
+template <typename T>
+class FrameVector {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "FrameVector moves values with memcpy");
+
+ public:
+  explicit FrameVector(size_t initial_capacity = 16,
+                       FrameArena& arena = FrameArena::get())
+      : arena(&arena), capacity(initial_capacity > 0 ? initial_capacity : 1) {
+    values = arena.allocate_array<T>(capacity);
+  }
+
+  void push_back(const T& value) {
+    if (count == capacity) {
+      _grow(capacity * 2);
+    }
+    values[count++] = value;
+  }
+
+  // New values are value-initialized.
+  void resize(size_t new_count) {
+    if (new_count > capacity) {
+      _grow(new_count);
+    }
+    for (size_t index = count; index < new_count; ++index) {
+      values[index] = T();
+    }
+    count = new_count;
+  }
+
+  void clear() { count = 0; }
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  T* data() { return values; }
+  const T* data() const { return values; }
+  T& operator[](size_t index) { return values[index]; }
+  const T& operator[](size_t index) const { return values[index]; }
+  T* begin() { return values; }
+  T* end() { return values + count; }
+  const T* begin() const { return values; }
+  const T* end() const { return values + count; }
+
+ private:
+  void _grow(size_t new_capacity) {
+    T* grown = arena->allocate_array<T>(new_capacity);
+    std::memcpy(static_cast<void*>(grown), values, sizeof(T) * count);
+    values = grown;
+    capacity = new_capacity;
+  }
+
+  FrameArena* arena;
+  T* values = nullptr;
+  size_t count = 0;
+  size_t capacity;
+};
+
+#endif  // GDEXTENSION_FRAME_ARENA_H
@@ -0,0 +1,330 @@
+#include "health_bar_renderer.hpp"
+
+#include <algorithm>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/quad_mesh.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/shader.hpp>
+#include <godot_cpp/classes/shader_material.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/variant.hpp>
+
+#include "match_manager.hpp"
+#include "unit_registry.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::PropertyInfo;
+using godot::QuadMesh;
+using godot::RenderingServer;
+using godot::Shader;
+using godot::ShaderMaterial;
+using godot::Variant;
+
+namespace {
+// Custom data: r = health ratio, g = resource ratio (negative when the unit
+// has none), a = visible.
+const char* const BAR_SHADER_CODE = R"(shader_type spatial;
+render_mode unshaded, cull_disabled, shadows_disabled;
+
+uniform vec4 health_color : source_color;
+uniform vec4 resource_color : source_color;
+uniform vec4 background_color : source_color;
+
+varying vec4 bar;
+
+void vertex() {
+  bar = INSTANCE_CUSTOM;
+  MODELVIEW_MATRIX = VIEW_MATRIX * mat4(INV_VIEW_MATRIX[0], INV_VIEW_MATRIX[1],
+                                        INV_VIEW_MATRIX[2], MODEL_MATRIX[3]);
+}
+
+void fragment() {
+  if (bar.a <= 0.0) {
+    discard;
+  }
+  bool resource_row = bar.g >= 0.0 && UV.y > 0.65;
+  float fill = resource_row ? bar.g : bar.r;
+  vec4 fill_color = resource_row ? resource_color : health_color;
+  vec4 color = UV.x <= fill ? fill_color : background_color;
+  ALBEDO = color.rgb;
+  ALPHA = color.a;
+}
+)";
+
+// Slots updated one by one up to this share of the instance count; past it a
+// single full buffer upload is cheaper than that many server calls.
+constexpr int32_t PARTIAL_UPDATE_DIVISOR = 4;
+}  // namespace
+
+HealthBarRenderer::HealthBarRenderer() = default;
+
+HealthBarRenderer::~HealthBarRenderer() = default;
+
+void HealthBarRenderer::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_bar_size", "size"),
+                       &HealthBarRenderer::set_bar_size);
+  ClassDB::bind_method(D_METHOD("get_bar_size"),
+                       &HealthBarRenderer::get_bar_size);
+  ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "bar_size"), "set_bar_size",
+               "get_bar_size");
+
+  ClassDB::bind_method(D_METHOD("set_bar_height", "height"),
+                       &HealthBarRenderer::set_bar_height);
+  ClassDB::bind_method(D_METHOD("get_bar_height"),
+                       &HealthBarRenderer::get_bar_height);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "bar_height"), "set_bar_height",
+               "get_bar_height");
+
+  ClassDB::bind_method(D_METHOD("set_health_color", "color"),
+                       &HealthBarRenderer::set_health_color);
+  ClassDB::bind_method(D_METHOD("get_health_color"),
+                       &HealthBarRenderer::get_health_color);
+  ADD_PROPERTY(PropertyInfo(Variant::COLOR, "health_color"),
+               "set_health_color", "get_health_color");
+
+  ClassDB::bind_method(D_METHOD("set_resource_color", "color"),
+                       &HealthBarRenderer::set_resource_color);
+  ClassDB::bind_method(D_METHOD("get_resource_color"),
+                       &HealthBarRenderer::get_resource_color);
+  ADD_PROPERTY(PropertyInfo(Variant::COLOR, "resource_color"),
+               "set_resource_color", "get_resource_color");
+
+  ClassDB::bind_method(D_METHOD("set_background_color", "color"),
+                       &HealthBarRenderer::set_background_color);
+  ClassDB::bind_method(D_METHOD("get_background_color"),
+                       &HealthBarRenderer::get_background_color);
+  ADD_PROPERTY(PropertyInfo(Variant::COLOR, "background_color"),
+               "set_background_color", "get_background_color");
+
+  ClassDB::bind_method(D_METHOD("get_last_update_count"),
+                       &HealthBarRenderer::get_last_update_count);
+}
+
+void HealthBarRenderer::_enter_tree() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  MatchManager* match = MatchManager::find_for(this);
+  if (match == nullptr) {
+    return;
+  }
+
+  _ensure_multimesh();
+  unit_registry = &match->get_unit_registry();
+
+  // Start from a full upload so bars of units registered earlier show up.
+  _reserve_instances(unit_registry->get_slot_count());
+  const int32_t slot_count = unit_registry->get_slot_count();
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    _write_instance(slot);
+  }
+  RenderingServer::get_singleton()->multimesh_set_buffer(bars->get_rid(),
+                                                         bar_buffer);
+  bar_reader = unit_registry->add_bar_reader();
+}
+
+void HealthBarRenderer::_exit_tree() {
+  if (unit_registry != nullptr) {
+    unit_registry->remove_bar_reader(bar_reader);
+  }
+  unit_registry = nullptr;
+}
+
+void HealthBarRenderer::_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  if (unit_registry == nullptr) {
+    return;
+  }
+
+  const int32_t* updates = unit_registry->get_bar_updates(bar_reader);
+  last_update_count = unit_registry->get_bar_update_count(bar_reader);
+  if (last_update_count == 0) {
+    return;
+  }
+
+  const bool resized = _reserve_instances(unit_registry->get_slot_count());
+  for (int32_t index = 0; index < last_update_count; ++index) {
+    _write_instance(updates[index]);
+  }
+
+  RenderingServer* rendering_server = RenderingServer::get_singleton();
+  const RID bars_rid = bars->get_rid();
+  const int32_t instance_count = bars->get_instance_count();
+  if (resized ||
+      last_update_count > instance_count / PARTIAL_UPDATE_DIVISOR) {
+    rendering_server->multimesh_set_buffer(bars_rid, bar_buffer);
+  } else {
+    const float* data = bar_buffer.ptr();
+    for (int32_t index = 0; index < last_update_count; ++index) {
+      const int32_t slot = updates[index];
+      const float* instance = data + slot * FLOATS_PER_INSTANCE;
+      Transform3D xform;
+      for (int32_t row = 0; row < 3; ++row) {
+        xform.basis.rows[row] =
+            Vector3(instance[row * 4 + 0], instance[row * 4 + 1],
+                    instance[row * 4 + 2]);
+        xform.origin[row] = instance[row * 4 + 3];
+      }
+      rendering_server->multimesh_instance_set_transform(bars_rid, slot,
+                                                         xform);
+      rendering_server->multimesh_instance_set_custom_data(
+          bars_rid, slot,
+          Color(instance[12], instance[13], instance[14], instance[15]));
+    }
+  }
+
+  unit_registry->finish_bar_updates(bar_reader);
+}
+
+void HealthBarRenderer::set_bar_size(const Vector2& size) {
+  bar_size = size;
+  if (bars.is_valid()) {
+    Ref<QuadMesh> quad = bars->get_mesh();
+    if (quad.is_valid()) {
+      quad->set_size(bar_size);
+    }
+  }
+}
+
+Vector2 HealthBarRenderer::get_bar_size() const {
+  return bar_size;
+}
+
+void HealthBarRenderer::set_bar_height(float height) {
+  bar_height = height;
+}
+
+float HealthBarRenderer::get_bar_height() const {
+  return bar_height;
+}
+
+void HealthBarRenderer::set_health_color(const Color& color) {
+  health_color = color;
+  _apply_material_colors();
+}
+
+Color HealthBarRenderer::get_health_color() const {
+  return health_color;
+}
+
+void HealthBarRenderer::set_resource_color(const Color& color) {
+  resource_color = color;
+  _apply_material_colors();
+}
+
+Color HealthBarRenderer::get_resource_color() const {
+  return resource_color;
+}
+
+void HealthBarRenderer::set_background_color(const Color& color) {
+  background_color = color;
+  _apply_material_colors();
+}
+
+Color HealthBarRenderer::get_background_color() const {
+  return background_color;
+}
+
+int32_t HealthBarRenderer::get_last_update_count() const {
+  return last_update_count;
+}
+
+void HealthBarRenderer::_ensure_multimesh() {
+  if (bars.is_valid()) {
+    return;
+  }
+
+  Ref<QuadMesh> quad;
+  quad.instantiate();
+  quad->set_size(bar_size);
+
+  bars.instantiate();
+  bars->set_transform_format(MultiMesh::TRANSFORM_3D);
+  bars->set_use_custom_data(true);
+  bars->set_mesh(quad);
+  set_multimesh(bars);
+
+  if (get_material_override().is_null()) {
+    Ref<Shader> shader;
+    shader.instantiate();
+    shader->set_code(BAR_SHADER_CODE);
+
+    Ref<ShaderMaterial> material;
+    material.instantiate();
+    material->set_shader(shader);
+    set_material_override(material);
+  }
+  _apply_material_colors();
+}
+
+bool HealthBarRenderer::_reserve_instances(int32_t count) {
+  const int32_t current = bars->get_instance_count();
+  if (current >= count && current > 0) {
+    return false;
+  }
+
+  int32_t capacity = std::max(64, current);
+  while (capacity < count) {
+    capacity *= 2;
+  }
+
+  // Resizing drops the server-side data; the caller uploads the full buffer.
+  bars->set_instance_count(capacity);
+  const int64_t old_size = bar_buffer.size();
+  bar_buffer.resize(static_cast<int64_t>(capacity) * FLOATS_PER_INSTANCE);
+  float* data = bar_buffer.ptrw();
+  for (int64_t i = old_size; i < bar_buffer.size(); ++i) {
+    data[i] = 0.0f;
+  }
+  return true;
+}
+
+void HealthBarRenderer::_write_instance(int32_t slot) {
+  float* instance = bar_buffer.ptrw() + slot * FLOATS_PER_INSTANCE;
+
+  if (unit_registry->get_unit(slot) == nullptr ||
+      unit_registry->get_health_ratio(slot) <= 0.0f ||
+      unit_registry->is_fogged(slot)) {
+    // Free slots, dead and fogged units keep their entry but draw nothing.
+    for (int32_t i = 0; i < FLOATS_PER_INSTANCE; ++i) {
+      instance[i] = 0.0f;
+    }
+    return;
+  }
+
+  const Vector3 origin =
+      unit_registry->get_position(slot) + Vector3(0, bar_height, 0);
+  instance[0] = 1.0f;
+  instance[1] = 0.0f;
+  instance[2] = 0.0f;
+  instance[3] = origin.x;
+  instance[4] = 0.0f;
+  instance[5] = 1.0f;
+  instance[6] = 0.0f;
+  instance[7] = origin.y;
+  instance[8] = 0.0f;
+  instance[9] = 0.0f;
+  instance[10] = 1.0f;
+  instance[11] = origin.z;
+  instance[12] = unit_registry->get_health_ratio(slot);
+  instance[13] = unit_registry->get_resource_ratio(slot);
+  instance[14] = 0.0f;
+  instance[15] = 1.0f;
+}
+
+void HealthBarRenderer::_apply_material_colors() {
+  Ref<ShaderMaterial> material = get_material_override();
+  if (material.is_null()) {
+    return;
+  }
+  material->set_shader_parameter("health_color", health_color);
+  material->set_shader_parameter("resource_color", resource_color);
+  material->set_shader_parameter("background_color", background_color);
+}
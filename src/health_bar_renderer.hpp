@@ -0,0 +1,78 @@
+#ifndef GDEXTENSION_HEALTH_BAR_RENDERER_H
+#define GDEXTENSION_HEALTH_BAR_RENDERER_H
+
+#include <godot_cpp/classes/multi_mesh.hpp>
+#include <godot_cpp/classes/multi_mesh_instance3d.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/color.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/vector2.hpp>
+
+using godot::Color;
+using godot::MultiMesh;
+using godot::MultiMeshInstance3D;
+using godot::PackedFloat32Array;
+using godot::Ref;
+using godot::Vector2;
+
+class UnitRegistry;
+
+// Health (and optional resource) bars for every unit of the match, drawn as
+// one billboard MultiMesh. Instance N is registry slot N; fill ratios live in
+// the instance custom data and only slots the registry reports as changed
+// are rewritten each frame.
+class HealthBarRenderer : public MultiMeshInstance3D {
+  GDCLASS(HealthBarRenderer, MultiMeshInstance3D)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  HealthBarRenderer();
+  ~HealthBarRenderer();
+
+  void _enter_tree() override;
+  void _exit_tree() override;
+  void _process(double delta) override;
+
+  void set_bar_size(const Vector2& size);
+  Vector2 get_bar_size() const;
+
+  void set_bar_height(float height);
+  float get_bar_height() const;
+
+  void set_health_color(const Color& color);
+  Color get_health_color() const;
+
+  void set_resource_color(const Color& color);
+  Color get_resource_color() const;
+
+  void set_background_color(const Color& color);
+  Color get_background_color() const;
+
+  int32_t get_last_update_count() const;
+
+ private:
+  // 12 transform + 4 custom data floats.
+  static constexpr int32_t FLOATS_PER_INSTANCE = 16;
+
+  void _ensure_multimesh();
+  bool _reserve_instances(int32_t count);
+  void _write_instance(int32_t slot);
+  void _apply_material_colors();
+
+  Vector2 bar_size = Vector2(1.2f, 0.16f);
+  float bar_height = 2.4f;
+  Color health_color = Color(0.2f, 0.85f, 0.25f, 1.0f);
+  Color resource_color = Color(0.25f, 0.45f, 1.0f, 1.0f);
+  Color background_color = Color(0.05f, 0.05f, 0.05f, 0.8f);
+
+  Ref<MultiMesh> bars;
+  PackedFloat32Array bar_buffer;
+  int32_t last_update_count = 0;
+
+  UnitRegistry* unit_registry = nullptr;
+  int32_t bar_reader = -1;  // Cursor into the registry's bar update log
+};
+
+#endif  // GDEXTENSION_HEALTH_BAR_RENDERER_H
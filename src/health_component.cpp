@@ -8,6 +8,7 @@
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <godot_cpp/variant/variant.hpp>
 
+#include "state_checksum.hpp"
 #include "unit.hpp"
 
 using godot::ClassDB;
@@ -47,12 +48,20 @@ void HealthComponent::_bind_methods() {
       godot::MethodInfo("died", PropertyInfo(Variant::OBJECT, "source")));
 }
 
+void HealthComponent::_ready() {
+  UnitComponent::_ready();
+  spawn_health = current_health;
+  _publish_health_ratio();
+}
+
 void HealthComponent::set_max_health(float value) {
   max_health = std::max(0.0f, value);
   if (current_health > max_health) {
     current_health = max_health;
+    fixed_health = Fixed::from_float(current_health);
   }
   emit_signal("health_changed", current_health, max_health);
+  _publish_health_ratio();
 }
 
 float HealthComponent::get_max_health() const {
@@ -61,9 +70,14 @@ float HealthComponent::get_max_health() const {
 
 void HealthComponent::set_current_health(float value) {
   current_health = std::clamp(value, 0.0f, max_health);
+  fixed_health = Fixed::from_float(current_health);
   emit_signal("health_changed", current_health, max_health);
+  _publish_health_ratio();
 
-  if (current_health <= 0.0f) {
+  if (is_dead()) {
+    if (owner_unit != nullptr) {
+      owner_unit->release_attackers();
+    }
     emit_signal("died", nullptr);
   }
 }
@@ -77,8 +91,10 @@ bool HealthComponent::apply_damage(float amount, godot::Object* source) {
     amount = 0.0f;
   }
 
-  current_health = std::max(0.0f, current_health - amount);
+  _change_health(-amount);
   emit_signal("health_changed", current_health, max_health);
+  _publish_health_ratio();
+  _add_threat(amount, source);
 
   // Log damage
   if (owner_unit != nullptr) {
@@ -94,13 +110,16 @@ bool HealthComponent::apply_damage(float amount, godot::Object* source) {
         godot::String::num(max_health));
   }
 
-  if (current_health <= 0.0f) {
+  if (is_dead()) {
     if (owner_unit != nullptr) {
       UtilityFunctions::print("[HealthComponent] " + owner_unit->get_name() +
                               " died!");
     } else {
       UtilityFunctions::print("[HealthComponent] Unit died!");
     }
+    if (owner_unit != nullptr) {
+      owner_unit->release_attackers();
+    }
     emit_signal("died", source);
     return true;  // Unit died
   }
@@ -113,10 +132,72 @@ void HealthComponent::heal(float amount) {
     amount = 0.0f;
   }
 
-  current_health = std::min(max_health, current_health + amount);
+  _change_health(amount);
   emit_signal("health_changed", current_health, max_health);
+  _publish_health_ratio();
+}
+
+void HealthComponent::reset_state() {
+  current_health = std::min(spawn_health, max_health);
+  fixed_health = Fixed::from_float(current_health);
+  emit_signal("health_changed", current_health, max_health);
+  _publish_health_ratio();
 }
 
 bool HealthComponent::is_dead() const {
+  if (_is_deterministic()) {
+    return fixed_health.raw <= 0;
+  }
   return current_health <= 0.0f;
 }
+
+Fixed HealthComponent::get_fixed_health() const {
+  return fixed_health;
+}
+
+void HealthComponent::_add_threat(float amount, godot::Object* source) {
+  auto attacker = Object::cast_to<Unit>(source);
+  if (owner_unit == nullptr || attacker == nullptr ||
+      owner_unit->get_unit_registry() == nullptr ||
+      attacker->get_unit_registry() != owner_unit->get_unit_registry()) {
+    return;
+  }
+  owner_unit->get_unit_registry()->get_threat_table().add_threat(
+      owner_unit->get_registry_slot(), attacker->get_registry_slot(), amount);
+}
+
+bool HealthComponent::_is_deterministic() const {
+  return owner_unit != nullptr && owner_unit->is_deterministic();
+}
+
+void HealthComponent::_change_health(float amount) {
+  if (_is_deterministic()) {
+    const Fixed max_value = Fixed::from_float(max_health);
+    fixed_health += Fixed::from_float(amount);
+    if (fixed_health < Fixed()) {
+      fixed_health = Fixed();
+    } else if (fixed_health > max_value) {
+      fixed_health = max_value;
+    }
+    current_health = fixed_health.to_float();
+    return;
+  }
+
+  current_health = std::clamp(current_health + amount, 0.0f, max_health);
+  fixed_health = Fixed::from_float(current_health);
+}
+
+void HealthComponent::_publish_health_ratio() {
+  if (owner_unit == nullptr || owner_unit->get_unit_registry() == nullptr) {
+    return;
+  }
+
+  UnitRegistry* registry = owner_unit->get_unit_registry();
+  const int32_t slot = owner_unit->get_registry_slot();
+  const float ratio = max_health > 0.0f ? current_health / max_health : 0.0f;
+  registry->set_health_ratio(slot, ratio);
+  registry->get_state_checksum().set_word(
+      slot, StateChecksum::HEALTH,
+      _is_deterministic() ? static_cast<uint32_t>(fixed_health.raw)
+                          : float_bits(current_health));
+}
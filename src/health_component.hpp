@@ -1,6 +1,7 @@
 #ifndef GDEXTENSION_HEALTH_COMPONENT_H
 #define GDEXTENSION_HEALTH_COMPONENT_H
 
+#include "fixed_point.hpp"
 #include "unit_component.hpp"
 
 class HealthComponent : public UnitComponent {
@@ -11,11 +12,15 @@ class HealthComponent : public UnitComponent {
 
   float max_health = 100.0f;
   float current_health = 100.0f;
+  Fixed fixed_health = Fixed::from_int(100);
+  float spawn_health = 100.0f;  // Health at _ready, restored on reuse
 
  public:
   HealthComponent();
   ~HealthComponent();
 
+  void _ready() override;
+
   void set_max_health(float value);
   float get_max_health() const;
 
@@ -26,6 +31,22 @@ class HealthComponent : public UnitComponent {
   bool apply_damage(float amount, godot::Object* source = nullptr);
   void heal(float amount);
   bool is_dead() const;
+
+  // Back to the health the unit was spawned with, without emitting died.
+  void reset_state() override;
+
+  // Authoritative health in deterministic matches; mirrors current_health
+  // otherwise.
+  Fixed get_fixed_health() const;
+
+ private:
+  // Mirrors the fill ratio into the match registry for the health bar layer.
+  void _publish_health_ratio();
+  // Credits the damage to the attacking unit in the match threat table.
+  void _add_threat(float amount, godot::Object* source);
+  bool _is_deterministic() const;
+  // Applies a health change, in fixed point when deterministic.
+  void _change_health(float amount);
 };
 
 #endif  // GDEXTENSION_HEALTH_COMPONENT_H
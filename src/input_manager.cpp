@@ -1,7 +1,10 @@
 #include "input_manager.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/input_event_mouse_button.hpp>
+#include <godot_cpp/classes/input_event_mouse_motion.hpp>
 #include <godot_cpp/classes/node3d.hpp>
 #include <godot_cpp/classes/physics_direct_space_state3d.hpp>
 #include <godot_cpp/classes/physics_ray_query_parameters3d.hpp>
@@ -16,13 +19,19 @@
 #include <godot_cpp/variant/vector2.hpp>
 
 #include "interactable.hpp"
+#include "match_manager.hpp"
 #include "unit.hpp"
+#include "unit_registry.hpp"
+#include "world_marker_pool.hpp"
 
 using godot::ClassDB;
 using godot::D_METHOD;
 using godot::Dictionary;
 using godot::Engine;
 using godot::InputEventMouseButton;
+using godot::InputEventMouseMotion;
+using godot::MethodInfo;
+using godot::MOUSE_BUTTON_LEFT;
 using godot::MOUSE_BUTTON_RIGHT;
 using godot::Node;
 using godot::Node3D;
@@ -33,14 +42,21 @@ using godot::UtilityFunctions;
 using godot::Variant;
 using godot::Vector2;
 
+namespace {
+// Drags shorter than this (in pixels) are treated as a click selection.
+constexpr float BOX_SELECT_MIN_SIZE = 6.0f;
+// Slack around the ground footprint of the box, covers unit height and
+// radius so units at the rect edges are still considered.
+constexpr float SELECTION_QUERY_MARGIN = 1.5f;
+// Point projected to screen for the selection test, roughly the unit center.
+constexpr float SELECTION_POINT_HEIGHT = 1.0f;
+// Height range around the commanded units searched by hover picking.
+constexpr float PICK_HEIGHT_BAND = 10.0f;
+}  // namespace
+
 InputManager::InputManager() = default;
 
-InputManager::~InputManager() {
-  if (click_marker != nullptr) {
-    click_marker->queue_free();
-    click_marker = nullptr;
-  }
-}
+InputManager::~InputManager() = default;
 
 void InputManager::_bind_methods() {
   ClassDB::bind_method(D_METHOD("set_controlled_unit", "unit"),
@@ -71,6 +87,46 @@ void InputManager::_bind_methods() {
   ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "click_indicator_scene",
                             godot::PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"),
                "set_click_indicator_scene", "get_click_indicator_scene");
+
+  ClassDB::bind_method(D_METHOD("set_formation_spacing", "spacing"),
+                       &InputManager::set_formation_spacing);
+  ClassDB::bind_method(D_METHOD("get_formation_spacing"),
+                       &InputManager::get_formation_spacing);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "formation_spacing"),
+               "set_formation_spacing", "get_formation_spacing");
+
+  ClassDB::bind_method(D_METHOD("select_units_in_rect", "screen_rect"),
+                       &InputManager::select_units_in_rect);
+  ClassDB::bind_method(D_METHOD("clear_selection"),
+                       &InputManager::clear_selection);
+  ClassDB::bind_method(D_METHOD("get_selected_units"),
+                       &InputManager::get_selected_units);
+  ClassDB::bind_method(D_METHOD("is_box_selecting"),
+                       &InputManager::is_box_selecting);
+  ClassDB::bind_method(D_METHOD("get_selection_rect"),
+                       &InputManager::get_selection_rect);
+
+  ClassDB::bind_method(D_METHOD("set_pick_radius", "radius"),
+                       &InputManager::set_pick_radius);
+  ClassDB::bind_method(D_METHOD("get_pick_radius"),
+                       &InputManager::get_pick_radius);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "pick_radius"), "set_pick_radius",
+               "get_pick_radius");
+
+  ClassDB::bind_method(D_METHOD("set_pick_height", "height"),
+                       &InputManager::set_pick_height);
+  ClassDB::bind_method(D_METHOD("get_pick_height"),
+                       &InputManager::get_pick_height);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "pick_height"), "set_pick_height",
+               "get_pick_height");
+
+  ClassDB::bind_method(D_METHOD("get_hovered_unit"),
+                       &InputManager::get_hovered_unit);
+
+  ADD_SIGNAL(MethodInfo("selection_changed",
+                        PropertyInfo(Variant::INT, "selected_count")));
+  ADD_SIGNAL(MethodInfo("hovered_unit_changed",
+                        PropertyInfo(Variant::OBJECT, "unit")));
 }
 
 void InputManager::_ready() {
@@ -90,6 +146,31 @@ void InputManager::_ready() {
       controlled_unit = Object::cast_to<Unit>(parent);
     }
   }
+
+  MatchManager* match = MatchManager::find_for(this);
+  if (match != nullptr) {
+    unit_registry = &match->get_unit_registry();
+  }
+
+  // The terrain query is reused for every click.
+  terrain_query.instantiate();
+  terrain_query->set_collide_with_bodies(true);
+  terrain_query->set_collide_with_areas(true);
+  _refresh_terrain_exclude();
+
+  // Click markers come from the match's marker pool, or from a private one
+  // when the match has none.
+  if (match != nullptr) {
+    marker_pool = match->get_marker_pool();
+  }
+  if (marker_pool == nullptr && click_indicator_scene.is_valid()) {
+    marker_pool = memnew(WorldMarkerPool);
+    add_child(marker_pool);
+  }
+  if (marker_pool != nullptr && click_indicator_scene.is_valid() &&
+      marker_pool->get_click_marker_scene().is_null()) {
+    marker_pool->set_click_marker_scene(click_indicator_scene);
+  }
 }
 
 void InputManager::_input(const Ref<InputEvent>& event) {
@@ -97,16 +178,24 @@ void InputManager::_input(const Ref<InputEvent>& event) {
     return;
   }
 
-  if (controlled_unit == nullptr) {
+  if (auto motion_event = Object::cast_to<InputEventMouseMotion>(event.ptr())) {
+    if (box_selecting) {
+      box_select_end = motion_event->get_position();
+    }
     return;
   }
 
-  // Check for right mouse button click
   auto mouse_event = Object::cast_to<InputEventMouseButton>(event.ptr());
   if (mouse_event == nullptr) {
     return;
   }
 
+  if (mouse_event->get_button_index() == MOUSE_BUTTON_LEFT) {
+    _handle_select_button(mouse_event);
+    return;
+  }
+
+  // Check for right mouse button click
   if (mouse_event->get_button_index() != MOUSE_BUTTON_RIGHT) {
     return;
   }
@@ -115,27 +204,26 @@ void InputManager::_input(const Ref<InputEvent>& event) {
     return;
   }
 
+  if (controlled_unit == nullptr && selected_units.empty()) {
+    return;
+  }
+
+  // Shift appends to each unit's order queue instead of replacing it.
+  const bool queued = mouse_event->is_shift_pressed();
+
+  // Units are picked against the registry first; the physics raycast is
+  // only needed for terrain and interactables.
+  if (Unit* picked_unit = _pick_unit(mouse_event->get_position(),
+                                     controlled_unit)) {
+    _handle_unit_click(picked_unit, queued);
+    return;
+  }
+
   Vector3 click_position;
   godot::Object* clicked_object = nullptr;
   if (_try_raycast(click_position, clicked_object)) {
     if (auto clicked_unit = Object::cast_to<Unit>(clicked_object)) {
-      if (clicked_unit == controlled_unit) {
-        // Ignore right-clicks on the main unit itself.
-        get_viewport()->set_input_as_handled();
-        return;
-      }
-
-      // Allies: do nothing.
-      if (clicked_unit->get_faction_id() == controlled_unit->get_faction_id()) {
-        get_viewport()->set_input_as_handled();
-        return;
-      }
-
-      // Enemies: issue ATTACK order (approach until in range).
-      controlled_unit->issue_attack_order(clicked_unit);
-      UtilityFunctions::print("[InputManager] Issued ATTACK order on: " +
-                              String(clicked_unit->get_name()));
-      get_viewport()->set_input_as_handled();
+      _handle_unit_click(clicked_unit, queued);
       return;
     }
 
@@ -148,22 +236,43 @@ void InputManager::_input(const Ref<InputEvent>& event) {
     }
 
     // Default: treat as terrain/world click.
-    controlled_unit->issue_move_order(click_position);
+    _issue_group_move_order(click_position, queued);
     _show_click_marker(click_position);
     get_viewport()->set_input_as_handled();
   }
 }
 
+void InputManager::_handle_unit_click(Unit* clicked_unit, bool queued) {
+  if (_is_commanded(clicked_unit)) {
+    // Ignore right-clicks on the commanded units themselves.
+    get_viewport()->set_input_as_handled();
+    return;
+  }
+
+  // Allies: do nothing.
+  if (clicked_unit->get_faction_id() == _get_commanding_faction()) {
+    get_viewport()->set_input_as_handled();
+    return;
+  }
+
+  // Enemies: issue ATTACK order (approach until in range).
+  _issue_group_attack_order(clicked_unit, queued);
+  UtilityFunctions::print("[InputManager] Issued ATTACK order on: " +
+                          String(clicked_unit->get_name()));
+  get_viewport()->set_input_as_handled();
+}
+
 void InputManager::_process(double delta) {
   if (Engine::get_singleton()->is_editor_hint()) {
     return;
   }
 
-  _update_click_marker(delta);
+  _update_hovered_unit();
 }
 
 void InputManager::set_controlled_unit(Unit* unit) {
   controlled_unit = unit;
+  _refresh_terrain_exclude();
 }
 
 Unit* InputManager::get_controlled_unit() const {
@@ -188,12 +297,299 @@ float InputManager::get_raycast_distance() const {
 
 void InputManager::set_click_indicator_scene(const Ref<PackedScene>& scene) {
   click_indicator_scene = scene;
+  if (marker_pool != nullptr) {
+    marker_pool->set_click_marker_scene(scene);
+  }
 }
 
 Ref<PackedScene> InputManager::get_click_indicator_scene() const {
   return click_indicator_scene;
 }
 
+void InputManager::set_formation_spacing(float spacing) {
+  formation_spacing = std::max(0.0f, spacing);
+}
+
+float InputManager::get_formation_spacing() const {
+  return formation_spacing;
+}
+
+void InputManager::set_pick_radius(float radius) {
+  unit_picker.set_pick_radius(radius);
+}
+
+float InputManager::get_pick_radius() const {
+  return unit_picker.get_pick_radius();
+}
+
+void InputManager::set_pick_height(float height) {
+  unit_picker.set_pick_height(height);
+}
+
+float InputManager::get_pick_height() const {
+  return unit_picker.get_pick_height();
+}
+
+Unit* InputManager::get_hovered_unit() const {
+  if (unit_registry == nullptr ||
+      unit_registry->get_unit(hovered_slot) != hovered_unit) {
+    return nullptr;  // Freed since the last hover update.
+  }
+  return hovered_unit;
+}
+
+void InputManager::select_units_in_rect(const Rect2& screen_rect) {
+  clear_selection();
+
+  if (unit_registry == nullptr || camera == nullptr) {
+    emit_signal("selection_changed", 0);
+    return;
+  }
+
+  const Rect2 rect = screen_rect.abs();
+  const Vector2 rect_end = rect.get_end();
+  const Vector2 corners[4] = {
+      rect.position,
+      Vector2(rect_end.x, rect.position.y),
+      rect_end,
+      Vector2(rect.position.x, rect_end.y),
+  };
+
+  // Ground footprint of the box: project its corners onto the plane the
+  // commanded units stand on and take the XZ bounds.
+  const float ground_height =
+      controlled_unit != nullptr ? controlled_unit->get_global_position().y
+                                 : 0.0f;
+  float min_x = 0.0f;
+  float min_z = 0.0f;
+  float max_x = 0.0f;
+  float max_z = 0.0f;
+  for (int32_t i = 0; i < 4; ++i) {
+    Vector3 point;
+    _project_to_ground(corners[i], ground_height, point);
+    min_x = i == 0 ? point.x : std::min(min_x, point.x);
+    min_z = i == 0 ? point.z : std::min(min_z, point.z);
+    max_x = i == 0 ? point.x : std::max(max_x, point.x);
+    max_z = i == 0 ? point.z : std::max(max_z, point.z);
+  }
+
+  selection_candidates.clear();
+  unit_registry->get_spatial_grid().query_rect(
+      min_x - SELECTION_QUERY_MARGIN, min_z - SELECTION_QUERY_MARGIN,
+      max_x + SELECTION_QUERY_MARGIN, max_z + SELECTION_QUERY_MARGIN,
+      selection_candidates);
+
+  const int32_t faction = _get_commanding_faction();
+  for (const int32_t slot : selection_candidates) {
+    Unit* unit = unit_registry->get_unit(slot);
+    if (unit == nullptr || unit_registry->get_faction(slot) != faction ||
+        unit_registry->get_health_ratio(slot) <= 0.0f) {
+      continue;
+    }
+
+    const Vector3 point = unit_registry->get_position(slot) +
+                          Vector3(0, SELECTION_POINT_HEIGHT, 0);
+    if (camera->is_position_behind(point) ||
+        !rect.has_point(camera->unproject_position(point))) {
+      continue;
+    }
+
+    selected_units.push_back(unit_registry->get_handle(slot));
+    unit_registry->set_individually_rendered(slot, true);
+  }
+
+  emit_signal("selection_changed",
+              static_cast<int32_t>(selected_units.size()));
+}
+
+void InputManager::clear_selection() {
+  if (unit_registry != nullptr) {
+    for (const UnitHandle selected : selected_units) {
+      const int32_t slot = unit_registry->resolve_slot(selected);
+      if (slot != UnitRegistry::INVALID_SLOT &&
+          unit_registry->get_unit(slot) != controlled_unit) {
+        unit_registry->set_individually_rendered(slot, false);
+      }
+    }
+  }
+  selected_units.clear();
+}
+
+Array InputManager::get_selected_units() const {
+  Array units;
+  for (const UnitHandle selected : selected_units) {
+    Unit* unit =
+        unit_registry != nullptr ? unit_registry->resolve(selected) : nullptr;
+    if (unit != nullptr) {
+      units.push_back(unit);
+    }
+  }
+  return units;
+}
+
+bool InputManager::is_box_selecting() const {
+  return box_selecting;
+}
+
+Rect2 InputManager::get_selection_rect() const {
+  return Rect2(box_select_start, box_select_end - box_select_start).abs();
+}
+
+void InputManager::_handle_select_button(const InputEventMouseButton* event) {
+  if (event->is_pressed()) {
+    box_selecting = true;
+    box_select_start = event->get_position();
+    box_select_end = box_select_start;
+    return;
+  }
+
+  if (!box_selecting) {
+    return;
+  }
+  box_selecting = false;
+  box_select_end = event->get_position();
+
+  Rect2 rect = get_selection_rect();
+  if (rect.size.x < BOX_SELECT_MIN_SIZE && rect.size.y < BOX_SELECT_MIN_SIZE) {
+    const Vector2 half_size =
+        Vector2(BOX_SELECT_MIN_SIZE, BOX_SELECT_MIN_SIZE) * 0.5f;
+    rect = Rect2(box_select_end - half_size, half_size * 2.0f);
+  }
+
+  select_units_in_rect(rect);
+  get_viewport()->set_input_as_handled();
+}
+
+bool InputManager::_project_to_ground(const Vector2& screen_position,
+                                      float ground_height,
+                                      Vector3& out_position) const {
+  const Vector3 origin = camera->project_ray_origin(screen_position);
+  const Vector3 normal = camera->project_ray_normal(screen_position);
+
+  // Rays at or above the horizon never reach the ground; clamp them to the
+  // raycast distance so the footprint stays finite.
+  if (normal.y > -0.0001f) {
+    out_position = origin + normal * raycast_distance;
+    return false;
+  }
+
+  const float distance =
+      std::min((ground_height - origin.y) / normal.y, raycast_distance);
+  out_position = origin + normal * distance;
+  return true;
+}
+
+int32_t InputManager::_get_commanding_faction() const {
+  if (controlled_unit != nullptr) {
+    return controlled_unit->get_faction_id();
+  }
+  for (const UnitHandle selected : selected_units) {
+    Unit* unit =
+        unit_registry != nullptr ? unit_registry->resolve(selected) : nullptr;
+    if (unit != nullptr) {
+      return unit->get_faction_id();
+    }
+  }
+  return 0;
+}
+
+bool InputManager::_is_commanded(const Unit* unit) const {
+  if (selected_units.empty()) {
+    return unit == controlled_unit;
+  }
+  const UnitHandle handle =
+      unit != nullptr ? unit->get_handle() : INVALID_UNIT_HANDLE;
+  return handle != INVALID_UNIT_HANDLE &&
+         std::find(selected_units.begin(), selected_units.end(), handle) !=
+             selected_units.end();
+}
+
+void InputManager::_collect_commanded_units() {
+  commanded_units.clear();
+
+  for (const UnitHandle selected : selected_units) {
+    const int32_t slot = unit_registry != nullptr
+                             ? unit_registry->resolve_slot(selected)
+                             : UnitRegistry::INVALID_SLOT;
+    if (slot == UnitRegistry::INVALID_SLOT) {
+      continue;  // Gone since it was selected.
+    }
+    const Vector3& position = unit_registry->get_position(slot);
+    commanded_units.push_back(
+        {unit_registry->get_unit(slot), position.x, position.z});
+  }
+
+  if (commanded_units.empty() && controlled_unit != nullptr) {
+    const Vector3 position = controlled_unit->get_global_position();
+    commanded_units.push_back({controlled_unit, position.x, position.z});
+  }
+}
+
+void InputManager::_issue_group_move_order(const Vector3& position,
+                                           bool queued) {
+  _collect_commanded_units();
+
+  const int32_t unit_count = static_cast<int32_t>(commanded_units.size());
+  if (unit_count == 0) {
+    return;
+  }
+  if (unit_count == 1) {
+    _give_move_order(commanded_units.front().unit, position, queued);
+    return;
+  }
+
+  // Square formation centered on the click. Units are sorted into rows by
+  // their current Z and within a row by X, so each keeps roughly its place
+  // in the group and paths do not cross.
+  const int32_t columns = static_cast<int32_t>(
+      std::ceil(std::sqrt(static_cast<float>(unit_count))));
+  const int32_t rows = (unit_count + columns - 1) / columns;
+
+  std::sort(commanded_units.begin(), commanded_units.end(),
+            [](const CommandedUnit& a, const CommandedUnit& b) {
+              return a.z < b.z;
+            });
+  for (int32_t row_start = 0; row_start < unit_count; row_start += columns) {
+    const int32_t row_end = std::min(row_start + columns, unit_count);
+    std::sort(commanded_units.begin() + row_start,
+              commanded_units.begin() + row_end,
+              [](const CommandedUnit& a, const CommandedUnit& b) {
+                return a.x < b.x;
+              });
+  }
+
+  const float half_width = (columns - 1) * 0.5f;
+  const float half_depth = (rows - 1) * 0.5f;
+  for (int32_t i = 0; i < unit_count; ++i) {
+    const float column = static_cast<float>(i % columns) - half_width;
+    const float row = static_cast<float>(i / columns) - half_depth;
+    const Vector3 offset =
+        Vector3(column * formation_spacing, 0, row * formation_spacing);
+    _give_move_order(commanded_units[i].unit, position + offset, queued);
+  }
+}
+
+void InputManager::_issue_group_attack_order(Unit* target, bool queued) {
+  _collect_commanded_units();
+  for (const CommandedUnit& commanded : commanded_units) {
+    if (queued) {
+      commanded.unit->queue_attack_order(target);
+    } else {
+      commanded.unit->issue_attack_order(target);
+    }
+  }
+}
+
+void InputManager::_give_move_order(Unit* unit,
+                                    const Vector3& position,
+                                    bool queued) {
+  if (queued) {
+    unit->queue_move_order(position);
+  } else {
+    unit->issue_move_order(position);
+  }
+}
+
 bool InputManager::_try_raycast(Vector3& out_position,
                                 godot::Object*& out_collider) {
   out_collider = nullptr;
@@ -231,21 +627,14 @@ bool InputManager::_try_raycast(Vector3& out_position,
   Vector3 ray_normal = camera->project_ray_normal(mouse_pos);
   Vector3 ray_to = ray_from + (ray_normal * raycast_distance);
 
-  // Setup raycast query
-  Ref<PhysicsRayQueryParameters3D> query =
-      PhysicsRayQueryParameters3D::create(ray_from, ray_to);
-  query->set_collide_with_bodies(true);
-  query->set_collide_with_areas(true);
-
-  // Avoid hitting the player's own unit.
-  if (controlled_unit != nullptr && controlled_unit->is_inside_tree()) {
-    godot::Array exclude;
-    exclude.push_back(controlled_unit->get_rid());
-    query->set_exclude(exclude);
+  if (terrain_query.is_null()) {
+    return false;
   }
+  terrain_query->set_from(ray_from);
+  terrain_query->set_to(ray_to);
 
   // Execute raycast
-  Dictionary result = physics_state->intersect_ray(query);
+  Dictionary result = physics_state->intersect_ray(terrain_query);
 
   if (result.is_empty()) {
     out_collider = nullptr;
@@ -257,67 +646,64 @@ bool InputManager::_try_raycast(Vector3& out_position,
   return true;
 }
 
-void InputManager::_show_click_marker(const Vector3& position) {
-  // Clean up old marker if it exists
-  if (click_marker != nullptr) {
-    click_marker->queue_free();
+Unit* InputManager::_pick_unit(const Vector2& screen_position,
+                               const Unit* ignored,
+                               int32_t* out_slot) const {
+  if (unit_registry == nullptr || camera == nullptr) {
+    return nullptr;
   }
 
-  // Check if scene is set
-  if (click_indicator_scene.is_null()) {
-    return;  // No scene configured
+  const float ground_height =
+      controlled_unit != nullptr ? controlled_unit->get_global_position().y
+                                 : 0.0f;
+  const int32_t ignored_slot = ignored != nullptr
+                                   ? ignored->get_registry_slot()
+                                   : UnitRegistry::INVALID_SLOT;
+  const int32_t slot = unit_picker.pick(
+      *unit_registry, camera->project_ray_origin(screen_position),
+      camera->project_ray_normal(screen_position), raycast_distance,
+      ground_height - PICK_HEIGHT_BAND, ground_height + PICK_HEIGHT_BAND,
+      ignored_slot);
+  if (out_slot != nullptr) {
+    *out_slot = slot;
   }
+  return slot != UnitRegistry::INVALID_SLOT ? unit_registry->get_unit(slot)
+                                            : nullptr;
+}
 
-  // Instantiate the click indicator scene
-  Node* marker_instance = click_indicator_scene->instantiate();
-  auto marker = Object::cast_to<Node3D>(marker_instance);
-  if (marker == nullptr) {
-    return;  // Scene root is not a Node3D
+void InputManager::_update_hovered_unit() {
+  Unit* unit = nullptr;
+  int32_t slot = UnitRegistry::INVALID_SLOT;
+  if (auto viewport = get_viewport()) {
+    unit = _pick_unit(viewport->get_mouse_position(), nullptr, &slot);
   }
-
-  // Add to scene FIRST, then set position
-  Node* parent = get_parent();
-  if (parent != nullptr) {
-    parent->add_child(marker);
+  if (unit == hovered_unit && slot == hovered_slot) {
+    return;
   }
-
-  // Position at click location (after adding to tree)
-  Vector3 marker_pos = position;
-  marker_pos.y += 0.5f;
-  marker->set_global_position(marker_pos);
-
-  click_marker = marker;
-  marker_active = true;
-  marker_fade_timer = 0.0f;
+  hovered_unit = unit;
+  hovered_slot = slot;
+  emit_signal("hovered_unit_changed", hovered_unit);
 }
 
-void InputManager::_update_click_marker(double delta) {
-  if (click_marker == nullptr) {
+void InputManager::_refresh_terrain_exclude() {
+  if (terrain_query.is_null()) {
     return;
   }
 
-  if (!marker_active) {
-    return;
+  // Avoid hitting the player's own unit.
+  terrain_exclude.clear();
+  if (controlled_unit != nullptr) {
+    terrain_exclude.push_back(controlled_unit->get_rid());
   }
+  terrain_query->set_exclude(terrain_exclude);
+}
 
-  marker_fade_timer += delta;
-
-  // Fade out the marker
-  if (marker_fade_timer < marker_fade_duration) {
-    float progress = marker_fade_timer / marker_fade_duration;
-    float alpha = 1.0f - progress;  // Fade from 1 to 0
-
-    if (marker_material.is_valid()) {
-      godot::Color color = marker_material->get_albedo();
-      color.a = alpha;
-      marker_material->set_albedo(color);
-    }
-  } else {
-    // Remove marker after fade is complete
-    click_marker->queue_free();
-    click_marker = nullptr;
-    marker_material.unref();
-    marker_active = false;
-    marker_fade_timer = 0.0f;
+void InputManager::_show_click_marker(const Vector3& position) {
+  if (marker_pool == nullptr) {
+    return;  // No scene configured
   }
+
+  Vector3 marker_pos = position;
+  marker_pos.y += 0.5f;
+  marker_pool->spawn_click_marker(marker_pos);
 }
@@ -5,33 +5,46 @@
 #include <godot_cpp/classes/input_event.hpp>
 #include <godot_cpp/classes/node.hpp>
 #include <godot_cpp/classes/packed_scene.hpp>
+#include <godot_cpp/classes/physics_ray_query_parameters3d.hpp>
 #include <godot_cpp/classes/ref.hpp>
 #include <godot_cpp/classes/resource_loader.hpp>
-#include <godot_cpp/classes/standard_material3d.hpp>
+#include <godot_cpp/variant/array.hpp>
 #include <godot_cpp/variant/color.hpp>
+#include <godot_cpp/variant/rect2.hpp>
 #include <godot_cpp/variant/string.hpp>
 #include <godot_cpp/variant/string_name.hpp>
+#include <godot_cpp/variant/vector2.hpp>
 #include <godot_cpp/variant/vector3.hpp>
 
+#include <vector>
+
+#include "unit_picker.hpp"
+#include "unit_registry.hpp"
+
 namespace godot {
+class InputEventMouseButton;
 class Object;
 class PhysicsDirectSpaceState3D;
 class Node3D;
 }  // namespace godot
 
+using godot::Array;
 using godot::Camera3D;
 using godot::Color;
 using godot::InputEvent;
 using godot::Node;
 using godot::PackedScene;
+using godot::Rect2;
 using godot::Ref;
 using godot::ResourceLoader;
-using godot::StandardMaterial3D;
 using godot::String;
 using godot::StringName;
+using godot::Vector2;
 using godot::Vector3;
 
 class Unit;
+class UnitRegistry;
+class WorldMarkerPool;
 
 class InputManager : public Node {
   GDCLASS(InputManager, Node)
@@ -59,25 +72,83 @@ class InputManager : public Node {
   void set_click_indicator_scene(const Ref<PackedScene>& scene);
   Ref<PackedScene> get_click_indicator_scene() const;
 
+  void set_formation_spacing(float spacing);
+  float get_formation_spacing() const;
+
+  // Selects the controllable units whose origin projects inside the screen
+  // rectangle. Candidates come from the match spatial grid, no raycasts.
+  void select_units_in_rect(const Rect2& screen_rect);
+  void clear_selection();
+  Array get_selected_units() const;
+
+  bool is_box_selecting() const;
+  Rect2 get_selection_rect() const;
+
+  // Size of the cylinder each unit is picked with.
+  void set_pick_radius(float radius);
+  float get_pick_radius() const;
+  void set_pick_height(float height);
+  float get_pick_height() const;
+
+  // Unit under the cursor, refreshed every frame.
+  Unit* get_hovered_unit() const;
+
  private:
+  struct CommandedUnit {
+    Unit* unit = nullptr;
+    float x = 0.0f;
+    float z = 0.0f;
+  };
+
   // Helper methods
   bool _try_raycast(Vector3& out_position, godot::Object*& out_collider);
+  Unit* _pick_unit(const Vector2& screen_position,
+                   const Unit* ignored,
+                   int32_t* out_slot = nullptr) const;
+  void _update_hovered_unit();
+  void _refresh_terrain_exclude();
+  void _handle_unit_click(Unit* clicked_unit, bool queued);
+  void _handle_select_button(const godot::InputEventMouseButton* event);
+  bool _project_to_ground(const Vector2& screen_position,
+                          float ground_height,
+                          Vector3& out_position) const;
+  int32_t _get_commanding_faction() const;
+  bool _is_commanded(const Unit* unit) const;
+  void _collect_commanded_units();
+  void _issue_group_move_order(const Vector3& position, bool queued);
+  void _issue_group_attack_order(Unit* target, bool queued);
+  static void _give_move_order(Unit* unit,
+                               const Vector3& position,
+                               bool queued);
   void _show_click_marker(const Vector3& position);
-  void _update_click_marker(double delta);
 
   // Member variables
   Unit* controlled_unit = nullptr;
   Camera3D* camera = nullptr;
   godot::PhysicsDirectSpaceState3D* physics_state = nullptr;
   float raycast_distance = 1000.0f;
+  UnitRegistry* unit_registry = nullptr;
+
+  // Picking
+  UnitPicker unit_picker;
+  Unit* hovered_unit = nullptr;
+  int32_t hovered_slot = -1;
+  Ref<godot::PhysicsRayQueryParameters3D> terrain_query;
+  Array terrain_exclude;
+
+  // Selection and group orders
+  // Handles, so a unit recycled into a selected slot is not taken for the
+  // selected one.
+  std::vector<UnitHandle> selected_units;
+  std::vector<CommandedUnit> commanded_units;
+  std::vector<int32_t> selection_candidates;
+  bool box_selecting = false;
+  Vector2 box_select_start = Vector2(0, 0);
+  Vector2 box_select_end = Vector2(0, 0);
+  float formation_spacing = 1.5f;
 
   // Visual feedback
-  godot::Node3D* click_marker = nullptr;
-  Ref<StandardMaterial3D> marker_material = nullptr;
-  Vector3 marker_target_position = Vector3(0, 0, 0);
-  float marker_fade_timer = 0.0f;
-  float marker_fade_duration = 2.0f;
-  bool marker_active = false;
+  WorldMarkerPool* marker_pool = nullptr;
   Ref<PackedScene> click_indicator_scene = nullptr;
 };
 
@@ -0,0 +1,346 @@
+#include "interest_manager.hpp"
+
+#include <algorithm>
+
+#include "unit_registry.hpp"
+
+namespace {
+// Just over half a cell diagonal: how far a unit can be from the center of
+// its cell.
+constexpr float HALF_DIAGONAL = 0.7072f;
+}  // namespace
+
+void InterestManager::set_vision_radius(float radius) {
+  vision_radius = std::max(radius, 0.0f);
+  invalidate();
+}
+
+float InterestManager::get_vision_radius() const {
+  return vision_radius;
+}
+
+void InterestManager::set_tier_radii(float near_limit, float far_limit) {
+  near_radius = std::max(near_limit, 0.0f);
+  far_radius = std::max(far_limit, near_radius);
+  invalidate();
+}
+
+float InterestManager::get_near_radius() const {
+  return near_radius;
+}
+
+float InterestManager::get_far_radius() const {
+  return far_radius;
+}
+
+int32_t InterestManager::add_viewer() {
+  int32_t viewer = 0;
+  while (viewer < static_cast<int32_t>(viewers.size()) &&
+         viewers[viewer].active) {
+    ++viewer;
+  }
+  if (viewer == static_cast<int32_t>(viewers.size())) {
+    viewers.emplace_back();
+  }
+  viewers[viewer].active = true;
+  viewers[viewer].full = true;
+  return viewer;
+}
+
+void InterestManager::remove_viewer(int32_t viewer) {
+  if (viewer < 0 || viewer >= static_cast<int32_t>(viewers.size())) {
+    return;
+  }
+  viewers[viewer].active = false;
+  viewers[viewer].focus_slot = -1;
+  std::fill(viewers[viewer].tiers.begin(), viewers[viewer].tiers.end(),
+            TIER_HIDDEN);
+}
+
+void InterestManager::set_viewer_focus(int32_t viewer, int32_t focus_slot) {
+  if (viewer < 0 || viewer >= static_cast<int32_t>(viewers.size())) {
+    return;
+  }
+  if (viewers[viewer].focus_slot != focus_slot) {
+    viewers[viewer].focus_slot = focus_slot;
+    viewers[viewer].full = true;
+  }
+}
+
+int32_t InterestManager::get_viewer_focus(int32_t viewer) const {
+  if (viewer < 0 || viewer >= static_cast<int32_t>(viewers.size())) {
+    return -1;
+  }
+  return viewers[viewer].focus_slot;
+}
+
+void InterestManager::update(const UnitRegistry& registry) {
+  last_update_evaluations = 0;
+  const bool has_viewers =
+      std::any_of(viewers.begin(), viewers.end(),
+                  [](const Viewer& viewer) { return viewer.active; });
+  if (!has_viewers) {
+    // Nobody to keep current; the next viewer starts from scratch.
+    all_dirty = true;
+    return;
+  }
+
+  const SpatialGrid& grid = registry.get_spatial_grid();
+  cell_size = grid.get_cell_size();
+  const VisibilityGrid& visibility = registry.get_visibility_grid();
+  const bool fog = visibility.is_enabled();
+  const int32_t fog_cells =
+      fog ? visibility.get_width() * visibility.get_depth() : 0;
+  if (fog_cells != fog_cell_count) {
+    // Fog of war was turned on, off or resized.
+    fog_cell_count = fog_cells;
+    all_dirty = true;
+  }
+  const int32_t slot_count = registry.get_slot_count();
+  if (static_cast<int32_t>(tracked.size()) < slot_count) {
+    tracked.resize(slot_count);
+    dirty.resize(slot_count, 0);
+  }
+
+  // Events: units that entered another cell, died, appeared or changed
+  // faction. Each one may change what is seen around its old and new cell.
+  // Fog of war reports those changes itself, as flipped cells.
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    Tracked now;
+    if (registry.get_unit(slot) != nullptr) {
+      const Vector3& position = registry.get_position(slot);
+      now.handle = registry.get_handle(slot);
+      now.cell_x = grid.cell_coord(position.x);
+      now.cell_z = grid.cell_coord(position.z);
+      now.faction = registry.get_faction(slot);
+      now.alive = registry.get_health_ratio(slot) > 0.0f;
+      now.sight_cell = fog ? visibility.get_slot_cell(slot) : -1;
+      if (!all_dirty && now.sight_cell >= 0 &&
+          visibility.is_cell_changed(now.sight_cell)) {
+        _mark(slot);
+      }
+    }
+
+    // Most units stay in their cell; this is the whole cost for them.
+    Tracked& last = tracked[slot];
+    if (now.handle == last.handle && now.cell_x == last.cell_x &&
+        now.cell_z == last.cell_z && now.faction == last.faction &&
+        now.sight_cell == last.sight_cell && now.alive == last.alive) {
+      continue;
+    }
+    if (!all_dirty) {
+      if (last.alive && !fog) {
+        _mark_around(registry, last.cell_x, last.cell_z);
+      }
+      if (now.alive && !fog) {
+        _mark_around(registry, now.cell_x, now.cell_z);
+      }
+      _mark(slot);
+    }
+    last = now;
+  }
+
+  // Factions currently looked through, one vision table each. A table
+  // that sat unused missed its events.
+  for (FactionVision& vision : visions) {
+    vision.full = vision.full || !vision.in_use;
+    vision.in_use = false;
+  }
+  for (Viewer& viewer : viewers) {
+    const int32_t previous_vision = viewer.vision;
+    viewer.vision = -1;
+    if (!viewer.active || viewer.focus_slot < 0 ||
+        viewer.focus_slot >= slot_count ||
+        tracked[viewer.focus_slot].handle == 0) {
+      // Nothing is relevant without the focus unit.
+      if (previous_vision >= 0) {
+        std::fill(viewer.tiers.begin(), viewer.tiers.end(), TIER_HIDDEN);
+      }
+      continue;
+    }
+    const Tracked& focus = tracked[viewer.focus_slot];
+    viewer.vision = _vision_for(focus.faction);
+    visions[viewer.vision].in_use = true;
+    viewer.tiers.resize(slot_count, TIER_HIDDEN);
+    // Tiers go by the focus cell and faction, so a change of either
+    // changes them all.
+    if (viewer.vision != previous_vision ||
+        focus.handle != viewer.focus_handle ||
+        focus.cell_x != viewer.focus_cell_x ||
+        focus.cell_z != viewer.focus_cell_z) {
+      viewer.focus_handle = focus.handle;
+      viewer.focus_cell_x = focus.cell_x;
+      viewer.focus_cell_z = focus.cell_z;
+      viewer.full = true;
+    }
+  }
+
+  for (FactionVision& vision : visions) {
+    if (!vision.in_use) {
+      continue;
+    }
+    vision.visible.resize(slot_count, 0);
+    if (all_dirty || vision.full) {
+      for (int32_t slot = 0; slot < slot_count; ++slot) {
+        vision.visible[slot] =
+            _is_visible_to(registry, slot, vision.faction) ? 1 : 0;
+      }
+      last_update_evaluations += slot_count;
+    } else {
+      for (const int32_t slot : dirty_slots) {
+        vision.visible[slot] =
+            _is_visible_to(registry, slot, vision.faction) ? 1 : 0;
+      }
+      last_update_evaluations += static_cast<int32_t>(dirty_slots.size());
+    }
+  }
+
+  for (Viewer& viewer : viewers) {
+    if (viewer.vision < 0) {
+      continue;
+    }
+    const FactionVision& vision = visions[viewer.vision];
+    if (all_dirty || vision.full || viewer.full) {
+      for (int32_t slot = 0; slot < slot_count; ++slot) {
+        viewer.tiers[slot] = _tier_for(viewer, slot, vision.visible[slot]);
+      }
+      viewer.full = false;
+    } else {
+      for (const int32_t slot : dirty_slots) {
+        viewer.tiers[slot] = _tier_for(viewer, slot, vision.visible[slot]);
+      }
+    }
+  }
+
+  for (FactionVision& vision : visions) {
+    vision.full = vision.full && !vision.in_use;
+  }
+  for (const int32_t slot : dirty_slots) {
+    dirty[slot] = 0;
+  }
+  dirty_slots.clear();
+  all_dirty = false;
+}
+
+void InterestManager::invalidate() {
+  all_dirty = true;
+}
+
+InterestManager::Tier InterestManager::get_tier(int32_t viewer,
+                                                int32_t slot) const {
+  if (viewer < 0 || viewer >= static_cast<int32_t>(viewers.size())) {
+    return TIER_HIDDEN;
+  }
+  const Viewer& entry = viewers[viewer];
+  if (entry.focus_slot < 0) {
+    return TIER_NEAR;
+  }
+  if (slot < 0 || slot >= static_cast<int32_t>(entry.tiers.size())) {
+    return TIER_HIDDEN;
+  }
+  return static_cast<Tier>(entry.tiers[slot]);
+}
+
+bool InterestManager::is_due(int32_t viewer,
+                             int32_t slot,
+                             uint32_t snapshot_number) const {
+  const Tier tier = get_tier(viewer, slot);
+  if (tier == TIER_HIDDEN) {
+    return false;
+  }
+  return (snapshot_number + static_cast<uint32_t>(slot)) % tier == 0;
+}
+
+int32_t InterestManager::get_last_update_evaluations() const {
+  return last_update_evaluations;
+}
+
+int32_t InterestManager::_vision_for(int32_t faction) {
+  for (int32_t index = 0; index < static_cast<int32_t>(visions.size());
+       ++index) {
+    if (visions[index].faction == faction) {
+      return index;
+    }
+  }
+  visions.emplace_back();
+  visions.back().faction = faction;
+  return static_cast<int32_t>(visions.size()) - 1;
+}
+
+Vector3 InterestManager::_cell_center(int32_t cell_x, int32_t cell_z) const {
+  return Vector3((static_cast<float>(cell_x) + 0.5f) * cell_size, 0.0f,
+                 (static_cast<float>(cell_z) + 0.5f) * cell_size);
+}
+
+void InterestManager::_mark_around(const UnitRegistry& registry,
+                                   int32_t cell_x,
+                                   int32_t cell_z) {
+  registry.get_spatial_grid().for_each_in_radius(
+      _cell_center(cell_x, cell_z), vision_radius + cell_size * HALF_DIAGONAL,
+      [&](int32_t id) { _mark(id); });
+}
+
+void InterestManager::_mark(int32_t slot) {
+  if (dirty[slot] == 0) {
+    dirty[slot] = 1;
+    dirty_slots.push_back(slot);
+  }
+}
+
+bool InterestManager::_is_visible_to(const UnitRegistry& registry,
+                                     int32_t slot,
+                                     int32_t faction) const {
+  const Tracked& target = tracked[slot];
+  if (target.handle == 0) {
+    return false;
+  }
+  if (target.faction == faction) {
+    return true;
+  }
+  // With fog of war, clients get exactly what their faction sees.
+  const VisibilityGrid& visibility = registry.get_visibility_grid();
+  if (visibility.is_enabled()) {
+    return visibility.can_see(faction, slot);
+  }
+
+  // Cell centers, so the answer only changes with the events update()
+  // tracks. Dead units see nothing.
+  const float radius_squared = vision_radius * vision_radius;
+  bool seen = false;
+  registry.get_spatial_grid().for_each_in_radius(
+      _cell_center(target.cell_x, target.cell_z),
+      vision_radius + cell_size * HALF_DIAGONAL, [&](int32_t id) {
+        const Tracked& observer = tracked[id];
+        if (seen || !observer.alive || observer.faction != faction) {
+          return;
+        }
+        const float dx =
+            static_cast<float>(observer.cell_x - target.cell_x) * cell_size;
+        const float dz =
+            static_cast<float>(observer.cell_z - target.cell_z) * cell_size;
+        seen = dx * dx + dz * dz <= radius_squared;
+      });
+  return seen;
+}
+
+InterestManager::Tier InterestManager::_tier_for(const Viewer& viewer,
+                                                 int32_t slot,
+                                                 bool visible) const {
+  if (!visible) {
+    return TIER_HIDDEN;
+  }
+
+  const Tracked& target = tracked[slot];
+  const float dx =
+      static_cast<float>(target.cell_x - viewer.focus_cell_x) * cell_size;
+  const float dz =
+      static_cast<float>(target.cell_z - viewer.focus_cell_z) * cell_size;
+  const float distance_squared = dx * dx + dz * dz;
+  if (distance_squared <= near_radius * near_radius) {
+    return TIER_NEAR;
+  }
+  if (distance_squared <= far_radius * far_radius) {
+    return TIER_MID;
+  }
+  return TIER_FAR;
+}
@@ -0,0 +1,122 @@
+#ifndef GDEXTENSION_INTEREST_MANAGER_H
+#define GDEXTENSION_INTEREST_MANAGER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/vector3.hpp>
+
+using godot::Vector3;
+
+class UnitRegistry;
+
+// Decides which units each network viewer needs and how often. A unit is
+// relevant to a viewer if it belongs to the viewer's faction or a living
+// unit of that faction is within vision_radius of it; its update rate then
+// drops with the distance to the viewer's focus unit (the client's main
+// unit). Distances are measured between the centers of spatial grid cells.
+//
+// Relevancy is maintained incrementally: update() scans the slots for
+// units that entered another cell, died, appeared or changed faction, and
+// re-evaluates only the units those events can affect. A new viewer, or one
+// whose focus changed cell, gets a full evaluation. Vision is shared per
+// faction, so viewers on the same team do the queries once.
+//
+// With fog of war, a faction sees exactly what its fog layer shows. The
+// events are then the cells whose visibility the last fog update flipped.
+class InterestManager {
+ public:
+  // A tier is the number of snapshots between updates of the unit; HIDDEN
+  // units are not sent at all.
+  enum Tier : uint8_t {
+    TIER_HIDDEN = 0,
+    TIER_NEAR = 1,
+    TIER_MID = 2,
+    TIER_FAR = 4,
+  };
+
+  void set_vision_radius(float radius);
+  float get_vision_radius() const;
+  // Units within near_radius of the focus update every snapshot, within
+  // far_radius every second one, beyond that every fourth.
+  void set_tier_radii(float near_radius, float far_radius);
+  float get_near_radius() const;
+  float get_far_radius() const;
+
+  int32_t add_viewer();
+  void remove_viewer(int32_t viewer);
+  // A viewer without a focus (-1) sees every unit at full rate.
+  void set_viewer_focus(int32_t viewer, int32_t focus_slot);
+  int32_t get_viewer_focus(int32_t viewer) const;
+
+  // Applies the events since the last update. Call once per tick; ticks
+  // without an update are only caught up by invalidate().
+  void update(const UnitRegistry& registry);
+  // Re-evaluates every slot for every viewer on the next update.
+  void invalidate();
+
+  Tier get_tier(int32_t viewer, int32_t slot) const;
+  // Whether the unit is due in the snapshot with the given sequence number.
+  // Slots are staggered so slower tiers spread over consecutive snapshots.
+  bool is_due(int32_t viewer, int32_t slot, uint32_t snapshot_number) const;
+
+  // Slots re-evaluated by the last update, for profiling.
+  int32_t get_last_update_evaluations() const;
+
+ private:
+  // What the last update saw of a slot; a difference is an event.
+  struct Tracked {
+    int64_t handle = 0;  // 0 for free slots
+    int32_t cell_x = 0;
+    int32_t cell_z = 0;
+    int32_t faction = 0;
+    int32_t sight_cell = -1;  // Fog of war cell, -1 without fog
+    bool alive = false;
+  };
+
+  struct Viewer {
+    bool active = false;
+    bool full = true;            // Re-evaluate every slot next update
+    int32_t focus_slot = -1;
+    int64_t focus_handle = 0;    // Focus unit and cell of the last update
+    int32_t focus_cell_x = 0;
+    int32_t focus_cell_z = 0;
+    int32_t vision = -1;         // Index into visions, -1 without a focus
+    std::vector<uint8_t> tiers;  // Tier per slot
+  };
+
+  struct FactionVision {
+    int32_t faction = 0;
+    bool in_use = false;
+    bool full = true;              // Re-evaluate every slot next update
+    std::vector<uint8_t> visible;  // Per slot
+  };
+
+  int32_t _vision_for(int32_t faction);
+  Vector3 _cell_center(int32_t cell_x, int32_t cell_z) const;
+  // Marks every slot an observer in the cell could see.
+  void _mark_around(const UnitRegistry& registry,
+                    int32_t cell_x,
+                    int32_t cell_z);
+  void _mark(int32_t slot);
+  bool _is_visible_to(const UnitRegistry& registry,
+                      int32_t slot,
+                      int32_t faction) const;
+  Tier _tier_for(const Viewer& viewer, int32_t slot, bool visible) const;
+
+  float vision_radius = 20.0f;
+  float near_radius = 30.0f;
+  float far_radius = 60.0f;
+  float cell_size = 0.0f;  // Of the registry's spatial grid
+
+  std::vector<Viewer> viewers;
+  std::vector<FactionVision> visions;
+  std::vector<Tracked> tracked;     // Per slot
+  std::vector<uint8_t> dirty;       // Per slot, set while in dirty_slots
+  std::vector<int32_t> dirty_slots;
+  bool all_dirty = true;
+  int32_t fog_cell_count = 0;  // Of the fog of war grid at the last update
+  int32_t last_update_evaluations = 0;
+};
+
+#endif  // GDEXTENSION_INTEREST_MANAGER_H
@@ -0,0 +1,79 @@
+#include "loopback_transport.hpp"
+
+#include <algorithm>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/property_info.hpp>
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::PropertyInfo;
+using godot::Variant;
+
+LoopbackTransport::LoopbackTransport() {
+  loss_random.seed(1);
+}
+
+LoopbackTransport::~LoopbackTransport() = default;
+
+void LoopbackTransport::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_packet_loss", "loss"),
+                       &LoopbackTransport::set_packet_loss);
+  ClassDB::bind_method(D_METHOD("get_packet_loss"),
+                       &LoopbackTransport::get_packet_loss);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "packet_loss",
+                            godot::PROPERTY_HINT_RANGE, "0,1,0.01"),
+               "set_packet_loss", "get_packet_loss");
+
+  ClassDB::bind_method(D_METHOD("get_delivered_packet_count"),
+                       &LoopbackTransport::get_delivered_packet_count);
+  ClassDB::bind_method(D_METHOD("get_dropped_packet_count"),
+                       &LoopbackTransport::get_dropped_packet_count);
+}
+
+void LoopbackTransport::set_packet_loss(float loss) {
+  packet_loss = std::clamp(loss, 0.0f, 1.0f);
+}
+
+float LoopbackTransport::get_packet_loss() const {
+  return packet_loss;
+}
+
+int64_t LoopbackTransport::get_delivered_packet_count() const {
+  return delivered_count;
+}
+
+int64_t LoopbackTransport::get_dropped_packet_count() const {
+  return dropped_count;
+}
+
+void LoopbackTransport::send_packet(int32_t from_peer,
+                                    int32_t to_peer,
+                                    const PackedByteArray& packet) {
+  // Seeded, so a lossy run drops the same packets every time.
+  if (packet_loss > 0.0f &&
+      static_cast<float>(loss_random.next_u32()) / 4294967296.0f <
+          packet_loss) {
+    dropped_count++;
+    return;
+  }
+
+  Packet queued;
+  queued.from_peer = from_peer;
+  queued.data = packet;
+  inboxes[to_peer].push_back(queued);
+}
+
+bool LoopbackTransport::poll_packet(int32_t peer,
+                                    int32_t& from_peer,
+                                    PackedByteArray& packet) {
+  auto inbox = inboxes.find(peer);
+  if (inbox == inboxes.end() || inbox->second.empty()) {
+    return false;
+  }
+
+  from_peer = inbox->second.front().from_peer;
+  packet = inbox->second.front().data;
+  inbox->second.pop_front();
+  delivered_count++;
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef GDEXTENSION_LOOPBACK_TRANSPORT_H
+#define GDEXTENSION_LOOPBACK_TRANSPORT_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+
+#include "fixed_point.hpp"
+#include "snapshot_transport.hpp"
+
+// In-process transport: server and clients in the same scene tree share one
+// LoopbackTransport node. Packets are delivered on the next poll, so the
+// whole snapshot protocol can be exercised without a network. Optional
+// packet loss shows how delta encoding copes with dropped snapshots.
+class LoopbackTransport : public SnapshotTransport {
+  GDCLASS(LoopbackTransport, SnapshotTransport)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  LoopbackTransport();
+  ~LoopbackTransport();
+
+  // Fraction of packets dropped, 0 to 1.
+  void set_packet_loss(float loss);
+  float get_packet_loss() const;
+
+  int64_t get_delivered_packet_count() const;
+  int64_t get_dropped_packet_count() const;
+
+  void send_packet(int32_t from_peer,
+                   int32_t to_peer,
+                   const PackedByteArray& packet) override;
+  bool poll_packet(int32_t peer,
+                   int32_t& from_peer,
+                   PackedByteArray& packet) override;
+
+ private:
+  struct Packet {
+    int32_t from_peer = 0;
+    PackedByteArray data;
+  };
+
+  float packet_loss = 0.0f;
+  DeterministicRandom loss_random;
+  std::map<int32_t, std::deque<Packet>> inboxes;
+  int64_t delivered_count = 0;
+  int64_t dropped_count = 0;
+};
+
+#endif  // GDEXTENSION_LOOPBACK_TRANSPORT_H
@@ -0,0 +1,423 @@
+#include "match_client.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/object.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "health_component.hpp"
+#include "match_manager.hpp"
+#include "snapshot_transport.hpp"
+#include "unit.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::MethodInfo;
+using godot::PropertyInfo;
+using godot::UtilityFunctions;
+using godot::Variant;
+
+MatchClient::MatchClient() {
+  history.resize(SNAPSHOT_HISTORY);
+}
+
+MatchClient::~MatchClient() = default;
+
+void MatchClient::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_transport", "transport"),
+                       &MatchClient::set_transport);
+  ClassDB::bind_method(D_METHOD("get_transport"), &MatchClient::get_transport);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "transport",
+                            godot::PROPERTY_HINT_NODE_TYPE,
+                            "SnapshotTransport"),
+               "set_transport", "get_transport");
+
+  ClassDB::bind_method(D_METHOD("set_peer_id", "id"),
+                       &MatchClient::set_peer_id);
+  ClassDB::bind_method(D_METHOD("get_peer_id"), &MatchClient::get_peer_id);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "peer_id"), "set_peer_id",
+               "get_peer_id");
+
+  ClassDB::bind_method(D_METHOD("set_apply_snapshots", "enabled"),
+                       &MatchClient::set_apply_snapshots);
+  ClassDB::bind_method(D_METHOD("get_apply_snapshots"),
+                       &MatchClient::get_apply_snapshots);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "apply_snapshots"),
+               "set_apply_snapshots", "get_apply_snapshots");
+
+  ClassDB::bind_method(D_METHOD("set_predict_controlled_unit", "enabled"),
+                       &MatchClient::set_predict_controlled_unit);
+  ClassDB::bind_method(D_METHOD("get_predict_controlled_unit"),
+                       &MatchClient::get_predict_controlled_unit);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "predict_controlled_unit"),
+               "set_predict_controlled_unit", "get_predict_controlled_unit");
+
+  ClassDB::bind_method(D_METHOD("set_reconcile_tolerance", "tolerance"),
+                       &MatchClient::set_reconcile_tolerance);
+  ClassDB::bind_method(D_METHOD("get_reconcile_tolerance"),
+                       &MatchClient::get_reconcile_tolerance);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "reconcile_tolerance",
+                            godot::PROPERTY_HINT_RANGE, "0.01,2,0.01"),
+               "set_reconcile_tolerance", "get_reconcile_tolerance");
+
+  ClassDB::bind_method(D_METHOD("get_correction_count"),
+                       &MatchClient::get_correction_count);
+  ClassDB::bind_method(D_METHOD("get_pending_input_count"),
+                       &MatchClient::get_pending_input_count);
+  ClassDB::bind_method(D_METHOD("get_snapshot_tick"),
+                       &MatchClient::get_snapshot_tick);
+  ClassDB::bind_method(D_METHOD("get_received_bytes"),
+                       &MatchClient::get_received_bytes);
+  ClassDB::bind_method(D_METHOD("get_unit_state", "slot"),
+                       &MatchClient::get_unit_state);
+
+  ADD_SIGNAL(MethodInfo("snapshot_received", PropertyInfo(Variant::INT, "tick"),
+                        PropertyInfo(Variant::INT, "byte_count")));
+}
+
+void MatchClient::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+  if (transport == nullptr) {
+    UtilityFunctions::push_warning("[MatchClient] transport is not set.");
+    return;
+  }
+
+  // Snapshot state must be in place before the local units step.
+  set_physics_process_priority(-900);
+  _send_join();
+}
+
+void MatchClient::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint() || transport == nullptr) {
+    return;
+  }
+
+  // State before this tick's step, tagged for reconciliation.
+  Unit* controlled = _get_controlled_unit();
+  if (controlled != nullptr) {
+    prediction.record_state(controlled->get_global_position(),
+                            controlled->get_current_order(),
+                            controlled->get_desired_location());
+  }
+
+  _receive_packets();
+  if (latest < 0) {
+    // The join may have been lost; repeat it until snapshots arrive.
+    _send_join();
+  } else if (!latest_applied && apply_snapshots) {
+    _apply_latest();
+  }
+  latest_applied = true;
+  _send_inputs();
+}
+
+void MatchClient::set_transport(SnapshotTransport* new_transport) {
+  transport = new_transport;
+}
+
+SnapshotTransport* MatchClient::get_transport() const {
+  return transport;
+}
+
+void MatchClient::set_peer_id(int32_t id) {
+  peer_id = id;
+}
+
+int32_t MatchClient::get_peer_id() const {
+  return peer_id;
+}
+
+void MatchClient::set_apply_snapshots(bool enabled) {
+  apply_snapshots = enabled;
+}
+
+bool MatchClient::get_apply_snapshots() const {
+  return apply_snapshots;
+}
+
+void MatchClient::set_predict_controlled_unit(bool enabled) {
+  predict_controlled_unit = enabled;
+}
+
+bool MatchClient::get_predict_controlled_unit() const {
+  return predict_controlled_unit;
+}
+
+void MatchClient::set_reconcile_tolerance(float tolerance) {
+  reconcile_tolerance = tolerance;
+}
+
+float MatchClient::get_reconcile_tolerance() const {
+  return reconcile_tolerance;
+}
+
+int64_t MatchClient::get_correction_count() const {
+  return correction_count;
+}
+
+int32_t MatchClient::get_pending_input_count() const {
+  return prediction.get_pending_input_count();
+}
+
+bool MatchClient::on_order_issued(Unit* unit,
+                                  const UnitOrder& order,
+                                  bool queued) {
+  // The main unit's orders go to the server whether or not it is predicted.
+  if (transport == nullptr || match == nullptr ||
+      unit != match->get_main_unit()) {
+    return false;
+  }
+  if (order.type == OrderType::INTERACT) {
+    // Interactables have no network identity yet.
+    UtilityFunctions::push_warning(
+        "[MatchClient] Interact orders are not networked.");
+    return false;
+  }
+  if (order.type == OrderType::ATTACK) {
+    auto target = Object::cast_to<Unit>(
+        godot::ObjectDB::get_instance(order.target_id));
+    if (target == nullptr) {
+      return false;
+    }
+  }
+
+  prediction.add_input(order, queued);
+  return true;
+}
+
+int64_t MatchClient::get_snapshot_tick() const {
+  return latest >= 0 ? history[latest].tick : 0;
+}
+
+int64_t MatchClient::get_received_bytes() const {
+  return received_bytes;
+}
+
+Dictionary MatchClient::get_unit_state(int32_t slot) const {
+  Dictionary state;
+  if (latest < 0 || slot < 0 ||
+      slot >= static_cast<int32_t>(history[latest].units.size()) ||
+      !history[latest].units[slot].present) {
+    return state;
+  }
+
+  const UnitSnapshot& unit = history[latest].units[slot];
+  state["position"] = unit.get_position();
+  state["yaw"] = unit.get_yaw();
+  state["health_ratio"] = unit.get_health_ratio();
+  state["order"] = static_cast<int64_t>(unit.order);
+  state["target_slot"] = static_cast<int64_t>(unit.target) - 1;
+  return state;
+}
+
+void MatchClient::_receive_packets() {
+  int32_t from_peer = 0;
+  while (transport->poll_packet(peer_id, from_peer, packet)) {
+    if (from_peer != SnapshotTransport::SERVER_PEER) {
+      continue;
+    }
+
+    BitReader reader(packet.ptr(), packet.size());
+    const auto type = static_cast<SnapshotMessage>(reader.read_bits(8));
+    if (type != SnapshotMessage::SNAPSHOT || !_decode_snapshot(reader)) {
+      continue;
+    }
+
+    received_bytes += packet.size();
+    emit_signal("snapshot_received", get_snapshot_tick(), packet.size());
+  }
+}
+
+bool MatchClient::_decode_snapshot(BitReader& reader) {
+  const uint32_t tick = reader.read_bits(32);
+  const uint32_t baseline_tick = reader.read_bits(32);
+  const uint32_t input_sequence = reader.read_bits(32);
+  const uint32_t steps = reader.read_varuint();
+  if (reader.is_overflowed() ||
+      (latest >= 0 && tick <= history[latest].tick)) {
+    // Late or duplicate packet; a newer state is already in use.
+    return false;
+  }
+
+  const MatchSnapshot* baseline = nullptr;
+  if (baseline_tick != 0) {
+    baseline = _find_snapshot(baseline_tick);
+    if (baseline == nullptr) {
+      // Only after acks were lost for longer than the history; the server
+      // has dropped that baseline as well and is about to send in full.
+      return false;
+    }
+  }
+  if (!SnapshotCodec::decode(reader, tick, baseline, decoded)) {
+    return false;
+  }
+
+  // Swapping keeps both buffers' capacity for the next packets.
+  history[next_history].units.swap(decoded.units);
+  history[next_history].tick = decoded.tick;
+  latest = next_history;
+  next_history = (next_history + 1) % SNAPSHOT_HISTORY;
+  latest_applied = false;
+  server_input_sequence = input_sequence;
+  server_steps = steps;
+  // Acknowledged here rather than on reconciliation, which only runs while
+  // snapshots are applied to a predicted unit.
+  prediction.acknowledge(input_sequence);
+
+  _send_ack(tick);
+  return true;
+}
+
+void MatchClient::_send_join() {
+  int32_t focus_slot = UnitRegistry::INVALID_SLOT;
+  if (match != nullptr && match->get_main_unit() != nullptr) {
+    focus_slot = match->get_main_unit()->get_registry_slot();
+  }
+
+  writer.clear();
+  writer.write_bits(static_cast<uint32_t>(SnapshotMessage::JOIN), 8);
+  writer.write_varuint(static_cast<uint32_t>(focus_slot + 1));
+  _send_written();
+}
+
+void MatchClient::_send_ack(uint32_t tick) {
+  writer.clear();
+  writer.write_bits(static_cast<uint32_t>(SnapshotMessage::ACK), 8);
+  writer.write_bits(tick, 32);
+  _send_written();
+}
+
+void MatchClient::_send_written() {
+  const std::vector<uint8_t>& bytes = writer.get_bytes();
+  ack_packet.resize(static_cast<int64_t>(bytes.size()));
+  std::memcpy(ack_packet.ptrw(), bytes.data(), bytes.size());
+  transport->send_packet(peer_id, SnapshotTransport::SERVER_PEER, ack_packet);
+}
+
+void MatchClient::_send_inputs() {
+  const int32_t input_count = prediction.get_pending_input_count();
+  if (input_count == 0 || match == nullptr) {
+    return;
+  }
+
+  // Every unacknowledged input goes out again, so a lost packet only delays
+  // an order instead of losing it.
+  writer.clear();
+  writer.write_bits(static_cast<uint32_t>(SnapshotMessage::INPUT), 8);
+  writer.write_varuint(static_cast<uint32_t>(input_count));
+  for (int32_t index = 0; index < input_count; ++index) {
+    const PredictionBuffer::Input& input = prediction.get_pending_input(index);
+    uint8_t type = static_cast<uint8_t>(input.order.type);
+    if (input.queued) {
+      type |= INPUT_QUEUED_BIT;
+    }
+    writer.write_bits(input.sequence, 32);
+    writer.write_bits(type, 8);
+    if (input.order.type == OrderType::MOVE) {
+      for (int32_t axis = 0; axis < 3; ++axis) {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &input.order.position[axis], sizeof(bits));
+        writer.write_bits(bits, 32);
+      }
+    } else if (input.order.type == OrderType::ATTACK) {
+      auto target = Object::cast_to<Unit>(
+          godot::ObjectDB::get_instance(input.order.target_id));
+      const int32_t slot = target != nullptr ? target->get_registry_slot()
+                                             : UnitRegistry::INVALID_SLOT;
+      // An invalid slot decodes to no target; the server skips the order.
+      writer.write_varuint(static_cast<uint32_t>(slot));
+    }
+  }
+  _send_written();
+}
+
+void MatchClient::_apply_latest() {
+  if (match == nullptr || latest < 0) {
+    return;
+  }
+
+  Unit* controlled = _get_controlled_unit();
+  UnitRegistry& registry = match->get_unit_registry();
+  const MatchSnapshot& snapshot = history[latest];
+  const int32_t slot_count = std::min(
+      static_cast<int32_t>(snapshot.units.size()), registry.get_slot_count());
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    const UnitSnapshot& state = snapshot.units[slot];
+    Unit* unit = registry.get_unit(slot);
+    if (unit == nullptr || !state.present) {
+      continue;
+    }
+
+    if (unit == controlled) {
+      _reconcile(unit, state);
+    } else {
+      unit->teleport(state.get_position());
+      unit->set_facing_yaw(state.get_yaw());
+    }
+    HealthComponent* health = unit->get_health_component();
+    if (health != nullptr) {
+      health->set_current_health(state.get_health_ratio() *
+                                 health->get_max_health());
+    }
+  }
+}
+
+void MatchClient::_reconcile(Unit* unit, const UnitSnapshot& server_state) {
+  const Vector3 server_position = server_state.get_position();
+
+  // Before the first input there is nothing to predict; states from then
+  // are not comparable with the server's step count either.
+  const int32_t index =
+      server_input_sequence == 0
+          ? -1
+          : prediction.find_state(server_input_sequence, server_steps);
+  if (index < 0) {
+    unit->teleport(server_position);
+    prediction.discard_states_before(prediction.get_state_count());
+    return;
+  }
+
+  prediction.discard_states_before(index);
+  PredictionBuffer::State& matched = prediction.get_state(0);
+  if (matched.position.distance_to(server_position) <= reconcile_tolerance) {
+    return;
+  }
+
+  // Misprediction: restart from the server state and replay only the steps
+  // taken since, with the orders that were in effect for each of them. The
+  // newest state is the start of the current tick.
+  correction_count++;
+  const double delta =
+      1.0 / Engine::get_singleton()->get_physics_ticks_per_second();
+  matched.position = server_position;
+  unit->teleport(server_position);
+  for (int32_t step = 1; step < prediction.get_state_count(); ++step) {
+    const PredictionBuffer::State& previous = prediction.get_state(step - 1);
+    unit->predict_movement_step(delta, previous.order, previous.destination);
+    prediction.get_state(step).position = unit->get_global_position();
+  }
+}
+
+Unit* MatchClient::_get_controlled_unit() const {
+  if (!predict_controlled_unit || match == nullptr) {
+    return nullptr;
+  }
+  return match->get_main_unit();
+}
+
+const MatchSnapshot* MatchClient::_find_snapshot(uint32_t tick) const {
+  for (const MatchSnapshot& snapshot : history) {
+    if (snapshot.tick == tick && !snapshot.units.empty()) {
+      return &snapshot;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,124 @@
+#ifndef GDEXTENSION_MATCH_CLIENT_H
+#define GDEXTENSION_MATCH_CLIENT_H
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "bit_stream.hpp"
+#include "match_snapshot.hpp"
+#include "prediction_buffer.hpp"
+
+using godot::Dictionary;
+using godot::Node;
+using godot::PackedByteArray;
+
+class MatchManager;
+class SnapshotTransport;
+class Unit;
+
+// Receiving side of a networked match. Decodes the server snapshots,
+// acknowledges each one so the server can delta against it, and moves the
+// units of the local match (the same scene, so the same registry slots) to
+// the snapshot state. The local main unit is reported to the server as the
+// client's point of interest.
+//
+// The main unit is also the one unit the client controls, once the server
+// binds it (MatchServer::set_client_unit). Its orders are sent to the
+// server as numbered inputs and executed locally right away; each tick's
+// predicted state is kept in a PredictionBuffer. When a snapshot
+// says which input the server applied last, the matching predicted state is
+// compared with the server's, and on a mismatch the unit is reset to the
+// server state and only the ticks after it are simulated again.
+class MatchClient : public Node {
+  GDCLASS(MatchClient, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  // Decoded snapshots kept as baselines; matches the server history.
+  static constexpr int32_t SNAPSHOT_HISTORY = 32;
+
+  MatchClient();
+  ~MatchClient();
+
+  void _ready() override;
+  void _physics_process(double delta) override;
+
+  void set_transport(SnapshotTransport* new_transport);
+  SnapshotTransport* get_transport() const;
+
+  // Must be unique per client and differ from the server's id (1).
+  void set_peer_id(int32_t id);
+  int32_t get_peer_id() const;
+
+  // Off leaves the local units alone; snapshots are still decoded.
+  void set_apply_snapshots(bool enabled);
+  bool get_apply_snapshots() const;
+
+  // Predict the main unit instead of snapping it to each snapshot.
+  void set_predict_controlled_unit(bool enabled);
+  bool get_predict_controlled_unit() const;
+
+  // Prediction error, in meters, tolerated before re-simulating. Should
+  // stay above the snapshot position quantization.
+  void set_reconcile_tolerance(float tolerance);
+  float get_reconcile_tolerance() const;
+
+  int64_t get_correction_count() const;
+  int32_t get_pending_input_count() const;
+
+  // Called by Unit for every order issued locally. Orders for the main unit
+  // are sent to the server and predicted; any other order is dropped, the
+  // server decides for those units.
+  bool on_order_issued(Unit* unit, const UnitOrder& order, bool queued);
+
+  int64_t get_snapshot_tick() const;
+  int64_t get_received_bytes() const;
+  // State of one unit in the newest snapshot: position, yaw, health_ratio,
+  // order and target_slot. Empty if the slot is not in it.
+  Dictionary get_unit_state(int32_t slot) const;
+
+ private:
+  void _receive_packets();
+  bool _decode_snapshot(BitReader& reader);
+  void _send_join();
+  void _send_ack(uint32_t tick);
+  void _send_written();
+  void _send_inputs();
+  void _apply_latest();
+  void _reconcile(Unit* unit, const UnitSnapshot& server_state);
+  Unit* _get_controlled_unit() const;
+  const MatchSnapshot* _find_snapshot(uint32_t tick) const;
+
+  SnapshotTransport* transport = nullptr;
+  int32_t peer_id = 2;
+  bool apply_snapshots = true;
+  bool predict_controlled_unit = true;
+  float reconcile_tolerance = 0.1f;
+
+  MatchManager* match = nullptr;
+  std::vector<MatchSnapshot> history;  // Ring of decoded snapshots
+  int32_t latest = -1;                 // Index of the newest, -1 before any
+  int32_t next_history = 0;
+  bool latest_applied = true;
+  int64_t received_bytes = 0;
+
+  PredictionBuffer prediction;
+  // Input tags of the newest snapshot.
+  uint32_t server_input_sequence = 0;
+  uint32_t server_steps = 0;
+  int64_t correction_count = 0;
+
+  // Reused every packet.
+  MatchSnapshot decoded;
+  BitWriter writer;
+  PackedByteArray packet;
+  PackedByteArray ack_packet;
+};
+
+#endif  // GDEXTENSION_MATCH_CLIENT_H
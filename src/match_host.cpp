@@ -0,0 +1,225 @@
+#include "match_host.hpp"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/sub_viewport.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+
+#include "frame_arena.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::MethodInfo;
+using godot::PropertyInfo;
+using godot::String;
+using godot::SubViewport;
+using godot::UtilityFunctions;
+using godot::Variant;
+
+MatchHost::MatchHost() = default;
+
+MatchHost::~MatchHost() = default;
+
+void MatchHost::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_match_scene", "scene"),
+                       &MatchHost::set_match_scene);
+  ClassDB::bind_method(D_METHOD("get_match_scene"),
+                       &MatchHost::get_match_scene);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "match_scene",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"),
+               "set_match_scene", "get_match_scene");
+
+  ClassDB::bind_method(D_METHOD("set_use_worker_threads", "enabled"),
+                       &MatchHost::set_use_worker_threads);
+  ClassDB::bind_method(D_METHOD("get_use_worker_threads"),
+                       &MatchHost::get_use_worker_threads);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_worker_threads"),
+               "set_use_worker_threads", "get_use_worker_threads");
+
+  ClassDB::bind_method(D_METHOD("set_report_interval", "seconds"),
+                       &MatchHost::set_report_interval);
+  ClassDB::bind_method(D_METHOD("get_report_interval"),
+                       &MatchHost::get_report_interval);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "report_interval",
+                            godot::PROPERTY_HINT_RANGE, "0,60,0.5"),
+               "set_report_interval", "get_report_interval");
+
+  ClassDB::bind_method(D_METHOD("start_match"), &MatchHost::start_match);
+  ClassDB::bind_method(D_METHOD("stop_match", "match_id"),
+                       &MatchHost::stop_match);
+  ClassDB::bind_method(D_METHOD("get_match_count"),
+                       &MatchHost::get_match_count);
+  ClassDB::bind_method(D_METHOD("get_match_ids"), &MatchHost::get_match_ids);
+  ClassDB::bind_method(D_METHOD("get_match_root", "match_id"),
+                       &MatchHost::get_match_root);
+  ClassDB::bind_method(D_METHOD("get_match_stats", "match_id"),
+                       &MatchHost::get_match_stats);
+
+  ADD_SIGNAL(MethodInfo("match_stats_reported",
+                        PropertyInfo(Variant::INT, "match_id"),
+                        PropertyInfo(Variant::DICTIONARY, "stats")));
+}
+
+void MatchHost::_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint() || report_interval <= 0.0f) {
+    return;
+  }
+
+  report_elapsed += delta;
+  if (report_elapsed >= report_interval) {
+    report_elapsed = 0.0;
+    _report();
+  }
+}
+
+void MatchHost::set_match_scene(const Ref<PackedScene>& scene) {
+  match_scene = scene;
+}
+
+Ref<PackedScene> MatchHost::get_match_scene() const {
+  return match_scene;
+}
+
+void MatchHost::set_use_worker_threads(bool enabled) {
+  use_worker_threads = enabled;
+}
+
+bool MatchHost::get_use_worker_threads() const {
+  return use_worker_threads;
+}
+
+void MatchHost::set_report_interval(float seconds) {
+  report_interval = std::max(seconds, 0.0f);
+}
+
+float MatchHost::get_report_interval() const {
+  return report_interval;
+}
+
+int32_t MatchHost::start_match() {
+  if (match_scene.is_null()) {
+    UtilityFunctions::push_error("[MatchHost] match_scene is not set.");
+    return -1;
+  }
+  Node* root = match_scene->instantiate();
+  if (root == nullptr) {
+    UtilityFunctions::push_error("[MatchHost] match_scene failed to load.");
+    return -1;
+  }
+
+  HostedMatch hosted;
+  hosted.id = next_match_id++;
+  hosted.root = root;
+
+  // Own World3D: a separate physics space per match.
+  hosted.viewport = memnew(SubViewport);
+  hosted.viewport->set_name("Match" + String::num_int64(hosted.id));
+  hosted.viewport->set_use_own_world_3d(true);
+  hosted.viewport->set_update_mode(SubViewport::UPDATE_DISABLED);
+  if (use_worker_threads) {
+    hosted.viewport->set_process_thread_group(
+        Node::PROCESS_THREAD_GROUP_SUB_THREAD);
+    hosted.viewport->set_process_thread_messages(
+        Node::FLAG_PROCESS_THREAD_MESSAGES_ALL);
+  }
+
+  // Inside the match root so they resolve its MatchManager.
+  hosted.start_probe = memnew(MatchTickProbe);
+  hosted.start_probe->setup(MatchTickProbe::ROLE_START, nullptr);
+  hosted.end_probe = memnew(MatchTickProbe);
+  hosted.end_probe->setup(MatchTickProbe::ROLE_END, hosted.start_probe);
+  root->add_child(hosted.start_probe);
+  root->add_child(hosted.end_probe);
+
+  hosted.viewport->add_child(root);
+  add_child(hosted.viewport);
+  matches.push_back(hosted);
+  return hosted.id;
+}
+
+void MatchHost::stop_match(int32_t match_id) {
+  for (auto it = matches.begin(); it != matches.end(); ++it) {
+    if (it->id == match_id) {
+      it->viewport->queue_free();
+      matches.erase(it);
+      return;
+    }
+  }
+}
+
+int32_t MatchHost::get_match_count() const {
+  return static_cast<int32_t>(matches.size());
+}
+
+PackedInt32Array MatchHost::get_match_ids() const {
+  PackedInt32Array ids;
+  for (const HostedMatch& hosted : matches) {
+    ids.push_back(hosted.id);
+  }
+  return ids;
+}
+
+Node* MatchHost::get_match_root(int32_t match_id) const {
+  const HostedMatch* hosted = _find_match(match_id);
+  return hosted != nullptr ? hosted->root : nullptr;
+}
+
+Dictionary MatchHost::get_match_stats(int32_t match_id) const {
+  const HostedMatch* hosted = _find_match(match_id);
+  return hosted != nullptr ? hosted->stats : Dictionary();
+}
+
+MatchManager* MatchHost::get_match_manager(int32_t match_id) const {
+  const HostedMatch* hosted = _find_match(match_id);
+  return hosted != nullptr ? hosted->end_probe->get_match() : nullptr;
+}
+
+MatchTickProbe::Window MatchHost::take_tick_window(int32_t match_id) {
+  HostedMatch* hosted = _find_match(match_id);
+  return hosted != nullptr ? hosted->end_probe->take_window()
+                           : MatchTickProbe::Window();
+}
+
+MatchHost::HostedMatch* MatchHost::_find_match(int32_t match_id) {
+  for (HostedMatch& hosted : matches) {
+    if (hosted.id == match_id) {
+      return &hosted;
+    }
+  }
+  return nullptr;
+}
+
+const MatchHost::HostedMatch* MatchHost::_find_match(int32_t match_id) const {
+  for (const HostedMatch& hosted : matches) {
+    if (hosted.id == match_id) {
+      return &hosted;
+    }
+  }
+  return nullptr;
+}
+
+void MatchHost::_report() {
+  for (HostedMatch& hosted : matches) {
+    const MatchTickProbe::Window window = hosted.end_probe->take_window();
+    Dictionary stats;
+    stats["tick_usec_avg"] =
+        window.ticks > 0 ? window.total_usec / window.ticks : 0;
+    stats["tick_usec_max"] = window.max_usec;
+    stats["checksum_usec_avg"] =
+        window.ticks > 0 ? window.checksum_usec / window.ticks : 0;
+    stats["ticks"] = window.ticks;
+    stats["memory_bytes"] = hosted.end_probe->get_memory_usage();
+    stats["unit_count"] = hosted.end_probe->get_unit_count();
+    stats["tick"] = hosted.end_probe->get_match_tick();
+    // Process-wide: arenas belong to worker threads, not matches.
+    stats["arena_heap_allocations"] = FrameArena::get_total_heap_allocations();
+    stats["arena_high_water_bytes"] = FrameArena::get_peak_high_water_mark();
+    hosted.stats = stats;
+    emit_signal("match_stats_reported", hosted.id, stats);
+  }
+}
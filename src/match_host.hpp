@@ -0,0 +1,105 @@
+#ifndef GDEXTENSION_MATCH_HOST_H
+#define GDEXTENSION_MATCH_HOST_H
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/packed_scene.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "match_tick_probe.hpp"
+
+namespace godot {
+class SubViewport;
+}  // namespace godot
+
+using godot::Dictionary;
+using godot::Node;
+using godot::PackedInt32Array;
+using godot::PackedScene;
+using godot::Ref;
+
+class MatchManager;
+
+// Hosts many independent matches in one process. Every match is an instance
+// of match_scene inside its own SubViewport with its own World3D, so each
+// has a separate physics space, MatchManager and UnitRegistry; nothing in
+// the simulation is shared between matches.
+//
+// With worker threads on, each match viewport is its own sub-thread process
+// group: the engine steps the matches in parallel on its worker thread pool,
+// each match on one thread at a time. Rendering is disabled for the match
+// viewports; run the host with --headless.
+//
+// Tick time (measured around all of a match's physics processing), the
+// match's simulation memory and unit count are reported per match every
+// report_interval seconds, along with the frame arena totals of the process.
+class MatchHost : public Node {
+  GDCLASS(MatchHost, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  MatchHost();
+  ~MatchHost();
+
+  void _process(double delta) override;
+
+  void set_match_scene(const Ref<PackedScene>& scene);
+  Ref<PackedScene> get_match_scene() const;
+
+  // Step matches on the worker thread pool. Only affects matches started
+  // afterwards.
+  void set_use_worker_threads(bool enabled);
+  bool get_use_worker_threads() const;
+
+  // Seconds between match_stats_reported signals; 0 turns reports off.
+  void set_report_interval(float seconds);
+  float get_report_interval() const;
+
+  // Instances match_scene as a new match and returns its id, or -1.
+  int32_t start_match();
+  void stop_match(int32_t match_id);
+  int32_t get_match_count() const;
+  PackedInt32Array get_match_ids() const;
+  // Root node of the match scene instance.
+  Node* get_match_root(int32_t match_id) const;
+  // Stats of the last report: tick_usec_avg, tick_usec_max,
+  // checksum_usec_avg (state hashing, part of the tick), ticks,
+  // memory_bytes, unit_count and tick.
+  Dictionary get_match_stats(int32_t match_id) const;
+
+  // Only safe between physics steps, when no match is being processed.
+  MatchManager* get_match_manager(int32_t match_id) const;
+  // Tick times since the last report or call. Callers that poll this should
+  // turn reports off, which take the same window.
+  MatchTickProbe::Window take_tick_window(int32_t match_id);
+
+ private:
+  struct HostedMatch {
+    int32_t id = 0;
+    godot::SubViewport* viewport = nullptr;
+    Node* root = nullptr;
+    MatchTickProbe* start_probe = nullptr;
+    MatchTickProbe* end_probe = nullptr;
+    Dictionary stats;
+  };
+
+  HostedMatch* _find_match(int32_t match_id);
+  const HostedMatch* _find_match(int32_t match_id) const;
+  void _report();
+
+  Ref<PackedScene> match_scene;
+  bool use_worker_threads = true;
+  float report_interval = 5.0f;
+
+  std::vector<HostedMatch> matches;
+  int32_t next_match_id = 1;
+  double report_elapsed = 0.0;
+};
+
+#endif  // GDEXTENSION_MATCH_HOST_H
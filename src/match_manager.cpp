@@ -1,21 +1,38 @@
 #include "match_manager.hpp"
 
+#include <algorithm>
 #include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/time.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/property_info.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
+#include "ai_scheduler.hpp"
+#include "desync_monitor.hpp"
+#include "frame_arena.hpp"
 #include "input_manager.hpp"
+#include "match_client.hpp"
 #include "moba_camera.hpp"
+#include "order_recorder.hpp"
 #include "unit.hpp"
+#include "unit_pool.hpp"
+#include "world_marker_pool.hpp"
 
 using godot::ClassDB;
 using godot::D_METHOD;
 using godot::Engine;
 using godot::PropertyInfo;
+using godot::StringName;
+using godot::Time;
 using godot::UtilityFunctions;
 using godot::Variant;
 
+namespace {
+// Set on the parent of every MatchManager so nodes can find their match by
+// walking up the tree.
+const char* const MATCH_MANAGER_META = "_match_manager";
+}  // namespace
+
 MatchManager::MatchManager() = default;
 
 MatchManager::~MatchManager() = default;
@@ -43,6 +60,140 @@ void MatchManager::_bind_methods() {
   ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "moba_camera",
                             godot::PROPERTY_HINT_NODE_TYPE, "MOBACamera"),
                "set_moba_camera", "get_moba_camera");
+
+  ClassDB::bind_method(D_METHOD("set_marker_pool", "pool"),
+                       &MatchManager::set_marker_pool);
+  ClassDB::bind_method(D_METHOD("get_marker_pool"),
+                       &MatchManager::get_marker_pool);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "marker_pool",
+                            godot::PROPERTY_HINT_NODE_TYPE, "WorldMarkerPool"),
+               "set_marker_pool", "get_marker_pool");
+
+  ClassDB::bind_method(D_METHOD("set_unit_pool", "pool"),
+                       &MatchManager::set_unit_pool);
+  ClassDB::bind_method(D_METHOD("get_unit_pool"),
+                       &MatchManager::get_unit_pool);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "unit_pool",
+                            godot::PROPERTY_HINT_NODE_TYPE, "UnitPool"),
+               "set_unit_pool", "get_unit_pool");
+
+  ClassDB::bind_method(D_METHOD("set_ai_scheduler", "scheduler"),
+                       &MatchManager::set_ai_scheduler);
+  ClassDB::bind_method(D_METHOD("get_ai_scheduler"),
+                       &MatchManager::get_ai_scheduler);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "ai_scheduler",
+                            godot::PROPERTY_HINT_NODE_TYPE, "AIScheduler"),
+               "set_ai_scheduler", "get_ai_scheduler");
+
+  ClassDB::bind_method(D_METHOD("set_order_recorder", "recorder"),
+                       &MatchManager::set_order_recorder);
+  ClassDB::bind_method(D_METHOD("get_order_recorder"),
+                       &MatchManager::get_order_recorder);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "order_recorder",
+                            godot::PROPERTY_HINT_NODE_TYPE, "OrderRecorder"),
+               "set_order_recorder", "get_order_recorder");
+
+  ClassDB::bind_method(D_METHOD("set_match_client", "client"),
+                       &MatchManager::set_match_client);
+  ClassDB::bind_method(D_METHOD("get_match_client"),
+                       &MatchManager::get_match_client);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "match_client",
+                            godot::PROPERTY_HINT_NODE_TYPE, "MatchClient"),
+               "set_match_client", "get_match_client");
+
+  ClassDB::bind_method(D_METHOD("set_desync_monitor", "monitor"),
+                       &MatchManager::set_desync_monitor);
+  ClassDB::bind_method(D_METHOD("get_desync_monitor"),
+                       &MatchManager::get_desync_monitor);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "desync_monitor",
+                            godot::PROPERTY_HINT_NODE_TYPE, "DesyncMonitor"),
+               "set_desync_monitor", "get_desync_monitor");
+
+  ClassDB::bind_method(D_METHOD("set_deterministic", "enabled"),
+                       &MatchManager::set_deterministic);
+  ClassDB::bind_method(D_METHOD("is_deterministic"),
+                       &MatchManager::is_deterministic);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "deterministic"),
+               "set_deterministic", "is_deterministic");
+
+  ClassDB::bind_method(D_METHOD("set_seed", "seed"), &MatchManager::set_seed);
+  ClassDB::bind_method(D_METHOD("get_seed"), &MatchManager::get_seed);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "seed"), "set_seed", "get_seed");
+
+  ClassDB::bind_method(D_METHOD("get_tick"), &MatchManager::get_tick);
+  ClassDB::bind_method(D_METHOD("get_state_checksum"),
+                       &MatchManager::get_state_checksum);
+  ClassDB::bind_method(D_METHOD("set_checksum_history_length", "length"),
+                       &MatchManager::set_checksum_history_length);
+  ClassDB::bind_method(D_METHOD("get_checksum_history_length"),
+                       &MatchManager::get_checksum_history_length);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "checksum_history_length",
+                            godot::PROPERTY_HINT_RANGE, "0,3600,1"),
+               "set_checksum_history_length", "get_checksum_history_length");
+  ClassDB::bind_method(D_METHOD("get_checksum_history"),
+                       &MatchManager::get_checksum_history);
+  ClassDB::bind_method(D_METHOD("get_checksum_at", "tick"),
+                       &MatchManager::get_checksum_at);
+  ClassDB::bind_method(D_METHOD("get_last_checksum_usec"),
+                       &MatchManager::get_last_checksum_usec);
+
+  ClassDB::bind_method(D_METHOD("set_position_history_length", "length"),
+                       &MatchManager::set_position_history_length);
+  ClassDB::bind_method(D_METHOD("get_position_history_length"),
+                       &MatchManager::get_position_history_length);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "position_history_length",
+                            godot::PROPERTY_HINT_RANGE, "0,600,1"),
+               "set_position_history_length", "get_position_history_length");
+  ClassDB::bind_method(D_METHOD("get_unit_by_handle", "handle"),
+                       &MatchManager::get_unit_by_handle);
+  ClassDB::bind_method(D_METHOD("is_handle_alive", "handle"),
+                       &MatchManager::is_handle_alive);
+  ClassDB::bind_method(
+      D_METHOD("get_handles_in_radius", "center", "radius", "faction_id"),
+      &MatchManager::get_handles_in_radius, -1);
+  ClassDB::bind_method(D_METHOD("get_frame_arena_stats"),
+                       &MatchManager::get_frame_arena_stats);
+  ClassDB::bind_method(D_METHOD("get_memory_usage"),
+                       &MatchManager::get_memory_usage);
+  ClassDB::bind_method(D_METHOD("get_position_at", "slot", "tick"),
+                       &MatchManager::get_position_at);
+  ClassDB::bind_method(D_METHOD("was_alive_at", "slot", "tick"),
+                       &MatchManager::was_alive_at);
+
+  ADD_SIGNAL(godot::MethodInfo("state_checksum_computed",
+                               PropertyInfo(Variant::INT, "tick"),
+                               PropertyInfo(Variant::INT, "checksum")));
+}
+
+void MatchManager::_notification(int p_what) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  // PARENTED arrives before any sibling enters the tree, so units instanced
+  // together with the match can already resolve it in _enter_tree().
+  const StringName meta_name(MATCH_MANAGER_META);
+  if (p_what == NOTIFICATION_PARENTED) {
+    get_parent()->set_meta(meta_name, this);
+    meta_parent_id = get_parent()->get_instance_id();
+    return;
+  }
+  if (p_what != NOTIFICATION_UNPARENTED && p_what != NOTIFICATION_PREDELETE) {
+    return;
+  }
+
+  // The parent is already gone from get_parent() on UNPARENTED. Leave the
+  // meta alone if another match has been added to that parent since.
+  auto parent =
+      Object::cast_to<Node>(godot::ObjectDB::get_instance(meta_parent_id));
+  meta_parent_id = 0;
+  if (parent == nullptr || !parent->has_meta(meta_name)) {
+    return;
+  }
+  godot::Object* match = parent->get_meta(meta_name);
+  if (match == this) {
+    parent->remove_meta(meta_name);
+  }
 }
 
 void MatchManager::_ready() {
@@ -50,11 +201,23 @@ void MatchManager::_ready() {
     return;
   }
 
+  fixed_tick_length =
+      Fixed::from_int(1) /
+      Fixed::from_int(Engine::get_singleton()->get_physics_ticks_per_second());
+
+  // Hash after units, components and projectiles have stepped.
+  set_physics_process_priority(1000);
+  checksum_history.assign(checksum_history_length, 0);
+
   if (main_unit == nullptr) {
     UtilityFunctions::push_warning("[MatchManager] main_unit is not set.");
     return;
   }
 
+  // The hero keeps its own mesh nodes even when its archetype is instanced.
+  unit_registry.set_individually_rendered(main_unit->get_registry_slot(),
+                                          true);
+
   if (player_controller == nullptr) {
     UtilityFunctions::push_warning(
         "[MatchManager] player_controller is not set.");
@@ -69,6 +232,45 @@ void MatchManager::_ready() {
   }
 }
 
+void MatchManager::_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  unit_registry.sync_visual_transforms();
+}
+
+void MatchManager::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  tick++;
+  if (deterministic) {
+    // Slot order is the registration order, identical on every peer that
+    // loads the same match scene.
+    const int32_t slot_count = unit_registry.get_slot_count();
+    for (int32_t slot = 0; slot < slot_count; ++slot) {
+      Unit* unit = unit_registry.get_unit(slot);
+      if (unit != nullptr) {
+        unit->simulate_tick(delta);
+      }
+    }
+  }
+
+  // Sight follows this tick's moves; acquisition reads it next tick.
+  unit_registry.get_visibility_grid().update(unit_registry);
+  unit_registry.record_position_history(tick);
+  if (deterministic || desync_monitor != nullptr ||
+      checksum_history_length > 0) {
+    _update_state_checksum();
+  }
+  transient_state = 0;
+
+  // Everything the tick allocated from the frame arena is released here.
+  FrameArena::get().reset();
+}
+
 void MatchManager::set_main_unit(Unit* unit) {
   main_unit = unit;
 }
@@ -92,3 +294,226 @@ void MatchManager::set_moba_camera(MOBACamera* camera) {
 MOBACamera* MatchManager::get_moba_camera() const {
   return moba_camera;
 }
+
+void MatchManager::set_marker_pool(WorldMarkerPool* pool) {
+  marker_pool = pool;
+}
+
+WorldMarkerPool* MatchManager::get_marker_pool() const {
+  return marker_pool;
+}
+
+void MatchManager::set_unit_pool(UnitPool* pool) {
+  unit_pool = pool;
+}
+
+UnitPool* MatchManager::get_unit_pool() const {
+  return unit_pool;
+}
+
+void MatchManager::set_ai_scheduler(AIScheduler* scheduler) {
+  ai_scheduler = scheduler;
+}
+
+AIScheduler* MatchManager::get_ai_scheduler() const {
+  return ai_scheduler;
+}
+
+void MatchManager::set_order_recorder(OrderRecorder* recorder) {
+  order_recorder = recorder;
+}
+
+OrderRecorder* MatchManager::get_order_recorder() const {
+  return order_recorder;
+}
+
+void MatchManager::set_match_client(MatchClient* client) {
+  match_client = client;
+}
+
+MatchClient* MatchManager::get_match_client() const {
+  return match_client;
+}
+
+void MatchManager::set_desync_monitor(DesyncMonitor* monitor) {
+  desync_monitor = monitor;
+}
+
+DesyncMonitor* MatchManager::get_desync_monitor() const {
+  return desync_monitor;
+}
+
+void MatchManager::set_deterministic(bool enabled) {
+  deterministic = enabled;
+}
+
+bool MatchManager::is_deterministic() const {
+  return deterministic;
+}
+
+void MatchManager::set_seed(int64_t new_seed) {
+  seed = new_seed;
+}
+
+int64_t MatchManager::get_seed() const {
+  return seed;
+}
+
+uint64_t MatchManager::get_unit_seed(int32_t slot) const {
+  if (order_recorder != nullptr &&
+      (order_recorder->is_recording() || order_recorder->is_replaying())) {
+    return order_recorder->get_unit_seed(slot);
+  }
+  return DeterministicRandom::stream_seed(static_cast<uint64_t>(seed), slot);
+}
+
+Fixed MatchManager::get_fixed_tick_length() const {
+  return fixed_tick_length;
+}
+
+int64_t MatchManager::get_tick() const {
+  return tick;
+}
+
+int64_t MatchManager::get_state_checksum() const {
+  return static_cast<int64_t>(state_checksum);
+}
+
+void MatchManager::set_checksum_history_length(int32_t length) {
+  checksum_history_length = std::max(length, 0);
+  checksum_history.assign(checksum_history_length, 0);
+}
+
+int32_t MatchManager::get_checksum_history_length() const {
+  return checksum_history_length;
+}
+
+PackedInt64Array MatchManager::get_checksum_history() const {
+  PackedInt64Array history;
+  const int64_t first =
+      std::max<int64_t>(tick - checksum_history_length + 1, 1);
+  for (int64_t at_tick = first; at_tick <= tick; ++at_tick) {
+    history.push_back(get_checksum_at(at_tick));
+  }
+  return history;
+}
+
+int64_t MatchManager::get_checksum_at(int64_t at_tick) const {
+  if (checksum_history_length == 0 || at_tick < 1 || at_tick > tick ||
+      at_tick <= tick - checksum_history_length) {
+    return 0;
+  }
+  return static_cast<int64_t>(
+      checksum_history[at_tick % checksum_history_length]);
+}
+
+void MatchManager::add_transient_state(uint64_t hash) {
+  // A sum, so projectiles may report in any order.
+  transient_state += DeterministicRandom::mix(hash);
+}
+
+int64_t MatchManager::get_last_checksum_usec() const {
+  return last_checksum_usec;
+}
+
+void MatchManager::_update_state_checksum() {
+  StateChecksum& state = unit_registry.get_state_checksum();
+  const uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+  state_checksum = state.compute(
+      hash_mix(hash_mix(HASH_SEED, static_cast<uint64_t>(tick)),
+               transient_state));
+  last_checksum_usec = static_cast<int64_t>(
+      Time::get_singleton()->get_ticks_usec() - start_usec);
+  if (checksum_history_length > 0) {
+    checksum_history[tick % checksum_history_length] = state_checksum;
+  }
+  if (desync_monitor != nullptr) {
+    desync_monitor->on_tick(tick, state_checksum, state);
+  }
+  emit_signal("state_checksum_computed", tick,
+              static_cast<int64_t>(state_checksum));
+}
+
+void MatchManager::set_position_history_length(int32_t length) {
+  unit_registry.get_position_history().set_capacity(length);
+}
+
+int32_t MatchManager::get_position_history_length() const {
+  return unit_registry.get_position_history().get_capacity();
+}
+
+Vector3 MatchManager::get_position_at(int32_t slot, int64_t at_tick) const {
+  const PositionHistory::Sample* sample =
+      unit_registry.get_position_history().sample(slot, at_tick);
+  if (sample == nullptr) {
+    return unit_registry.get_unit(slot) != nullptr
+               ? unit_registry.get_position(slot)
+               : Vector3();
+  }
+  return sample->position;
+}
+
+bool MatchManager::was_alive_at(int32_t slot, int64_t at_tick) const {
+  const PositionHistory::Sample* sample =
+      unit_registry.get_position_history().sample(slot, at_tick);
+  return sample != nullptr && sample->alive;
+}
+
+Unit* MatchManager::get_unit_by_handle(int64_t handle) const {
+  return unit_registry.resolve(handle);
+}
+
+bool MatchManager::is_handle_alive(int64_t handle) const {
+  return unit_registry.is_alive(handle);
+}
+
+PackedInt64Array MatchManager::get_handles_in_radius(const Vector3& center,
+                                                     float radius,
+                                                     int32_t faction_id) const {
+  PackedInt64Array handles;
+  unit_registry.get_spatial_grid().for_each_in_radius(
+      center, radius, [&](int32_t slot) {
+        if (faction_id < 0 || unit_registry.get_faction(slot) == faction_id) {
+          handles.push_back(unit_registry.get_handle(slot));
+        }
+      });
+  return handles;
+}
+
+Dictionary MatchManager::get_frame_arena_stats() const {
+  const FrameArena& arena = FrameArena::get();
+  Dictionary stats;
+  stats["capacity_bytes"] = static_cast<int64_t>(arena.get_capacity());
+  stats["last_tick_bytes"] = static_cast<int64_t>(arena.get_last_tick_used());
+  stats["high_water_bytes"] =
+      static_cast<int64_t>(arena.get_high_water_mark());
+  stats["heap_allocations"] = arena.get_heap_allocation_count();
+  stats["total_heap_allocations"] = FrameArena::get_total_heap_allocations();
+  return stats;
+}
+
+int64_t MatchManager::get_memory_usage() const {
+  return static_cast<int64_t>(unit_registry.get_memory_usage() +
+                              checksum_history.capacity() * sizeof(uint64_t));
+}
+
+UnitRegistry& MatchManager::get_unit_registry() {
+  return unit_registry;
+}
+
+const UnitRegistry& MatchManager::get_unit_registry() const {
+  return unit_registry;
+}
+
+MatchManager* MatchManager::find_for(const Node* node) {
+  const StringName meta_name(MATCH_MANAGER_META);
+  for (const Node* current = node; current != nullptr;
+       current = current->get_parent()) {
+    if (!current->has_meta(meta_name)) {
+      continue;
+    }
+    godot::Object* match = current->get_meta(meta_name);
+    return Object::cast_to<MatchManager>(match);
+  }
+  return nullptr;
+}
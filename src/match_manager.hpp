@@ -2,12 +2,27 @@
 #define GDEXTENSION_MATCH_MANAGER_H
 
 #include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_int64_array.hpp>
 
+#include <vector>
+
+#include "fixed_point.hpp"
+#include "unit_registry.hpp"
+
+using godot::Dictionary;
 using godot::Node;
+using godot::PackedInt64Array;
 
+class AIScheduler;
+class DesyncMonitor;
 class InputManager;
+class MatchClient;
 class MOBACamera;
+class OrderRecorder;
 class Unit;
+class UnitPool;
+class WorldMarkerPool;
 
 class MatchManager : public Node {
   GDCLASS(MatchManager, Node)
@@ -19,7 +34,10 @@ class MatchManager : public Node {
   MatchManager();
   ~MatchManager();
 
+  void _notification(int p_what);
   void _ready() override;
+  void _process(double delta) override;
+  void _physics_process(double delta) override;
 
   void set_main_unit(Unit* unit);
   Unit* get_main_unit() const;
@@ -30,10 +48,128 @@ class MatchManager : public Node {
   void set_moba_camera(MOBACamera* camera);
   MOBACamera* get_moba_camera() const;
 
+  // Shared pool for transient world FX (hit sparks, impacts). Optional.
+  void set_marker_pool(WorldMarkerPool* pool);
+  WorldMarkerPool* get_marker_pool() const;
+
+  // Recycles spawned units (creep waves). Optional.
+  void set_unit_pool(UnitPool* pool);
+  UnitPool* get_unit_pool() const;
+
+  // Runs bot decisions under a per-frame budget. Optional.
+  void set_ai_scheduler(AIScheduler* scheduler);
+  AIScheduler* get_ai_scheduler() const;
+
+  // Records or replays the orders given to the match units. Optional.
+  void set_order_recorder(OrderRecorder* recorder);
+  OrderRecorder* get_order_recorder() const;
+
+  // Set when the match mirrors a remote server. Orders for the main unit are
+  // then predicted locally and forwarded. Optional.
+  void set_match_client(MatchClient* client);
+  MatchClient* get_match_client() const;
+
+  // Writes and checks per-tick checksum streams. Optional.
+  void set_desync_monitor(DesyncMonitor* monitor);
+  DesyncMonitor* get_desync_monitor() const;
+
+  // Lockstep mode: positions, timers and damage use fixed-point math and
+  // units are stepped by the match in registry slot order, so the state
+  // checksum can be compared between peers. Units neither collide nor fall
+  // there, and navmesh path corners are the only float input to steering.
+  // Set before the match starts.
+  void set_deterministic(bool enabled);
+  bool is_deterministic() const;
+
+  // Seed of the per-unit random streams. Recordings override it.
+  void set_seed(int64_t new_seed);
+  int64_t get_seed() const;
+  uint64_t get_unit_seed(int32_t slot) const;
+
+  // Length of one physics tick in fixed point.
+  Fixed get_fixed_tick_length() const;
+  int64_t get_tick() const;
+
+  // Checksum of the simulation state after the last tick. Outside
+  // deterministic mode it only matches between runs on the same machine and
+  // build, e.g. a recording and its replay.
+  int64_t get_state_checksum() const;
+  // Number of recent checksums kept, 0 by default. 0 turns hashing off
+  // unless the match is deterministic or has a desync monitor.
+  void set_checksum_history_length(int32_t length);
+  int32_t get_checksum_history_length() const;
+  // Recent checksums, oldest first, ending with the current tick.
+  PackedInt64Array get_checksum_history() const;
+  // Checksum of a recent tick, or 0 if it is no longer in the history.
+  int64_t get_checksum_at(int64_t at_tick) const;
+  // Time the last tick spent hashing its state, desync monitor excluded.
+  int64_t get_last_checksum_usec() const;
+  // Folds state that does not live in a registry slot (projectiles) into the
+  // checksum of the current tick. Order independent.
+  void add_transient_state(uint64_t hash);
+
+  // Ticks of unit positions kept for lag compensation (see
+  // PositionHistory); 0 keeps none. MatchServer raises it to its rewind
+  // limit.
+  void set_position_history_length(int32_t length);
+  int32_t get_position_history_length() const;
+  // Recorded position of a slot at a recent tick; the unit's current
+  // position once the tick is no longer kept.
+  Vector3 get_position_at(int32_t slot, int64_t at_tick) const;
+  bool was_alive_at(int32_t slot, int64_t at_tick) const;
+
+  // Generational unit handles (see UnitHandle) for scripts. Handles stay
+  // safe to pass around after their unit left; they just stop resolving.
+  Unit* get_unit_by_handle(int64_t handle) const;
+  bool is_handle_alive(int64_t handle) const;
+  // Handles of every unit within radius of center on the ground plane,
+  // optionally of one faction (-1 for all).
+  PackedInt64Array get_handles_in_radius(const Vector3& center,
+                                         float radius,
+                                         int32_t faction_id) const;
+
+  // Frame arena of the calling thread (see FrameArena): capacity, bytes
+  // used by the last tick, high-water mark and heap allocations, plus the
+  // heap allocations of every thread's arena. Call it from the thread that
+  // steps the match; MatchHost reports the process totals per match.
+  Dictionary get_frame_arena_stats() const;
+
+  // Bytes held by the match's simulation tables (registry, histories).
+  // Nodes and resources are not included.
+  int64_t get_memory_usage() const;
+
+  UnitRegistry& get_unit_registry();
+  const UnitRegistry& get_unit_registry() const;
+
+  // Returns the match a node belongs to: the MatchManager that is a sibling of
+  // the node or of one of its ancestors.
+  static MatchManager* find_for(const Node* node);
+
  private:
+  uint64_t meta_parent_id = 0;  // Instance id of the node holding our meta
   Unit* main_unit = nullptr;
   InputManager* player_controller = nullptr;
   MOBACamera* moba_camera = nullptr;
+  WorldMarkerPool* marker_pool = nullptr;
+  UnitPool* unit_pool = nullptr;
+  AIScheduler* ai_scheduler = nullptr;
+  OrderRecorder* order_recorder = nullptr;
+  DesyncMonitor* desync_monitor = nullptr;
+  MatchClient* match_client = nullptr;
+
+  void _update_state_checksum();
+
+  bool deterministic = false;
+  int64_t seed = 0;
+  Fixed fixed_tick_length = Fixed::from_int(1);
+  int64_t tick = 0;
+  uint64_t state_checksum = 0;
+  int64_t last_checksum_usec = 0;
+  uint64_t transient_state = 0;
+  int32_t checksum_history_length = 0;
+  std::vector<uint64_t> checksum_history;  // Ring indexed by tick.
+
+  UnitRegistry unit_registry;
 };
 
 #endif  // GDEXTENSION_MATCH_MANAGER_H
@@ -0,0 +1,513 @@
+#include "match_server.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "health_component.hpp"
+#include "match_manager.hpp"
+#include "snapshot_transport.hpp"
+#include "unit.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::MethodInfo;
+using godot::PropertyInfo;
+using godot::UtilityFunctions;
+using godot::Variant;
+using godot::Vector3;
+
+namespace {
+
+// Client input is untrusted: a move must stay inside the area snapshots can
+// encode, which is the playable map.
+bool is_valid_move_position(const Vector3& position) {
+  for (int32_t axis = 0; axis < 3; ++axis) {
+    const float extent = axis == 1 ? SnapshotCodec::HEIGHT_EXTENT
+                                   : SnapshotCodec::WORLD_EXTENT;
+    if (!std::isfinite(position[axis]) || std::abs(position[axis]) > extent) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Only living units of another faction may be attacked.
+bool is_valid_attack_target(const Unit* unit, Unit* target) {
+  if (target == nullptr || target == unit || !target->is_inside_tree() ||
+      target->get_faction_id() == unit->get_faction_id()) {
+    return false;
+  }
+  const HealthComponent* health = target->get_health_component();
+  return health == nullptr || !health->is_dead();
+}
+
+}  // namespace
+
+MatchServer::MatchServer() = default;
+
+MatchServer::~MatchServer() = default;
+
+void MatchServer::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_transport", "transport"),
+                       &MatchServer::set_transport);
+  ClassDB::bind_method(D_METHOD("get_transport"), &MatchServer::get_transport);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "transport",
+                            godot::PROPERTY_HINT_NODE_TYPE,
+                            "SnapshotTransport"),
+               "set_transport", "get_transport");
+
+  ClassDB::bind_method(D_METHOD("set_snapshot_interval", "ticks"),
+                       &MatchServer::set_snapshot_interval);
+  ClassDB::bind_method(D_METHOD("get_snapshot_interval"),
+                       &MatchServer::get_snapshot_interval);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "snapshot_interval",
+                            godot::PROPERTY_HINT_RANGE, "1,60,1"),
+               "set_snapshot_interval", "get_snapshot_interval");
+
+  ClassDB::bind_method(D_METHOD("set_max_rewind_ticks", "ticks"),
+                       &MatchServer::set_max_rewind_ticks);
+  ClassDB::bind_method(D_METHOD("get_max_rewind_ticks"),
+                       &MatchServer::get_max_rewind_ticks);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "max_rewind_ticks",
+                            godot::PROPERTY_HINT_RANGE, "0,120,1"),
+               "set_max_rewind_ticks", "get_max_rewind_ticks");
+
+  ClassDB::bind_method(D_METHOD("set_interest_management", "enabled"),
+                       &MatchServer::set_interest_management);
+  ClassDB::bind_method(D_METHOD("get_interest_management"),
+                       &MatchServer::get_interest_management);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "interest_management"),
+               "set_interest_management", "get_interest_management");
+
+  ClassDB::bind_method(D_METHOD("set_vision_radius", "radius"),
+                       &MatchServer::set_vision_radius);
+  ClassDB::bind_method(D_METHOD("get_vision_radius"),
+                       &MatchServer::get_vision_radius);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "vision_radius"),
+               "set_vision_radius", "get_vision_radius");
+
+  ClassDB::bind_method(D_METHOD("set_near_radius", "radius"),
+                       &MatchServer::set_near_radius);
+  ClassDB::bind_method(D_METHOD("get_near_radius"),
+                       &MatchServer::get_near_radius);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "near_radius"),
+               "set_near_radius", "get_near_radius");
+
+  ClassDB::bind_method(D_METHOD("set_far_radius", "radius"),
+                       &MatchServer::set_far_radius);
+  ClassDB::bind_method(D_METHOD("get_far_radius"),
+                       &MatchServer::get_far_radius);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "far_radius"), "set_far_radius",
+               "get_far_radius");
+
+  ClassDB::bind_method(D_METHOD("add_client", "peer_id"),
+                       &MatchServer::add_client);
+  ClassDB::bind_method(D_METHOD("remove_client", "peer_id"),
+                       &MatchServer::remove_client);
+  ClassDB::bind_method(D_METHOD("has_client", "peer_id"),
+                       &MatchServer::has_client);
+  ClassDB::bind_method(D_METHOD("get_client_count"),
+                       &MatchServer::get_client_count);
+  ClassDB::bind_method(D_METHOD("set_client_focus", "peer_id", "slot"),
+                       &MatchServer::set_client_focus);
+  ClassDB::bind_method(D_METHOD("set_client_unit", "peer_id", "slot"),
+                       &MatchServer::set_client_unit);
+  ClassDB::bind_method(D_METHOD("get_client_unit", "peer_id"),
+                       &MatchServer::get_client_unit);
+  ClassDB::bind_method(D_METHOD("get_client_bandwidth", "peer_id"),
+                       &MatchServer::get_client_bandwidth);
+  ClassDB::bind_method(D_METHOD("get_bandwidth_report"),
+                       &MatchServer::get_bandwidth_report);
+
+  ADD_SIGNAL(
+      MethodInfo("client_joined", PropertyInfo(Variant::INT, "peer_id")));
+  ADD_SIGNAL(MethodInfo("bandwidth_reported",
+                        PropertyInfo(Variant::INT, "peer_id"),
+                        PropertyInfo(Variant::INT, "bytes_per_second")));
+}
+
+void MatchServer::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+  if (match == nullptr) {
+    UtilityFunctions::push_warning(
+        "[MatchServer] Not part of a match, nothing to serve.");
+    set_physics_process(false);
+    return;
+  }
+  if (transport == nullptr) {
+    UtilityFunctions::push_warning("[MatchServer] transport is not set.");
+  }
+
+  // Hits are judged in the past up to the rewind limit.
+  if (max_rewind_ticks > 0 &&
+      match->get_position_history_length() <= max_rewind_ticks) {
+    match->set_position_history_length(max_rewind_ticks + 1);
+  }
+
+  // Snapshot the state the match just finished simulating and hashing.
+  set_physics_process_priority(1001);
+}
+
+void MatchServer::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint() || transport == nullptr) {
+    return;
+  }
+
+  // Units stepped once since the last call.
+  for (Client& client : clients) {
+    client.steps_since_input++;
+  }
+  _receive_packets();
+
+  UnitRegistry& registry = match->get_unit_registry();
+  if (interest_management) {
+    // Every tick, so no cell crossing is missed; without viewers it only
+    // remembers to start over.
+    interest.update(registry);
+  }
+
+  const int64_t tick = match->get_tick();
+  if (!clients.empty() && tick % snapshot_interval == 0) {
+    SnapshotCodec::capture(registry, static_cast<uint32_t>(tick), current);
+    for (Client& client : clients) {
+      _send_snapshot(client);
+    }
+  }
+
+  window_ticks++;
+  if (window_ticks >= Engine::get_singleton()->get_physics_ticks_per_second()) {
+    _report_bandwidth();
+  }
+}
+
+void MatchServer::set_transport(SnapshotTransport* new_transport) {
+  transport = new_transport;
+}
+
+SnapshotTransport* MatchServer::get_transport() const {
+  return transport;
+}
+
+void MatchServer::set_snapshot_interval(int32_t ticks) {
+  snapshot_interval = std::max(ticks, 1);
+}
+
+int32_t MatchServer::get_snapshot_interval() const {
+  return snapshot_interval;
+}
+
+void MatchServer::set_max_rewind_ticks(int32_t ticks) {
+  max_rewind_ticks = std::max(ticks, 0);
+}
+
+int32_t MatchServer::get_max_rewind_ticks() const {
+  return max_rewind_ticks;
+}
+
+void MatchServer::set_interest_management(bool enabled) {
+  if (enabled && !interest_management) {
+    interest.invalidate();
+  }
+  interest_management = enabled;
+}
+
+bool MatchServer::get_interest_management() const {
+  return interest_management;
+}
+
+void MatchServer::set_vision_radius(float radius) {
+  interest.set_vision_radius(radius);
+}
+
+float MatchServer::get_vision_radius() const {
+  return interest.get_vision_radius();
+}
+
+void MatchServer::set_near_radius(float radius) {
+  interest.set_tier_radii(radius, interest.get_far_radius());
+}
+
+float MatchServer::get_near_radius() const {
+  return interest.get_near_radius();
+}
+
+void MatchServer::set_far_radius(float radius) {
+  interest.set_tier_radii(interest.get_near_radius(), radius);
+}
+
+float MatchServer::get_far_radius() const {
+  return interest.get_far_radius();
+}
+
+void MatchServer::add_client(int32_t peer_id) {
+  if (peer_id == SnapshotTransport::SERVER_PEER || has_client(peer_id)) {
+    return;
+  }
+
+  Client client;
+  client.peer_id = peer_id;
+  client.history.resize(SNAPSHOT_HISTORY);
+  client.viewer = interest.add_viewer();
+  clients.push_back(std::move(client));
+  emit_signal("client_joined", peer_id);
+}
+
+void MatchServer::remove_client(int32_t peer_id) {
+  const Client* client = _find_client(peer_id);
+  if (client != nullptr) {
+    interest.remove_viewer(client->viewer);
+  }
+  clients.erase(std::remove_if(clients.begin(), clients.end(),
+                               [peer_id](const Client& client) {
+                                 return client.peer_id == peer_id;
+                               }),
+                clients.end());
+}
+
+bool MatchServer::has_client(int32_t peer_id) const {
+  return _find_client(peer_id) != nullptr;
+}
+
+int32_t MatchServer::get_client_count() const {
+  return static_cast<int32_t>(clients.size());
+}
+
+void MatchServer::set_client_focus(int32_t peer_id, int32_t slot) {
+  const Client* client = _find_client(peer_id);
+  if (client != nullptr) {
+    interest.set_viewer_focus(client->viewer, slot);
+  }
+}
+
+void MatchServer::set_client_unit(int32_t peer_id, int32_t slot) {
+  Client* client = _find_client(peer_id);
+  if (client != nullptr) {
+    client->unit_slot = slot;
+  }
+}
+
+int32_t MatchServer::get_client_unit(int32_t peer_id) const {
+  const Client* client = _find_client(peer_id);
+  return client != nullptr ? client->unit_slot : UnitRegistry::INVALID_SLOT;
+}
+
+int64_t MatchServer::get_client_bandwidth(int32_t peer_id) const {
+  const Client* client = _find_client(peer_id);
+  return client != nullptr ? client->bytes_per_second : 0;
+}
+
+Dictionary MatchServer::get_bandwidth_report() const {
+  Dictionary report;
+  for (const Client& client : clients) {
+    report[client.peer_id] = client.bytes_per_second;
+  }
+  return report;
+}
+
+MatchServer::Client* MatchServer::_find_client(int32_t peer_id) {
+  for (Client& client : clients) {
+    if (client.peer_id == peer_id) {
+      return &client;
+    }
+  }
+  return nullptr;
+}
+
+const MatchServer::Client* MatchServer::_find_client(int32_t peer_id) const {
+  for (const Client& client : clients) {
+    if (client.peer_id == peer_id) {
+      return &client;
+    }
+  }
+  return nullptr;
+}
+
+void MatchServer::_receive_packets() {
+  int32_t from_peer = 0;
+  while (transport->poll_packet(SnapshotTransport::SERVER_PEER, from_peer,
+                                packet)) {
+    BitReader reader(packet.ptr(), packet.size());
+    const auto type = static_cast<SnapshotMessage>(reader.read_bits(8));
+    if (type == SnapshotMessage::JOIN) {
+      const uint32_t focus = reader.read_varuint();
+      if (!reader.is_overflowed()) {
+        add_client(from_peer);
+        set_client_focus(from_peer, static_cast<int32_t>(focus) - 1);
+      }
+      continue;
+    }
+    if (type == SnapshotMessage::INPUT) {
+      Client* client = _find_client(from_peer);
+      if (client != nullptr) {
+        _apply_inputs(*client, reader);
+      }
+      continue;
+    }
+
+    const uint32_t acked_tick = reader.read_bits(32);
+    if (reader.is_overflowed() || type != SnapshotMessage::ACK) {
+      continue;
+    }
+
+    add_client(from_peer);
+    Client* client = _find_client(from_peer);
+    // Acks can arrive out of order; only a newer one moves the baseline.
+    if (client != nullptr && acked_tick > client->acked_tick) {
+      client->acked_tick = acked_tick;
+      // The age of the snapshot on arrival of its ack approximates how far
+      // the client's orders lag the server: its view plus the way back.
+      const int64_t delay = match->get_tick() - acked_tick;
+      match->get_unit_registry().get_position_history().set_view_delay(
+          client->unit_slot,
+          static_cast<int32_t>(std::min<int64_t>(delay, max_rewind_ticks)));
+    }
+  }
+}
+
+void MatchServer::_apply_inputs(Client& client, BitReader& reader) {
+  UnitRegistry& registry = match->get_unit_registry();
+  Unit* unit = registry.get_unit(client.unit_slot);
+
+  // The client repeats every input until acknowledged; skip the ones that
+  // were applied already.
+  const uint32_t input_count = reader.read_varuint();
+  for (uint32_t i = 0; i < input_count && !reader.is_overflowed(); ++i) {
+    const uint32_t sequence = reader.read_bits(32);
+    const uint8_t type = static_cast<uint8_t>(reader.read_bits(8));
+    const bool queued = (type & INPUT_QUEUED_BIT) != 0;
+
+    UnitOrder order;
+    order.type = static_cast<OrderType>(type & ~INPUT_QUEUED_BIT);
+    // Anything else is not sent by MatchClient; the rest of the packet
+    // cannot be parsed either.
+    if (order.type != OrderType::NONE && order.type != OrderType::MOVE &&
+        order.type != OrderType::ATTACK) {
+      return;
+    }
+    Unit* target = nullptr;
+    if (order.type == OrderType::MOVE) {
+      for (int32_t axis = 0; axis < 3; ++axis) {
+        const uint32_t bits = reader.read_bits(32);
+        std::memcpy(&order.position[axis], &bits, sizeof(bits));
+      }
+    } else if (order.type == OrderType::ATTACK) {
+      target = registry.get_unit(static_cast<int32_t>(reader.read_varuint()));
+    }
+    if (reader.is_overflowed() || sequence <= client.input_sequence) {
+      continue;
+    }
+
+    client.input_sequence = sequence;
+    client.steps_since_input = 0;
+    if (unit == nullptr) {
+      continue;
+    }
+    // Rejected inputs stay consumed; resending them would not change that.
+    if (order.type == OrderType::MOVE &&
+        !is_valid_move_position(order.position)) {
+      continue;
+    }
+    if (order.type == OrderType::ATTACK) {
+      if (!is_valid_attack_target(unit, target)) {
+        continue;
+      }
+      order.target_id = target->get_instance_id();
+    }
+    if (order.type == OrderType::NONE) {
+      unit->stop_order();
+    } else if (queued) {
+      unit->queue_order(order);
+    } else if (order.type == OrderType::MOVE) {
+      unit->issue_move_order(order.position);
+    } else if (order.type == OrderType::ATTACK) {
+      unit->issue_attack_order(target);
+    }
+  }
+}
+
+void MatchServer::_send_snapshot(Client& client) {
+  const MatchSnapshot* baseline = nullptr;
+  if (client.acked_tick != 0) {
+    for (const MatchSnapshot& sent : client.history) {
+      if (sent.tick == client.acked_tick) {
+        baseline = &sent;
+        break;
+      }
+    }
+  }
+
+  const MatchSnapshot* sent = &current;
+  if (interest_management) {
+    _filter_snapshot(client);
+    sent = &filtered;
+  }
+
+  writer.clear();
+  writer.write_bits(static_cast<uint32_t>(SnapshotMessage::SNAPSHOT), 8);
+  writer.write_bits(sent->tick, 32);
+  writer.write_bits(baseline != nullptr ? baseline->tick : 0, 32);
+  writer.write_bits(client.input_sequence, 32);
+  writer.write_varuint(client.steps_since_input);
+  SnapshotCodec::encode(*sent, baseline, writer);
+
+  const std::vector<uint8_t>& bytes = writer.get_bytes();
+  packet.resize(static_cast<int64_t>(bytes.size()));
+  std::memcpy(packet.ptrw(), bytes.data(), bytes.size());
+  transport->send_packet(SnapshotTransport::SERVER_PEER, client.peer_id,
+                         packet);
+  client.window_bytes += static_cast<int64_t>(bytes.size());
+
+  // Acks older than the ring find no baseline and get a full snapshot.
+  client.history[client.next_history] = *sent;
+  client.next_history = (client.next_history + 1) % SNAPSHOT_HISTORY;
+  client.snapshot_number++;
+}
+
+void MatchServer::_filter_snapshot(const Client& client) {
+  // Units not due keep the state last sent, not the acked baseline: with
+  // acks in flight the client may already be past the baseline. Once acked,
+  // the repeat encodes as "unchanged".
+  const MatchSnapshot& previous =
+      client.history[(client.next_history + SNAPSHOT_HISTORY - 1) %
+                     SNAPSHOT_HISTORY];
+  const int32_t slot_count = static_cast<int32_t>(current.units.size());
+  const int32_t previous_count = static_cast<int32_t>(previous.units.size());
+  filtered.tick = current.tick;
+  filtered.units.resize(slot_count);
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    UnitSnapshot& unit = filtered.units[slot];
+    const InterestManager::Tier tier = interest.get_tier(client.viewer, slot);
+    if (tier == InterestManager::TIER_HIDDEN) {
+      unit = UnitSnapshot();
+    } else if (slot < previous_count && previous.units[slot].present &&
+               !interest.is_due(client.viewer, slot,
+                                client.snapshot_number)) {
+      unit = previous.units[slot];
+    } else {
+      unit = current.units[slot];
+    }
+  }
+}
+
+void MatchServer::_report_bandwidth() {
+  const int32_t ticks_per_second =
+      Engine::get_singleton()->get_physics_ticks_per_second();
+  for (Client& client : clients) {
+    client.bytes_per_second =
+        client.window_bytes * ticks_per_second / window_ticks;
+    client.window_bytes = 0;
+    emit_signal("bandwidth_reported", client.peer_id,
+                client.bytes_per_second);
+  }
+  window_ticks = 0;
+}
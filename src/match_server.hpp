@@ -0,0 +1,135 @@
+#ifndef GDEXTENSION_MATCH_SERVER_H
+#define GDEXTENSION_MATCH_SERVER_H
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "bit_stream.hpp"
+#include "interest_manager.hpp"
+#include "match_snapshot.hpp"
+
+using godot::Dictionary;
+using godot::Node;
+using godot::PackedByteArray;
+
+class MatchManager;
+class SnapshotTransport;
+
+// Authoritative side of a networked match. The match simulates as usual
+// (run the server scene with --headless for a dedicated server) and every
+// snapshot_interval ticks each client receives a snapshot of the units,
+// delta-encoded against the last snapshot it acknowledged. A client that
+// has acknowledged nothing, or fell too far behind, gets a full snapshot.
+//
+// Clients control the unit the server binds to them (set_client_unit) by
+// sending INPUT orders; each snapshot tells the client which input was
+// applied last so it can reconcile its prediction (see MatchClient).
+//
+// Hits by client units are lag compensated: they are judged against where
+// their targets were when the client issued the attack.
+//
+// With interest management on, each client only receives the units its
+// faction can see, and distant ones less often (see InterestManager).
+class MatchServer : public Node {
+  GDCLASS(MatchServer, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  // Sent snapshots kept per client as delta baselines.
+  static constexpr int32_t SNAPSHOT_HISTORY = 32;
+
+  MatchServer();
+  ~MatchServer();
+
+  void _ready() override;
+  void _physics_process(double delta) override;
+
+  void set_transport(SnapshotTransport* new_transport);
+  SnapshotTransport* get_transport() const;
+
+  // Physics ticks between snapshots; 3 is 20 snapshots a second at 60 Hz.
+  void set_snapshot_interval(int32_t ticks);
+  int32_t get_snapshot_interval() const;
+
+  // Lag compensation limit: hits by a client's unit are judged against
+  // unit positions up to this many ticks old, matching what the client saw
+  // (see PositionHistory). 0 turns lag compensation off.
+  void set_max_rewind_ticks(int32_t ticks);
+  int32_t get_max_rewind_ticks() const;
+
+  // Interest management settings; see InterestManager.
+  void set_interest_management(bool enabled);
+  bool get_interest_management() const;
+  void set_vision_radius(float radius);
+  float get_vision_radius() const;
+  void set_near_radius(float radius);
+  float get_near_radius() const;
+  void set_far_radius(float radius);
+  float get_far_radius() const;
+
+  // Clients also join on their own by sending JOIN or their first ACK.
+  void add_client(int32_t peer_id);
+  void remove_client(int32_t peer_id);
+  bool has_client(int32_t peer_id) const;
+  int32_t get_client_count() const;
+  // Unit whose surroundings the client cares about; -1 sees everything.
+  void set_client_focus(int32_t peer_id, int32_t slot);
+  // Unit the client's INPUT orders drive; -1 ignores its orders. Only the
+  // server decides this, never the client's JOIN.
+  void set_client_unit(int32_t peer_id, int32_t slot);
+  int32_t get_client_unit(int32_t peer_id) const;
+
+  // Snapshot bytes sent to the client during the last full second.
+  int64_t get_client_bandwidth(int32_t peer_id) const;
+  // Peer id to bytes per second, for every client.
+  Dictionary get_bandwidth_report() const;
+
+ private:
+  struct Client {
+    int32_t peer_id = 0;
+    uint32_t acked_tick = 0;
+    int32_t viewer = -1;  // InterestManager viewer
+    int32_t unit_slot = -1;  // Driven by the client's inputs
+    uint32_t snapshot_number = 0;
+    uint32_t input_sequence = 0;  // Newest input applied
+    uint32_t steps_since_input = 0;
+    std::vector<MatchSnapshot> history;  // Ring of sent snapshots
+    int32_t next_history = 0;
+    int64_t window_bytes = 0;
+    int64_t bytes_per_second = 0;
+  };
+
+  Client* _find_client(int32_t peer_id);
+  const Client* _find_client(int32_t peer_id) const;
+  void _receive_packets();
+  void _apply_inputs(Client& client, BitReader& reader);
+  void _send_snapshot(Client& client);
+  // Fills filtered with what the client gets this time: hidden units are
+  // left out, units not due this time repeat their previous state.
+  void _filter_snapshot(const Client& client);
+  void _report_bandwidth();
+
+  SnapshotTransport* transport = nullptr;
+  int32_t snapshot_interval = 3;
+  int32_t max_rewind_ticks = 15;  // 250 ms at 60 Hz
+  bool interest_management = true;
+
+  MatchManager* match = nullptr;
+  std::vector<Client> clients;
+  InterestManager interest;
+  int32_t window_ticks = 0;
+
+  // Reused every snapshot.
+  MatchSnapshot current;
+  MatchSnapshot filtered;
+  BitWriter writer;
+  PackedByteArray packet;
+};
+
+#endif  // GDEXTENSION_MATCH_SERVER_H
@@ -0,0 +1,233 @@
+#include "match_snapshot.hpp"
+
+#include <cmath>
+
+#include "state_checksum.hpp"
+#include "unit_registry.hpp"
+
+namespace {
+constexpr float PI = 3.14159265358979f;
+constexpr int32_t DELTA_LIMIT = 1 << (SnapshotCodec::POSITION_DELTA_BITS - 1);
+
+inline int32_t axis_bits(int32_t axis) {
+  return axis == 1 ? SnapshotCodec::HEIGHT_BITS : SnapshotCodec::POSITION_BITS;
+}
+
+inline float axis_extent(int32_t axis) {
+  return axis == 1 ? SnapshotCodec::HEIGHT_EXTENT : SnapshotCodec::WORLD_EXTENT;
+}
+
+inline bool same_position(const UnitSnapshot& a, const UnitSnapshot& b) {
+  return a.position[0] == b.position[0] && a.position[1] == b.position[1] &&
+         a.position[2] == b.position[2];
+}
+}  // namespace
+
+Vector3 UnitSnapshot::get_position() const {
+  Vector3 result;
+  for (int32_t axis = 0; axis < 3; ++axis) {
+    result[axis] = dequantize(position[axis], -axis_extent(axis),
+                              axis_extent(axis), axis_bits(axis));
+  }
+  return result;
+}
+
+float UnitSnapshot::get_yaw() const {
+  return dequantize(yaw, -PI, PI, SnapshotCodec::YAW_BITS);
+}
+
+float UnitSnapshot::get_health_ratio() const {
+  return dequantize(health, 0.0f, 1.0f, SnapshotCodec::HEALTH_BITS);
+}
+
+void SnapshotCodec::capture(const UnitRegistry& registry,
+                            uint32_t tick,
+                            MatchSnapshot& out) {
+  const StateChecksum& state = registry.get_state_checksum();
+  const int32_t slot_count = registry.get_slot_count();
+  out.tick = tick;
+  out.units.resize(slot_count);
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    UnitSnapshot& unit = out.units[slot];
+    unit.present = registry.get_unit(slot) != nullptr;
+    if (!unit.present) {
+      continue;
+    }
+
+    const Vector3& position = registry.get_position(slot);
+    for (int32_t axis = 0; axis < 3; ++axis) {
+      unit.position[axis] = quantize(position[axis], -axis_extent(axis),
+                                     axis_extent(axis), axis_bits(axis));
+    }
+    unit.yaw = quantize(std::remainder(registry.get_yaw(slot), 2.0f * PI),
+                        -PI, PI, YAW_BITS);
+    unit.health =
+        quantize(registry.get_health_ratio(slot), 0.0f, 1.0f, HEALTH_BITS);
+    // The order words are kept current by the units for the checksum.
+    unit.order = state.get_word(slot, StateChecksum::ORDER);
+    unit.target = state.get_word(slot, StateChecksum::ORDER_TARGET);
+  }
+}
+
+void SnapshotCodec::encode(const MatchSnapshot& snapshot,
+                           const MatchSnapshot* baseline,
+                           BitWriter& writer) {
+  const int32_t slot_count = static_cast<int32_t>(snapshot.units.size());
+  writer.write_varuint(static_cast<uint32_t>(slot_count));
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    const UnitSnapshot& unit = snapshot.units[slot];
+    writer.write_bool(unit.present);
+    if (!unit.present) {
+      continue;
+    }
+
+    // The receiver holds the same baseline, so whether a slot is sent as a
+    // delta needs no flag.
+    const bool has_base = baseline != nullptr &&
+                          slot < static_cast<int32_t>(baseline->units.size()) &&
+                          baseline->units[slot].present;
+    if (has_base) {
+      _encode_delta(unit, baseline->units[slot], writer);
+    } else {
+      _encode_full(unit, writer);
+    }
+  }
+}
+
+bool SnapshotCodec::decode(BitReader& reader,
+                           uint32_t tick,
+                           const MatchSnapshot* baseline,
+                           MatchSnapshot& out) {
+  const uint32_t slot_count = reader.read_varuint();
+  if (reader.is_overflowed() || slot_count > (1u << 20)) {
+    return false;
+  }
+
+  out.tick = tick;
+  out.units.resize(slot_count);
+  for (int32_t slot = 0; slot < static_cast<int32_t>(slot_count); ++slot) {
+    UnitSnapshot& unit = out.units[slot];
+    unit = UnitSnapshot();
+    unit.present = reader.read_bool();
+    if (!unit.present) {
+      continue;
+    }
+
+    const bool has_base = baseline != nullptr &&
+                          slot < static_cast<int32_t>(baseline->units.size()) &&
+                          baseline->units[slot].present;
+    if (has_base) {
+      _decode_delta(reader, baseline->units[slot], unit);
+    } else {
+      _decode_full(reader, unit);
+    }
+  }
+  return !reader.is_overflowed();
+}
+
+void SnapshotCodec::_encode_full(const UnitSnapshot& unit, BitWriter& writer) {
+  for (int32_t axis = 0; axis < 3; ++axis) {
+    writer.write_bits(unit.position[axis], axis_bits(axis));
+  }
+  writer.write_bits(unit.yaw, YAW_BITS);
+  writer.write_bits(unit.health, HEALTH_BITS);
+  writer.write_bits(unit.order, ORDER_BITS);
+  writer.write_varuint(unit.target);
+}
+
+void SnapshotCodec::_decode_full(BitReader& reader, UnitSnapshot& unit) {
+  for (int32_t axis = 0; axis < 3; ++axis) {
+    unit.position[axis] = reader.read_bits(axis_bits(axis));
+  }
+  unit.yaw = reader.read_bits(YAW_BITS);
+  unit.health = reader.read_bits(HEALTH_BITS);
+  unit.order = reader.read_bits(ORDER_BITS);
+  unit.target = reader.read_varuint();
+}
+
+void SnapshotCodec::_encode_delta(const UnitSnapshot& unit,
+                                  const UnitSnapshot& base,
+                                  BitWriter& writer) {
+  const bool position_changed = !same_position(unit, base);
+  const bool yaw_changed = unit.yaw != base.yaw;
+  const bool health_changed = unit.health != base.health;
+  const bool order_changed =
+      unit.order != base.order || unit.target != base.target;
+  const bool changed =
+      position_changed || yaw_changed || health_changed || order_changed;
+  writer.write_bool(changed);
+  if (!changed) {
+    return;
+  }
+
+  writer.write_bool(position_changed);
+  if (position_changed) {
+    int32_t deltas[3];
+    bool small = true;
+    for (int32_t axis = 0; axis < 3; ++axis) {
+      deltas[axis] = static_cast<int32_t>(unit.position[axis]) -
+                     static_cast<int32_t>(base.position[axis]);
+      small = small && deltas[axis] >= -DELTA_LIMIT &&
+              deltas[axis] < DELTA_LIMIT;
+    }
+    writer.write_bool(small);
+    for (int32_t axis = 0; axis < 3; ++axis) {
+      if (small) {
+        writer.write_bits(static_cast<uint32_t>(deltas[axis] + DELTA_LIMIT),
+                          POSITION_DELTA_BITS);
+      } else {
+        writer.write_bits(unit.position[axis], axis_bits(axis));
+      }
+    }
+  }
+
+  writer.write_bool(yaw_changed);
+  if (yaw_changed) {
+    writer.write_bits(unit.yaw, YAW_BITS);
+  }
+  writer.write_bool(health_changed);
+  if (health_changed) {
+    writer.write_bits(unit.health, HEALTH_BITS);
+  }
+  writer.write_bool(order_changed);
+  if (order_changed) {
+    writer.write_bits(unit.order, ORDER_BITS);
+    writer.write_varuint(unit.target);
+  }
+}
+
+void SnapshotCodec::_decode_delta(BitReader& reader,
+                                  const UnitSnapshot& base,
+                                  UnitSnapshot& unit) {
+  unit = base;
+  if (!reader.read_bool()) {
+    return;
+  }
+
+  if (reader.read_bool()) {
+    const bool small = reader.read_bool();
+    for (int32_t axis = 0; axis < 3; ++axis) {
+      if (small) {
+        const int32_t delta =
+            static_cast<int32_t>(reader.read_bits(POSITION_DELTA_BITS)) -
+            DELTA_LIMIT;
+        unit.position[axis] =
+            static_cast<uint32_t>(static_cast<int32_t>(base.position[axis]) +
+                                  delta);
+      } else {
+        unit.position[axis] = reader.read_bits(axis_bits(axis));
+      }
+    }
+  }
+
+  if (reader.read_bool()) {
+    unit.yaw = reader.read_bits(YAW_BITS);
+  }
+  if (reader.read_bool()) {
+    unit.health = reader.read_bits(HEALTH_BITS);
+  }
+  if (reader.read_bool()) {
+    unit.order = reader.read_bits(ORDER_BITS);
+    unit.target = reader.read_varuint();
+  }
+}
@@ -0,0 +1,95 @@
+#ifndef GDEXTENSION_MATCH_SNAPSHOT_H
+#define GDEXTENSION_MATCH_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/vector3.hpp>
+
+#include "bit_stream.hpp"
+
+using godot::Vector3;
+
+class UnitRegistry;
+
+// First byte of every packet between MatchServer and MatchClient. SNAPSHOT
+// carries its tick, the tick of its baseline (0 for none), the newest input
+// the server applied for the client and the steps simulated since, then the
+// encoded units. ACK carries the newest snapshot tick the client decoded.
+// JOIN carries the slot + 1 of the client's main unit (0 for a spectator),
+// which drives interest management. INPUT carries the client's
+// unacknowledged orders for that unit.
+enum class SnapshotMessage : uint8_t {
+  SNAPSHOT = 1,
+  ACK = 2,
+  JOIN = 3,
+  INPUT = 4,
+};
+
+// INPUT order type byte; the top bit marks a shift-queued order.
+constexpr uint8_t INPUT_QUEUED_BIT = 0x80;
+
+// Networked state of one unit, already quantized. Comparing two of these
+// tells whether anything visible to a client changed.
+struct UnitSnapshot {
+  bool present = false;
+  uint32_t position[3] = {0, 0, 0};
+  uint32_t yaw = 0;
+  uint32_t health = 0;
+  uint32_t order = 0;
+  uint32_t target = 0;  // Registry slot + 1 of the order target, 0 for none
+
+  Vector3 get_position() const;
+  float get_yaw() const;
+  float get_health_ratio() const;
+};
+
+// Every unit of a match at one tick, indexed by registry slot. Slots match
+// between server and clients as long as both load the same match scene.
+struct MatchSnapshot {
+  uint32_t tick = 0;
+  std::vector<UnitSnapshot> units;
+};
+
+// Quantizes registry state into snapshots and delta-encodes them against a
+// baseline the receiver is known to have. Unchanged units cost two bits,
+// moving units send small position deltas instead of full coordinates.
+class SnapshotCodec {
+ public:
+  // Playable area covered by the quantized positions, centered on the
+  // origin. 16 bits over 512 m is just under 8 mm per step.
+  static constexpr float WORLD_EXTENT = 256.0f;
+  static constexpr float HEIGHT_EXTENT = 32.0f;
+  static constexpr int32_t POSITION_BITS = 16;
+  static constexpr int32_t HEIGHT_BITS = 12;
+  static constexpr int32_t POSITION_DELTA_BITS = 8;
+  static constexpr int32_t YAW_BITS = 10;
+  static constexpr int32_t HEALTH_BITS = 8;
+  static constexpr int32_t ORDER_BITS = 2;
+
+  static void capture(const UnitRegistry& registry,
+                      uint32_t tick,
+                      MatchSnapshot& out);
+
+  // A null baseline, or one that lacks a slot, sends the slot in full.
+  static void encode(const MatchSnapshot& snapshot,
+                     const MatchSnapshot* baseline,
+                     BitWriter& writer);
+  // Returns false on a truncated or malformed stream.
+  static bool decode(BitReader& reader,
+                     uint32_t tick,
+                     const MatchSnapshot* baseline,
+                     MatchSnapshot& out);
+
+ private:
+  static void _encode_full(const UnitSnapshot& unit, BitWriter& writer);
+  static void _decode_full(BitReader& reader, UnitSnapshot& unit);
+  static void _encode_delta(const UnitSnapshot& unit,
+                            const UnitSnapshot& base,
+                            BitWriter& writer);
+  static void _decode_delta(BitReader& reader,
+                            const UnitSnapshot& base,
+                            UnitSnapshot& unit);
+};
+
+#endif  // GDEXTENSION_MATCH_SNAPSHOT_H
@@ -0,0 +1,95 @@
+#include "match_tick_probe.hpp"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+#include <climits>
+
+#include "match_manager.hpp"
+
+using godot::Engine;
+using godot::Time;
+
+MatchTickProbe::MatchTickProbe() = default;
+
+MatchTickProbe::~MatchTickProbe() = default;
+
+void MatchTickProbe::_bind_methods() {}
+
+void MatchTickProbe::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+  set_physics_process_priority(role == ROLE_START ? INT_MIN : INT_MAX);
+}
+
+void MatchTickProbe::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  const uint64_t now = Time::get_singleton()->get_ticks_usec();
+  if (role == ROLE_START) {
+    started_usec = now;
+    return;
+  }
+  if (start_probe == nullptr) {
+    return;
+  }
+
+  const int64_t elapsed = static_cast<int64_t>(now - start_probe->started_usec);
+  window_ticks.fetch_add(1, std::memory_order_relaxed);
+  window_total_usec.fetch_add(elapsed, std::memory_order_relaxed);
+  if (elapsed > window_max_usec.load(std::memory_order_relaxed)) {
+    window_max_usec.store(elapsed, std::memory_order_relaxed);
+  }
+
+  if (match == nullptr) {
+    return;
+  }
+  const int64_t tick = match->get_tick();
+  match_tick.store(tick, std::memory_order_relaxed);
+  window_checksum_usec.fetch_add(match->get_last_checksum_usec(),
+                                 std::memory_order_relaxed);
+  if (tick % MEMORY_SAMPLE_TICKS == 0) {
+    memory_usage.store(match->get_memory_usage(), std::memory_order_relaxed);
+    unit_count.store(match->get_unit_registry().get_unit_count(),
+                     std::memory_order_relaxed);
+  }
+}
+
+void MatchTickProbe::setup(Role new_role, MatchTickProbe* start) {
+  role = new_role;
+  start_probe = start;
+}
+
+MatchTickProbe::Window MatchTickProbe::take_window() {
+  // A tick finishing in between lands in either window; the counts can be
+  // off by one, which a report does not care about.
+  Window window;
+  window.ticks = window_ticks.exchange(0, std::memory_order_relaxed);
+  window.total_usec = window_total_usec.exchange(0, std::memory_order_relaxed);
+  window.max_usec = window_max_usec.exchange(0, std::memory_order_relaxed);
+  window.checksum_usec =
+      window_checksum_usec.exchange(0, std::memory_order_relaxed);
+  return window;
+}
+
+int64_t MatchTickProbe::get_memory_usage() const {
+  return memory_usage.load(std::memory_order_relaxed);
+}
+
+int64_t MatchTickProbe::get_unit_count() const {
+  return unit_count.load(std::memory_order_relaxed);
+}
+
+int64_t MatchTickProbe::get_match_tick() const {
+  return match_tick.load(std::memory_order_relaxed);
+}
+
+MatchManager* MatchTickProbe::get_match() const {
+  return match;
+}
@@ -0,0 +1,71 @@
+#ifndef GDEXTENSION_MATCH_TICK_PROBE_H
+#define GDEXTENSION_MATCH_TICK_PROBE_H
+
+#include <godot_cpp/classes/node.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+using godot::Node;
+
+class MatchManager;
+
+// Pair of nodes MatchHost adds to every hosted match to time its physics
+// tick. The START probe runs before every other node of the match and the
+// END probe after all of them, on whichever thread processes the match.
+// Statistics are atomics so the host can read them from the main thread.
+class MatchTickProbe : public Node {
+  GDCLASS(MatchTickProbe, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  enum Role {
+    ROLE_START,
+    ROLE_END,
+  };
+
+  // Ticks between samples of the match memory usage.
+  static constexpr int32_t MEMORY_SAMPLE_TICKS = 60;
+
+  struct Window {
+    int64_t ticks = 0;
+    int64_t total_usec = 0;
+    int64_t max_usec = 0;
+    int64_t checksum_usec = 0;  // Part of total_usec spent hashing state
+  };
+
+  MatchTickProbe();
+  ~MatchTickProbe();
+
+  void _ready() override;
+  void _physics_process(double delta) override;
+
+  // start is the START probe of the same match; only used by END probes.
+  void setup(Role new_role, MatchTickProbe* start);
+
+  // Returns the ticks timed since the last call and starts a new window.
+  Window take_window();
+  int64_t get_memory_usage() const;
+  int64_t get_unit_count() const;
+  int64_t get_match_tick() const;
+  // The match this probe times, once it is ready.
+  MatchManager* get_match() const;
+
+ private:
+  Role role = ROLE_START;
+  MatchTickProbe* start_probe = nullptr;
+  MatchManager* match = nullptr;
+
+  uint64_t started_usec = 0;  // START probe
+  std::atomic<int64_t> window_ticks{0};
+  std::atomic<int64_t> window_total_usec{0};
+  std::atomic<int64_t> window_max_usec{0};
+  std::atomic<int64_t> window_checksum_usec{0};
+  std::atomic<int64_t> memory_usage{0};
+  std::atomic<int64_t> unit_count{0};
+  std::atomic<int64_t> match_tick{0};
+};
+
+#endif  // GDEXTENSION_MATCH_TICK_PROBE_H
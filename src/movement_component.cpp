@@ -14,17 +14,20 @@
 #include "health_component.hpp"
 #include "unit.hpp"
 
-using godot::Basis;
 using godot::Callable;
 using godot::ClassDB;
 using godot::D_METHOD;
 using godot::Node;
 using godot::PropertyInfo;
 using godot::StringName;
-using godot::Transform3D;
 using godot::Variant;
 using godot::Vector3;
 
+namespace {
+// About a millimeter; below it a unit counts as on its path corner.
+constexpr Fixed FIXED_STEER_EPSILON = Fixed::from_raw(64);
+}  // namespace
+
 MovementComponent::MovementComponent() = default;
 
 MovementComponent::~MovementComponent() = default;
@@ -81,20 +84,19 @@ float MovementComponent::get_rotation_speed() const {
   return rotation_speed;
 }
 
-Vector3 MovementComponent::process_movement(double delta,
-                                            const Vector3& target_location,
-                                            OrderType order) {
+bool MovementComponent::_update_navigation(const Vector3& target_location,
+                                           OrderType order) {
   // Safety checks
   Unit* owner = get_owner_unit();
   if (owner == nullptr || !owner->is_inside_tree()) {
-    return Vector3(0, 0, 0);
+    return false;
   }
 
   // If owner unit is dead, don't move
   // Check if owner is valid and check its health status
   HealthComponent* health_comp = owner->get_health_component();
   if (health_comp != nullptr && health_comp->is_dead()) {
-    return Vector3(0, 0, 0);
+    return false;
   }
 
   // Ensure this component (which IS the NavigationAgent3D) is in tree before
@@ -102,19 +104,19 @@ Vector3 MovementComponent::process_movement(double delta,
   // Also check if we've been queued for deletion
   if (!is_inside_tree()) {
     frame_count = 0;
-    return Vector3(0, 0, 0);
+    return false;
   }
 
   // Don't process if we're queued for deletion
   if (is_queued_for_deletion()) {
-    return Vector3(0, 0, 0);
+    return false;
   }
 
   // Wait several frames after entering tree before using navigation
   if (!is_ready) {
     frame_count++;
     if (frame_count < 3) {
-      return Vector3(0, 0, 0);
+      return false;
     }
     is_ready = true;
     _apply_navigation_target_distance(order);
@@ -128,9 +130,18 @@ Vector3 MovementComponent::process_movement(double delta,
   if (!current_target.is_equal_approx(target_location)) {
     set_target_position(target_location);
   }
+  return true;
+}
+
+Vector3 MovementComponent::process_movement(double delta,
+                                            const Vector3& target_location,
+                                            OrderType order) {
+  if (!_update_navigation(target_location, order)) {
+    return Vector3(0, 0, 0);
+  }
 
   // Get next path position and calculate velocity
-  Vector3 current_position = owner->get_global_position();
+  Vector3 current_position = get_owner_unit()->get_global_position();
   Vector3 next_position = get_next_path_position();
   Vector3 displacement = next_position - current_position;
   float distance = displacement.length();
@@ -161,6 +172,44 @@ Vector3 MovementComponent::process_movement(double delta,
   return velocity;
 }
 
+FixedVector3 MovementComponent::process_fixed_movement(
+    const FixedVector3& position,
+    const Vector3& target_location,
+    OrderType order) {
+  if (!_update_navigation(target_location, order)) {
+    return FixedVector3();
+  }
+
+  // The path corner is the only float that reaches the simulation. Every
+  // peer quantizes it the same way, and from there on it is integer math.
+  FixedVector3 displacement =
+      FixedVector3::from_vector3(get_next_path_position()) - position;
+  displacement.y = Fixed();
+  const Fixed distance = displacement.horizontal_length();
+  if (distance <= FIXED_STEER_EPSILON) {
+    // Facing is presentation only; the checksum does not include it.
+    FixedVector3 to_target =
+        FixedVector3::from_vector3(target_location) - position;
+    to_target.y = Fixed();
+    if (to_target.horizontal_length() > FIXED_STEER_EPSILON) {
+      _face_horizontal_direction(to_target.to_vector3());
+    }
+    return FixedVector3();
+  }
+
+  _face_horizontal_direction(displacement.to_vector3());
+  return displacement * (Fixed::from_float(speed) / distance);
+}
+
+bool MovementComponent::is_at_fixed_destination(
+    const FixedVector3& position,
+    const Vector3& target_location) const {
+  FixedVector3 offset = FixedVector3::from_vector3(target_location) - position;
+  offset.y = Fixed();
+  return offset.horizontal_length() <=
+         Fixed::from_float(get_target_desired_distance());
+}
+
 void MovementComponent::_face_horizontal_direction(const Vector3& direction) {
   Unit* owner = get_owner_unit();
   if (owner == nullptr || !owner->is_inside_tree()) {
@@ -176,17 +225,7 @@ void MovementComponent::_face_horizontal_direction(const Vector3& direction) {
   float target_angle =
       std::atan2(-horizontal_direction.x, -horizontal_direction.z);
 
-  float cos_a = std::cos(target_angle);
-  float sin_a = std::sin(target_angle);
-  Vector3 new_forward = Vector3(-sin_a, 0, -cos_a);
-  Vector3 new_right = Vector3(cos_a, 0, -sin_a);
-  Vector3 new_up = Vector3(0, 1, 0);
-
-  Basis new_basis = Basis();
-  new_basis.set_column(0, new_right);
-  new_basis.set_column(1, new_up);
-  new_basis.set_column(2, -new_forward);
-  owner->set_transform(Transform3D(new_basis, owner->get_transform().origin));
+  owner->set_facing_yaw(target_angle);
 }
 
 void MovementComponent::_apply_navigation_target_distance(OrderType order) {
@@ -222,6 +261,14 @@ bool MovementComponent::is_at_destination() const {
   return const_cast<MovementComponent*>(this)->is_navigation_finished();
 }
 
+bool MovementComponent::is_navigation_ready() const {
+  return is_ready;
+}
+
+void MovementComponent::set_navigation_ready() {
+  is_ready = true;
+}
+
 Unit* MovementComponent::get_owner_unit() const {
   // Check if we're still in the tree - if not, parent might be invalid
   if (!is_inside_tree()) {
@@ -236,9 +283,16 @@ Unit* MovementComponent::get_owner_unit() const {
 }
 
 void MovementComponent::_on_owner_unit_died(godot::Object* source) {
-  // When the owner unit dies, queue this movement component for deletion
-  // Dead units should not have a movement component
-  if (is_inside_tree()) {
-    queue_free();
+  // Dead units stop navigating; the component stays so a pooled unit can
+  // move again once it is reused.
+  set_process_mode(PROCESS_MODE_DISABLED);
+  set_velocity(Vector3(0, 0, 0));
+}
+
+void MovementComponent::reset_state() {
+  set_process_mode(PROCESS_MODE_INHERIT);
+  Unit* owner = get_owner_unit();
+  if (owner != nullptr && owner->is_inside_tree()) {
+    set_target_position(owner->get_global_position());
   }
 }
@@ -5,6 +5,7 @@
 #include <godot_cpp/variant/packed_string_array.hpp>
 #include <godot_cpp/variant/vector3.hpp>
 
+#include "fixed_point.hpp"
 #include "unit_order.hpp"
 
 using godot::NavigationAgent3D;
@@ -26,6 +27,9 @@ class MovementComponent : public NavigationAgent3D {
   int32_t frame_count = 0;
 
   // Private helper methods
+  // Readiness checks and navigation target update shared by both movement
+  // paths; false when the unit should not move this tick.
+  bool _update_navigation(const Vector3& target_location, OrderType order);
   void _face_horizontal_direction(const Vector3& direction);
   void _apply_navigation_target_distance(OrderType order);
   void _on_owner_unit_died(godot::Object* source);
@@ -48,12 +52,31 @@ class MovementComponent : public NavigationAgent3D {
   Vector3 process_movement(double delta,
                            const Vector3& target_location,
                            OrderType order);
+  // Deterministic mode counterpart: steers from the fixed position in fixed
+  // point and returns the horizontal velocity. NavigationAgent3D has no
+  // fixed-point pathfinder, so the next path corner is the one float input;
+  // it is quantized before use.
+  FixedVector3 process_fixed_movement(const FixedVector3& position,
+                                      const Vector3& target_location,
+                                      OrderType order);
 
   // Utility
   bool is_at_destination() const;
+  // Arrival test of the deterministic mode, on fixed positions.
+  bool is_at_fixed_destination(const FixedVector3& position,
+                               const Vector3& target_location) const;
+  // False during the first frames after entering the tree, while the
+  // navigation map is not usable yet.
+  bool is_navigation_ready() const;
+  // Skips the warm-up. For spawners that check once for a whole batch that
+  // the navigation map has synced.
+  void set_navigation_ready();
 
   // Get owner Unit for context (replaces get_component_by_class logic)
   Unit* get_owner_unit() const;
+
+  // Re-enables navigation after death, for pooled units being reused.
+  void reset_state();
 };
 
 #endif  // GDEXTENSION_MOVEMENT_COMPONENT_H
@@ -0,0 +1,134 @@
+#include "occluder_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void OccluderGrid::reset(int32_t new_width, int32_t new_depth) {
+  width = std::max(new_width, 0);
+  depth = std::max(new_depth, 0);
+  heights.clear();
+  heights.shrink_to_fit();
+}
+
+void OccluderGrid::fill(float height) {
+  heights.assign(static_cast<size_t>(width) * depth, height);
+}
+
+int32_t OccluderGrid::get_width() const {
+  return width;
+}
+
+int32_t OccluderGrid::get_depth() const {
+  return depth;
+}
+
+void OccluderGrid::set_height(int32_t cell, float height) {
+  heights[cell] = height;
+}
+
+void OccluderGrid::add_surface_triangle(const Vector3& a,
+                                        const Vector3& b,
+                                        const Vector3& c) {
+  const float area = (b.x - a.x) * (c.z - a.z) - (c.x - a.x) * (b.z - a.z);
+  if (area == 0.0f) {
+    return;
+  }
+  const float inverse_area = 1.0f / area;
+
+  // Cell x covers [x, x + 1), so its center is at x + 0.5.
+  const int32_t first_x = std::max(
+      static_cast<int32_t>(std::ceil(std::min({a.x, b.x, c.x}) - 0.5f)), 0);
+  const int32_t last_x = std::min(
+      static_cast<int32_t>(std::floor(std::max({a.x, b.x, c.x}) - 0.5f)),
+      width - 1);
+  const int32_t first_z = std::max(
+      static_cast<int32_t>(std::ceil(std::min({a.z, b.z, c.z}) - 0.5f)), 0);
+  const int32_t last_z = std::min(
+      static_cast<int32_t>(std::floor(std::max({a.z, b.z, c.z}) - 0.5f)),
+      depth - 1);
+
+  for (int32_t z = first_z; z <= last_z; ++z) {
+    const float pz = z + 0.5f;
+    for (int32_t x = first_x; x <= last_x; ++x) {
+      const float px = x + 0.5f;
+      // Barycentric weights; all three share the sign of area inside.
+      const float wa =
+          ((b.x - px) * (c.z - pz) - (c.x - px) * (b.z - pz)) * inverse_area;
+      const float wb =
+          ((c.x - px) * (a.z - pz) - (a.x - px) * (c.z - pz)) * inverse_area;
+      const float wc = 1.0f - wa - wb;
+      if (wa < 0.0f || wb < 0.0f || wc < 0.0f) {
+        continue;
+      }
+      const float height = wa * a.y + wb * b.y + wc * c.y;
+      float& cell = heights[static_cast<size_t>(z) * width + x];
+      cell = cell == WALL ? height : std::max(cell, height);
+    }
+  }
+}
+
+void OccluderGrid::close_surface_gaps(int32_t reach) {
+  if (reach <= 0 || heights.empty()) {
+    return;
+  }
+
+  const std::vector<float> baked = heights;
+  for (int32_t z = 0; z < depth; ++z) {
+    for (int32_t x = 0; x < width; ++x) {
+      const size_t cell = static_cast<size_t>(z) * width + x;
+      if (baked[cell] != WALL) {
+        continue;
+      }
+      float highest = WALL;
+      const int32_t last_z = std::min(z + reach, depth - 1);
+      const int32_t last_x = std::min(x + reach, width - 1);
+      for (int32_t nz = std::max(z - reach, 0); nz <= last_z; ++nz) {
+        for (int32_t nx = std::max(x - reach, 0); nx <= last_x; ++nx) {
+          const float height = baked[static_cast<size_t>(nz) * width + nx];
+          if (height != WALL) {
+            highest = highest == WALL ? height : std::max(highest, height);
+          }
+        }
+      }
+      heights[cell] = highest;
+    }
+  }
+}
+
+void OccluderGrid::set_step_height(float height) {
+  step_height = height;
+}
+
+float OccluderGrid::get_step_height() const {
+  return step_height;
+}
+
+void OccluderGrid::fill_opacity(int32_t first_x,
+                                int32_t first_z,
+                                int32_t size,
+                                float viewer_height,
+                                uint8_t* out) const {
+  const float limit = viewer_height + step_height;
+  const int32_t begin = std::clamp(-first_x, 0, size);
+  const int32_t end = std::clamp(width - first_x, begin, size);
+  for (int32_t row = 0; row < size; ++row) {
+    uint8_t* line = out + static_cast<size_t>(row) * size;
+    const int32_t z = first_z + row;
+    if (z < 0 || z >= depth) {
+      std::memset(line, 1, size);
+      continue;
+    }
+    std::memset(line, 1, begin);
+    std::memset(line + end, 1, size - end);
+    // Branch-free compare over a contiguous row; the compiler vectorizes it.
+    const float* row_heights = heights.data() + static_cast<size_t>(z) * width;
+    for (int32_t index = begin; index < end; ++index) {
+      line[index] = row_heights[first_x + index] > limit ? 1 : 0;
+    }
+  }
+}
+
+size_t OccluderGrid::get_memory_usage() const {
+  return heights.capacity() * sizeof(float);
+}
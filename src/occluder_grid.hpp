@@ -0,0 +1,68 @@
+#ifndef GDEXTENSION_OCCLUDER_GRID_H
+#define GDEXTENSION_OCCLUDER_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/vector3.hpp>
+
+using godot::Vector3;
+
+// Ground height of every fog of war cell, baked once when the match loads
+// (see FogOfWar). A cell blocks the sight of a viewer standing more than
+// step_height below it, so ramps and small steps do not, but cliffs and
+// walls do.
+//
+// An unbaked grid blocks nothing.
+class OccluderGrid {
+ public:
+  // Blocks sight from any height: where the navigation mesh does not go.
+  static constexpr float WALL = 1.0e9f;
+  // Never blocks: where collision baking found no ground.
+  static constexpr float OPEN = -1.0e9f;
+
+  // Drops the baked heights and takes the new grid size in cells.
+  void reset(int32_t width, int32_t depth);
+  bool is_baked() const { return !heights.empty(); }
+  // Starts a bake with every cell at height.
+  void fill(float height);
+
+  int32_t get_width() const;
+  int32_t get_depth() const;
+  void set_height(int32_t cell, float height);
+  float get_height(int32_t cell) const { return heights[cell]; }
+
+  // Sets every cell whose center lies under the triangle to the surface
+  // height there, keeping the highest surface of overlapping triangles.
+  // x and z are in cells from the grid origin, y is world height.
+  void add_surface_triangle(const Vector3& a,
+                            const Vector3& b,
+                            const Vector3& c);
+  // Gives WALL cells within reach cells of a surface the highest height
+  // around them. Closes the gap a navigation mesh leaves along cliff edges
+  // (its agent radius), so cliffs block upward but not downward sight.
+  void close_surface_gaps(int32_t reach);
+
+  void set_step_height(float height);
+  float get_step_height() const;
+
+  // Writes 1 for every cell of the size x size window at first_x, first_z
+  // that blocks a viewer on a cell of the given height, row by row. Cells
+  // outside the grid block.
+  void fill_opacity(int32_t first_x,
+                    int32_t first_z,
+                    int32_t size,
+                    float viewer_height,
+                    uint8_t* out) const;
+
+  size_t get_memory_usage() const;
+
+ private:
+  int32_t width = 0;
+  int32_t depth = 0;
+  float step_height = 1.0f;
+  std::vector<float> heights;  // z * width + x, empty until baked
+};
+
+#endif  // GDEXTENSION_OCCLUDER_GRID_H
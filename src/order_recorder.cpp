@@ -0,0 +1,446 @@
+#include "order_recorder.hpp"
+
+#include <algorithm>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/object.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "fixed_point.hpp"
+#include "interactable.hpp"
+#include "match_manager.hpp"
+#include "unit.hpp"
+#include "unit_registry.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::MethodInfo;
+using godot::PropertyInfo;
+using godot::Time;
+using godot::UtilityFunctions;
+using godot::Variant;
+
+namespace {
+constexpr uint32_t FILE_MAGIC = 0x4F475052;  // "RPGO"
+constexpr uint16_t FILE_VERSION = 1;
+
+// Record type byte: low bits hold the OrderType, the top bit marks a queued
+// order. END closes the file and carries the last tick of the recording.
+constexpr uint8_t RECORD_QUEUED_BIT = 0x80;
+constexpr uint8_t RECORD_END = 0x7F;
+
+}  // namespace
+
+OrderRecorder::OrderRecorder() = default;
+
+OrderRecorder::~OrderRecorder() = default;
+
+void OrderRecorder::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_mode", "mode"), &OrderRecorder::set_mode);
+  ClassDB::bind_method(D_METHOD("get_mode"), &OrderRecorder::get_mode);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "mode", godot::PROPERTY_HINT_ENUM,
+                            "Off,Record,Replay"),
+               "set_mode", "get_mode");
+
+  ClassDB::bind_method(D_METHOD("set_file_path", "path"),
+                       &OrderRecorder::set_file_path);
+  ClassDB::bind_method(D_METHOD("get_file_path"),
+                       &OrderRecorder::get_file_path);
+  ADD_PROPERTY(PropertyInfo(Variant::STRING, "file_path",
+                            godot::PROPERTY_HINT_SAVE_FILE, "*.replay"),
+               "set_file_path", "get_file_path");
+
+  ClassDB::bind_method(D_METHOD("set_seed", "seed"), &OrderRecorder::set_seed);
+  ClassDB::bind_method(D_METHOD("get_seed"), &OrderRecorder::get_seed);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "seed"), "set_seed", "get_seed");
+
+  ClassDB::bind_method(D_METHOD("set_quit_when_replay_ends", "quit"),
+                       &OrderRecorder::set_quit_when_replay_ends);
+  ClassDB::bind_method(D_METHOD("get_quit_when_replay_ends"),
+                       &OrderRecorder::get_quit_when_replay_ends);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "quit_when_replay_ends"),
+               "set_quit_when_replay_ends", "get_quit_when_replay_ends");
+
+  ClassDB::bind_method(D_METHOD("start_recording"),
+                       &OrderRecorder::start_recording);
+  ClassDB::bind_method(D_METHOD("stop_recording"),
+                       &OrderRecorder::stop_recording);
+  ClassDB::bind_method(D_METHOD("start_replay"), &OrderRecorder::start_replay);
+  ClassDB::bind_method(D_METHOD("is_recording"), &OrderRecorder::is_recording);
+  ClassDB::bind_method(D_METHOD("is_replaying"), &OrderRecorder::is_replaying);
+  ClassDB::bind_method(D_METHOD("get_tick"), &OrderRecorder::get_tick);
+  ClassDB::bind_method(D_METHOD("get_recorded_order_count"),
+                       &OrderRecorder::get_recorded_order_count);
+
+  ADD_SIGNAL(MethodInfo("replay_finished", PropertyInfo(Variant::INT, "ticks"),
+                        PropertyInfo(Variant::INT, "elapsed_msec")));
+}
+
+void OrderRecorder::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+  if (match == nullptr) {
+    UtilityFunctions::push_warning(
+        "[OrderRecorder] Not part of a match, nothing to record.");
+    return;
+  }
+
+  // Replayed orders must be in place before any unit simulates the tick.
+  set_physics_process_priority(-1000);
+
+  if (mode == MODE_RECORD) {
+    start_recording();
+  } else if (mode == MODE_REPLAY) {
+    start_replay();
+  }
+}
+
+void OrderRecorder::_exit_tree() {
+  if (recording) {
+    stop_recording();
+  }
+  replaying = false;
+}
+
+void OrderRecorder::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  tick++;
+  if (!replaying) {
+    return;
+  }
+
+  while (replay_cursor < replay_orders.size() &&
+         replay_orders[replay_cursor].tick <= tick) {
+    _apply(replay_orders[replay_cursor]);
+    replay_cursor++;
+  }
+  if (replay_cursor >= replay_orders.size() && tick >= replay_end_tick) {
+    _finish_replay();
+  }
+}
+
+void OrderRecorder::set_mode(int32_t new_mode) {
+  mode = std::clamp(new_mode, static_cast<int32_t>(MODE_OFF),
+                    static_cast<int32_t>(MODE_REPLAY));
+}
+
+int32_t OrderRecorder::get_mode() const {
+  return mode;
+}
+
+void OrderRecorder::set_file_path(const String& path) {
+  file_path = path;
+}
+
+String OrderRecorder::get_file_path() const {
+  return file_path;
+}
+
+void OrderRecorder::set_seed(int64_t new_seed) {
+  seed = new_seed;
+}
+
+int64_t OrderRecorder::get_seed() const {
+  return seed;
+}
+
+void OrderRecorder::set_quit_when_replay_ends(bool quit) {
+  quit_when_replay_ends = quit;
+}
+
+bool OrderRecorder::get_quit_when_replay_ends() const {
+  return quit_when_replay_ends;
+}
+
+bool OrderRecorder::start_recording() {
+  if (recording || replaying || match == nullptr) {
+    return false;
+  }
+
+  file = FileAccess::open(file_path, FileAccess::WRITE);
+  if (file.is_null()) {
+    UtilityFunctions::push_error("[OrderRecorder] Cannot write " + file_path);
+    return false;
+  }
+
+  if (seed == 0) {
+    seed = static_cast<int64_t>(
+        (static_cast<uint64_t>(UtilityFunctions::randi()) << 32) |
+        static_cast<uint64_t>(UtilityFunctions::randi()));
+  }
+
+  file->store_32(FILE_MAGIC);
+  file->store_16(FILE_VERSION);
+  file->store_64(static_cast<uint64_t>(seed));
+  file->store_32(static_cast<uint32_t>(
+      Engine::get_singleton()->get_physics_ticks_per_second()));
+
+  recording = true;
+  order_count = 0;
+  return true;
+}
+
+void OrderRecorder::stop_recording() {
+  if (!recording) {
+    return;
+  }
+
+  file->store_32(tick);
+  file->store_8(RECORD_END);
+  file->close();
+  file.unref();
+  recording = false;
+
+  UtilityFunctions::print("[OrderRecorder] Recorded " +
+                          String::num_int64(order_count) + " orders over " +
+                          String::num_int64(tick) + " ticks to " + file_path);
+}
+
+bool OrderRecorder::start_replay() {
+  if (recording || replaying || match == nullptr) {
+    return false;
+  }
+
+  file = FileAccess::open(file_path, FileAccess::READ);
+  if (file.is_null()) {
+    UtilityFunctions::push_error("[OrderRecorder] Cannot read " + file_path);
+    return false;
+  }
+
+  if (file->get_32() != FILE_MAGIC || file->get_16() != FILE_VERSION) {
+    UtilityFunctions::push_error("[OrderRecorder] " + file_path +
+                                 " is not an order recording");
+    file.unref();
+    return false;
+  }
+  seed = static_cast<int64_t>(file->get_64());
+  const int32_t ticks_per_second = static_cast<int32_t>(file->get_32());
+  if (ticks_per_second !=
+      Engine::get_singleton()->get_physics_ticks_per_second()) {
+    UtilityFunctions::push_warning(
+        "[OrderRecorder] Recording used a different physics tick rate.");
+  }
+  // The recorder never touches time_scale; scaling it scales the physics
+  // delta, so the replay would no longer match the recording.
+  if (Engine::get_singleton()->get_time_scale() != 1.0) {
+    UtilityFunctions::push_warning(
+        "[OrderRecorder] Engine.time_scale is not 1; the replay will "
+        "diverge. Use --fixed-fps to replay faster.");
+  }
+
+  replay_orders.clear();
+  replay_end_tick = 0;
+  RecordedOrder record;
+  while (_read_order(record)) {
+    replay_orders.push_back(record);
+  }
+  file.unref();
+  replay_cursor = 0;
+
+  replay_start_usec = Time::get_singleton()->get_ticks_usec();
+  replaying = true;
+  return true;
+}
+
+bool OrderRecorder::is_recording() const {
+  return recording;
+}
+
+bool OrderRecorder::is_replaying() const {
+  return replaying;
+}
+
+int64_t OrderRecorder::get_tick() const {
+  return tick;
+}
+
+int64_t OrderRecorder::get_recorded_order_count() const {
+  return order_count;
+}
+
+bool OrderRecorder::on_order_issued(int32_t unit_slot,
+                                    const UnitOrder& order,
+                                    bool queued) {
+  if (replaying) {
+    return applying;
+  }
+  if (!recording || unit_slot < 0) {
+    return true;
+  }
+
+  RecordedOrder record;
+  // Orders given between physics ticks (mouse input) take effect on the next
+  // one, orders given during a tick belong to it.
+  record.tick =
+      Engine::get_singleton()->is_in_physics_frame() ? tick : tick + 1;
+  record.unit_slot = unit_slot;
+  record.order = order;
+  record.queued = queued;
+
+  godot::Object* target = godot::ObjectDB::get_instance(order.target_id);
+  if (order.type == OrderType::ATTACK) {
+    auto target_unit = Object::cast_to<Unit>(target);
+    if (target_unit == nullptr) {
+      return true;
+    }
+    record.target_slot = target_unit->get_registry_slot();
+  } else if (order.type == OrderType::INTERACT) {
+    auto target_node = Object::cast_to<Node>(target);
+    Node* root = _get_match_root();
+    if (target_node == nullptr || root == nullptr) {
+      return true;
+    }
+    record.target_path = root->get_path_to(target_node);
+  }
+
+  _write_order(record);
+  order_count++;
+  return true;
+}
+
+uint64_t OrderRecorder::get_unit_seed(int32_t unit_slot) const {
+  return DeterministicRandom::stream_seed(static_cast<uint64_t>(seed),
+                                         unit_slot);
+}
+
+void OrderRecorder::_write_order(const RecordedOrder& record) {
+  uint8_t type = static_cast<uint8_t>(record.order.type);
+  if (record.queued) {
+    type |= RECORD_QUEUED_BIT;
+  }
+
+  file->store_32(record.tick);
+  file->store_8(type);
+  file->store_32(static_cast<uint32_t>(record.unit_slot));
+  switch (record.order.type) {
+    case OrderType::MOVE:
+      file->store_float(record.order.position.x);
+      file->store_float(record.order.position.y);
+      file->store_float(record.order.position.z);
+      break;
+    case OrderType::ATTACK:
+      file->store_32(static_cast<uint32_t>(record.target_slot));
+      break;
+    case OrderType::INTERACT:
+      file->store_pascal_string(String(record.target_path));
+      break;
+    case OrderType::NONE:
+    default:
+      break;
+  }
+}
+
+bool OrderRecorder::_read_order(RecordedOrder& record) {
+  record = RecordedOrder();
+  record.tick = file->get_32();
+  const uint8_t type = file->get_8();
+  if (file->eof_reached()) {
+    return false;
+  }
+  if (type == RECORD_END) {
+    replay_end_tick = record.tick;
+    return false;
+  }
+
+  record.queued = (type & RECORD_QUEUED_BIT) != 0;
+  record.order.type = static_cast<OrderType>(type & ~RECORD_QUEUED_BIT);
+  record.unit_slot = static_cast<int32_t>(file->get_32());
+  switch (record.order.type) {
+    case OrderType::MOVE:
+      record.order.position.x = file->get_float();
+      record.order.position.y = file->get_float();
+      record.order.position.z = file->get_float();
+      break;
+    case OrderType::ATTACK:
+      record.target_slot = static_cast<int32_t>(file->get_32());
+      break;
+    case OrderType::INTERACT:
+      record.target_path = NodePath(file->get_pascal_string());
+      break;
+    case OrderType::NONE:
+    default:
+      break;
+  }
+  return !file->eof_reached();
+}
+
+void OrderRecorder::_apply(const RecordedOrder& record) {
+  UnitRegistry& registry = match->get_unit_registry();
+  Unit* unit = registry.get_unit(record.unit_slot);
+  if (unit == nullptr) {
+    return;
+  }
+
+  applying = true;
+  switch (record.order.type) {
+    case OrderType::MOVE:
+      if (record.queued) {
+        unit->queue_move_order(record.order.position);
+      } else {
+        unit->issue_move_order(record.order.position);
+      }
+      break;
+    case OrderType::ATTACK: {
+      Unit* target = registry.get_unit(record.target_slot);
+      if (target == nullptr) {
+        break;
+      }
+      if (record.queued) {
+        unit->queue_attack_order(target);
+      } else {
+        unit->issue_attack_order(target);
+      }
+      break;
+    }
+    case OrderType::INTERACT: {
+      Node* root = _get_match_root();
+      auto target = root != nullptr ? Object::cast_to<Interactable>(
+                                          root->get_node_or_null(
+                                              record.target_path))
+                                    : nullptr;
+      if (target == nullptr) {
+        break;
+      }
+      if (record.queued) {
+        unit->queue_interact_order(target);
+      } else {
+        unit->issue_interact_order(target);
+      }
+      break;
+    }
+    case OrderType::NONE:
+    default:
+      unit->stop_order();
+      break;
+  }
+  applying = false;
+}
+
+void OrderRecorder::_finish_replay() {
+  replaying = false;
+
+  const int64_t elapsed_msec = static_cast<int64_t>(
+      (Time::get_singleton()->get_ticks_usec() - replay_start_usec) / 1000);
+  UtilityFunctions::print("[OrderRecorder] Replayed " +
+                          String::num_int64(tick) + " ticks in " +
+                          String::num_int64(elapsed_msec) + " ms");
+  emit_signal("replay_finished", static_cast<int64_t>(tick), elapsed_msec);
+
+  if (quit_when_replay_ends) {
+    get_tree()->quit();
+  }
+}
+
+Node* OrderRecorder::_get_match_root() const {
+  return match != nullptr ? match->get_parent() : nullptr;
+}
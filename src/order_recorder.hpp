@@ -0,0 +1,118 @@
+#ifndef GDEXTENSION_ORDER_RECORDER_H
+#define GDEXTENSION_ORDER_RECORDER_H
+
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/node_path.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "unit_order.hpp"
+
+using godot::FileAccess;
+using godot::Node;
+using godot::NodePath;
+using godot::Ref;
+using godot::String;
+
+class MatchManager;
+
+// Records every order issued to the units of a match, tick by tick, into a
+// compact binary file and plays it back. During playback only the recorded
+// orders reach the units, so a heavy match can be profiled again and again
+// and compared across builds. Run replays with --headless --fixed-fps <tick
+// rate> to simulate as fast as the machine allows; scaling Engine.time_scale
+// instead would change the physics delta and the outcome.
+//
+// Units are identified by registry slot, which is stable as long as the
+// match scene spawns its units in the same order.
+class OrderRecorder : public Node {
+  GDCLASS(OrderRecorder, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  enum Mode {
+    MODE_OFF,
+    MODE_RECORD,
+    MODE_REPLAY,
+  };
+
+  OrderRecorder();
+  ~OrderRecorder();
+
+  void _ready() override;
+  void _exit_tree() override;
+  void _physics_process(double delta) override;
+
+  void set_mode(int32_t new_mode);
+  int32_t get_mode() const;
+
+  void set_file_path(const String& path);
+  String get_file_path() const;
+
+  // Seed handed to randomized behaviours. 0 picks one when recording starts;
+  // replays use the seed stored in the file.
+  void set_seed(int64_t new_seed);
+  int64_t get_seed() const;
+
+  void set_quit_when_replay_ends(bool quit);
+  bool get_quit_when_replay_ends() const;
+
+  bool start_recording();
+  void stop_recording();
+  bool start_replay();
+
+  bool is_recording() const;
+  bool is_replaying() const;
+  int64_t get_tick() const;
+  int64_t get_recorded_order_count() const;
+
+  // Called by Unit for every order issued from outside the unit. Returns
+  // false if the order must be dropped: during playback only orders coming
+  // from the recording are accepted.
+  bool on_order_issued(int32_t unit_slot, const UnitOrder& order, bool queued);
+
+  // Seed for one unit's randomized behaviour, derived from the match seed.
+  uint64_t get_unit_seed(int32_t unit_slot) const;
+
+ private:
+  struct RecordedOrder {
+    uint32_t tick = 0;
+    int32_t unit_slot = -1;
+    UnitOrder order;
+    bool queued = false;
+    int32_t target_slot = -1;  // ATTACK
+    NodePath target_path;      // INTERACT, relative to the match root
+  };
+
+  void _write_order(const RecordedOrder& record);
+  bool _read_order(RecordedOrder& record);
+  void _apply(const RecordedOrder& record);
+  void _finish_replay();
+  Node* _get_match_root() const;
+
+  int32_t mode = MODE_OFF;
+  String file_path = "user://match.replay";
+  int64_t seed = 0;
+  bool quit_when_replay_ends = false;
+
+  MatchManager* match = nullptr;
+  Ref<FileAccess> file;
+  bool recording = false;
+  bool replaying = false;
+  bool applying = false;
+  uint32_t tick = 0;
+  int64_t order_count = 0;
+
+  std::vector<RecordedOrder> replay_orders;
+  size_t replay_cursor = 0;
+  uint32_t replay_end_tick = 0;
+  uint64_t replay_start_usec = 0;
+};
+
+#endif  // GDEXTENSION_ORDER_RECORDER_H
@@ -0,0 +1,108 @@
+#include "position_history.hpp"
+
+#include <algorithm>
+
+void PositionHistory::set_capacity(int32_t ticks) {
+  capacity = std::max(ticks, 0);
+  samples.assign(static_cast<size_t>(slot_count) * capacity, Sample());
+  recorded_ticks = 0;
+}
+
+int32_t PositionHistory::get_capacity() const {
+  return capacity;
+}
+
+void PositionHistory::reset_slot(int32_t slot) {
+  _ensure_slot(slot);
+  first_tick[slot] = newest_tick + 1;
+  view_delays[slot] = 0;
+}
+
+void PositionHistory::begin_tick(int64_t tick, int32_t slots) {
+  if (capacity == 0) {
+    return;
+  }
+  if (slots > slot_count) {
+    _ensure_slot(slots - 1);
+  }
+  newest_tick = tick;
+  column = static_cast<int32_t>(tick % capacity);
+  recorded_ticks = std::min<int64_t>(recorded_ticks + 1, capacity);
+}
+
+int64_t PositionHistory::get_newest_tick() const {
+  return newest_tick;
+}
+
+int64_t PositionHistory::get_oldest_tick() const {
+  if (recorded_ticks == 0) {
+    return -1;
+  }
+  return newest_tick - recorded_ticks + 1;
+}
+
+const PositionHistory::Sample* PositionHistory::sample(int32_t slot,
+                                                       int64_t tick) const {
+  if (slot < 0 || slot >= slot_count || recorded_ticks == 0 ||
+      tick > newest_tick || tick < get_oldest_tick() ||
+      tick < first_tick[slot]) {
+    return nullptr;
+  }
+  return &samples[slot * capacity + tick % capacity];
+}
+
+void PositionHistory::set_view_delay(int32_t slot, int32_t ticks) {
+  if (slot < 0 || slot >= slot_count) {
+    return;
+  }
+  view_delays[slot] = std::max(ticks, 0);
+}
+
+int32_t PositionHistory::get_view_delay(int32_t slot) const {
+  if (slot < 0 || slot >= slot_count) {
+    return 0;
+  }
+  return view_delays[slot];
+}
+
+int64_t PositionHistory::get_view_tick(int32_t slot) const {
+  return rewind(get_view_delay(slot));
+}
+
+int64_t PositionHistory::rewind(int32_t ticks) const {
+  const int64_t oldest = get_oldest_tick();
+  if (oldest < 0) {
+    return -1;
+  }
+  return std::max(newest_tick - ticks, oldest);
+}
+
+bool PositionHistory::was_within_range(int32_t slot,
+                                       int64_t tick,
+                                       const Vector3& point,
+                                       float range) const {
+  const Sample* past = sample(slot, tick);
+  if (past == nullptr || !past->alive) {
+    return false;
+  }
+  const float dx = past->position.x - point.x;
+  const float dz = past->position.z - point.z;
+  return dx * dx + dz * dz <= range * range;
+}
+
+size_t PositionHistory::get_memory_usage() const {
+  return samples.capacity() * sizeof(Sample) +
+         first_tick.capacity() * sizeof(int64_t) +
+         view_delays.capacity() * sizeof(int32_t);
+}
+
+void PositionHistory::_ensure_slot(int32_t slot) {
+  if (slot < slot_count) {
+    return;
+  }
+  slot_count = slot + 1;
+  // Slot-major layout: new slots append whole rings, existing ones stay put.
+  samples.resize(static_cast<size_t>(slot_count) * capacity);
+  first_tick.resize(slot_count, newest_tick + 1);
+  view_delays.resize(slot_count, 0);
+}
@@ -0,0 +1,80 @@
+#ifndef GDEXTENSION_POSITION_HISTORY_H
+#define GDEXTENSION_POSITION_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/vector3.hpp>
+
+using godot::Vector3;
+
+// Where every unit was, and whether it was alive, during the last few ticks.
+// Lets the server judge a hit against the world as the attacking client saw
+// it, which lags the server by that client's round trip.
+//
+// Samples live in one contiguous array, slot-major with a ring of ticks per
+// slot, so a lookup is a bounds check and one index computation.
+class PositionHistory {
+ public:
+  struct Sample {
+    Vector3 position;
+    bool alive = false;
+  };
+
+  // Ticks kept per slot. Changing it forgets every recorded tick.
+  void set_capacity(int32_t ticks);
+  int32_t get_capacity() const;
+
+  // Called when a slot changes hands so the new unit never inherits the
+  // previous one's past.
+  void reset_slot(int32_t slot);
+
+  // Starts the column for tick; the caller then writes slots [0, slots).
+  void begin_tick(int64_t tick, int32_t slots);
+  void write(int32_t slot, const Vector3& position, bool alive) {
+    Sample& sample = samples[slot * capacity + column];
+    sample.position = position;
+    sample.alive = alive;
+  }
+
+  int64_t get_newest_tick() const;
+  // Oldest tick that can still be sampled, or -1 with nothing recorded.
+  int64_t get_oldest_tick() const;
+  // Null when the tick is not kept or the slot was not occupied then.
+  const Sample* sample(int32_t slot, int64_t tick) const;
+
+  // How many ticks behind the server a unit's controller sees the world.
+  // Set by the server for client-controlled units; 0 for everything else.
+  void set_view_delay(int32_t slot, int32_t ticks);
+  int32_t get_view_delay(int32_t slot) const;
+  // Newest tick the slot's controller had seen, clamped to the history.
+  int64_t get_view_tick(int32_t slot) const;
+  // The tick the given number of ticks back, clamped to the history; -1
+  // with nothing recorded.
+  int64_t rewind(int32_t ticks) const;
+
+  // Whether the unit was alive and within range of point at tick, measured
+  // on the ground plane like attack ranges. Falls back to false when the
+  // tick is not in the history.
+  bool was_within_range(int32_t slot,
+                        int64_t tick,
+                        const Vector3& point,
+                        float range) const;
+
+  size_t get_memory_usage() const;
+
+ private:
+  void _ensure_slot(int32_t slot);
+
+  int32_t capacity = 0;
+  int32_t slot_count = 0;
+  std::vector<Sample> samples;       // slot * capacity + tick % capacity
+  std::vector<int64_t> first_tick;   // Per slot, first tick of the occupant
+  std::vector<int32_t> view_delays;  // Per slot
+  int64_t newest_tick = -1;
+  int64_t recorded_ticks = 0;  // Since the last reset, capped at capacity
+  int32_t column = 0;
+};
+
+#endif  // GDEXTENSION_POSITION_HISTORY_H
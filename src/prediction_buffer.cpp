@@ -0,0 +1,93 @@
+#include "prediction_buffer.hpp"
+
+void PredictionBuffer::clear() {
+  input_head = 0;
+  input_count = 0;
+  state_head = 0;
+  state_count = 0;
+  current_sequence = 0;
+  steps_since_input = 0;
+}
+
+uint32_t PredictionBuffer::add_input(const UnitOrder& order, bool queued) {
+  if (input_count == INPUT_CAPACITY) {
+    // The server has not answered for a long time; drop the oldest.
+    input_head = (input_head + 1) % INPUT_CAPACITY;
+    input_count--;
+  }
+
+  Input& input = inputs[(input_head + input_count) % INPUT_CAPACITY];
+  input.sequence = next_sequence++;
+  input.order = order;
+  input.queued = queued;
+  input_count++;
+
+  current_sequence = input.sequence;
+  steps_since_input = 0;
+  return input.sequence;
+}
+
+void PredictionBuffer::acknowledge(uint32_t sequence) {
+  while (input_count > 0 && inputs[input_head].sequence <= sequence) {
+    input_head = (input_head + 1) % INPUT_CAPACITY;
+    input_count--;
+  }
+}
+
+int32_t PredictionBuffer::get_pending_input_count() const {
+  return input_count;
+}
+
+const PredictionBuffer::Input& PredictionBuffer::get_pending_input(
+    int32_t index) const {
+  return inputs[(input_head + index) % INPUT_CAPACITY];
+}
+
+void PredictionBuffer::record_state(const Vector3& position,
+                                    OrderType order,
+                                    const Vector3& destination) {
+  if (state_count == STATE_CAPACITY) {
+    state_head = (state_head + 1) % STATE_CAPACITY;
+    state_count--;
+  }
+
+  State& state = states[(state_head + state_count) % STATE_CAPACITY];
+  state.input_sequence = current_sequence;
+  state.steps_since_input = steps_since_input;
+  state.position = position;
+  state.order = order;
+  state.destination = destination;
+  state_count++;
+  steps_since_input++;
+}
+
+int32_t PredictionBuffer::get_state_count() const {
+  return state_count;
+}
+
+PredictionBuffer::State& PredictionBuffer::get_state(int32_t index) {
+  return states[(state_head + index) % STATE_CAPACITY];
+}
+
+int32_t PredictionBuffer::find_state(uint32_t input_sequence,
+                                     uint32_t steps) const {
+  for (int32_t index = 0; index < state_count; ++index) {
+    const State& state = states[(state_head + index) % STATE_CAPACITY];
+    if (state.input_sequence == input_sequence &&
+        state.steps_since_input == steps) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+void PredictionBuffer::discard_states_before(int32_t index) {
+  if (index <= 0) {
+    return;
+  }
+  if (index > state_count) {
+    index = state_count;
+  }
+  state_head = (state_head + index) % STATE_CAPACITY;
+  state_count -= index;
+}
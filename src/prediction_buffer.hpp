@@ -0,0 +1,77 @@
+#ifndef GDEXTENSION_PREDICTION_BUFFER_H
+#define GDEXTENSION_PREDICTION_BUFFER_H
+
+#include <cstdint>
+
+#include <godot_cpp/variant/vector3.hpp>
+
+#include "unit_order.hpp"
+
+using godot::Vector3;
+
+// Client-side prediction history of the controlled unit, in fixed-size
+// rings so predicting never allocates.
+//
+// Inputs (orders) are numbered and kept until the server acknowledges them.
+// States are recorded once per tick before the unit steps, tagged with the
+// newest input and how many steps ran since it, which is exactly what the
+// server reports with each snapshot. Matching the two tags lines up the
+// predicted and authoritative state without any clock synchronization.
+class PredictionBuffer {
+ public:
+  static constexpr int32_t INPUT_CAPACITY = 32;
+  static constexpr int32_t STATE_CAPACITY = 128;  // Two seconds at 60 Hz
+
+  struct Input {
+    uint32_t sequence = 0;
+    UnitOrder order;
+    bool queued = false;
+  };
+
+  struct State {
+    uint32_t input_sequence = 0;
+    uint32_t steps_since_input = 0;
+    Vector3 position;
+    // Order in effect for the step that follows this state.
+    OrderType order = OrderType::NONE;
+    Vector3 destination;
+  };
+
+  void clear();
+
+  // Numbers a new input; the step count restarts from it.
+  uint32_t add_input(const UnitOrder& order, bool queued);
+  // Drops inputs the server has applied.
+  void acknowledge(uint32_t sequence);
+  int32_t get_pending_input_count() const;
+  // 0 is the oldest unacknowledged input.
+  const Input& get_pending_input(int32_t index) const;
+
+  // Records the state at the start of a tick, then counts the step the unit
+  // is about to take.
+  void record_state(const Vector3& position,
+                    OrderType order,
+                    const Vector3& destination);
+  int32_t get_state_count() const;
+  // 0 is the oldest recorded state.
+  State& get_state(int32_t index);
+  // Index of the state with the given tags, or -1 if it is not (or no
+  // longer) in the ring.
+  int32_t find_state(uint32_t input_sequence, uint32_t steps) const;
+  // Forgets every state older than index.
+  void discard_states_before(int32_t index);
+
+ private:
+  Input inputs[INPUT_CAPACITY];
+  int32_t input_head = 0;  // Oldest pending input
+  int32_t input_count = 0;
+  uint32_t next_sequence = 1;
+
+  State states[STATE_CAPACITY];
+  int32_t state_head = 0;  // Oldest state
+  int32_t state_count = 0;
+  uint32_t current_sequence = 0;
+  uint32_t steps_since_input = 0;
+};
+
+#endif  // GDEXTENSION_PREDICTION_BUFFER_H
@@ -7,7 +7,10 @@
 #include <godot_cpp/variant/variant.hpp>
 
 #include "health_component.hpp"
+#include "match_manager.hpp"
+#include "state_checksum.hpp"
 #include "unit.hpp"
+#include "world_marker_pool.hpp"
 
 using godot::ClassDB;
 using godot::D_METHOD;
@@ -33,44 +36,74 @@ void Projectile::_physics_process(double delta) {
     return;
   }
 
-  if (target == nullptr || !target->is_inside_tree()) {
+  const UnitRegistry* registry =
+      match != nullptr ? &match->get_unit_registry() : nullptr;
+  Unit* target_unit = registry != nullptr ? registry->resolve(target)
+                                          : nullptr;
+  if (target_unit == nullptr) {
     queue_free();
     return;
   }
 
-  Vector3 current_pos = get_global_position();
-  Vector3 target_pos = target->get_global_position();
-
-  // Recompute direction each frame (target might be moving)
-  Vector3 to_target = target_pos - current_pos;
-  float distance_to_target = to_target.length();
-
   // Check if we've arrived (close enough)
-  if (distance_to_target <= hit_radius) {
-    // Check if target is still alive
-    HealthComponent* target_health = Object::cast_to<HealthComponent>(
-        target->get_component_by_class("HealthComponent"));
-
-    if (target_health != nullptr && !target_health->is_dead()) {
-      // Apply damage
-      if (attacker != nullptr) {
-        UtilityFunctions::print("[Projectile] " + attacker->get_name() +
-                                "'s projectile hit " + target->get_name() +
-                                " for " + godot::String::num(damage) +
-                                " damage");
+  if (_step_towards_target(delta, target_unit)) {
+    // The attacker may have died and left during the flight.
+    Unit* attacker_unit = registry->resolve(attacker);
+    if (registry->is_alive(target)) {
+      HealthComponent* target_health = target_unit->get_health_component();
+      if (attacker_unit != nullptr) {
+        UtilityFunctions::print("[Projectile] " + attacker_unit->get_name() +
+                                "'s projectile hit " +
+                                target_unit->get_name() + " for " +
+                                godot::String::num(damage) + " damage");
       }
-      target_health->apply_damage(damage, attacker);
-    } else if (target_health != nullptr && target_health->is_dead()) {
-      if (attacker != nullptr) {
-        UtilityFunctions::print("[Projectile] " + attacker->get_name() +
-                                "'s projectile reached " + target->get_name() +
-                                " but target was already dead");
+      if (target_health != nullptr) {
+        target_health->apply_damage(damage, attacker_unit);
       }
+    } else if (attacker_unit != nullptr) {
+      UtilityFunctions::print("[Projectile] " + attacker_unit->get_name() +
+                              "'s projectile reached " +
+                              target_unit->get_name() +
+                              " but target was already dead");
     }
 
+    WorldMarkerPool::spawn_for(this, MarkerKind::IMPACT,
+                               get_global_position());
     queue_free();
     return;
   }
+  _publish_state();
+}
+
+bool Projectile::_step_towards_target(double delta,
+                                      const Unit* target_unit) {
+  if (deterministic) {
+    const FixedVector3 to_target =
+        target_unit->get_fixed_position() - fixed_position;
+    const Fixed distance_to_target = to_target.length();
+    if (distance_to_target <= Fixed::from_float(hit_radius)) {
+      return true;
+    }
+
+    if (fixed_step >= distance_to_target) {
+      fixed_position = target_unit->get_fixed_position();
+    } else {
+      fixed_position =
+          fixed_position + to_target * (fixed_step / distance_to_target);
+    }
+    set_global_position(fixed_position.to_vector3());
+    return false;
+  }
+
+  Vector3 current_pos = get_global_position();
+  Vector3 target_pos = _get_target_position(target_unit);
+
+  // Recompute direction each frame (target might be moving)
+  Vector3 to_target = target_pos - current_pos;
+  float distance_to_target = to_target.length();
+  if (distance_to_target <= hit_radius) {
+    return true;
+  }
 
   // Move towards target
   if (distance_to_target > 0.001f) {
@@ -79,18 +112,75 @@ void Projectile::_physics_process(double delta) {
     set_global_position(current_pos + velocity * static_cast<float>(delta));
     travel_distance += speed * delta;
   }
+  return false;
+}
+
+Vector3 Projectile::_get_target_position(const Unit* target_unit) const {
+  if (rewind_ticks == 0 || match == nullptr) {
+    return target_unit->get_global_position();
+  }
+
+  const PositionHistory& history =
+      match->get_unit_registry().get_position_history();
+  const PositionHistory::Sample* past = history.sample(
+      target_unit->get_registry_slot(), history.rewind(rewind_ticks));
+  return past != nullptr ? past->position
+                         : target_unit->get_global_position();
+}
+
+void Projectile::_publish_state() const {
+  if (match == nullptr) {
+    return;
+  }
+
+  uint64_t hash = hash_mix(HASH_SEED, float_bits(damage));
+  hash = hash_mix(hash,
+                  static_cast<uint32_t>(UnitRegistry::slot_of(target)));
+  if (deterministic) {
+    hash = hash_mix(hash, static_cast<uint32_t>(fixed_position.x.raw));
+    hash = hash_mix(hash, static_cast<uint32_t>(fixed_position.y.raw));
+    hash = hash_mix(hash, static_cast<uint32_t>(fixed_position.z.raw));
+  } else {
+    const Vector3 position = get_global_position();
+    hash = hash_mix(hash, float_bits(position.x));
+    hash = hash_mix(hash, float_bits(position.y));
+    hash = hash_mix(hash, float_bits(position.z));
+  }
+  match->add_transient_state(hash);
 }
 
 void Projectile::setup(Unit* attacker_unit,
                        Unit* target_unit,
                        float damage_amount,
                        float travel_speed) {
-  attacker = attacker_unit;
-  target = target_unit;
   damage = damage_amount;
   speed = travel_speed;
 
-  if (target != nullptr) {
+  // Without a match there is nothing to resolve the handles against; the
+  // projectile then frees itself on its first tick.
+  match = attacker_unit != nullptr ? attacker_unit->get_match_manager()
+                                   : nullptr;
+  attacker = attacker_unit != nullptr ? attacker_unit->get_handle()
+                                      : INVALID_UNIT_HANDLE;
+  target = target_unit != nullptr && match != nullptr &&
+                   target_unit->get_match_manager() == match
+               ? target_unit->get_handle()
+               : INVALID_UNIT_HANDLE;
+  deterministic =
+      attacker_unit != nullptr && attacker_unit->is_deterministic();
+  // Fixed for the flight, so the attacker may die before it lands.
+  rewind_ticks =
+      match != nullptr && !deterministic
+          ? match->get_unit_registry().get_position_history().get_view_delay(
+                attacker_unit->get_registry_slot())
+          : 0;
+  if (deterministic) {
+    fixed_position = FixedVector3::from_vector3(get_global_position());
+    fixed_step = Fixed::from_float(speed) *
+                 attacker_unit->get_match_manager()->get_fixed_tick_length();
+  }
+
+  if (target_unit != nullptr) {
     Vector3 start_pos = attacker_unit != nullptr
                             ? attacker_unit->get_global_position()
                             : get_global_position();
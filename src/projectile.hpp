@@ -4,9 +4,13 @@
 #include <godot_cpp/classes/node3d.hpp>
 #include <godot_cpp/variant/vector3.hpp>
 
+#include "fixed_point.hpp"
+#include "unit_registry.hpp"
+
 using godot::Node3D;
 using godot::Vector3;
 
+class MatchManager;
 class Unit;
 
 class Projectile : public Node3D {
@@ -15,8 +19,9 @@ class Projectile : public Node3D {
  protected:
   static void _bind_methods();
 
-  Unit* attacker = nullptr;
-  Unit* target = nullptr;
+  // Handles, so either unit may leave or be freed during the flight.
+  UnitHandle attacker = INVALID_UNIT_HANDLE;
+  UnitHandle target = INVALID_UNIT_HANDLE;
   float damage = 0.0f;
   float speed = 20.0f;
   float hit_radius = 0.5f;  // "Close enough" distance
@@ -24,6 +29,18 @@ class Projectile : public Node3D {
   Vector3 direction = Vector3(0, 0, 0);
   double travel_distance = 0.0;
 
+  // Deterministic matches move the projectile in fixed point.
+  bool deterministic = false;
+  FixedVector3 fixed_position;
+  Fixed fixed_step;  // Distance covered per tick
+
+  // Resolves the handles and receives the per-tick state hash.
+  MatchManager* match = nullptr;
+
+  // Lag compensation: the projectile chases the target where the
+  // attacker's controller saw it, this many ticks in the past.
+  int32_t rewind_ticks = 0;
+
  public:
   Projectile();
   ~Projectile();
@@ -38,6 +55,13 @@ class Projectile : public Node3D {
 
   void set_hit_radius(float radius);
   float get_hit_radius() const;
+
+ private:
+  // Advances toward the target; returns true once it is within hit_radius.
+  bool _step_towards_target(double delta, const Unit* target_unit);
+  Vector3 _get_target_position(const Unit* target_unit) const;
+  // Adds this projectile to the match state checksum of the current tick.
+  void _publish_state() const;
 };
 
 #endif  // GDEXTENSION_PROJECTILE_H
@@ -5,19 +5,36 @@
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
 
+#include "ai_scheduler.hpp"
 #include "attack_component.hpp"
 #include "beeper.h"
+#include "desync_monitor.hpp"
+#include "fog_of_war.hpp"
+#include "health_bar_renderer.hpp"
 #include "health_component.hpp"
 #include "input_manager.hpp"
 #include "interactable.hpp"
+#include "loopback_transport.hpp"
+#include "match_client.hpp"
+#include "match_host.hpp"
 #include "match_manager.hpp"
+#include "match_server.hpp"
+#include "match_tick_probe.hpp"
 #include "moba_camera.hpp"
 #include "movement_component.hpp"
+#include "order_recorder.hpp"
 #include "projectile.hpp"
 #include "resource_pool_component.hpp"
+#include "self_play_runner.hpp"
+#include "snapshot_transport.hpp"
 #include "test_movement.hpp"
 #include "unit.hpp"
 #include "unit_component.hpp"
+#include "unit_instance_renderer.hpp"
+#include "unit_pool.hpp"
+#include "utility_ai.hpp"
+#include "wave_spawner.hpp"
+#include "world_marker_pool.hpp"
 
 using namespace godot;
 
@@ -39,6 +56,23 @@ void initialize_example_module(ModuleInitializationLevel p_level) {
   GDREGISTER_CLASS(ResourcePoolComponent)
   GDREGISTER_CLASS(AttackComponent)
   GDREGISTER_CLASS(Projectile)
+  GDREGISTER_CLASS(UnitInstanceRenderer)
+  GDREGISTER_CLASS(HealthBarRenderer)
+  GDREGISTER_CLASS(WorldMarkerPool)
+  GDREGISTER_CLASS(OrderRecorder)
+  GDREGISTER_CLASS(DesyncMonitor)
+  GDREGISTER_ABSTRACT_CLASS(SnapshotTransport)
+  GDREGISTER_CLASS(LoopbackTransport)
+  GDREGISTER_CLASS(MatchServer)
+  GDREGISTER_CLASS(MatchClient)
+  GDREGISTER_INTERNAL_CLASS(MatchTickProbe)
+  GDREGISTER_CLASS(MatchHost)
+  GDREGISTER_CLASS(SelfPlayRunner)
+  GDREGISTER_CLASS(UnitPool)
+  GDREGISTER_CLASS(WaveSpawner)
+  GDREGISTER_CLASS(AIScheduler)
+  GDREGISTER_CLASS(UtilityAI)
+  GDREGISTER_CLASS(FogOfWar)
 }
 
 void uninitialize_example_module(ModuleInitializationLevel p_level) {
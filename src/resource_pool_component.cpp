@@ -7,6 +7,8 @@
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <godot_cpp/variant/variant.hpp>
 
+#include "unit.hpp"
+
 using godot::ClassDB;
 using godot::D_METHOD;
 using godot::PropertyInfo;
@@ -45,11 +47,24 @@ void ResourcePoolComponent::_bind_methods() {
   ClassDB::bind_method(D_METHOD("restore", "amount"),
                        &ResourcePoolComponent::restore);
 
+  ClassDB::bind_method(D_METHOD("set_show_on_health_bar", "show"),
+                       &ResourcePoolComponent::set_show_on_health_bar);
+  ClassDB::bind_method(D_METHOD("get_show_on_health_bar"),
+                       &ResourcePoolComponent::get_show_on_health_bar);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "show_on_health_bar"),
+               "set_show_on_health_bar", "get_show_on_health_bar");
+
   ADD_SIGNAL(godot::MethodInfo("value_changed",
                                PropertyInfo(Variant::FLOAT, "current"),
                                PropertyInfo(Variant::FLOAT, "max")));
 }
 
+void ResourcePoolComponent::_ready() {
+  UnitComponent::_ready();
+  spawn_value = current_value;
+  _publish_value_ratio();
+}
+
 void ResourcePoolComponent::set_pool_id(StringName id) {
   pool_id = id;
 }
@@ -64,6 +79,7 @@ void ResourcePoolComponent::set_max_value(float value) {
     current_value = max_value;
   }
   emit_signal("value_changed", current_value, max_value);
+  _publish_value_ratio();
 }
 
 float ResourcePoolComponent::get_max_value() const {
@@ -73,6 +89,7 @@ float ResourcePoolComponent::get_max_value() const {
 void ResourcePoolComponent::set_current_value(float value) {
   current_value = std::clamp(value, 0.0f, max_value);
   emit_signal("value_changed", current_value, max_value);
+  _publish_value_ratio();
 }
 
 float ResourcePoolComponent::get_current_value() const {
@@ -90,6 +107,7 @@ bool ResourcePoolComponent::try_spend(float amount) {
 
   current_value -= amount;
   emit_signal("value_changed", current_value, max_value);
+  _publish_value_ratio();
   return true;
 }
 
@@ -100,4 +118,28 @@ void ResourcePoolComponent::restore(float amount) {
 
   current_value = std::min(max_value, current_value + amount);
   emit_signal("value_changed", current_value, max_value);
+  _publish_value_ratio();
+}
+
+void ResourcePoolComponent::reset_state() {
+  set_current_value(spawn_value);
+}
+
+void ResourcePoolComponent::set_show_on_health_bar(bool show) {
+  show_on_health_bar = show;
+}
+
+bool ResourcePoolComponent::get_show_on_health_bar() const {
+  return show_on_health_bar;
+}
+
+void ResourcePoolComponent::_publish_value_ratio() {
+  if (!show_on_health_bar || owner_unit == nullptr ||
+      owner_unit->get_unit_registry() == nullptr) {
+    return;
+  }
+
+  const float ratio = max_value > 0.0f ? current_value / max_value : 0.0f;
+  owner_unit->get_unit_registry()->set_resource_ratio(
+      owner_unit->get_registry_slot(), ratio);
 }
@@ -16,11 +16,15 @@ class ResourcePoolComponent : public UnitComponent {
   StringName pool_id = "default";
   float max_value = 100.0f;
   float current_value = 100.0f;
+  float spawn_value = 100.0f;  // Value at _ready, restored on reuse
+  bool show_on_health_bar = true;
 
  public:
   ResourcePoolComponent();
   ~ResourcePoolComponent();
 
+  void _ready() override;
+
   void set_pool_id(StringName id);
   StringName get_pool_id() const;
 
@@ -33,6 +37,16 @@ class ResourcePoolComponent : public UnitComponent {
   bool can_spend(float amount) const;
   bool try_spend(float amount);
   void restore(float amount);
+
+  // Back to the value the unit was spawned with.
+  void reset_state() override;
+
+  // Only one pool per unit should be shown under the health bar.
+  void set_show_on_health_bar(bool show);
+  bool get_show_on_health_bar() const;
+
+ private:
+  void _publish_value_ratio();
 };
 
 #endif  // GDEXTENSION_RESOURCE_POOL_COMPONENT_H
@@ -0,0 +1,13 @@
+#include "response_curve.hpp"
+
+ResponseCurve::ResponseCurve(Shape default_shape)
+    : default_shape(default_shape) {
+  bake(Ref<Curve>());
+}
+
+void ResponseCurve::bake(const Ref<Curve>& curve) {
+  for (int32_t index = 0; index < RESOLUTION; ++index) {
+    const float x = static_cast<float>(index) / (RESOLUTION - 1);
+    table[index] = curve.is_valid() ? curve->sample_baked(x) : default_shape(x);
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef GDEXTENSION_RESPONSE_CURVE_H
+#define GDEXTENSION_RESPONSE_CURVE_H
+
+#include <algorithm>
+#include <cstdint>
+
+#include <godot_cpp/classes/curve.hpp>
+#include <godot_cpp/classes/ref.hpp>
+
+using godot::Curve;
+using godot::Ref;
+
+// Response curve of a utility consideration, baked into a lookup table over
+// inputs in [0, 1] so scoring is a clamp, a multiply and a load; no curve
+// evaluation in the scoring loops.
+class ResponseCurve {
+ public:
+  static constexpr int32_t RESOLUTION = 64;
+
+  using Shape = float (*)(float);
+
+  explicit ResponseCurve(Shape default_shape);
+
+  // Bakes the curve resource, or the default shape when it is null.
+  void bake(const Ref<Curve>& curve);
+
+  float sample(float x) const {
+    x = std::min(std::max(x, 0.0f), 1.0f);
+    return table[static_cast<int32_t>(x * (RESOLUTION - 1) + 0.5f)];
+  }
+
+ private:
+  Shape default_shape;
+  float table[RESOLUTION];
+};
+
+#endif  // GDEXTENSION_RESPONSE_CURVE_H
@@ -0,0 +1,466 @@
+#include "self_play_runner.hpp"
+
+#include <godot_cpp/classes/display_server.hpp>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+
+#include "input_manager.hpp"
+#include "match_host.hpp"
+#include "match_manager.hpp"
+#include "moba_camera.hpp"
+#include "test_movement.hpp"
+#include "unit.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::DisplayServer;
+using godot::Engine;
+using godot::MethodInfo;
+using godot::OS;
+using godot::PropertyInfo;
+using godot::Time;
+using godot::UtilityFunctions;
+using godot::Variant;
+
+namespace {
+
+constexpr const char* RESULTS_HEADER =
+    "match,winner,reason,ticks,sim_seconds,wall_seconds,realtime_factor,"
+    "tick_usec_avg,tick_usec_max,checksum_usec_avg,memory_bytes,units_alive";
+
+struct FactionTally {
+  int32_t faction = 0;
+  int32_t alive = 0;
+  float health = 0.0f;  // Sum of health ratios
+  Vector3 position_sum;
+  int32_t unit_count = 0;
+};
+
+// Per-faction counts over the match registry; factions are few.
+void tally_factions(const UnitRegistry& registry,
+                    std::vector<FactionTally>& tallies) {
+  tallies.clear();
+  for (int32_t slot = 0; slot < registry.get_slot_count(); ++slot) {
+    if (registry.get_unit(slot) == nullptr) {
+      continue;
+    }
+    const int32_t faction = registry.get_faction(slot);
+    auto it = std::find_if(
+        tallies.begin(), tallies.end(),
+        [faction](const FactionTally& tally) {
+          return tally.faction == faction;
+        });
+    if (it == tallies.end()) {
+      tallies.emplace_back();
+      it = tallies.end() - 1;
+      it->faction = faction;
+    }
+    const float health = registry.get_health_ratio(slot);
+    it->alive += health > 0.0f ? 1 : 0;
+    it->health += std::max(health, 0.0f);
+    it->position_sum += registry.get_position(slot);
+    it->unit_count++;
+  }
+}
+
+}  // namespace
+
+SelfPlayRunner::SelfPlayRunner() = default;
+
+SelfPlayRunner::~SelfPlayRunner() = default;
+
+void SelfPlayRunner::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_match_scene", "scene"),
+                       &SelfPlayRunner::set_match_scene);
+  ClassDB::bind_method(D_METHOD("get_match_scene"),
+                       &SelfPlayRunner::get_match_scene);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "match_scene",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"),
+               "set_match_scene", "get_match_scene");
+
+  ClassDB::bind_method(D_METHOD("set_match_count", "count"),
+                       &SelfPlayRunner::set_match_count);
+  ClassDB::bind_method(D_METHOD("get_match_count"),
+                       &SelfPlayRunner::get_match_count);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "match_count",
+                            godot::PROPERTY_HINT_RANGE, "1,100000,1"),
+               "set_match_count", "get_match_count");
+
+  ClassDB::bind_method(D_METHOD("set_parallel_matches", "count"),
+                       &SelfPlayRunner::set_parallel_matches);
+  ClassDB::bind_method(D_METHOD("get_parallel_matches"),
+                       &SelfPlayRunner::get_parallel_matches);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "parallel_matches",
+                            godot::PROPERTY_HINT_RANGE, "1,256,1"),
+               "set_parallel_matches", "get_parallel_matches");
+
+  ClassDB::bind_method(D_METHOD("set_max_match_seconds", "seconds"),
+                       &SelfPlayRunner::set_max_match_seconds);
+  ClassDB::bind_method(D_METHOD("get_max_match_seconds"),
+                       &SelfPlayRunner::get_max_match_seconds);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_match_seconds"),
+               "set_max_match_seconds", "get_max_match_seconds");
+
+  ClassDB::bind_method(D_METHOD("set_results_path", "path"),
+                       &SelfPlayRunner::set_results_path);
+  ClassDB::bind_method(D_METHOD("get_results_path"),
+                       &SelfPlayRunner::get_results_path);
+  ADD_PROPERTY(PropertyInfo(Variant::STRING, "results_path",
+                            godot::PROPERTY_HINT_SAVE_FILE, "*.csv"),
+               "set_results_path", "get_results_path");
+
+  ClassDB::bind_method(D_METHOD("set_add_bots", "enabled"),
+                       &SelfPlayRunner::set_add_bots);
+  ClassDB::bind_method(D_METHOD("get_add_bots"), &SelfPlayRunner::get_add_bots);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "add_bots"), "set_add_bots",
+               "get_add_bots");
+
+  ClassDB::bind_method(D_METHOD("set_bot_decision_interval", "seconds"),
+                       &SelfPlayRunner::set_bot_decision_interval);
+  ClassDB::bind_method(D_METHOD("get_bot_decision_interval"),
+                       &SelfPlayRunner::get_bot_decision_interval);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "bot_decision_interval"),
+               "set_bot_decision_interval", "get_bot_decision_interval");
+
+  ClassDB::bind_method(D_METHOD("set_quit_when_done", "quit"),
+                       &SelfPlayRunner::set_quit_when_done);
+  ClassDB::bind_method(D_METHOD("get_quit_when_done"),
+                       &SelfPlayRunner::get_quit_when_done);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "quit_when_done"),
+               "set_quit_when_done", "get_quit_when_done");
+
+  ClassDB::bind_method(D_METHOD("get_finished_match_count"),
+                       &SelfPlayRunner::get_finished_match_count);
+
+  ADD_SIGNAL(MethodInfo("match_finished", PropertyInfo(Variant::INT, "index"),
+                        PropertyInfo(Variant::DICTIONARY, "result")));
+  ADD_SIGNAL(MethodInfo("all_matches_finished"));
+}
+
+void SelfPlayRunner::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  if (match_scene.is_null()) {
+    UtilityFunctions::push_error("[SelfPlayRunner] match_scene is not set.");
+    set_process(false);
+    return;
+  }
+  if (DisplayServer::get_singleton()->get_name() != "headless") {
+    UtilityFunctions::push_warning(
+        "[SelfPlayRunner] Not headless; run with --headless to skip "
+        "rendering.");
+  }
+  if (!OS::get_singleton()->get_cmdline_args().has("--fixed-fps")) {
+    UtilityFunctions::push_warning(
+        "[SelfPlayRunner] Without --fixed-fps the matches run in real time.");
+  }
+
+  results = FileAccess::open(results_path, FileAccess::WRITE);
+  if (results.is_null()) {
+    UtilityFunctions::push_error("[SelfPlayRunner] Cannot write " +
+                                 results_path);
+  } else {
+    results->store_line(RESULTS_HEADER);
+  }
+
+  host = memnew(MatchHost);
+  host->set_match_scene(match_scene);
+  host->set_use_worker_threads(parallel_matches > 1);
+  host->set_report_interval(0.0f);  // Tick windows are polled below
+  add_child(host);
+
+  const int32_t initial = std::min(parallel_matches, match_count);
+  for (int32_t i = 0; i < initial; ++i) {
+    _start_next_match();
+  }
+}
+
+void SelfPlayRunner::_exit_tree() {
+  if (results.is_valid()) {
+    results->close();
+    results.unref();
+  }
+}
+
+void SelfPlayRunner::_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint() || host == nullptr) {
+    return;
+  }
+
+  // Matches are stepped in the physics phase; here none is running.
+  Dictionary result;
+  for (size_t i = 0; i < running.size();) {
+    RunningMatch& match_run = running[i];
+    const MatchTickProbe::Window window =
+        host->take_tick_window(match_run.host_id);
+    match_run.ticks.ticks += window.ticks;
+    match_run.ticks.total_usec += window.total_usec;
+    match_run.ticks.max_usec =
+        std::max(match_run.ticks.max_usec, window.max_usec);
+    match_run.ticks.checksum_usec += window.checksum_usec;
+
+    MatchManager* match = host->get_match_manager(match_run.host_id);
+    if (match == nullptr) {
+      ++i;
+      continue;
+    }
+    if (!match_run.prepared) {
+      _prepare_match(match);
+      match_run.prepared = true;
+    }
+    if (!_evaluate(match, result)) {
+      ++i;
+      continue;
+    }
+
+    const RunningMatch finished = match_run;
+    running.erase(running.begin() + i);
+    _finish_match(finished, result);
+    if (started_matches < match_count) {
+      _start_next_match();
+    }
+  }
+
+  if (running.empty() && finished_matches >= match_count) {
+    set_process(false);
+    if (results.is_valid()) {
+      results->close();
+      results.unref();
+    }
+    UtilityFunctions::print("[SelfPlayRunner] " +
+                            String::num_int64(finished_matches) +
+                            " matches written to " + results_path);
+    emit_signal("all_matches_finished");
+    if (quit_when_done) {
+      get_tree()->quit();
+    }
+  }
+}
+
+void SelfPlayRunner::set_match_scene(const Ref<PackedScene>& scene) {
+  match_scene = scene;
+}
+
+Ref<PackedScene> SelfPlayRunner::get_match_scene() const {
+  return match_scene;
+}
+
+void SelfPlayRunner::set_match_count(int32_t count) {
+  match_count = std::max(count, 1);
+}
+
+int32_t SelfPlayRunner::get_match_count() const {
+  return match_count;
+}
+
+void SelfPlayRunner::set_parallel_matches(int32_t count) {
+  parallel_matches = std::max(count, 1);
+}
+
+int32_t SelfPlayRunner::get_parallel_matches() const {
+  return parallel_matches;
+}
+
+void SelfPlayRunner::set_max_match_seconds(float seconds) {
+  max_match_seconds = std::max(seconds, 1.0f);
+}
+
+float SelfPlayRunner::get_max_match_seconds() const {
+  return max_match_seconds;
+}
+
+void SelfPlayRunner::set_results_path(const String& path) {
+  results_path = path;
+}
+
+String SelfPlayRunner::get_results_path() const {
+  return results_path;
+}
+
+void SelfPlayRunner::set_add_bots(bool enabled) {
+  add_bots = enabled;
+}
+
+bool SelfPlayRunner::get_add_bots() const {
+  return add_bots;
+}
+
+void SelfPlayRunner::set_bot_decision_interval(float seconds) {
+  bot_decision_interval = std::max(seconds, 0.0f);
+}
+
+float SelfPlayRunner::get_bot_decision_interval() const {
+  return bot_decision_interval;
+}
+
+void SelfPlayRunner::set_quit_when_done(bool quit) {
+  quit_when_done = quit;
+}
+
+bool SelfPlayRunner::get_quit_when_done() const {
+  return quit_when_done;
+}
+
+int32_t SelfPlayRunner::get_finished_match_count() const {
+  return finished_matches;
+}
+
+void SelfPlayRunner::_start_next_match() {
+  RunningMatch match_run;
+  match_run.host_id = host->start_match();
+  if (match_run.host_id < 0) {
+    // The scene does not load; count the match as played so the run ends.
+    started_matches = match_count;
+    finished_matches = match_count;
+    return;
+  }
+  match_run.index = started_matches++;
+  match_run.start_usec = Time::get_singleton()->get_ticks_usec();
+  running.push_back(match_run);
+}
+
+void SelfPlayRunner::_prepare_match(MatchManager* match) const {
+  if (match->get_player_controller() != nullptr) {
+    match->get_player_controller()->set_process_mode(
+        Node::PROCESS_MODE_DISABLED);
+  }
+  if (match->get_moba_camera() != nullptr) {
+    match->get_moba_camera()->set_process_mode(Node::PROCESS_MODE_DISABLED);
+  }
+  if (!add_bots) {
+    return;
+  }
+
+  const UnitRegistry& registry = match->get_unit_registry();
+  std::vector<FactionTally> tallies;
+  tally_factions(registry, tallies);
+  int32_t total_units = 0;
+  Vector3 total_position;
+  for (const FactionTally& tally : tallies) {
+    total_units += tally.unit_count;
+    total_position += tally.position_sum;
+  }
+
+  for (int32_t slot = 0; slot < registry.get_slot_count(); ++slot) {
+    Unit* unit = registry.get_unit(slot);
+    if (unit == nullptr ||
+        unit->get_component_by_class("TestMovement") != nullptr) {
+      continue;
+    }
+
+    // Head for the centre of every other faction's units.
+    const int32_t faction = registry.get_faction(slot);
+    const auto own = std::find_if(
+        tallies.begin(), tallies.end(),
+        [faction](const FactionTally& tally) {
+          return tally.faction == faction;
+        });
+    const int32_t enemy_units = total_units - own->unit_count;
+
+    TestMovement* bot = memnew(TestMovement);
+    bot->set_behavior(TestMovement::BEHAVIOR_FIGHT);
+    bot->set_interval_seconds(bot_decision_interval);
+    if (enemy_units > 0) {
+      bot->set_objective((total_position - own->position_sum) / enemy_units);
+      bot->set_use_objective(true);
+    }
+    unit->add_child(bot);
+  }
+}
+
+bool SelfPlayRunner::_evaluate(const MatchManager* match,
+                               Dictionary& result) const {
+  std::vector<FactionTally> tallies;
+  tally_factions(match->get_unit_registry(), tallies);
+
+  int32_t factions_alive = 0;
+  int32_t units_alive = 0;
+  int32_t winner = -1;
+  for (const FactionTally& tally : tallies) {
+    units_alive += tally.alive;
+    if (tally.alive > 0) {
+      factions_alive++;
+      winner = tally.faction;
+    }
+  }
+
+  const int64_t tick = match->get_tick();
+  const double tick_rate =
+      Engine::get_singleton()->get_physics_ticks_per_second();
+  String reason = "elimination";
+  if (factions_alive > 1) {
+    if (tick < static_cast<int64_t>(max_match_seconds * tick_rate)) {
+      return false;
+    }
+
+    // Timed out: most remaining health wins, a tie is a draw.
+    reason = "timeout";
+    winner = -1;
+    float best = -1.0f;
+    for (const FactionTally& tally : tallies) {
+      if (tally.health > best) {
+        best = tally.health;
+        winner = tally.faction;
+      } else if (tally.health == best) {
+        winner = -1;
+      }
+    }
+  }
+
+  result["winner"] = winner;
+  result["reason"] = reason;
+  result["ticks"] = tick;
+  result["sim_seconds"] = tick / tick_rate;
+  result["memory_bytes"] = match->get_memory_usage();
+  result["units_alive"] = units_alive;
+  return true;
+}
+
+void SelfPlayRunner::_finish_match(const RunningMatch& match_run,
+                                   Dictionary& result) {
+  const double wall_seconds =
+      (Time::get_singleton()->get_ticks_usec() - match_run.start_usec) /
+      1000000.0;
+  const double sim_seconds = result["sim_seconds"];
+  result["wall_seconds"] = wall_seconds;
+  result["realtime_factor"] =
+      wall_seconds > 0.0 ? sim_seconds / wall_seconds : 0.0;
+  result["tick_usec_avg"] =
+      match_run.ticks.ticks > 0
+          ? match_run.ticks.total_usec / match_run.ticks.ticks
+          : 0;
+  result["tick_usec_max"] = match_run.ticks.max_usec;
+  result["checksum_usec_avg"] =
+      match_run.ticks.ticks > 0
+          ? match_run.ticks.checksum_usec / match_run.ticks.ticks
+          : 0;
+  host->stop_match(match_run.host_id);
+  finished_matches++;
+
+  if (results.is_valid()) {
+    results->store_line(
+        String::num_int64(match_run.index) + "," +
+        result["winner"].stringify() + "," + result["reason"].stringify() +
+        "," + result["ticks"].stringify() + "," +
+        String::num(sim_seconds, 2) + "," + String::num(wall_seconds, 3) +
+        "," + String::num(result["realtime_factor"], 1) + "," +
+        result["tick_usec_avg"].stringify() + "," +
+        result["tick_usec_max"].stringify() + "," +
+        result["checksum_usec_avg"].stringify() + "," +
+        result["memory_bytes"].stringify() + "," +
+        result["units_alive"].stringify());
+    // Overnight runs may be cut short; keep every finished row.
+    results->flush();
+  }
+  emit_signal("match_finished", match_run.index, result);
+}
@@ -0,0 +1,116 @@
+#ifndef GDEXTENSION_SELF_PLAY_RUNNER_H
+#define GDEXTENSION_SELF_PLAY_RUNNER_H
+
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/packed_scene.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "match_tick_probe.hpp"
+
+using godot::Dictionary;
+using godot::FileAccess;
+using godot::Node;
+using godot::PackedScene;
+using godot::Ref;
+using godot::String;
+
+class MatchHost;
+class MatchManager;
+
+// Plays bot matches back to back for AI and balance tuning and writes one
+// CSV row per match: winner, length and tick cost.
+//
+// Run it with --headless --fixed-fps <physics tick rate>. Every frame then
+// advances exactly one tick with a fixed delta and no frame waits, so the
+// simulation runs as fast as the CPU allows; scaling Engine.time_scale
+// would change the delta instead. Matches run on a MatchHost, several in
+// parallel on worker threads.
+//
+// Every unit gets a FIGHT TestMovement bot heading for the enemy side,
+// unless its scene already gives it one (a scripted controller). The
+// player controller and camera of the match scene are disabled.
+//
+// A match ends when at most one faction has living units, or after
+// max_match_seconds, when the faction with the most remaining health wins.
+// Winner -1 is a draw.
+class SelfPlayRunner : public Node {
+  GDCLASS(SelfPlayRunner, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  SelfPlayRunner();
+  ~SelfPlayRunner();
+
+  void _ready() override;
+  void _exit_tree() override;
+  void _process(double delta) override;
+
+  void set_match_scene(const Ref<PackedScene>& scene);
+  Ref<PackedScene> get_match_scene() const;
+
+  void set_match_count(int32_t count);
+  int32_t get_match_count() const;
+
+  void set_parallel_matches(int32_t count);
+  int32_t get_parallel_matches() const;
+
+  // Simulated seconds before a match is decided on remaining health.
+  void set_max_match_seconds(float seconds);
+  float get_max_match_seconds() const;
+
+  void set_results_path(const String& path);
+  String get_results_path() const;
+
+  void set_add_bots(bool enabled);
+  bool get_add_bots() const;
+
+  // Seconds between decisions of the added bots.
+  void set_bot_decision_interval(float seconds);
+  float get_bot_decision_interval() const;
+
+  void set_quit_when_done(bool quit);
+  bool get_quit_when_done() const;
+
+  int32_t get_finished_match_count() const;
+
+ private:
+  struct RunningMatch {
+    int32_t host_id = -1;
+    int32_t index = 0;
+    uint64_t start_usec = 0;
+    bool prepared = false;
+    MatchTickProbe::Window ticks;
+  };
+
+  void _start_next_match();
+  // Disables player-facing nodes and hands the units to bots.
+  void _prepare_match(MatchManager* match) const;
+  // Fills result and returns true once the match is decided.
+  bool _evaluate(const MatchManager* match, Dictionary& result) const;
+  void _finish_match(const RunningMatch& running, Dictionary& result);
+
+  Ref<PackedScene> match_scene;
+  int32_t match_count = 100;
+  int32_t parallel_matches = 4;
+  float max_match_seconds = 600.0f;
+  String results_path = "user://self_play_results.csv";
+  bool add_bots = true;
+  float bot_decision_interval = 0.5f;
+  bool quit_when_done = true;
+
+  MatchHost* host = nullptr;
+  std::vector<RunningMatch> running;
+  int32_t started_matches = 0;
+  int32_t finished_matches = 0;
+  Ref<FileAccess> results;
+};
+
+#endif  // GDEXTENSION_SELF_PLAY_RUNNER_H
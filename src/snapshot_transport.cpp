@@ -0,0 +1,17 @@
+#include "snapshot_transport.hpp"
+
+SnapshotTransport::SnapshotTransport() = default;
+
+SnapshotTransport::~SnapshotTransport() = default;
+
+void SnapshotTransport::_bind_methods() {}
+
+void SnapshotTransport::send_packet(int32_t from_peer,
+                                    int32_t to_peer,
+                                    const PackedByteArray& packet) {}
+
+bool SnapshotTransport::poll_packet(int32_t peer,
+                                    int32_t& from_peer,
+                                    PackedByteArray& packet) {
+  return false;
+}
@@ -0,0 +1,38 @@
+#ifndef GDEXTENSION_SNAPSHOT_TRANSPORT_H
+#define GDEXTENSION_SNAPSHOT_TRANSPORT_H
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+#include <cstdint>
+
+using godot::Node;
+using godot::PackedByteArray;
+
+// Carries packets between a MatchServer and its MatchClients. Peers are
+// identified by integer ids, the server is always SERVER_PEER. Delivery may
+// be unreliable and unordered; the snapshot protocol only needs datagrams.
+// Subclass it to put the protocol on a real network; the base class itself
+// drops everything.
+class SnapshotTransport : public Node {
+  GDCLASS(SnapshotTransport, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  static constexpr int32_t SERVER_PEER = 1;
+
+  SnapshotTransport();
+  ~SnapshotTransport();
+
+  virtual void send_packet(int32_t from_peer,
+                           int32_t to_peer,
+                           const PackedByteArray& packet);
+  // Takes the next packet waiting for peer. Returns false when none is.
+  virtual bool poll_packet(int32_t peer,
+                           int32_t& from_peer,
+                           PackedByteArray& packet);
+};
+
+#endif  // GDEXTENSION_SNAPSHOT_TRANSPORT_H
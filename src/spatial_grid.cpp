@@ -0,0 +1,105 @@
+#include "spatial_grid.hpp"
+
+SpatialGrid::SpatialGrid(float cell_size, int32_t bucket_bits)
+    : cell_size(cell_size),
+      inverse_cell_size(1.0f / cell_size),
+      bucket_mask((1u << bucket_bits) - 1u),
+      buckets(static_cast<size_t>(1) << bucket_bits) {}
+
+bool SpatialGrid::update(int32_t id, const Vector3& position) {
+  if (id < 0) {
+    return false;
+  }
+  if (id >= static_cast<int32_t>(entries.size())) {
+    entries.resize(id + 1);
+  }
+
+  Entry& entry = entries[id];
+  entry.x = position.x;
+  entry.z = position.z;
+
+  const int32_t cell_x = cell_coord(position.x);
+  const int32_t cell_z = cell_coord(position.z);
+  const bool in_grid = entry.index_in_bucket >= 0;
+  if (in_grid && entry.cell_x == cell_x && entry.cell_z == cell_z) {
+    return false;
+  }
+
+  if (in_grid) {
+    _unlink(id);
+  } else {
+    entry_count++;
+  }
+
+  entry.cell_x = cell_x;
+  entry.cell_z = cell_z;
+  std::vector<int32_t>& bucket = buckets[_bucket_of(cell_x, cell_z)];
+  entry.index_in_bucket = static_cast<int32_t>(bucket.size());
+  bucket.push_back(id);
+  return true;
+}
+
+void SpatialGrid::remove(int32_t id) {
+  if (!contains(id)) {
+    return;
+  }
+  _unlink(id);
+  entries[id].index_in_bucket = -1;
+  entry_count--;
+}
+
+bool SpatialGrid::contains(int32_t id) const {
+  return id >= 0 && id < static_cast<int32_t>(entries.size()) &&
+         entries[id].index_in_bucket >= 0;
+}
+
+float SpatialGrid::get_cell_size() const {
+  return cell_size;
+}
+
+int32_t SpatialGrid::cell_coord(float value) const {
+  return static_cast<int32_t>(std::floor(value * inverse_cell_size));
+}
+
+void SpatialGrid::query_rect(float min_x,
+                             float min_z,
+                             float max_x,
+                             float max_z,
+                             std::vector<int32_t>& out) const {
+  for_each_in_rect(min_x, min_z, max_x, max_z,
+                   [&out](int32_t id) { out.push_back(id); });
+}
+
+void SpatialGrid::query_radius(const Vector3& center,
+                               float radius,
+                               std::vector<int32_t>& out) const {
+  for_each_in_radius(center, radius,
+                     [&out](int32_t id) { out.push_back(id); });
+}
+
+size_t SpatialGrid::get_memory_usage() const {
+  size_t bytes = buckets.capacity() * sizeof(std::vector<int32_t>) +
+                 entries.capacity() * sizeof(Entry);
+  for (const std::vector<int32_t>& bucket : buckets) {
+    bytes += bucket.capacity() * sizeof(int32_t);
+  }
+  return bytes;
+}
+
+uint32_t SpatialGrid::_bucket_of(int32_t cell_x, int32_t cell_z) const {
+  const uint32_t hash = static_cast<uint32_t>(cell_x) * 73856093u ^
+                        static_cast<uint32_t>(cell_z) * 19349663u;
+  return hash & bucket_mask;
+}
+
+void SpatialGrid::_unlink(int32_t id) {
+  Entry& entry = entries[id];
+  std::vector<int32_t>& bucket =
+      buckets[_bucket_of(entry.cell_x, entry.cell_z)];
+
+  // Swap-remove, patching the index of the entry moved into the hole.
+  const int32_t last_id = bucket.back();
+  bucket[entry.index_in_bucket] = last_id;
+  entries[last_id].index_in_bucket = entry.index_in_bucket;
+  bucket.pop_back();
+}
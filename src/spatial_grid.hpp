@@ -0,0 +1,131 @@
+#ifndef GDEXTENSION_SPATIAL_GRID_H
+#define GDEXTENSION_SPATIAL_GRID_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/vector3.hpp>
+
+using godot::Vector3;
+
+// Uniform grid over the XZ plane with hashed buckets, so it needs no map
+// bounds. Entries are identified by small dense ids (registry slots).
+class SpatialGrid {
+ public:
+  explicit SpatialGrid(float cell_size = 4.0f, int32_t bucket_bits = 12);
+
+  // Inserts the id or moves it. Returns true if it entered a new cell.
+  bool update(int32_t id, const Vector3& position);
+  void remove(int32_t id);
+  bool contains(int32_t id) const;
+
+  float get_cell_size() const;
+  int32_t cell_coord(float value) const;
+
+  // Calls visit(id) for every entry inside the XZ rectangle.
+  template <typename Visitor>
+  void for_each_in_rect(float min_x,
+                        float min_z,
+                        float max_x,
+                        float max_z,
+                        Visitor&& visit) const;
+
+  // Calls visit(id) for every entry within radius of center on XZ.
+  template <typename Visitor>
+  void for_each_in_radius(const Vector3& center,
+                          float radius,
+                          Visitor&& visit) const;
+
+  void query_rect(float min_x,
+                  float min_z,
+                  float max_x,
+                  float max_z,
+                  std::vector<int32_t>& out) const;
+  void query_radius(const Vector3& center,
+                    float radius,
+                    std::vector<int32_t>& out) const;
+
+  // Bytes held by the grid's arrays.
+  size_t get_memory_usage() const;
+
+ private:
+  struct Entry {
+    float x = 0.0f;
+    float z = 0.0f;
+    int32_t cell_x = 0;
+    int32_t cell_z = 0;
+    int32_t index_in_bucket = -1;  // -1 when not in the grid
+  };
+
+  uint32_t _bucket_of(int32_t cell_x, int32_t cell_z) const;
+  void _unlink(int32_t id);
+
+  float cell_size;
+  float inverse_cell_size;
+  uint32_t bucket_mask;
+  std::vector<std::vector<int32_t>> buckets;
+  std::vector<Entry> entries;
+  int32_t entry_count = 0;
+};
+
+template <typename Visitor>
+void SpatialGrid::for_each_in_rect(float min_x,
+                                   float min_z,
+                                   float max_x,
+                                   float max_z,
+                                   Visitor&& visit) const {
+  const int32_t first_x = cell_coord(min_x);
+  const int32_t first_z = cell_coord(min_z);
+  const int32_t last_x = cell_coord(max_x);
+  const int32_t last_z = cell_coord(max_z);
+
+  const int64_t cell_count = static_cast<int64_t>(last_x - first_x + 1) *
+                             static_cast<int64_t>(last_z - first_z + 1);
+  if (cell_count > static_cast<int64_t>(entry_count)) {
+    // Rect covers more cells than there are entries, scan entries instead.
+    const int32_t id_count = static_cast<int32_t>(entries.size());
+    for (int32_t id = 0; id < id_count; ++id) {
+      const Entry& entry = entries[id];
+      if (entry.index_in_bucket >= 0 && entry.x >= min_x &&
+          entry.x <= max_x && entry.z >= min_z && entry.z <= max_z) {
+        visit(id);
+      }
+    }
+    return;
+  }
+
+  for (int32_t cz = first_z; cz <= last_z; ++cz) {
+    for (int32_t cx = first_x; cx <= last_x; ++cx) {
+      for (const int32_t id : buckets[_bucket_of(cx, cz)]) {
+        const Entry& entry = entries[id];
+        if (entry.cell_x != cx || entry.cell_z != cz) {
+          continue;  // Hash collision with another cell.
+        }
+        if (entry.x >= min_x && entry.x <= max_x && entry.z >= min_z &&
+            entry.z <= max_z) {
+          visit(id);
+        }
+      }
+    }
+  }
+}
+
+template <typename Visitor>
+void SpatialGrid::for_each_in_radius(const Vector3& center,
+                                     float radius,
+                                     Visitor&& visit) const {
+  const float radius_squared = radius * radius;
+  for_each_in_rect(center.x - radius, center.z - radius, center.x + radius,
+                   center.z + radius, [&](int32_t id) {
+                     const Entry& entry = entries[id];
+                     const float dx = entry.x - center.x;
+                     const float dz = entry.z - center.z;
+                     if (dx * dx + dz * dz <= radius_squared) {
+                       visit(id);
+                     }
+                   });
+}
+
+#endif  // GDEXTENSION_SPATIAL_GRID_H
@@ -0,0 +1,110 @@
+#include "state_checksum.hpp"
+
+#include <cstring>
+
+#include "fixed_point.hpp"
+
+namespace {
+const char* const WORD_NAMES[StateChecksum::WORD_COUNT] = {
+    "occupied",        "position_x",    "position_y",
+    "position_z",      "order",         "order_target",
+    "queued_orders",   "health",        "attack_cooldown",
+    "attack_windup",
+};
+
+// murmur3 finalizer.
+inline uint32_t mix_lane(uint32_t hash) {
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6Bu;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35u;
+  hash ^= hash >> 16;
+  return hash;
+}
+}  // namespace
+
+const char* StateChecksum::get_word_name(int32_t word) {
+  if (word < 0 || word >= WORD_COUNT) {
+    return "";
+  }
+  return WORD_NAMES[word];
+}
+
+void StateChecksum::ensure_slot(int32_t slot) {
+  if (slot < slot_count) {
+    return;
+  }
+  slot_count = slot + 1;
+  for (std::vector<uint32_t>& word : words) {
+    word.resize(slot_count, 0);
+  }
+  lane_hashes.resize(slot_count, 0);
+}
+
+void StateChecksum::clear_slot(int32_t slot) {
+  if (slot < 0 || slot >= slot_count) {
+    return;
+  }
+  for (std::vector<uint32_t>& word : words) {
+    word[slot] = 0;
+  }
+}
+
+int32_t StateChecksum::get_slot_count() const {
+  return slot_count;
+}
+
+uint64_t StateChecksum::compute(uint64_t extra) {
+  uint32_t* lanes = lane_hashes.data();
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    lanes[slot] = static_cast<uint32_t>(slot) * 0x9E3779B1u;
+  }
+
+  // murmur3 body, one lane per slot. No branches and no cross-lane data, so
+  // each inner loop compiles to packed 32-bit multiplies.
+  for (int32_t word = 0; word < WORD_COUNT; ++word) {
+    const uint32_t* values = words[word].data();
+    for (int32_t slot = 0; slot < slot_count; ++slot) {
+      uint32_t k = values[slot] * 0xCC9E2D51u;
+      k = (k << 15) | (k >> 17);
+      k *= 0x1B873593u;
+      uint32_t h = lanes[slot] ^ k;
+      h = (h << 13) | (h >> 19);
+      lanes[slot] = h * 5u + 0xE6546B64u;
+    }
+  }
+
+  uint64_t sum = 0;
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    lanes[slot] = mix_lane(lanes[slot]);
+    sum += lanes[slot];
+  }
+  return DeterministicRandom::mix(
+      sum ^ (static_cast<uint64_t>(slot_count) << 40) ^
+      DeterministicRandom::mix(extra));
+}
+
+uint32_t StateChecksum::get_lane_hash(int32_t slot) const {
+  if (slot < 0 || slot >= slot_count) {
+    return 0;
+  }
+  return lane_hashes[slot];
+}
+
+const std::vector<uint32_t>& StateChecksum::get_lane_hashes() const {
+  return lane_hashes;
+}
+
+size_t StateChecksum::get_memory_usage() const {
+  size_t bytes = lane_hashes.capacity() * sizeof(uint32_t);
+  for (const std::vector<uint32_t>& word : words) {
+    bytes += word.capacity() * sizeof(uint32_t);
+  }
+  return bytes;
+}
+
+uint32_t float_bits(float value) {
+  uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
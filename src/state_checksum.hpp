@@ -0,0 +1,61 @@
+#ifndef GDEXTENSION_STATE_CHECKSUM_H
+#define GDEXTENSION_STATE_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Simulation-relevant state of every unit as 32-bit words, stored word-major
+// (one array per word, indexed by registry slot) so hashing runs down
+// contiguous arrays in a loop the compiler vectorizes. Units rewrite their
+// words as they simulate; compute() rehashes all slots once per tick.
+class StateChecksum {
+ public:
+  enum Word {
+    OCCUPIED,
+    POSITION_X,
+    POSITION_Y,
+    POSITION_Z,
+    ORDER,
+    ORDER_TARGET,
+    QUEUED_ORDERS,
+    HEALTH,
+    ATTACK_COOLDOWN,
+    ATTACK_WINDUP,
+    WORD_COUNT,
+  };
+
+  static const char* get_word_name(int32_t word);
+
+  void ensure_slot(int32_t slot);
+  // Zeroes the slot's words, which also marks it unoccupied.
+  void clear_slot(int32_t slot);
+  int32_t get_slot_count() const;
+
+  void set_word(int32_t slot, Word word, uint32_t value) {
+    words[word][slot] = value;
+  }
+  uint32_t get_word(int32_t slot, int32_t word) const {
+    return words[word][slot];
+  }
+
+  // Hashes every slot into its lane and folds the lanes, together with
+  // extra (state that does not live in slots, such as projectiles), into
+  // one checksum.
+  uint64_t compute(uint64_t extra);
+  // Per-slot hash from the last compute(); locates the unit that diverged.
+  uint32_t get_lane_hash(int32_t slot) const;
+  const std::vector<uint32_t>& get_lane_hashes() const;
+
+  size_t get_memory_usage() const;
+
+ private:
+  std::vector<uint32_t> words[WORD_COUNT];
+  std::vector<uint32_t> lane_hashes;
+  int32_t slot_count = 0;
+};
+
+// Reinterprets a float's bits for hashing.
+uint32_t float_bits(float value);
+
+#endif  // GDEXTENSION_STATE_CHECKSUM_H
@@ -1,5 +1,8 @@
 #include "test_movement.hpp"
 
+#include "ai_scheduler.hpp"
+#include "match_manager.hpp"
+#include "order_recorder.hpp"
 #include "unit.hpp"
 
 #include <cmath>
@@ -46,36 +49,89 @@ void TestMovement::_bind_methods() {
   ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "wander_radius"),
                "set_wander_radius", "get_wander_radius");
 
+  ClassDB::bind_method(D_METHOD("set_behavior", "behavior"),
+                       &TestMovement::set_behavior);
+  ClassDB::bind_method(D_METHOD("get_behavior"), &TestMovement::get_behavior);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "behavior", godot::PROPERTY_HINT_ENUM,
+                            "Wander,Fight"),
+               "set_behavior", "get_behavior");
+
+  ClassDB::bind_method(D_METHOD("set_aggro_radius", "radius"),
+                       &TestMovement::set_aggro_radius);
+  ClassDB::bind_method(D_METHOD("get_aggro_radius"),
+                       &TestMovement::get_aggro_radius);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "aggro_radius"),
+               "set_aggro_radius", "get_aggro_radius");
+
+  ClassDB::bind_method(D_METHOD("set_objective", "position"),
+                       &TestMovement::set_objective);
+  ClassDB::bind_method(D_METHOD("get_objective"), &TestMovement::get_objective);
+  ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "objective"), "set_objective",
+               "get_objective");
+
+  ClassDB::bind_method(D_METHOD("set_use_objective", "enabled"),
+                       &TestMovement::set_use_objective);
+  ClassDB::bind_method(D_METHOD("get_use_objective"),
+                       &TestMovement::get_use_objective);
+  ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_objective"),
+               "set_use_objective", "get_use_objective");
+
   ClassDB::bind_method(D_METHOD("reset_origin"), &TestMovement::reset_origin);
   ClassDB::bind_method(D_METHOD("wander_once"), &TestMovement::wander_once);
+  ClassDB::bind_method(D_METHOD("fight_once"), &TestMovement::fight_once);
+  ClassDB::bind_method(D_METHOD("decide"), &TestMovement::decide);
 }
 
-void TestMovement::_ready() {
+void TestMovement::_enter_tree() {
   if (Engine::get_singleton()->is_editor_hint()) {
     return;
   }
 
-  set_physics_process(true);
+  // Entered again for every spawn of a pooled unit, after the unit has
+  // registered.
+  _claim_unit(enabled);
+  MatchManager* match = MatchManager::find_for(this);
+  AIScheduler* scheduler =
+      match != nullptr ? match->get_ai_scheduler() : nullptr;
+  if (scheduler != nullptr) {
+    scheduler_id = scheduler->get_instance_id();
+    scheduler_agent = scheduler->register_agent(this);
+  }
+}
 
-  rng.instantiate();
-  rng->randomize();
+void TestMovement::_exit_tree() {
+  _claim_unit(false);
+  if (scheduler_agent < 0) {
+    return;
+  }
 
-  reset_origin();
-  time_until_next = interval_seconds;
+  // The scheduler may leave the tree, or be freed, first.
+  auto scheduler = Object::cast_to<AIScheduler>(
+      godot::ObjectDB::get_instance(scheduler_id));
+  if (scheduler != nullptr) {
+    scheduler->unregister_agent(scheduler_agent);
+  }
+  scheduler_agent = -1;
 }
 
-void TestMovement::_physics_process(double delta) {
+void TestMovement::_ready() {
   if (Engine::get_singleton()->is_editor_hint()) {
     return;
   }
 
-  if (!enabled) {
+  set_physics_process(scheduler_agent < 0);
+
+  reset_origin();
+  time_until_next = interval_seconds;
+}
+
+void TestMovement::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
     return;
   }
 
-  _ensure_origin();
-
-  if (!has_origin || interval_seconds <= 0.0) {
+  // Decided by the scheduler instead.
+  if (!enabled || interval_seconds <= 0.0 || scheduler_agent >= 0) {
     return;
   }
 
@@ -84,7 +140,7 @@ void TestMovement::_physics_process(double delta) {
     return;
   }
 
-  wander_once();
+  decide();
   time_until_next += interval_seconds;
 }
 
@@ -101,6 +157,9 @@ PackedStringArray TestMovement::_get_configuration_warnings() const {
 
 void TestMovement::set_enabled(bool new_enabled) {
   enabled = new_enabled;
+  if (is_inside_tree()) {
+    _claim_unit(enabled);
+  }
 }
 
 bool TestMovement::get_enabled() const {
@@ -133,6 +192,39 @@ double TestMovement::get_wander_radius() const {
   return wander_radius;
 }
 
+void TestMovement::set_behavior(int32_t new_behavior) {
+  behavior = new_behavior == BEHAVIOR_FIGHT ? BEHAVIOR_FIGHT : BEHAVIOR_WANDER;
+  engaged_slot = -1;
+}
+
+int32_t TestMovement::get_behavior() const {
+  return behavior;
+}
+
+void TestMovement::set_aggro_radius(double radius) {
+  aggro_radius = radius < 0.0 ? 0.0 : radius;
+}
+
+double TestMovement::get_aggro_radius() const {
+  return aggro_radius;
+}
+
+void TestMovement::set_objective(const Vector3& position) {
+  objective = position;
+}
+
+Vector3 TestMovement::get_objective() const {
+  return objective;
+}
+
+void TestMovement::set_use_objective(bool enabled) {
+  use_objective = enabled;
+}
+
+bool TestMovement::get_use_objective() const {
+  return use_objective;
+}
+
 void TestMovement::reset_origin() {
   Unit* unit = _get_unit();
   if (unit == nullptr || !unit->is_inside_tree()) {
@@ -161,16 +253,18 @@ void TestMovement::wander_once() {
     return;
   }
 
-  if (rng.is_null()) {
-    rng.instantiate();
-    rng->randomize();
-  }
+  Vector3 offset;
+  if (unit->is_deterministic()) {
+    offset = _deterministic_offset(unit);
+  } else {
+    _ensure_rng(unit);
 
-  const double angle = rng->randf_range(0.0, 2.0 * Math_PI);
-  const double distance = std::sqrt(rng->randf()) * wander_radius;
+    const double angle = rng->randf_range(0.0, 2.0 * Math_PI);
+    const double distance = std::sqrt(rng->randf()) * wander_radius;
 
-  Vector3 offset =
-      Vector3(std::cos(angle) * distance, 0.0, std::sin(angle) * distance);
+    offset =
+        Vector3(std::cos(angle) * distance, 0.0, std::sin(angle) * distance);
+  }
 
   Vector3 target = origin_position + offset;
   target.y = origin_position.y;
@@ -178,6 +272,102 @@ void TestMovement::wander_once() {
   unit->issue_move_order(target);
 }
 
+void TestMovement::fight_once() {
+  Unit* unit = _get_unit();
+  if (unit == nullptr || !unit->is_inside_tree() ||
+      unit->get_unit_registry() == nullptr) {
+    return;
+  }
+
+  const int32_t enemy_slot = _find_enemy(unit);
+  if (enemy_slot >= 0) {
+    // Re-issuing the same attack would restart the chase every decision.
+    if (enemy_slot != engaged_slot ||
+        unit->get_current_order() != OrderType::ATTACK) {
+      unit->issue_attack_order(unit->get_unit_registry()->get_unit(enemy_slot));
+      engaged_slot = enemy_slot;
+    }
+    return;
+  }
+
+  engaged_slot = -1;
+  if (use_objective && unit->get_current_order() != OrderType::MOVE) {
+    unit->issue_move_order(objective);
+  }
+}
+
+void TestMovement::decide() {
+  if (!enabled || interval_seconds <= 0.0) {
+    return;
+  }
+
+  _ensure_origin();
+  if (!has_origin) {
+    return;
+  }
+
+  if (behavior == BEHAVIOR_FIGHT) {
+    fight_once();
+  } else {
+    wander_once();
+  }
+}
+
+int32_t TestMovement::_find_enemy(const Unit* unit) const {
+  const UnitRegistry& registry = *unit->get_unit_registry();
+  const int32_t own_slot = unit->get_registry_slot();
+  const int32_t faction = registry.get_faction(own_slot);
+  const Vector3& position = registry.get_position(own_slot);
+  const float aggro_squared = static_cast<float>(aggro_radius * aggro_radius);
+
+  // Under fog of war only what the faction sees can be picked.
+  const VisibilityGrid& visibility = registry.get_visibility_grid();
+  const bool fogged = visibility.is_enabled();
+  const int32_t layer = fogged ? visibility.find_layer(faction) : -1;
+  if (fogged && layer < 0) {
+    return -1;
+  }
+
+  // Whoever hurt the unit most comes first while it is within reach.
+  const int32_t threat =
+      registry.get_threat_table().get_top_threat(own_slot);
+  if (threat != ThreatTable::NONE && registry.get_faction(threat) != faction &&
+      registry.get_health_ratio(threat) > 0.0f &&
+      (!fogged || visibility.is_slot_visible(layer, threat)) &&
+      registry.get_position(threat).distance_squared_to(position) <=
+          aggro_squared) {
+    return threat;
+  }
+
+  int32_t nearest = -1;
+  float nearest_distance = 0.0f;
+  registry.get_spatial_grid().for_each_in_radius(
+      position, static_cast<float>(aggro_radius), [&](int32_t slot) {
+        if (registry.get_faction(slot) == faction ||
+            registry.get_health_ratio(slot) <= 0.0f ||
+            (fogged && !visibility.is_slot_visible(layer, slot))) {
+          return;
+        }
+        const float distance =
+            registry.get_position(slot).distance_squared_to(position);
+        // Ties go to the lower slot so deterministic matches agree.
+        if (nearest < 0 || distance < nearest_distance ||
+            (distance == nearest_distance && slot < nearest)) {
+          nearest = slot;
+          nearest_distance = distance;
+        }
+      });
+  return nearest;
+}
+
+void TestMovement::_claim_unit(bool claim) {
+  Unit* unit = _get_unit();
+  if (unit != nullptr && unit->get_unit_registry() != nullptr) {
+    unit->get_unit_registry()->set_bot_controlled(unit->get_registry_slot(),
+                                                  claim);
+  }
+}
+
 Unit* TestMovement::_get_unit() const {
   Node* parent = get_parent();
   if (parent == nullptr) {
@@ -187,6 +377,42 @@ Unit* TestMovement::_get_unit() const {
   return Object::cast_to<Unit>(parent);
 }
 
+void TestMovement::_ensure_rng(const Unit* unit) {
+  if (rng.is_valid()) {
+    return;
+  }
+  rng.instantiate();
+
+  // Seeded from the match recorder so recorded matches wander the same way
+  // when replayed.
+  MatchManager* match = MatchManager::find_for(unit);
+  OrderRecorder* recorder =
+      match != nullptr ? match->get_order_recorder() : nullptr;
+  if (recorder != nullptr && (recorder->is_recording() ||
+                              recorder->is_replaying())) {
+    rng->set_seed(recorder->get_unit_seed(unit->get_registry_slot()));
+  } else {
+    rng->randomize();
+  }
+}
+
+Vector3 TestMovement::_deterministic_offset(Unit* unit) const {
+  // Rejection sampling in the unit's fixed-point stream: no trigonometry,
+  // whose results differ between math libraries.
+  DeterministicRandom& random = unit->get_random();
+  const Fixed radius = Fixed::from_float(wander_radius);
+  const int64_t radius_squared = static_cast<int64_t>(radius.raw) * radius.raw;
+  Fixed x;
+  Fixed z;
+  do {
+    x = random.next_signed(radius);
+    z = random.next_signed(radius);
+  } while (static_cast<int64_t>(x.raw) * x.raw +
+               static_cast<int64_t>(z.raw) * z.raw >
+           radius_squared);
+  return Vector3(x.to_float(), 0.0f, z.to_float());
+}
+
 void TestMovement::_ensure_origin() {
   if (has_origin) {
     return;
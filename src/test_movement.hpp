@@ -6,12 +6,21 @@
 #include <godot_cpp/variant/packed_string_array.hpp>
 #include <godot_cpp/variant/vector3.hpp>
 
+class AIScheduler;
 class Unit;
 
 using godot::Node;
 using godot::PackedStringArray;
 using godot::Vector3;
 
+// Simple bot for a unit. WANDER moves to random points around the spawn
+// position; FIGHT attacks the living enemy within aggro_radius that hurt it
+// most, or else the nearest one, and otherwise walks toward the objective,
+// which is enough to play out bot matches (see SelfPlayRunner). Under fog
+// of war it only attacks enemies its faction sees.
+//
+// When the match has an AIScheduler the bot registers with it and decides
+// when the scheduler says so; otherwise it keeps its own timer.
 class TestMovement : public Node {
   GDCLASS(TestMovement, Node)
 
@@ -19,9 +28,16 @@ class TestMovement : public Node {
   static void _bind_methods();
 
  public:
+  enum Behavior {
+    BEHAVIOR_WANDER,
+    BEHAVIOR_FIGHT,
+  };
+
   TestMovement();
   ~TestMovement();
 
+  void _enter_tree() override;
+  void _exit_tree() override;
   void _ready() override;
   void _physics_process(double delta) override;
   PackedStringArray _get_configuration_warnings() const override;
@@ -35,21 +51,52 @@ class TestMovement : public Node {
   void set_wander_radius(double radius);
   double get_wander_radius() const;
 
+  void set_behavior(int32_t new_behavior);
+  int32_t get_behavior() const;
+
+  void set_aggro_radius(double radius);
+  double get_aggro_radius() const;
+
+  // Where FIGHT bots head while no enemy is in range. Only used with
+  // use_objective set; the bot holds its position otherwise.
+  void set_objective(const Vector3& position);
+  Vector3 get_objective() const;
+  void set_use_objective(bool enabled);
+  bool get_use_objective() const;
+
   void reset_origin();
   void wander_once();
+  void fight_once();
+  // One decision of the configured behavior; called on every interval.
+  void decide();
 
  private:
   Unit* _get_unit() const;
+  // Marks the unit as driven by this bot, so UtilityAI skips it.
+  void _claim_unit(bool claim);
   void _ensure_origin();
+  void _ensure_rng(const Unit* unit);
+  Vector3 _deterministic_offset(Unit* unit) const;
+  // Slot of the living enemy within aggro_radius that dealt the unit the
+  // most damage, else the nearest one; -1 when there is none.
+  int32_t _find_enemy(const Unit* unit) const;
 
   bool enabled = true;
   double interval_seconds = 5.0;
   double wander_radius = 5.0;
+  Behavior behavior = BEHAVIOR_WANDER;
+  double aggro_radius = 15.0;
+  Vector3 objective;
+  bool use_objective = false;
+  int32_t engaged_slot = -1;  // Enemy the last FIGHT decision attacked
 
   bool has_origin = false;
   Vector3 origin_position;
   double time_until_next = 0.0;
 
+  uint64_t scheduler_id = 0;  // Instance id of the AIScheduler, if any
+  int32_t scheduler_agent = -1;
+
   godot::Ref<godot::RandomNumberGenerator> rng;
 };
 
@@ -0,0 +1,197 @@
+#include "threat_table.hpp"
+
+#include <algorithm>
+
+void ThreatTable::reset_slot(int32_t slot) {
+  _ensure_slot(slot);
+  disengage(slot);
+  remove_source(slot);
+
+  for (const Threat& threat : threats[slot]) {
+    std::vector<int32_t>& victims = threatened[threat.source];
+    auto found = std::find(victims.begin(), victims.end(), slot);
+    if (found != victims.end()) {
+      victims.erase(found);
+    }
+  }
+  threats[slot].clear();
+  top_sources[slot] = NONE;
+  top_amounts[slot] = 0.0f;
+
+  // Any attacker still listed lost its target without being told.
+  for (const int32_t attacker : attackers[slot]) {
+    engaged_targets[attacker] = NONE;
+  }
+  attackers[slot].clear();
+}
+
+void ThreatTable::add_threat(int32_t victim, int32_t source, float amount) {
+  if (victim == source || amount <= 0.0f) {
+    return;
+  }
+  _ensure_slot(std::max(victim, source));
+
+  std::vector<Threat>& victim_threats = threats[victim];
+  auto found = std::find_if(
+      victim_threats.begin(), victim_threats.end(),
+      [source](const Threat& threat) { return threat.source == source; });
+  if (found == victim_threats.end()) {
+    victim_threats.push_back(Threat{source, 0.0f});
+    found = victim_threats.end() - 1;
+    threatened[source].push_back(victim);
+  }
+  found->amount += amount;
+
+  // Threat only grows here, so the top can only be overtaken.
+  const int32_t top = top_sources[victim];
+  if (top == NONE || found->amount > top_amounts[victim] ||
+      (found->amount == top_amounts[victim] && source < top)) {
+    top_sources[victim] = source;
+    top_amounts[victim] = found->amount;
+  } else if (top == source) {
+    top_amounts[victim] = found->amount;
+  }
+}
+
+float ThreatTable::get_threat(int32_t victim, int32_t source) const {
+  if (victim < 0 || victim >= static_cast<int32_t>(threats.size())) {
+    return 0.0f;
+  }
+  for (const Threat& threat : threats[victim]) {
+    if (threat.source == source) {
+      return threat.amount;
+    }
+  }
+  return 0.0f;
+}
+
+int32_t ThreatTable::get_top_threat(int32_t victim) const {
+  if (victim < 0 || victim >= static_cast<int32_t>(top_sources.size())) {
+    return NONE;
+  }
+  return top_sources[victim];
+}
+
+void ThreatTable::remove_source(int32_t source) {
+  if (source < 0 || source >= static_cast<int32_t>(threatened.size())) {
+    return;
+  }
+  for (const int32_t victim : threatened[source]) {
+    _remove_threat(victim, source);
+  }
+  threatened[source].clear();
+}
+
+void ThreatTable::engage(int32_t attacker, int32_t target) {
+  if (attacker == target) {
+    return;
+  }
+  _ensure_slot(std::max(attacker, target));
+  if (engaged_targets[attacker] == target) {
+    return;
+  }
+
+  disengage(attacker);
+  engaged_targets[attacker] = target;
+  attacker_positions[attacker] =
+      static_cast<int32_t>(attackers[target].size());
+  attackers[target].push_back(attacker);
+}
+
+void ThreatTable::disengage(int32_t attacker) {
+  if (attacker < 0 ||
+      attacker >= static_cast<int32_t>(engaged_targets.size())) {
+    return;
+  }
+  const int32_t target = engaged_targets[attacker];
+  if (target == NONE) {
+    return;
+  }
+
+  // Swap-remove, moving the last attacker into the freed position.
+  std::vector<int32_t>& list = attackers[target];
+  const int32_t position = attacker_positions[attacker];
+  list[position] = list.back();
+  attacker_positions[list[position]] = position;
+  list.pop_back();
+  engaged_targets[attacker] = NONE;
+}
+
+int32_t ThreatTable::get_engaged_target(int32_t attacker) const {
+  if (attacker < 0 ||
+      attacker >= static_cast<int32_t>(engaged_targets.size())) {
+    return NONE;
+  }
+  return engaged_targets[attacker];
+}
+
+int32_t ThreatTable::get_attacker_count(int32_t target) const {
+  if (target < 0 || target >= static_cast<int32_t>(attackers.size())) {
+    return 0;
+  }
+  return static_cast<int32_t>(attackers[target].size());
+}
+
+int32_t ThreatTable::get_attacker(int32_t target, int32_t index) const {
+  return attackers[target][index];
+}
+
+size_t ThreatTable::get_memory_usage() const {
+  size_t bytes = top_sources.capacity() * sizeof(int32_t) +
+                 top_amounts.capacity() * sizeof(float) +
+                 engaged_targets.capacity() * sizeof(int32_t) +
+                 attacker_positions.capacity() * sizeof(int32_t);
+  for (const std::vector<Threat>& list : threats) {
+    bytes += sizeof(list) + list.capacity() * sizeof(Threat);
+  }
+  for (const std::vector<int32_t>& list : threatened) {
+    bytes += sizeof(list) + list.capacity() * sizeof(int32_t);
+  }
+  for (const std::vector<int32_t>& list : attackers) {
+    bytes += sizeof(list) + list.capacity() * sizeof(int32_t);
+  }
+  return bytes;
+}
+
+void ThreatTable::_ensure_slot(int32_t slot) {
+  if (slot < static_cast<int32_t>(top_sources.size())) {
+    return;
+  }
+  const size_t size = static_cast<size_t>(slot) + 1;
+  threats.resize(size);
+  top_sources.resize(size, NONE);
+  top_amounts.resize(size, 0.0f);
+  threatened.resize(size);
+  engaged_targets.resize(size, NONE);
+  attacker_positions.resize(size, 0);
+  attackers.resize(size);
+}
+
+void ThreatTable::_remove_threat(int32_t victim, int32_t source) {
+  std::vector<Threat>& victim_threats = threats[victim];
+  auto found = std::find_if(
+      victim_threats.begin(), victim_threats.end(),
+      [source](const Threat& threat) { return threat.source == source; });
+  if (found == victim_threats.end()) {
+    return;
+  }
+  *found = victim_threats.back();
+  victim_threats.pop_back();
+  if (top_sources[victim] == source) {
+    _refresh_top(victim);
+  }
+}
+
+void ThreatTable::_refresh_top(int32_t victim) {
+  int32_t top = NONE;
+  float top_amount = 0.0f;
+  for (const Threat& threat : threats[victim]) {
+    if (top == NONE || threat.amount > top_amount ||
+        (threat.amount == top_amount && threat.source < top)) {
+      top = threat.source;
+      top_amount = threat.amount;
+    }
+  }
+  top_sources[victim] = top;
+  top_amounts[victim] = top_amount;
+}
@@ -0,0 +1,64 @@
+#ifndef GDEXTENSION_THREAT_TABLE_H
+#define GDEXTENSION_THREAT_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Who threatens whom, by registry slot.
+//
+// Threat is the damage a unit took from each source, accumulated as it is
+// dealt; the highest source is kept up to date so AI can read it without a
+// scan. Engagements are the current attack orders, indexed both ways, so a
+// unit that dies or leaves can notify exactly the units attacking it
+// instead of every attacker polling its target each tick.
+class ThreatTable {
+ public:
+  static constexpr int32_t NONE = -1;
+
+  // Forgets everything about the slot, as victim, source and attacker. The
+  // slot's attackers must have been released first.
+  void reset_slot(int32_t slot);
+
+  void add_threat(int32_t victim, int32_t source, float amount);
+  float get_threat(int32_t victim, int32_t source) const;
+  // Source with the most threat on victim, ties to the lower slot; NONE
+  // when nothing damaged it.
+  int32_t get_top_threat(int32_t victim) const;
+  // Removes the source's threat from every unit it damaged (source died).
+  void remove_source(int32_t source);
+
+  void engage(int32_t attacker, int32_t target);
+  void disengage(int32_t attacker);
+  int32_t get_engaged_target(int32_t attacker) const;
+  int32_t get_attacker_count(int32_t target) const;
+  // Newest engagements last.
+  int32_t get_attacker(int32_t target, int32_t index) const;
+
+  size_t get_memory_usage() const;
+
+ private:
+  struct Threat {
+    int32_t source = NONE;
+    float amount = 0.0f;
+  };
+
+  void _ensure_slot(int32_t slot);
+  void _remove_threat(int32_t victim, int32_t source);
+  void _refresh_top(int32_t victim);
+
+  // Per victim.
+  std::vector<std::vector<Threat>> threats;
+  std::vector<int32_t> top_sources;
+  std::vector<float> top_amounts;
+  // Per source, the victims holding threat from it.
+  std::vector<std::vector<int32_t>> threatened;
+
+  // Per attacker, and its position in the target's attacker list.
+  std::vector<int32_t> engaged_targets;
+  std::vector<int32_t> attacker_positions;
+  // Per target.
+  std::vector<std::vector<int32_t>> attackers;
+};
+
+#endif  // GDEXTENSION_THREAT_TABLE_H
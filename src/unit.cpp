@@ -3,20 +3,27 @@
 #include "attack_component.hpp"
 #include "health_component.hpp"
 #include "interactable.hpp"
+#include "match_client.hpp"
+#include "match_manager.hpp"
 #include "movement_component.hpp"
+#include "order_recorder.hpp"
 
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/visual_instance3d.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/object.hpp>
 #include <godot_cpp/core/property_info.hpp>
 #include <godot_cpp/variant/packed_string_array.hpp>
 #include <godot_cpp/variant/string.hpp>
+#include <godot_cpp/variant/basis.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
 #include <godot_cpp/variant/string_name.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <godot_cpp/variant/variant.hpp>
 #include <godot_cpp/variant/vector3.hpp>
 
+using godot::Basis;
 using godot::ClassDB;
 using godot::D_METHOD;
 using godot::Engine;
@@ -27,6 +34,7 @@ using godot::StringName;
 using godot::UtilityFunctions;
 using godot::Variant;
 using godot::Vector3;
+using godot::VisualInstance3D;
 
 Unit::Unit() = default;
 
@@ -40,6 +48,31 @@ void Unit::_bind_methods() {
   ClassDB::bind_method(D_METHOD("issue_interact_order", "target"),
                        &Unit::issue_interact_order);
   ClassDB::bind_method(D_METHOD("stop_order"), &Unit::stop_order);
+  ClassDB::bind_method(D_METHOD("teleport", "position"), &Unit::teleport);
+  ClassDB::bind_method(D_METHOD("reset_for_spawn"), &Unit::reset_for_spawn);
+
+  ClassDB::bind_method(D_METHOD("get_handle"), &Unit::get_handle);
+
+  ClassDB::bind_method(D_METHOD("get_highest_threat"),
+                       &Unit::get_highest_threat);
+  ClassDB::bind_method(D_METHOD("get_threat_from", "source"),
+                       &Unit::get_threat_from);
+  ClassDB::bind_method(D_METHOD("get_attacker_count"),
+                       &Unit::get_attacker_count);
+
+  ClassDB::bind_method(D_METHOD("queue_move_order", "position"),
+                       &Unit::queue_move_order);
+  ClassDB::bind_method(D_METHOD("queue_attack_order", "target"),
+                       &Unit::queue_attack_order);
+  ClassDB::bind_method(D_METHOD("queue_interact_order", "target"),
+                       &Unit::queue_interact_order);
+  ClassDB::bind_method(D_METHOD("clear_order_queue"),
+                       &Unit::clear_order_queue);
+  ClassDB::bind_method(D_METHOD("get_queued_order_count"),
+                       &Unit::get_queued_order_count);
+  ClassDB::bind_static_method("Unit",
+                              D_METHOD("append_order_queue", "units", "orders"),
+                              &Unit::append_order_queue);
 
   ClassDB::bind_method(D_METHOD("set_desired_location", "location"),
                        &Unit::set_desired_location);
@@ -68,18 +101,88 @@ void Unit::_bind_methods() {
   ADD_PROPERTY(PropertyInfo(Variant::INT, "faction_id"), "set_faction_id",
                "get_faction_id");
 
+  ClassDB::bind_method(D_METHOD("set_sight_radius", "radius"),
+                       &Unit::set_sight_radius);
+  ClassDB::bind_method(D_METHOD("get_sight_radius"), &Unit::get_sight_radius);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "sight_radius"),
+               "set_sight_radius", "get_sight_radius");
+
+  ClassDB::bind_method(D_METHOD("set_visual_archetype", "archetype"),
+                       &Unit::set_visual_archetype);
+  ClassDB::bind_method(D_METHOD("get_visual_archetype"),
+                       &Unit::get_visual_archetype);
+  ADD_PROPERTY(PropertyInfo(Variant::STRING_NAME, "visual_archetype"),
+               "set_visual_archetype", "get_visual_archetype");
+
+  ClassDB::bind_method(D_METHOD("set_tint_color", "color"),
+                       &Unit::set_tint_color);
+  ClassDB::bind_method(D_METHOD("get_tint_color"), &Unit::get_tint_color);
+  ADD_PROPERTY(PropertyInfo(Variant::COLOR, "tint_color"), "set_tint_color",
+               "get_tint_color");
+
+  ClassDB::bind_method(D_METHOD("set_facing_yaw", "yaw"),
+                       &Unit::set_facing_yaw);
+  ClassDB::bind_method(D_METHOD("get_facing_yaw"), &Unit::get_facing_yaw);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "facing_yaw",
+                            godot::PROPERTY_HINT_NONE, "",
+                            godot::PROPERTY_USAGE_NONE),
+               "set_facing_yaw", "get_facing_yaw");
+
   ADD_SIGNAL(MethodInfo("order_changed",
                         PropertyInfo(Variant::INT, "previous_order"),
                         PropertyInfo(Variant::INT, "new_order"),
                         PropertyInfo(Variant::OBJECT, "target")));
 }
 
+void Unit::_enter_tree() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  MatchManager* match = MatchManager::find_for(this);
+  if (match == nullptr) {
+    return;
+  }
+
+  facing_yaw = get_global_transform().basis.get_euler().y;
+  fixed_position = FixedVector3::from_vector3(get_global_position());
+  match_manager = match;
+  unit_registry = &match->get_unit_registry();
+  registry_slot = unit_registry->register_unit(this);
+  unit_registry->set_pose(registry_slot, get_global_position(), facing_yaw);
+  unit_registry->set_faction(registry_slot, faction_id);
+  unit_registry->set_sight_radius(registry_slot, sight_radius);
+  unit_registry->set_tint(registry_slot, tint_color);
+  unit_registry->set_archetype(registry_slot, visual_archetype);
+  if (visual_parts_collected) {
+    unit_registry->set_visuals(registry_slot, visual_parts);
+  }
+  random.seed(match->get_unit_seed(registry_slot));
+}
+
+void Unit::_exit_tree() {
+  if (unit_registry == nullptr) {
+    return;
+  }
+
+  release_attackers();
+  unit_registry->unregister_unit(registry_slot);
+  match_manager = nullptr;
+  unit_registry = nullptr;
+  registry_slot = UnitRegistry::INVALID_SLOT;
+}
+
 void Unit::_ready() {
   if (Engine::get_singleton()->is_editor_hint()) {
     return;
   }
   movement_component = Object::cast_to<MovementComponent>(
       get_component_by_class("MovementComponent"));
+
+  if (unit_registry != nullptr) {
+    _collect_visual_parts();
+    unit_registry->set_visuals(registry_slot, visual_parts);
+  }
 }
 
 void Unit::_physics_process(double delta) {
@@ -87,6 +190,14 @@ void Unit::_physics_process(double delta) {
     return;
   }
 
+  // Deterministic matches step their units themselves, in slot order.
+  if (is_deterministic()) {
+    return;
+  }
+  simulate_tick(delta);
+}
+
+void Unit::simulate_tick(double delta) {
   // Safety check - unit must be in tree to function
   if (!is_inside_tree()) {
     return;
@@ -100,49 +211,57 @@ void Unit::_physics_process(double delta) {
 
   // Handle order-specific logic
   bool should_attempt_attack = false;
+  Unit* target = nullptr;
 
   if (current_order == OrderType::ATTACK) {
-    if (attack_target == nullptr || !attack_target->is_inside_tree()) {
-      stop_order();
+    // No poll of the target: when it dies or leaves it clears attack_target
+    // itself (see release_attackers()).
+    if (unit_registry != nullptr) {
+      target = unit_registry->resolve(attack_target);
+    }
+    if (target == nullptr) {
+      _complete_current_order();
     } else {
-      // Check if target is dead
-      HealthComponent* target_health = attack_target->get_health_component();
-      if (target_health != nullptr && target_health->is_dead()) {
-        stop_order();
-      } else {
-        const Vector3 target_pos = attack_target->get_global_position();
-        desired_location = target_pos;
-
-        // Check if target is within attack range
-        Vector3 current_position = get_global_position();
-        Vector3 to_target = target_pos - current_position;
-        to_target.y = 0.0f;
-        const float distance_to_target = to_target.length();
-
-        // Get attack range from AttackComponent
-        AttackComponent* attack_comp = get_attack_component();
-        float effective_attack_range = auto_attack_range;
-        if (attack_comp != nullptr) {
-          effective_attack_range = attack_comp->get_attack_range();
-        }
-
-        // Hysteresis: stop when within range, but resume only when far enough
-        // away. This prevents jitter from continuous start/stop cycles.
-        const float resume_distance =
-            effective_attack_range + attack_buffer_range;
-        if (distance_to_target <= effective_attack_range) {
-          // In attack range - stop movement and attempt attack
-          should_attempt_attack = true;
-          // Still use MovementComponent to face target while attacking
-        } else if (distance_to_target <= resume_distance) {
-          // In the buffer zone: keep moving toward target
-          // MovementComponent will handle the movement and rotation
-        }
+      const Vector3 target_pos = target->get_global_position();
+      desired_location = target_pos;
+
+      // Check if target is within attack range
+      Vector3 current_position = get_global_position();
+      Vector3 to_target = target_pos - current_position;
+      to_target.y = 0.0f;
+      const float distance_to_target = to_target.length();
+
+      // Get attack range from AttackComponent
+      AttackComponent* attack_comp = get_attack_component();
+      float effective_attack_range = auto_attack_range;
+      if (attack_comp != nullptr) {
+        effective_attack_range = attack_comp->get_attack_range();
+      }
+
+      // Deterministic matches decide on the fixed positions instead.
+      const bool in_attack_range =
+          is_deterministic()
+              ? (target->get_fixed_position() - fixed_position)
+                        .horizontal_length() <=
+                    Fixed::from_float(effective_attack_range)
+              : distance_to_target <= effective_attack_range;
+
+      // Hysteresis: stop when within range, but resume only when far enough
+      // away. This prevents jitter from continuous start/stop cycles.
+      const float resume_distance =
+          effective_attack_range + attack_buffer_range;
+      if (in_attack_range) {
+        // In attack range - stop movement and attempt attack
+        should_attempt_attack = true;
+        // Still use MovementComponent to face target while attacking
+      } else if (distance_to_target <= resume_distance) {
+        // In the buffer zone: keep moving toward target
+        // MovementComponent will handle the movement and rotation
       }
     }
   } else if (current_order == OrderType::INTERACT) {
     if (interact_target == nullptr || !interact_target->is_inside_tree()) {
-      stop_order();
+      _complete_current_order();
     } else {
       desired_location = interact_target->get_global_position();
     }
@@ -152,67 +271,306 @@ void Unit::_physics_process(double delta) {
   // MovementComponent handles movement AND rotation via
   // _face_horizontal_direction()
   Vector3 movement_velocity = Vector3(0, 0, 0);
+  FixedVector3 fixed_velocity;
   if (movement_component != nullptr && movement_component->is_inside_tree()) {
-    movement_velocity = movement_component->process_movement(
-        delta, desired_location, current_order);
+    if (is_deterministic()) {
+      fixed_velocity = movement_component->process_fixed_movement(
+          fixed_position, desired_location, current_order);
+    } else {
+      movement_velocity = movement_component->process_movement(
+          delta, desired_location, current_order);
+    }
   } else if (movement_component != nullptr) {
     // Component was queued for deletion, clear our reference
     movement_component = nullptr;
   }
 
+  // Arriving completes MOVE/INTERACT only when something is queued behind
+  // them; otherwise the order stays current as before.
+  if (!order_queue.is_empty() &&
+      (current_order == OrderType::MOVE ||
+       current_order == OrderType::INTERACT) &&
+      movement_component != nullptr &&
+      movement_component->is_navigation_ready() &&
+      (is_deterministic() ? movement_component->is_at_fixed_destination(
+                                fixed_position, desired_location)
+                          : movement_component->is_at_destination())) {
+    _complete_current_order();
+  }
+
   // If we should attack, zero out movement but keep the rotation from above
   if (should_attempt_attack) {
     movement_velocity = Vector3(0, 0, 0);
+    fixed_velocity = FixedVector3();
 
     AttackComponent* attack_comp = get_attack_component();
     if (attack_comp != nullptr) {
-      attack_comp->try_fire_at(attack_target, delta);
+      attack_comp->try_fire_at(target, delta);
     } else {
       UtilityFunctions::push_error(
           "[Unit] ATTACK order requires AttackComponent");
-      stop_order();
+      order_queue.clear();
+      _halt();
+    }
+  }
+
+  if (is_deterministic()) {
+    // Components are children and would step after the unit; keep that
+    // order.
+    AttackComponent* attack_comp = get_attack_component();
+    if (attack_comp != nullptr) {
+      attack_comp->advance_timers(delta);
     }
+
+    // Fixed-point integration instead of move_and_slide(): the physics
+    // server is not deterministic across machines. Deterministic units
+    // therefore neither collide nor fall; height stays as placed.
+    fixed_position = fixed_position +
+                     fixed_velocity * match_manager->get_fixed_tick_length();
+    set_global_position(fixed_position.to_vector3());
+  } else {
+    // Apply gravity and move
+    Vector3 velocity = movement_velocity;
+    velocity.y = get_velocity().y;
+    set_velocity(velocity);
+    move_and_slide();
+  }
+
+  if (unit_registry != nullptr) {
+    unit_registry->set_pose(registry_slot, get_global_position(), facing_yaw);
+    _publish_sim_state();
+  }
+}
+
+OrderType Unit::get_current_order() const {
+  return current_order;
+}
+
+void Unit::predict_movement_step(double delta,
+                                 OrderType order,
+                                 const Vector3& destination) {
+  if (movement_component == nullptr || !movement_component->is_inside_tree()) {
+    return;
   }
 
-  // Apply gravity and move
-  Vector3 velocity = movement_velocity;
+  Vector3 velocity =
+      movement_component->process_movement(delta, destination, order);
   velocity.y = get_velocity().y;
   set_velocity(velocity);
   move_and_slide();
+  if (unit_registry != nullptr) {
+    unit_registry->set_pose(registry_slot, get_global_position(), facing_yaw);
+  }
 }
 
 void Unit::issue_move_order(const Vector3& position) {
-  _clear_order_targets();
-  _set_order(OrderType::MOVE, nullptr);
-  desired_location = position;
+  UnitOrder order;
+  order.type = OrderType::MOVE;
+  order.position = position;
+  if (!_accept_issued_order(order, false)) {
+    return;
+  }
+  order_queue.clear();
+  _start_move_order(position);
 }
 
 void Unit::issue_attack_order(Unit* target) {
-  _clear_order_targets();
-  attack_target = target;
-  _set_order(OrderType::ATTACK, target);
+  // Like queued orders (_start_order), a dead target is not worth leaving
+  // the current order for.
+  HealthComponent* target_health =
+      target != nullptr ? target->get_health_component() : nullptr;
+  if (target_health != nullptr && target_health->is_dead()) {
+    return;
+  }
 
-  if (attack_target != nullptr && attack_target->is_inside_tree()) {
-    desired_location = attack_target->get_global_position();
+  UnitOrder order;
+  order.type = OrderType::ATTACK;
+  order.target_id = target != nullptr ? target->get_instance_id() : 0;
+  if (!_accept_issued_order(order, false)) {
+    return;
   }
+  order_queue.clear();
+  _start_attack_order(target);
 }
 
 void Unit::issue_interact_order(Interactable* target) {
-  _clear_order_targets();
-  interact_target = target;
-  _set_order(OrderType::INTERACT, target);
-
-  if (interact_target != nullptr && interact_target->is_inside_tree()) {
-    desired_location = interact_target->get_global_position();
+  UnitOrder order;
+  order.type = OrderType::INTERACT;
+  order.target_id = target != nullptr ? target->get_instance_id() : 0;
+  if (!_accept_issued_order(order, false)) {
+    return;
   }
+  order_queue.clear();
+  _start_interact_order(target);
 }
 
 void Unit::stop_order() {
-  _clear_order_targets();
-  _set_order(OrderType::NONE, nullptr);
+  if (!_accept_issued_order(UnitOrder(), false)) {
+    return;
+  }
+  order_queue.clear();
+  _halt();
+}
 
-  // Stop horizontal movement but keep vertical velocity (gravity).
-  set_velocity(Vector3(0, get_velocity().y, 0));
+void Unit::teleport(const Vector3& position) {
+  set_global_position(position);
+  fixed_position = FixedVector3::from_vector3(position);
+  if (unit_registry != nullptr) {
+    unit_registry->set_pose(registry_slot, position, facing_yaw);
+  }
+}
+
+void Unit::queue_move_order(const Vector3& position) {
+  UnitOrder order;
+  order.type = OrderType::MOVE;
+  order.position = position;
+  queue_order(order);
+}
+
+void Unit::queue_attack_order(Unit* target) {
+  if (target == nullptr) {
+    return;
+  }
+  UnitOrder order;
+  order.type = OrderType::ATTACK;
+  order.target_id = target->get_instance_id();
+  queue_order(order);
+}
+
+void Unit::queue_interact_order(Interactable* target) {
+  if (target == nullptr) {
+    return;
+  }
+  UnitOrder order;
+  order.type = OrderType::INTERACT;
+  order.target_id = target->get_instance_id();
+  queue_order(order);
+}
+
+void Unit::queue_order(const UnitOrder& order) {
+  if (!_accept_issued_order(order, true)) {
+    return;
+  }
+  if (current_order == OrderType::NONE && order_queue.is_empty()) {
+    _start_order(order);
+    return;
+  }
+  order_queue.push_back(order);
+}
+
+void Unit::reset_for_spawn() {
+  order_queue.clear();
+  _halt();
+  set_velocity(Vector3(0, 0, 0));
+  if (is_inside_tree()) {
+    desired_location = get_global_position();
+  }
+
+  const int32_t total_children = get_child_count();
+  for (int32_t i = 0; i < total_children; ++i) {
+    auto component = Object::cast_to<UnitComponent>(get_child(i));
+    if (component != nullptr) {
+      component->reset_state();
+    }
+  }
+  if (movement_component != nullptr) {
+    movement_component->reset_state();
+  }
+}
+
+Unit* Unit::get_highest_threat() const {
+  if (unit_registry == nullptr) {
+    return nullptr;
+  }
+  const int32_t source =
+      unit_registry->get_threat_table().get_top_threat(registry_slot);
+  if (source == ThreatTable::NONE) {
+    return nullptr;
+  }
+  return unit_registry->get_unit(source);
+}
+
+float Unit::get_threat_from(const Unit* source) const {
+  if (unit_registry == nullptr || source == nullptr ||
+      source->get_unit_registry() != unit_registry) {
+    return 0.0f;
+  }
+  return unit_registry->get_threat_table().get_threat(
+      registry_slot, source->get_registry_slot());
+}
+
+int32_t Unit::get_attacker_count() const {
+  if (unit_registry == nullptr) {
+    return 0;
+  }
+  return unit_registry->get_threat_table().get_attacker_count(registry_slot);
+}
+
+void Unit::release_attackers() {
+  if (unit_registry == nullptr) {
+    return;
+  }
+
+  ThreatTable& threat = unit_registry->get_threat_table();
+  threat.remove_source(registry_slot);
+  threat.disengage(registry_slot);
+  while (threat.get_attacker_count(registry_slot) > 0) {
+    const int32_t attacker = threat.get_attacker(registry_slot, 0);
+    threat.disengage(attacker);
+    Unit* unit = unit_registry->get_unit(attacker);
+    if (unit != nullptr) {
+      unit->_lose_attack_target();
+    }
+  }
+}
+
+void Unit::clear_order_queue() {
+  order_queue.clear();
+}
+
+int32_t Unit::get_queued_order_count() const {
+  return order_queue.size();
+}
+
+void Unit::append_orders(Unit* const* units,
+                         int32_t unit_count,
+                         const UnitOrder* orders,
+                         int32_t order_count) {
+  for (int32_t i = 0; i < unit_count; ++i) {
+    Unit* unit = units[i];
+    if (unit == nullptr) {
+      continue;
+    }
+    for (int32_t j = 0; j < order_count; ++j) {
+      unit->queue_order(orders[j]);
+    }
+  }
+}
+
+void Unit::append_order_queue(const Array& units, const Array& orders) {
+  // Convert once, then hand the same order list to every unit.
+  std::vector<UnitOrder> converted;
+  converted.reserve(orders.size());
+  for (int64_t i = 0; i < orders.size(); ++i) {
+    const godot::Dictionary entry = orders[i];
+    UnitOrder order;
+    order.type = static_cast<OrderType>(
+        static_cast<int32_t>(entry.get("type", 0)));
+    order.position = entry.get("position", Vector3(0, 0, 0));
+    godot::Object* target = entry.get("target", Variant());
+    order.target_id = target != nullptr ? target->get_instance_id() : 0;
+    converted.push_back(order);
+  }
+
+  std::vector<Unit*> targets;
+  targets.reserve(units.size());
+  for (int64_t i = 0; i < units.size(); ++i) {
+    godot::Object* object = units[i];
+    targets.push_back(Object::cast_to<Unit>(object));
+  }
+
+  append_orders(targets.data(), static_cast<int32_t>(targets.size()),
+                converted.data(), static_cast<int32_t>(converted.size()));
 }
 
 void Unit::set_desired_location(const Vector3& location) {
@@ -244,29 +602,289 @@ float Unit::get_attack_buffer_range() const {
 
 void Unit::set_faction_id(int32_t new_faction_id) {
   faction_id = new_faction_id;
+  if (unit_registry != nullptr) {
+    unit_registry->set_faction(registry_slot, faction_id);
+  }
 }
 
 int32_t Unit::get_faction_id() const {
   return faction_id;
 }
 
+void Unit::set_sight_radius(float radius) {
+  sight_radius = radius < 0.0f ? 0.0f : radius;
+  if (unit_registry != nullptr) {
+    unit_registry->set_sight_radius(registry_slot, sight_radius);
+  }
+}
+
+float Unit::get_sight_radius() const {
+  return sight_radius;
+}
+
+void Unit::set_visual_archetype(const StringName& archetype) {
+  visual_archetype = archetype;
+  if (unit_registry != nullptr) {
+    unit_registry->set_archetype(registry_slot, visual_archetype);
+  }
+}
+
+StringName Unit::get_visual_archetype() const {
+  return visual_archetype;
+}
+
+void Unit::set_tint_color(const godot::Color& color) {
+  tint_color = color;
+  if (unit_registry != nullptr) {
+    unit_registry->set_tint(registry_slot, tint_color);
+  }
+}
+
+godot::Color Unit::get_tint_color() const {
+  return tint_color;
+}
+
+void Unit::set_facing_yaw(float yaw) {
+  facing_yaw = yaw;
+
+  if (unit_registry == nullptr) {
+    // No match to batch through, rotate the body directly.
+    set_transform(
+        Transform3D(Basis(Vector3(0, 1, 0), yaw), get_transform().origin));
+  }
+}
+
+float Unit::get_facing_yaw() const {
+  return facing_yaw;
+}
+
+UnitHandle Unit::get_handle() const {
+  if (unit_registry == nullptr) {
+    return INVALID_UNIT_HANDLE;
+  }
+  return unit_registry->get_handle(registry_slot);
+}
+
+UnitRegistry* Unit::get_unit_registry() const {
+  return unit_registry;
+}
+
+int32_t Unit::get_registry_slot() const {
+  return registry_slot;
+}
+
 void Unit::_set_order(OrderType new_order, godot::Object* new_target) {
   OrderType previous_order = current_order;
-  godot::Object* previous_target = current_order_target;
+  const uint64_t previous_target = current_order_target;
 
   current_order = new_order;
-  current_order_target = new_target;
+  current_order_target =
+      new_target != nullptr ? new_target->get_instance_id() : 0;
 
   if (previous_order != current_order ||
       previous_target != current_order_target) {
     emit_signal("order_changed", static_cast<int>(previous_order),
-                static_cast<int>(current_order), current_order_target);
+                static_cast<int>(current_order), new_target);
   }
 }
 
+void Unit::_start_move_order(const Vector3& position) {
+  _clear_order_targets();
+  _set_order(OrderType::MOVE, nullptr);
+  desired_location = position;
+}
+
+void Unit::_start_attack_order(Unit* target) {
+  _clear_order_targets();
+  // Targets outside the unit's match have no handle; the order then
+  // completes on the next tick.
+  if (unit_registry != nullptr && target != nullptr &&
+      target->get_unit_registry() == unit_registry) {
+    attack_target = target->get_handle();
+    unit_registry->get_threat_table().engage(registry_slot,
+                                             target->get_registry_slot());
+  }
+  _set_order(OrderType::ATTACK, target);
+
+  if (target != nullptr && target->is_inside_tree()) {
+    desired_location = target->get_global_position();
+  }
+}
+
+void Unit::_start_interact_order(Interactable* target) {
+  _clear_order_targets();
+  interact_target = target;
+  if (target != nullptr && target->is_inside_tree()) {
+    interact_target_id = String(target->get_path()).hash();
+  }
+  _set_order(OrderType::INTERACT, target);
+
+  if (interact_target != nullptr && interact_target->is_inside_tree()) {
+    desired_location = interact_target->get_global_position();
+  }
+}
+
+bool Unit::_start_order(const UnitOrder& order) {
+  switch (order.type) {
+    case OrderType::MOVE:
+      _start_move_order(order.position);
+      return true;
+    case OrderType::ATTACK: {
+      auto target =
+          Object::cast_to<Unit>(godot::ObjectDB::get_instance(order.target_id));
+      if (target == nullptr || !target->is_inside_tree()) {
+        return false;
+      }
+      HealthComponent* target_health = target->get_health_component();
+      if (target_health != nullptr && target_health->is_dead()) {
+        return false;
+      }
+      _start_attack_order(target);
+      return true;
+    }
+    case OrderType::INTERACT: {
+      auto target = Object::cast_to<Interactable>(
+          godot::ObjectDB::get_instance(order.target_id));
+      if (target == nullptr || !target->is_inside_tree()) {
+        return false;
+      }
+      _start_interact_order(target);
+      return true;
+    }
+    case OrderType::NONE:
+    default:
+      return false;
+  }
+}
+
+void Unit::_complete_current_order() {
+  // Skip queued orders whose target disappeared while they waited.
+  while (!order_queue.is_empty()) {
+    if (_start_order(order_queue.pop_front())) {
+      return;
+    }
+  }
+  _halt();
+}
+
+MatchManager* Unit::get_match_manager() const {
+  return match_manager;
+}
+
+bool Unit::is_deterministic() const {
+  return match_manager != nullptr && match_manager->is_deterministic();
+}
+
+const FixedVector3& Unit::get_fixed_position() const {
+  return fixed_position;
+}
+
+DeterministicRandom& Unit::get_random() {
+  return random;
+}
+
+bool Unit::_accept_issued_order(const UnitOrder& order, bool queued) {
+  if (match_manager == nullptr) {
+    return true;
+  }
+  MatchClient* client = match_manager->get_match_client();
+  if (client != nullptr && !client->on_order_issued(this, order, queued)) {
+    return false;
+  }
+  if (match_manager->get_order_recorder() == nullptr) {
+    return true;
+  }
+  return match_manager->get_order_recorder()->on_order_issued(registry_slot,
+                                                              order, queued);
+}
+
+void Unit::_publish_sim_state() {
+  StateChecksum& state = unit_registry->get_state_checksum();
+  if (is_deterministic()) {
+    state.set_word(registry_slot, StateChecksum::POSITION_X,
+                   static_cast<uint32_t>(fixed_position.x.raw));
+    state.set_word(registry_slot, StateChecksum::POSITION_Y,
+                   static_cast<uint32_t>(fixed_position.y.raw));
+    state.set_word(registry_slot, StateChecksum::POSITION_Z,
+                   static_cast<uint32_t>(fixed_position.z.raw));
+  } else {
+    const Vector3 position = get_global_position();
+    state.set_word(registry_slot, StateChecksum::POSITION_X,
+                   float_bits(position.x));
+    state.set_word(registry_slot, StateChecksum::POSITION_Y,
+                   float_bits(position.y));
+    state.set_word(registry_slot, StateChecksum::POSITION_Z,
+                   float_bits(position.z));
+  }
+  state.set_word(registry_slot, StateChecksum::ORDER,
+                 static_cast<uint32_t>(current_order));
+
+  // Targets as slots, which are identical between runs; instance IDs are
+  // not. Interact targets are not units and go by their scene path hash.
+  uint32_t target = 0;
+  if (current_order == OrderType::ATTACK &&
+      attack_target != INVALID_UNIT_HANDLE) {
+    target =
+        static_cast<uint32_t>(UnitRegistry::slot_of(attack_target)) + 1u;
+  } else if (current_order == OrderType::INTERACT &&
+             interact_target != nullptr) {
+    target = interact_target_id;
+  }
+  state.set_word(registry_slot, StateChecksum::ORDER_TARGET, target);
+  state.set_word(registry_slot, StateChecksum::QUEUED_ORDERS,
+                 static_cast<uint32_t>(order_queue.size()));
+
+  const AttackComponent* attack = get_attack_component();
+  if (attack != nullptr) {
+    state.set_word(registry_slot, StateChecksum::ATTACK_COOLDOWN,
+                   attack->get_cooldown_state());
+    state.set_word(registry_slot, StateChecksum::ATTACK_WINDUP,
+                   attack->get_windup_state());
+  }
+}
+
+void Unit::_halt() {
+  _clear_order_targets();
+  _set_order(OrderType::NONE, nullptr);
+
+  // Stop horizontal movement but keep vertical velocity (gravity).
+  set_velocity(Vector3(0, get_velocity().y, 0));
+}
+
 void Unit::_clear_order_targets() {
-  attack_target = nullptr;
+  if (attack_target != INVALID_UNIT_HANDLE && unit_registry != nullptr) {
+    unit_registry->get_threat_table().disengage(registry_slot);
+  }
+  attack_target = INVALID_UNIT_HANDLE;
   interact_target = nullptr;
+  interact_target_id = 0;
+}
+
+void Unit::_lose_attack_target() {
+  attack_target = INVALID_UNIT_HANDLE;
+}
+
+void Unit::_collect_visual_parts() {
+  if (visual_parts_collected) {
+    return;
+  }
+  visual_parts_collected = true;
+
+  // Detach the meshes from the body transform so moving the body no longer
+  // propagates to them; the registry places them from the pose buffer.
+  const int32_t total_children = get_child_count();
+  for (int32_t i = 0; i < total_children; ++i) {
+    auto visual = Object::cast_to<VisualInstance3D>(get_child(i));
+    if (visual == nullptr ||
+        visual_parts.count >= UnitRegistry::MAX_VISUAL_PARTS) {
+      continue;
+    }
+
+    const int32_t part = visual_parts.count++;
+    visual_parts.instances[part] = visual->get_instance();
+    visual_parts.local_transforms[part] = visual->get_transform();
+    visual->set_as_top_level(true);
+  }
 }
 
 Node* Unit::get_component_by_class(const StringName& class_name) const {
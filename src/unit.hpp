@@ -2,11 +2,14 @@
 #define GDEXTENSION_UNIT_H
 
 #include <godot_cpp/classes/character_body3d.hpp>
+#include <godot_cpp/variant/array.hpp>
 #include <godot_cpp/variant/packed_string_array.hpp>
 #include <godot_cpp/variant/string.hpp>
 #include <godot_cpp/variant/vector3.hpp>
 
+#include "fixed_point.hpp"
 #include "unit_order.hpp"
+#include "unit_registry.hpp"
 
 namespace godot {
 class Object;
@@ -14,6 +17,7 @@ class Node;
 class StringName;
 }  // namespace godot
 
+using godot::Array;
 using godot::CharacterBody3D;
 using godot::PackedStringArray;
 using godot::String;
@@ -23,6 +27,7 @@ using godot::Vector3;
 class Interactable;
 class HealthComponent;
 class AttackComponent;
+class MatchManager;
 class MovementComponent;
 
 class Unit : public CharacterBody3D {
@@ -35,13 +40,63 @@ class Unit : public CharacterBody3D {
   Unit();
   ~Unit();
 
+  void _enter_tree() override;
+  void _exit_tree() override;
   void _ready() override;
   void _physics_process(double delta) override;
 
+  // One simulation step. Called from _physics_process, or by the match in
+  // slot order when it runs in deterministic mode.
+  void simulate_tick(double delta);
+
   void issue_move_order(const Vector3& position);
   void issue_attack_order(Unit* target);
   void issue_interact_order(Interactable* target);
   void stop_order();
+  // Moves the unit instantly. Use it instead of setting the transform:
+  // in deterministic mode the fixed position is only read from the node
+  // when the unit enters the tree, and the next step would undo the move.
+  void teleport(const Vector3& position);
+
+  // Shift-queue variants: start right away when idle, otherwise run after
+  // the current and already queued orders complete.
+  void queue_move_order(const Vector3& position);
+  void queue_attack_order(Unit* target);
+  void queue_interact_order(Interactable* target);
+  void queue_order(const UnitOrder& order);
+  void clear_order_queue();
+  int32_t get_queued_order_count() const;
+
+  // Appends the same orders to the queue of every unit.
+  static void append_orders(Unit* const* units,
+                            int32_t unit_count,
+                            const UnitOrder* orders,
+                            int32_t order_count);
+  // Script version; orders are dictionaries with "type", "position" and
+  // "target" keys.
+  static void append_order_queue(const Array& units, const Array& orders);
+
+  OrderType get_current_order() const;
+
+  // Threat: damage taken from each other unit of the match. The highest
+  // source is tracked as damage comes in, so this is a lookup.
+  Unit* get_highest_threat() const;
+  float get_threat_from(const Unit* source) const;
+  // Units whose current attack order targets this one.
+  int32_t get_attacker_count() const;
+  // Ends the attack orders of every unit attacking this one and drops the
+  // threat it caused. Called when the unit dies or leaves the match.
+  void release_attackers();
+
+  // Clears orders and velocity and restores every component to its spawn
+  // state. Used when a pooled unit is reused.
+  void reset_for_spawn();
+
+  // One movement-only step toward destination, as simulate_tick() would
+  // take it. Used to re-simulate predicted ticks after a server correction.
+  void predict_movement_step(double delta,
+                             OrderType order,
+                             const Vector3& destination);
 
   void set_desired_location(const Vector3& location);
   Vector3 get_desired_location() const;
@@ -55,6 +110,36 @@ class Unit : public CharacterBody3D {
   void set_faction_id(int32_t new_faction_id);
   int32_t get_faction_id() const;
 
+  // How far the unit reveals the fog of war for its faction; 0 sees
+  // nothing. Only used when the match has a FogOfWar.
+  void set_sight_radius(float radius);
+  float get_sight_radius() const;
+
+  // Units sharing an archetype are drawn by that archetype's
+  // UnitInstanceRenderer instead of their own mesh nodes.
+  void set_visual_archetype(const StringName& archetype);
+  StringName get_visual_archetype() const;
+
+  void set_tint_color(const godot::Color& color);
+  godot::Color get_tint_color() const;
+
+  // Facing around the Y axis. With a match present the body itself is never
+  // rotated; the registry pushes the facing to the visuals once per frame.
+  void set_facing_yaw(float yaw);
+  float get_facing_yaw() const;
+
+  // Generational handle of the unit in its match; 0 outside a match.
+  UnitHandle get_handle() const;
+  UnitRegistry* get_unit_registry() const;
+  int32_t get_registry_slot() const;
+  MatchManager* get_match_manager() const;
+
+  // Deterministic mode state. The fixed position is authoritative there and
+  // the node position only mirrors it; see teleport().
+  bool is_deterministic() const;
+  const FixedVector3& get_fixed_position() const;
+  DeterministicRandom& get_random();
+
   // Component lookup helpers
   godot::Node* get_component_by_class(const StringName& class_name) const;
   HealthComponent* get_health_component() const;
@@ -63,19 +148,46 @@ class Unit : public CharacterBody3D {
  private:
   void _set_order(OrderType new_order, godot::Object* new_target);
   void _clear_order_targets();
+  // Called by a target that died or left; the order completes next tick.
+  void _lose_attack_target();
+  void _start_move_order(const Vector3& position);
+  void _start_attack_order(Unit* target);
+  void _start_interact_order(Interactable* target);
+  bool _start_order(const UnitOrder& order);
+  void _complete_current_order();
+  void _halt();
+  // Writes this tick's state words for the match checksum.
+  void _publish_sim_state();
+  // Lets the match recorder log the order; false drops it (replays).
+  bool _accept_issued_order(const UnitOrder& order, bool queued);
+  void _collect_visual_parts();
 
   Vector3 desired_location = Vector3(0, 0, 0);
 
   OrderType current_order = OrderType::NONE;
-  godot::Object* current_order_target = nullptr;
-  Unit* attack_target = nullptr;
+  uint64_t current_order_target = 0;  // Instance id, for order_changed
+  UnitHandle attack_target = INVALID_UNIT_HANDLE;
   Interactable* interact_target = nullptr;
+  uint32_t interact_target_id = 0;  // Scene path hash, for the checksum
+  UnitOrderQueue order_queue;
 
   float auto_attack_range = 2.5f;
   float attack_buffer_range = 0.5f;  // Hysteresis buffer for resuming chase
   int32_t faction_id = 0;
+  float sight_radius = 12.0f;
 
   MovementComponent* movement_component = nullptr;
+
+  StringName visual_archetype;
+  godot::Color tint_color = godot::Color(1, 1, 1, 1);
+  float facing_yaw = 0.0f;
+  MatchManager* match_manager = nullptr;
+  UnitRegistry* unit_registry = nullptr;
+  FixedVector3 fixed_position;
+  DeterministicRandom random;
+  int32_t registry_slot = UnitRegistry::INVALID_SLOT;
+  UnitRegistry::VisualSet visual_parts;
+  bool visual_parts_collected = false;
 };
 
 #endif  // GDEXTENSION_UNIT_H
@@ -39,3 +39,5 @@ void UnitComponent::_ready() {
 Unit* UnitComponent::get_unit() const {
   return owner_unit;
 }
+
+void UnitComponent::reset_state() {}
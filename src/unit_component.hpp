@@ -22,6 +22,10 @@ class UnitComponent : public Node {
   void _ready() override;
 
   Unit* get_unit() const;
+
+  // Restores the state a freshly spawned unit starts with. Called when a
+  // pooled unit is reused (see UnitPool).
+  virtual void reset_state();
 };
 
 #endif  // GDEXTENSION_UNIT_COMPONENT_H
@@ -0,0 +1,254 @@
+#include "unit_instance_renderer.hpp"
+
+#include <algorithm>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/shader.hpp>
+#include <godot_cpp/classes/shader_material.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/color.hpp>
+#include <godot_cpp/variant/variant.hpp>
+
+#include "match_manager.hpp"
+#include "unit_registry.hpp"
+
+using godot::ClassDB;
+using godot::Color;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::PropertyInfo;
+using godot::RenderingServer;
+using godot::Shader;
+using godot::ShaderMaterial;
+using godot::Variant;
+
+namespace {
+// The instance color is the albedo; the mesh's own material is replaced.
+// The faction tint in custom data is blended on top by its alpha.
+const char* const DEFAULT_SHADER_CODE = R"(shader_type spatial;
+
+varying vec4 faction_tint;
+
+void vertex() {
+  faction_tint = INSTANCE_CUSTOM;
+}
+
+void fragment() {
+  ALBEDO = mix(COLOR.rgb, faction_tint.rgb, faction_tint.a);
+}
+)";
+}  // namespace
+
+UnitInstanceRenderer::UnitInstanceRenderer() = default;
+
+UnitInstanceRenderer::~UnitInstanceRenderer() = default;
+
+void UnitInstanceRenderer::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_archetype", "archetype"),
+                       &UnitInstanceRenderer::set_archetype);
+  ClassDB::bind_method(D_METHOD("get_archetype"),
+                       &UnitInstanceRenderer::get_archetype);
+  ADD_PROPERTY(PropertyInfo(Variant::STRING_NAME, "archetype"),
+               "set_archetype", "get_archetype");
+
+  ClassDB::bind_method(D_METHOD("set_mesh", "mesh"),
+                       &UnitInstanceRenderer::set_mesh);
+  ClassDB::bind_method(D_METHOD("get_mesh"), &UnitInstanceRenderer::get_mesh);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "mesh",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "Mesh"),
+               "set_mesh", "get_mesh");
+
+  ClassDB::bind_method(D_METHOD("set_mesh_transform", "transform"),
+                       &UnitInstanceRenderer::set_mesh_transform);
+  ClassDB::bind_method(D_METHOD("get_mesh_transform"),
+                       &UnitInstanceRenderer::get_mesh_transform);
+  ADD_PROPERTY(PropertyInfo(Variant::TRANSFORM3D, "mesh_transform"),
+               "set_mesh_transform", "get_mesh_transform");
+
+  ClassDB::bind_method(D_METHOD("set_faction_colors", "colors"),
+                       &UnitInstanceRenderer::set_faction_colors);
+  ClassDB::bind_method(D_METHOD("get_faction_colors"),
+                       &UnitInstanceRenderer::get_faction_colors);
+  ADD_PROPERTY(PropertyInfo(Variant::PACKED_COLOR_ARRAY, "faction_colors"),
+               "set_faction_colors", "get_faction_colors");
+
+  ClassDB::bind_method(D_METHOD("get_drawn_instance_count"),
+                       &UnitInstanceRenderer::get_drawn_instance_count);
+}
+
+void UnitInstanceRenderer::_enter_tree() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  MatchManager* match = MatchManager::find_for(this);
+  if (match == nullptr) {
+    return;
+  }
+
+  _ensure_multimesh();
+
+  unit_registry = &match->get_unit_registry();
+  archetype_id = unit_registry->find_or_add_archetype(archetype);
+  unit_registry->add_archetype_renderer(archetype_id);
+  has_uploaded = false;
+}
+
+void UnitInstanceRenderer::_exit_tree() {
+  if (unit_registry == nullptr) {
+    return;
+  }
+
+  unit_registry->remove_archetype_renderer(archetype_id);
+  unit_registry = nullptr;
+  archetype_id = UnitRegistry::NO_ARCHETYPE;
+}
+
+void UnitInstanceRenderer::_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  if (unit_registry == nullptr || archetype_id == UnitRegistry::NO_ARCHETYPE) {
+    return;
+  }
+
+  const uint64_t revision = unit_registry->get_render_revision(archetype_id);
+  if (has_uploaded && revision == uploaded_revision) {
+    return;
+  }
+
+  const int32_t slot_count = unit_registry->get_slot_count();
+  _reserve_instances(slot_count);
+
+  float* out = instance_buffer.ptrw();
+  int32_t count = 0;
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    if (unit_registry->get_archetype(slot) != archetype_id ||
+        !unit_registry->is_instanced(slot) ||
+        unit_registry->is_fogged(slot)) {
+      continue;
+    }
+
+    const Transform3D xform =
+        unit_registry->get_transform(slot) * mesh_transform;
+    const Color& tint = unit_registry->get_tint(slot);
+    const int32_t faction = unit_registry->get_faction(slot);
+    const Color faction_tint = faction >= 0 && faction < faction_colors.size()
+                                   ? faction_colors[faction]
+                                   : Color(0, 0, 0, 0);
+
+    float* instance = out + count * FLOATS_PER_INSTANCE;
+    for (int32_t row = 0; row < 3; ++row) {
+      instance[row * 4 + 0] = xform.basis.rows[row].x;
+      instance[row * 4 + 1] = xform.basis.rows[row].y;
+      instance[row * 4 + 2] = xform.basis.rows[row].z;
+      instance[row * 4 + 3] = xform.origin[row];
+    }
+    instance[12] = tint.r;
+    instance[13] = tint.g;
+    instance[14] = tint.b;
+    instance[15] = tint.a;
+    instance[16] = faction_tint.r;
+    instance[17] = faction_tint.g;
+    instance[18] = faction_tint.b;
+    instance[19] = faction_tint.a;
+    count++;
+  }
+
+  RenderingServer* rendering_server = RenderingServer::get_singleton();
+  const RID multimesh_rid = instances->get_rid();
+  rendering_server->multimesh_set_buffer(multimesh_rid, instance_buffer);
+  rendering_server->multimesh_set_visible_instances(multimesh_rid, count);
+
+  drawn_instance_count = count;
+  uploaded_revision = revision;
+  has_uploaded = true;
+}
+
+void UnitInstanceRenderer::set_archetype(const StringName& new_archetype) {
+  if (unit_registry != nullptr) {
+    unit_registry->remove_archetype_renderer(archetype_id);
+    archetype_id = unit_registry->find_or_add_archetype(new_archetype);
+    unit_registry->add_archetype_renderer(archetype_id);
+    has_uploaded = false;
+  }
+  archetype = new_archetype;
+}
+
+StringName UnitInstanceRenderer::get_archetype() const {
+  return archetype;
+}
+
+void UnitInstanceRenderer::set_mesh(const Ref<Mesh>& new_mesh) {
+  mesh = new_mesh;
+  if (instances.is_valid()) {
+    instances->set_mesh(mesh);
+  }
+}
+
+Ref<Mesh> UnitInstanceRenderer::get_mesh() const {
+  return mesh;
+}
+
+void UnitInstanceRenderer::set_mesh_transform(const Transform3D& transform) {
+  mesh_transform = transform;
+  has_uploaded = false;
+}
+
+Transform3D UnitInstanceRenderer::get_mesh_transform() const {
+  return mesh_transform;
+}
+
+void UnitInstanceRenderer::set_faction_colors(const PackedColorArray& colors) {
+  faction_colors = colors;
+  has_uploaded = false;
+}
+
+PackedColorArray UnitInstanceRenderer::get_faction_colors() const {
+  return faction_colors;
+}
+
+int32_t UnitInstanceRenderer::get_drawn_instance_count() const {
+  return drawn_instance_count;
+}
+
+void UnitInstanceRenderer::_ensure_multimesh() {
+  if (instances.is_valid()) {
+    return;
+  }
+
+  instances.instantiate();
+  instances->set_transform_format(MultiMesh::TRANSFORM_3D);
+  instances->set_use_colors(true);
+  instances->set_use_custom_data(true);
+  instances->set_mesh(mesh);
+  set_multimesh(instances);
+
+  if (get_material_override().is_null()) {
+    Ref<Shader> shader;
+    shader.instantiate();
+    shader->set_code(DEFAULT_SHADER_CODE);
+
+    Ref<ShaderMaterial> material;
+    material.instantiate();
+    material->set_shader(shader);
+    set_material_override(material);
+  }
+}
+
+void UnitInstanceRenderer::_reserve_instances(int32_t count) {
+  if (instances->get_instance_count() >= count && count > 0) {
+    return;
+  }
+
+  // Grow geometrically; resizing the MultiMesh reallocates its GPU buffer.
+  int32_t capacity = std::max(64, instances->get_instance_count());
+  while (capacity < count) {
+    capacity *= 2;
+  }
+
+  instances->set_instance_count(capacity);
+  instance_buffer.resize(static_cast<int64_t>(capacity) * FLOATS_PER_INSTANCE);
+}
@@ -0,0 +1,81 @@
+#ifndef GDEXTENSION_UNIT_INSTANCE_RENDERER_H
+#define GDEXTENSION_UNIT_INSTANCE_RENDERER_H
+
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/multi_mesh.hpp>
+#include <godot_cpp/classes/multi_mesh_instance3d.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/packed_color_array.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/string_name.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+
+using godot::Mesh;
+using godot::MultiMesh;
+using godot::MultiMeshInstance3D;
+using godot::PackedColorArray;
+using godot::PackedFloat32Array;
+using godot::Ref;
+using godot::StringName;
+using godot::Transform3D;
+
+class UnitRegistry;
+
+// Draws every unit of one visual archetype with a single MultiMesh. Instance
+// data is filled straight from the match UnitRegistry: the transform, the
+// unit tint as instance color and the faction tint as custom data.
+//
+// One renderer draws one mesh part, so an archetype built from several meshes
+// (body + nose) uses one renderer per part, each with its own mesh_transform.
+class UnitInstanceRenderer : public MultiMeshInstance3D {
+  GDCLASS(UnitInstanceRenderer, MultiMeshInstance3D)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  UnitInstanceRenderer();
+  ~UnitInstanceRenderer();
+
+  void _enter_tree() override;
+  void _exit_tree() override;
+  void _process(double delta) override;
+
+  void set_archetype(const StringName& new_archetype);
+  StringName get_archetype() const;
+
+  void set_mesh(const Ref<Mesh>& new_mesh);
+  Ref<Mesh> get_mesh() const;
+
+  void set_mesh_transform(const Transform3D& transform);
+  Transform3D get_mesh_transform() const;
+
+  // Indexed by Unit::faction_id. Alpha is the tint strength.
+  void set_faction_colors(const PackedColorArray& colors);
+  PackedColorArray get_faction_colors() const;
+
+  int32_t get_drawn_instance_count() const;
+
+ private:
+  // 12 transform + 4 color + 4 custom data floats.
+  static constexpr int32_t FLOATS_PER_INSTANCE = 20;
+
+  void _ensure_multimesh();
+  void _reserve_instances(int32_t count);
+
+  StringName archetype;
+  Ref<Mesh> mesh;
+  Transform3D mesh_transform;
+  PackedColorArray faction_colors;
+
+  Ref<MultiMesh> instances;
+  PackedFloat32Array instance_buffer;
+  int32_t drawn_instance_count = 0;
+
+  UnitRegistry* unit_registry = nullptr;
+  int32_t archetype_id = -1;
+  uint64_t uploaded_revision = 0;
+  bool has_uploaded = false;
+};
+
+#endif  // GDEXTENSION_UNIT_INSTANCE_RENDERER_H
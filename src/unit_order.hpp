@@ -1,6 +1,11 @@
 #ifndef GDEXTENSION_UNIT_ORDER_H
 #define GDEXTENSION_UNIT_ORDER_H
 
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/vector3.hpp>
+
 enum class OrderType {
   NONE,
   MOVE,
@@ -8,4 +13,59 @@ enum class OrderType {
   INTERACT,
 };
 
+struct UnitOrder {
+  OrderType type = OrderType::NONE;
+  godot::Vector3 position = godot::Vector3(0, 0, 0);
+  // Instance id of the ATTACK/INTERACT target, resolved when the order starts
+  // so a target freed while queued is simply skipped.
+  uint64_t target_id = 0;
+};
+
+// FIFO of orders waiting behind the current one. The first CAPACITY entries
+// live inline in a ring buffer; only longer queues spill to the heap.
+class UnitOrderQueue {
+ public:
+  static constexpr int32_t CAPACITY = 8;
+
+  void push_back(const UnitOrder& order) {
+    if (count < CAPACITY && overflow.empty()) {
+      ring[(head + count) % CAPACITY] = order;
+      count++;
+      return;
+    }
+    overflow.push_back(order);
+  }
+
+  UnitOrder pop_front() {
+    UnitOrder order = ring[head];
+    head = (head + 1) % CAPACITY;
+    count--;
+
+    if (!overflow.empty()) {
+      ring[(head + count) % CAPACITY] = overflow.front();
+      count++;
+      overflow.erase(overflow.begin());
+    }
+    return order;
+  }
+
+  const UnitOrder& front() const { return ring[head]; }
+  bool is_empty() const { return count == 0; }
+  int32_t size() const {
+    return count + static_cast<int32_t>(overflow.size());
+  }
+
+  void clear() {
+    head = 0;
+    count = 0;
+    overflow.clear();
+  }
+
+ private:
+  UnitOrder ring[CAPACITY];
+  int32_t head = 0;
+  int32_t count = 0;
+  std::vector<UnitOrder> overflow;
+};
+
 #endif  // GDEXTENSION_UNIT_ORDER_H
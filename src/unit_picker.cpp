@@ -0,0 +1,121 @@
+#include "unit_picker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "unit_registry.hpp"
+
+namespace {
+constexpr float RAY_EPSILON = 0.0001f;
+}  // namespace
+
+void UnitPicker::set_pick_radius(float radius) {
+  pick_radius = std::max(0.0f, radius);
+}
+
+float UnitPicker::get_pick_radius() const {
+  return pick_radius;
+}
+
+void UnitPicker::set_pick_height(float height) {
+  pick_height = std::max(0.0f, height);
+}
+
+float UnitPicker::get_pick_height() const {
+  return pick_height;
+}
+
+int32_t UnitPicker::pick(const UnitRegistry& registry,
+                         const Vector3& origin,
+                         const Vector3& direction,
+                         float max_distance,
+                         float min_height,
+                         float max_height,
+                         int32_t ignored_slot,
+                         float* out_distance) const {
+  // Clip the ray to the height band the units can occupy.
+  float start = 0.0f;
+  float end = max_distance;
+  if (std::abs(direction.y) > RAY_EPSILON) {
+    const float to_min = (min_height - origin.y) / direction.y;
+    const float to_max = (max_height + pick_height - origin.y) / direction.y;
+    start = std::max(start, std::min(to_min, to_max));
+    end = std::min(end, std::max(to_min, to_max));
+  } else if (origin.y < min_height || origin.y > max_height + pick_height) {
+    return UnitRegistry::INVALID_SLOT;
+  }
+  if (start > end) {
+    return UnitRegistry::INVALID_SLOT;
+  }
+
+  const Vector3 first = origin + direction * start;
+  const Vector3 last = origin + direction * end;
+
+  int32_t best_slot = UnitRegistry::INVALID_SLOT;
+  float best_distance = max_distance;
+  registry.get_spatial_grid().for_each_in_rect(
+      std::min(first.x, last.x) - pick_radius,
+      std::min(first.z, last.z) - pick_radius,
+      std::max(first.x, last.x) + pick_radius,
+      std::max(first.z, last.z) + pick_radius, [&](int32_t slot) {
+        // Dead units stay registered but cannot be selected or targeted.
+        if (slot == ignored_slot || registry.get_unit(slot) == nullptr ||
+            registry.get_health_ratio(slot) <= 0.0f) {
+          return;
+        }
+        const float distance = _intersect(
+            origin, direction, registry.get_position(slot), best_distance);
+        if (distance >= 0.0f && distance < best_distance) {
+          best_distance = distance;
+          best_slot = slot;
+        }
+      });
+
+  if (out_distance != nullptr && best_slot != UnitRegistry::INVALID_SLOT) {
+    *out_distance = best_distance;
+  }
+  return best_slot;
+}
+
+float UnitPicker::_intersect(const Vector3& origin,
+                             const Vector3& direction,
+                             const Vector3& base,
+                             float max_distance) const {
+  float enter = 0.0f;
+  float exit = max_distance;
+
+  // Side wall: solve the ray against the circle on the XZ plane.
+  const float ox = origin.x - base.x;
+  const float oz = origin.z - base.z;
+  const float a = direction.x * direction.x + direction.z * direction.z;
+  const float c = ox * ox + oz * oz - pick_radius * pick_radius;
+  if (a < RAY_EPSILON) {
+    if (c > 0.0f) {
+      return -1.0f;  // Vertical ray passing beside the cylinder.
+    }
+  } else {
+    const float b = ox * direction.x + oz * direction.z;
+    const float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) {
+      return -1.0f;
+    }
+    const float root = std::sqrt(discriminant);
+    enter = std::max(enter, (-b - root) / a);
+    exit = std::min(exit, (-b + root) / a);
+  }
+
+  // Caps: clip to the span between the base and the top.
+  const float oy = origin.y - base.y;
+  if (std::abs(direction.y) < RAY_EPSILON) {
+    if (oy < 0.0f || oy > pick_height) {
+      return -1.0f;
+    }
+  } else {
+    const float to_base = -oy / direction.y;
+    const float to_top = (pick_height - oy) / direction.y;
+    enter = std::max(enter, std::min(to_base, to_top));
+    exit = std::min(exit, std::max(to_base, to_top));
+  }
+
+  return enter <= exit ? enter : -1.0f;
+}
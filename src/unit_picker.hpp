@@ -0,0 +1,49 @@
+#ifndef GDEXTENSION_UNIT_PICKER_H
+#define GDEXTENSION_UNIT_PICKER_H
+
+#include <cstdint>
+
+#include <godot_cpp/variant/vector3.hpp>
+
+using godot::Vector3;
+
+class UnitRegistry;
+
+// Picks units under a screen ray without touching the physics server. Every
+// unit is treated as an upright cylinder standing on its registry position;
+// candidates come from the match spatial grid, so a pick allocates nothing.
+class UnitPicker {
+ public:
+  void set_pick_radius(float radius);
+  float get_pick_radius() const;
+
+  void set_pick_height(float height);
+  float get_pick_height() const;
+
+  // Returns the slot of the nearest unit hit by the ray, or
+  // UnitRegistry::INVALID_SLOT. Only the part of the ray between
+  // min_height and max_height is searched, which keeps the grid query
+  // small for a camera looking down at the field. ignored_slot and dead
+  // units are skipped.
+  int32_t pick(const UnitRegistry& registry,
+               const Vector3& origin,
+               const Vector3& direction,
+               float max_distance,
+               float min_height,
+               float max_height,
+               int32_t ignored_slot,
+               float* out_distance = nullptr) const;
+
+ private:
+  // Entry distance of the ray into the cylinder at base, or a negative
+  // value on a miss.
+  float _intersect(const Vector3& origin,
+                   const Vector3& direction,
+                   const Vector3& base,
+                   float max_distance) const;
+
+  float pick_radius = 0.6f;
+  float pick_height = 2.0f;
+};
+
+#endif  // GDEXTENSION_UNIT_PICKER_H
@@ -0,0 +1,295 @@
+#include "unit_pool.hpp"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/node3d.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/core/object.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/callable.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "health_component.hpp"
+#include "match_manager.hpp"
+#include "unit.hpp"
+
+using godot::Callable;
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::Node3D;
+using godot::ObjectDB;
+using godot::PropertyInfo;
+using godot::StringName;
+using godot::Transform3D;
+using godot::UtilityFunctions;
+using godot::Variant;
+
+UnitPool::UnitPool() = default;
+
+UnitPool::~UnitPool() {
+  // Returned units are outside the tree, so nothing else frees them.
+  for (SceneUnits& scene_units : scenes) {
+    for (Unit* unit : scene_units.free_units) {
+      memdelete(unit);
+    }
+  }
+}
+
+void UnitPool::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_recycle_delay", "seconds"),
+                       &UnitPool::set_recycle_delay);
+  ClassDB::bind_method(D_METHOD("get_recycle_delay"),
+                       &UnitPool::get_recycle_delay);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "recycle_delay",
+                            godot::PROPERTY_HINT_RANGE, "0,30,0.1"),
+               "set_recycle_delay", "get_recycle_delay");
+
+  ClassDB::bind_method(D_METHOD("set_spawn_parent", "parent"),
+                       &UnitPool::set_spawn_parent);
+  ClassDB::bind_method(D_METHOD("get_spawn_parent"),
+                       &UnitPool::get_spawn_parent);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "spawn_parent",
+                            godot::PROPERTY_HINT_NODE_TYPE, "Node"),
+               "set_spawn_parent", "get_spawn_parent");
+
+  ClassDB::bind_method(D_METHOD("get_effective_spawn_parent"),
+                       &UnitPool::get_effective_spawn_parent);
+  ClassDB::bind_method(D_METHOD("prewarm", "scene", "count"),
+                       &UnitPool::prewarm);
+  ClassDB::bind_method(D_METHOD("get_free_count", "scene"),
+                       &UnitPool::get_free_count);
+  ClassDB::bind_method(D_METHOD("spawn", "scene", "position", "faction_id"),
+                       &UnitPool::spawn);
+  ClassDB::bind_method(D_METHOD("release", "unit"), &UnitPool::release);
+  ClassDB::bind_method(D_METHOD("get_active_count"),
+                       &UnitPool::get_active_count);
+  ClassDB::bind_method(D_METHOD("get_pooled_count"),
+                       &UnitPool::get_pooled_count);
+  ClassDB::bind_method(D_METHOD("get_instantiated_count"),
+                       &UnitPool::get_instantiated_count);
+
+  ClassDB::bind_method(D_METHOD("_on_unit_died", "source", "unit"),
+                       &UnitPool::_on_unit_died);
+}
+
+void UnitPool::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+  if (match == nullptr && spawn_parent == nullptr) {
+    UtilityFunctions::push_warning(
+        "[UnitPool] Not part of a match and spawn_parent is not set.");
+  }
+}
+
+void UnitPool::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  // Backwards, so returning swap-removes only entries already visited.
+  for (int32_t index = static_cast<int32_t>(owned.size()) - 1; index >= 0;
+       --index) {
+    Owned& entry = owned[index];
+    if (ObjectDB::get_instance(entry.instance_id) == nullptr) {
+      owned[index] = owned.back();
+      owned.pop_back();
+      continue;
+    }
+    if (entry.recycle_ticks < 0) {
+      continue;
+    }
+    if (entry.recycle_ticks-- == 0) {
+      _return_to_pool(index);
+    }
+  }
+}
+
+void UnitPool::set_recycle_delay(float seconds) {
+  recycle_delay = std::max(seconds, 0.0f);
+}
+
+float UnitPool::get_recycle_delay() const {
+  return recycle_delay;
+}
+
+void UnitPool::set_spawn_parent(Node* parent) {
+  spawn_parent = parent;
+}
+
+Node* UnitPool::get_spawn_parent() const {
+  return spawn_parent;
+}
+
+Node* UnitPool::get_effective_spawn_parent() const {
+  if (spawn_parent != nullptr) {
+    return spawn_parent;
+  }
+  return match != nullptr ? match->get_parent() : nullptr;
+}
+
+void UnitPool::prewarm(const Ref<PackedScene>& scene, int32_t count) {
+  if (scene.is_null()) {
+    return;
+  }
+
+  const int32_t scene_index = _scene_index(scene);
+  for (int32_t i = 0; i < count; ++i) {
+    Unit* unit = _instantiate(scene_index);
+    if (unit == nullptr) {
+      return;
+    }
+    scenes[scene_index].free_units.push_back(unit);
+    pooled_count++;
+  }
+}
+
+Unit* UnitPool::spawn(const Ref<PackedScene>& scene,
+                      const Vector3& position,
+                      int32_t faction_id) {
+  Node* parent = get_effective_spawn_parent();
+  if (scene.is_null() || parent == nullptr) {
+    return nullptr;
+  }
+
+  const int32_t scene_index = _scene_index(scene);
+  std::vector<Unit*>& free_units = scenes[scene_index].free_units;
+  Unit* unit = nullptr;
+  bool reused = false;
+  if (!free_units.empty()) {
+    unit = free_units.back();
+    free_units.pop_back();
+    pooled_count--;
+    reused = true;
+  } else {
+    unit = _instantiate(scene_index);
+    if (unit == nullptr) {
+      return nullptr;
+    }
+  }
+
+  // Placed before entering the tree, where the unit registers its pose and
+  // faction with the match.
+  Transform3D transform(godot::Basis(), position);
+  auto parent_3d = Object::cast_to<Node3D>(parent);
+  if (parent_3d != nullptr) {
+    transform = parent_3d->get_global_transform().affine_inverse() * transform;
+  }
+  unit->set_transform(transform);
+  unit->set_faction_id(faction_id);
+  parent->add_child(unit);
+  if (reused) {
+    unit->reset_for_spawn();
+  }
+
+  Owned entry;
+  entry.unit = unit;
+  entry.instance_id = unit->get_instance_id();
+  entry.scene_index = scene_index;
+  owned.push_back(entry);
+  return unit;
+}
+
+void UnitPool::release(Unit* unit) {
+  const int32_t index = _find_owned(unit);
+  if (index < 0) {
+    UtilityFunctions::push_warning(
+        "[UnitPool] release() called for a unit the pool did not spawn.");
+    return;
+  }
+  _return_to_pool(index);
+}
+
+int32_t UnitPool::get_free_count(const Ref<PackedScene>& scene) const {
+  for (const SceneUnits& scene_units : scenes) {
+    if (scene_units.scene == scene) {
+      return static_cast<int32_t>(scene_units.free_units.size());
+    }
+  }
+  return 0;
+}
+
+int32_t UnitPool::get_active_count() const {
+  return static_cast<int32_t>(owned.size());
+}
+
+int32_t UnitPool::get_pooled_count() const {
+  return pooled_count;
+}
+
+int32_t UnitPool::get_instantiated_count() const {
+  return instantiated_count;
+}
+
+int32_t UnitPool::_scene_index(const Ref<PackedScene>& scene) {
+  for (int32_t index = 0; index < static_cast<int32_t>(scenes.size());
+       ++index) {
+    if (scenes[index].scene == scene) {
+      return index;
+    }
+  }
+  scenes.emplace_back();
+  scenes.back().scene = scene;
+  return static_cast<int32_t>(scenes.size()) - 1;
+}
+
+Unit* UnitPool::_instantiate(int32_t scene_index) {
+  Node* node = scenes[scene_index].scene->instantiate();
+  auto unit = Object::cast_to<Unit>(node);
+  if (unit == nullptr) {
+    UtilityFunctions::push_error("[UnitPool] Scene root must be a Unit.");
+    if (node != nullptr) {
+      memdelete(node);
+    }
+    return nullptr;
+  }
+  instantiated_count++;
+
+  // Connected once; the connection survives every trip through the pool.
+  HealthComponent* health = unit->get_health_component();
+  if (health != nullptr) {
+    health->connect(StringName("died"),
+                    Callable(this, StringName("_on_unit_died")).bind(unit));
+  }
+  return unit;
+}
+
+int32_t UnitPool::_find_owned(const Unit* unit) const {
+  for (int32_t index = 0; index < static_cast<int32_t>(owned.size());
+       ++index) {
+    if (owned[index].unit == unit) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+void UnitPool::_return_to_pool(int32_t owned_index) {
+  const Owned entry = owned[owned_index];
+  owned[owned_index] = owned.back();
+  owned.pop_back();
+
+  // Leaving the tree unregisters the unit and stops its processing.
+  Node* parent = entry.unit->get_parent();
+  if (parent != nullptr) {
+    parent->remove_child(entry.unit);
+  }
+  scenes[entry.scene_index].free_units.push_back(entry.unit);
+  pooled_count++;
+}
+
+void UnitPool::_on_unit_died(godot::Object* source, godot::Object* unit) {
+  const int32_t index = _find_owned(Object::cast_to<Unit>(unit));
+  if (index < 0 || owned[index].recycle_ticks >= 0) {
+    return;
+  }
+  owned[index].recycle_ticks = static_cast<int32_t>(std::lround(
+      recycle_delay * Engine::get_singleton()->get_physics_ticks_per_second()));
+}
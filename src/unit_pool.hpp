@@ -0,0 +1,98 @@
+#ifndef GDEXTENSION_UNIT_POOL_H
+#define GDEXTENSION_UNIT_POOL_H
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/packed_scene.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using godot::Node;
+using godot::PackedScene;
+using godot::Ref;
+using godot::Vector3;
+
+class MatchManager;
+class Unit;
+
+// Recycles units instead of instancing and freeing them, for creep waves
+// that spawn and die all match long.
+//
+// Units spawned through the pool are returned to it recycle_delay seconds
+// after they die (the corpse stays visible until then): they are removed
+// from the tree, which unregisters them from the match registry and its
+// spatial grid and stops all their processing. The next spawn of the same
+// scene takes a returned unit, resets its orders and components and adds it
+// back, so steady-state waves never instantiate.
+class UnitPool : public Node {
+  GDCLASS(UnitPool, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  UnitPool();
+  ~UnitPool();
+
+  void _ready() override;
+  void _physics_process(double delta) override;
+
+  // Seconds a dead unit stays before it is returned to the pool.
+  void set_recycle_delay(float seconds);
+  float get_recycle_delay() const;
+
+  // Parent of spawned units; the match root when unset.
+  void set_spawn_parent(Node* parent);
+  Node* get_spawn_parent() const;
+  // Where spawned units go: spawn_parent, or the match root.
+  Node* get_effective_spawn_parent() const;
+
+  // Instances count units of the scene ahead of time.
+  void prewarm(const Ref<PackedScene>& scene, int32_t count);
+  // Returned or prewarmed units of the scene waiting for a spawn.
+  int32_t get_free_count(const Ref<PackedScene>& scene) const;
+  // Spawns a unit of the scene at a global position, reusing a returned one
+  // when available.
+  Unit* spawn(const Ref<PackedScene>& scene,
+              const Vector3& position,
+              int32_t faction_id);
+  // Returns a unit spawned by this pool right away, dead or alive.
+  void release(Unit* unit);
+
+  int32_t get_active_count() const;
+  int32_t get_pooled_count() const;
+  // Units instanced since the pool started; stays flat once waves recycle.
+  int32_t get_instantiated_count() const;
+
+ private:
+  struct SceneUnits {
+    Ref<PackedScene> scene;
+    std::vector<Unit*> free_units;  // Out of the tree, ready for reuse
+  };
+
+  struct Owned {
+    Unit* unit = nullptr;
+    uint64_t instance_id = 0;  // Detects units freed behind the pool's back
+    int32_t scene_index = 0;
+    int32_t recycle_ticks = -1;  // Countdown after death, -1 while alive
+  };
+
+  int32_t _scene_index(const Ref<PackedScene>& scene);
+  Unit* _instantiate(int32_t scene_index);
+  int32_t _find_owned(const Unit* unit) const;
+  void _return_to_pool(int32_t owned_index);
+  void _on_unit_died(godot::Object* source, godot::Object* unit);
+
+  float recycle_delay = 2.0f;
+  Node* spawn_parent = nullptr;
+
+  MatchManager* match = nullptr;
+  std::vector<SceneUnits> scenes;
+  std::vector<Owned> owned;  // Units in the tree
+  int32_t pooled_count = 0;
+  int32_t instantiated_count = 0;
+};
+
+#endif  // GDEXTENSION_UNIT_POOL_H
@@ -0,0 +1,547 @@
+#include "unit_registry.hpp"
+
+#include <algorithm>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/variant/basis.hpp>
+
+using godot::Basis;
+using godot::RenderingServer;
+
+namespace {
+
+template <typename T>
+size_t capacity_bytes(const std::vector<T>& values) {
+  return values.capacity() * sizeof(T);
+}
+
+}  // namespace
+
+int32_t UnitRegistry::register_unit(Unit* unit) {
+  int32_t slot = INVALID_SLOT;
+  if (!free_slots.empty()) {
+    slot = free_slots.back();
+    free_slots.pop_back();
+  } else {
+    slot = static_cast<int32_t>(units.size());
+    units.push_back(nullptr);
+    generations.push_back(1);
+    positions.emplace_back();
+    yaws.push_back(0.0f);
+    transforms.emplace_back();
+    visuals.emplace_back();
+    visuals_hidden.push_back(0);
+    factions.push_back(0);
+    sight_radii.push_back(0.0f);
+    tints.emplace_back(1, 1, 1, 1);
+    archetypes.push_back(NO_ARCHETYPE);
+    individually_rendered.push_back(0);
+    fogged_slots.push_back(0);
+    bot_controlled.push_back(0);
+    pose_queued.push_back(0);
+    health_ratios.push_back(1.0f);
+    resource_ratios.push_back(-1.0f);
+    bar_logged_at.push_back(-1);
+  }
+
+  units[slot] = unit;
+  positions[slot] = Vector3(0, 0, 0);
+  yaws[slot] = 0.0f;
+  transforms[slot] = Transform3D();
+  visuals[slot] = VisualSet();
+  visuals_hidden[slot] = 0;
+  factions[slot] = 0;
+  sight_radii[slot] = 0.0f;
+  tints[slot] = Color(1, 1, 1, 1);
+  archetypes[slot] = NO_ARCHETYPE;
+  individually_rendered[slot] = 0;
+  fogged_slots[slot] = 0;
+  bot_controlled[slot] = 0;
+  health_ratios[slot] = 1.0f;
+  resource_ratios[slot] = -1.0f;
+  state_checksum.ensure_slot(slot);
+  state_checksum.set_word(slot, StateChecksum::OCCUPIED, 1);
+  position_history.reset_slot(slot);
+  unit_count++;
+  _queue_bar_update(slot);
+  return slot;
+}
+
+void UnitRegistry::unregister_unit(int32_t slot) {
+  if (slot < 0 || slot >= static_cast<int32_t>(units.size()) ||
+      units[slot] == nullptr) {
+    return;
+  }
+
+  // A pending sync entry for this slot is skipped once the unit is gone.
+  units[slot] = nullptr;
+  // Handles to the leaving unit go stale; 0 is skipped so no handle is 0.
+  generations[slot] =
+      generations[slot] == UINT32_MAX ? 1 : generations[slot] + 1;
+  spatial_grid.remove(slot);
+  state_checksum.clear_slot(slot);
+  threat_table.reset_slot(slot);
+  visuals[slot] = VisualSet();
+  _bump_render_revision(slot);
+  archetypes[slot] = NO_ARCHETYPE;
+  free_slots.push_back(slot);
+  unit_count--;
+  _queue_bar_update(slot);
+}
+
+Unit* UnitRegistry::get_unit(int32_t slot) const {
+  if (slot < 0 || slot >= static_cast<int32_t>(units.size())) {
+    return nullptr;
+  }
+  return units[slot];
+}
+
+UnitHandle UnitRegistry::get_handle(int32_t slot) const {
+  if (slot < 0 || slot >= static_cast<int32_t>(units.size()) ||
+      units[slot] == nullptr) {
+    return INVALID_UNIT_HANDLE;
+  }
+  return static_cast<UnitHandle>(
+      (static_cast<uint64_t>(generations[slot]) << 32) |
+      static_cast<uint32_t>(slot));
+}
+
+Unit* UnitRegistry::resolve(UnitHandle handle) const {
+  const int32_t slot = resolve_slot(handle);
+  return slot == INVALID_SLOT ? nullptr : units[slot];
+}
+
+bool UnitRegistry::is_alive(UnitHandle handle) const {
+  const int32_t slot = resolve_slot(handle);
+  return slot != INVALID_SLOT && health_ratios[slot] > 0.0f;
+}
+
+int32_t UnitRegistry::get_slot_count() const {
+  return static_cast<int32_t>(units.size());
+}
+
+int32_t UnitRegistry::get_unit_count() const {
+  return unit_count;
+}
+
+void UnitRegistry::set_visuals(int32_t slot, const VisualSet& visual_set) {
+  if (get_unit(slot) == nullptr) {
+    return;
+  }
+  // Freshly registered instances are visible, as their nodes are.
+  visuals[slot] = visual_set;
+  visuals_hidden[slot] = 0;
+  _refresh_visual_mode(slot);
+  _queue_pose_sync(slot);
+}
+
+void UnitRegistry::set_pose(int32_t slot,
+                            const Vector3& position,
+                            float yaw) {
+  if (get_unit(slot) == nullptr) {
+    return;
+  }
+
+  if (positions[slot] == position && yaws[slot] == yaw &&
+      spatial_grid.contains(slot)) {
+    return;
+  }
+
+  positions[slot] = position;
+  spatial_grid.update(slot, position);
+  yaws[slot] = yaw;
+  transforms[slot] = Transform3D(Basis(Vector3(0, 1, 0), yaw), position);
+  _bump_render_revision(slot);
+  _queue_pose_sync(slot);
+  _queue_bar_update(slot);
+}
+
+const Vector3& UnitRegistry::get_position(int32_t slot) const {
+  return positions[slot];
+}
+
+const SpatialGrid& UnitRegistry::get_spatial_grid() const {
+  return spatial_grid;
+}
+
+float UnitRegistry::get_yaw(int32_t slot) const {
+  return yaws[slot];
+}
+
+const Transform3D& UnitRegistry::get_transform(int32_t slot) const {
+  return transforms[slot];
+}
+
+void UnitRegistry::set_faction(int32_t slot, int32_t faction_id) {
+  if (get_unit(slot) == nullptr) {
+    return;
+  }
+  factions[slot] = faction_id;
+  _bump_render_revision(slot);
+}
+
+int32_t UnitRegistry::get_faction(int32_t slot) const {
+  return factions[slot];
+}
+
+void UnitRegistry::set_sight_radius(int32_t slot, float radius) {
+  if (get_unit(slot) == nullptr) {
+    return;
+  }
+  sight_radii[slot] = radius;
+}
+
+float UnitRegistry::get_sight_radius(int32_t slot) const {
+  return sight_radii[slot];
+}
+
+void UnitRegistry::set_tint(int32_t slot, const Color& tint) {
+  if (get_unit(slot) == nullptr) {
+    return;
+  }
+  tints[slot] = tint;
+  _bump_render_revision(slot);
+}
+
+const Color& UnitRegistry::get_tint(int32_t slot) const {
+  return tints[slot];
+}
+
+int32_t UnitRegistry::find_or_add_archetype(const StringName& archetype) {
+  if (archetype.is_empty()) {
+    return NO_ARCHETYPE;
+  }
+
+  const int32_t archetype_count =
+      static_cast<int32_t>(archetype_names.size());
+  for (int32_t i = 0; i < archetype_count; ++i) {
+    if (archetype_names[i] == archetype) {
+      return i;
+    }
+  }
+
+  archetype_names.push_back(archetype);
+  archetype_renderer_counts.push_back(0);
+  render_revisions.push_back(0);
+  return archetype_count;
+}
+
+void UnitRegistry::set_archetype(int32_t slot, const StringName& archetype) {
+  if (get_unit(slot) == nullptr) {
+    return;
+  }
+  // The old archetype's renderer has to drop the unit.
+  _bump_render_revision(slot);
+  archetypes[slot] = find_or_add_archetype(archetype);
+  _refresh_visual_mode(slot);
+}
+
+int32_t UnitRegistry::get_archetype(int32_t slot) const {
+  return archetypes[slot];
+}
+
+void UnitRegistry::add_archetype_renderer(int32_t archetype_id) {
+  if (archetype_id < 0 ||
+      archetype_id >= static_cast<int32_t>(archetype_names.size())) {
+    return;
+  }
+
+  if (archetype_renderer_counts[archetype_id]++ > 0) {
+    return;
+  }
+
+  const int32_t slot_count = get_slot_count();
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    if (archetypes[slot] == archetype_id) {
+      _refresh_visual_mode(slot);
+    }
+  }
+}
+
+void UnitRegistry::remove_archetype_renderer(int32_t archetype_id) {
+  if (archetype_id < 0 ||
+      archetype_id >= static_cast<int32_t>(archetype_names.size()) ||
+      archetype_renderer_counts[archetype_id] == 0) {
+    return;
+  }
+
+  if (--archetype_renderer_counts[archetype_id] > 0) {
+    return;
+  }
+
+  const int32_t slot_count = get_slot_count();
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    if (archetypes[slot] == archetype_id) {
+      _refresh_visual_mode(slot);
+    }
+  }
+}
+
+void UnitRegistry::set_individually_rendered(int32_t slot, bool individual) {
+  if (get_unit(slot) == nullptr) {
+    return;
+  }
+  individually_rendered[slot] = individual ? 1 : 0;
+  _refresh_visual_mode(slot);
+}
+
+void UnitRegistry::set_fogged(int32_t slot, bool fogged) {
+  const uint8_t value = fogged ? 1 : 0;
+  if (get_unit(slot) == nullptr || fogged_slots[slot] == value) {
+    return;
+  }
+  fogged_slots[slot] = value;
+  _refresh_visual_mode(slot);
+  _queue_bar_update(slot);
+}
+
+bool UnitRegistry::is_fogged(int32_t slot) const {
+  return fogged_slots[slot] != 0;
+}
+
+void UnitRegistry::set_bot_controlled(int32_t slot, bool controlled) {
+  if (get_unit(slot) == nullptr) {
+    return;
+  }
+  bot_controlled[slot] = controlled ? 1 : 0;
+}
+
+bool UnitRegistry::is_bot_controlled(int32_t slot) const {
+  return bot_controlled[slot] != 0;
+}
+
+bool UnitRegistry::is_instanced(int32_t slot) const {
+  if (units[slot] == nullptr || individually_rendered[slot] != 0) {
+    return false;
+  }
+  const int32_t archetype_id = archetypes[slot];
+  return archetype_id != NO_ARCHETYPE &&
+         archetype_renderer_counts[archetype_id] > 0;
+}
+
+void UnitRegistry::set_health_ratio(int32_t slot, float ratio) {
+  if (get_unit(slot) == nullptr || health_ratios[slot] == ratio) {
+    return;
+  }
+  health_ratios[slot] = ratio;
+  _queue_bar_update(slot);
+}
+
+float UnitRegistry::get_health_ratio(int32_t slot) const {
+  return health_ratios[slot];
+}
+
+void UnitRegistry::set_resource_ratio(int32_t slot, float ratio) {
+  if (get_unit(slot) == nullptr || resource_ratios[slot] == ratio) {
+    return;
+  }
+  resource_ratios[slot] = ratio;
+  _queue_bar_update(slot);
+}
+
+float UnitRegistry::get_resource_ratio(int32_t slot) const {
+  return resource_ratios[slot];
+}
+
+int32_t UnitRegistry::add_bar_reader() {
+  const int64_t end = bar_log_base + static_cast<int64_t>(bar_log.size());
+  // Slots logged before the reader's start must log again on their next
+  // change.
+  bar_read_max = end;
+  const auto free_reader = std::find(bar_readers.begin(), bar_readers.end(),
+                                     static_cast<int64_t>(-1));
+  if (free_reader != bar_readers.end()) {
+    *free_reader = end;
+    return static_cast<int32_t>(free_reader - bar_readers.begin());
+  }
+  bar_readers.push_back(end);
+  return static_cast<int32_t>(bar_readers.size()) - 1;
+}
+
+void UnitRegistry::remove_bar_reader(int32_t reader) {
+  if (reader < 0 || reader >= static_cast<int32_t>(bar_readers.size())) {
+    return;
+  }
+  bar_readers[reader] = -1;
+  if (std::all_of(bar_readers.begin(), bar_readers.end(),
+                  [](int64_t cursor) { return cursor < 0; })) {
+    // Nobody is left to read it; readers added later start from scratch.
+    bar_log_base += static_cast<int64_t>(bar_log.size());
+    bar_log.clear();
+    bar_readers.clear();
+  }
+}
+
+int32_t UnitRegistry::get_bar_update_count(int32_t reader) const {
+  return static_cast<int32_t>(bar_log_base +
+                              static_cast<int64_t>(bar_log.size()) -
+                              bar_readers[reader]);
+}
+
+const int32_t* UnitRegistry::get_bar_updates(int32_t reader) const {
+  return bar_log.data() + (bar_readers[reader] - bar_log_base);
+}
+
+void UnitRegistry::finish_bar_updates(int32_t reader) {
+  const int64_t end = bar_log_base + static_cast<int64_t>(bar_log.size());
+  bar_readers[reader] = end;
+  bar_read_max = end;
+
+  // Drop what every reader has seen once that is most of the log, so the
+  // front erase stays amortized.
+  int64_t oldest = end;
+  for (const int64_t cursor : bar_readers) {
+    if (cursor >= 0) {
+      oldest = std::min(oldest, cursor);
+    }
+  }
+  const int64_t consumed = oldest - bar_log_base;
+  if (consumed > 0 && consumed * 2 >= static_cast<int64_t>(bar_log.size())) {
+    bar_log.erase(bar_log.begin(), bar_log.begin() + consumed);
+    bar_log_base = oldest;
+  }
+}
+
+uint64_t UnitRegistry::get_render_revision(int32_t archetype_id) const {
+  if (archetype_id < 0 ||
+      archetype_id >= static_cast<int32_t>(render_revisions.size())) {
+    return 0;
+  }
+  return render_revisions[archetype_id];
+}
+
+void UnitRegistry::sync_visual_transforms() {
+  if (queued_slots.empty()) {
+    return;
+  }
+
+  RenderingServer* rendering_server = RenderingServer::get_singleton();
+  for (const int32_t slot : queued_slots) {
+    pose_queued[slot] = 0;
+    if (units[slot] == nullptr || visuals_hidden[slot] != 0) {
+      continue;
+    }
+
+    const Transform3D& unit_transform = transforms[slot];
+    const VisualSet& visual_set = visuals[slot];
+    for (int32_t i = 0; i < visual_set.count; ++i) {
+      rendering_server->instance_set_transform(
+          visual_set.instances[i],
+          unit_transform * visual_set.local_transforms[i]);
+    }
+  }
+  queued_slots.clear();
+}
+
+void UnitRegistry::_queue_pose_sync(int32_t slot) {
+  if (pose_queued[slot] != 0) {
+    return;
+  }
+  pose_queued[slot] = 1;
+  queued_slots.push_back(slot);
+}
+
+void UnitRegistry::_queue_bar_update(int32_t slot) {
+  // Still ahead of every reader, so all of them will see it. Without
+  // readers nothing is logged.
+  if (bar_logged_at[slot] >= bar_read_max || bar_readers.empty()) {
+    return;
+  }
+  bar_logged_at[slot] = bar_log_base + static_cast<int64_t>(bar_log.size());
+  bar_log.push_back(slot);
+}
+
+void UnitRegistry::_bump_render_revision(int32_t slot) {
+  const int32_t archetype_id = archetypes[slot];
+  if (archetype_id != NO_ARCHETYPE) {
+    render_revisions[archetype_id]++;
+  }
+}
+
+void UnitRegistry::_refresh_visual_mode(int32_t slot) {
+  _bump_render_revision(slot);
+
+  const uint8_t hide = is_instanced(slot) || fogged_slots[slot] != 0 ? 1 : 0;
+  if (visuals_hidden[slot] == hide) {
+    return;
+  }
+  visuals_hidden[slot] = hide;
+
+  RenderingServer* rendering_server = RenderingServer::get_singleton();
+  const VisualSet& visual_set = visuals[slot];
+  for (int32_t i = 0; i < visual_set.count; ++i) {
+    rendering_server->instance_set_visible(visual_set.instances[i], hide == 0);
+  }
+
+  // Hidden instances are not kept up to date, catch them up on the next sync.
+  if (hide == 0) {
+    _queue_pose_sync(slot);
+  }
+}
+
+StateChecksum& UnitRegistry::get_state_checksum() {
+  return state_checksum;
+}
+
+const StateChecksum& UnitRegistry::get_state_checksum() const {
+  return state_checksum;
+}
+
+PositionHistory& UnitRegistry::get_position_history() {
+  return position_history;
+}
+
+const PositionHistory& UnitRegistry::get_position_history() const {
+  return position_history;
+}
+
+void UnitRegistry::record_position_history(int64_t tick) {
+  if (position_history.get_capacity() == 0) {
+    return;
+  }
+
+  const int32_t slot_count = get_slot_count();
+  position_history.begin_tick(tick, slot_count);
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    position_history.write(slot, positions[slot],
+                           units[slot] != nullptr && health_ratios[slot] > 0);
+  }
+}
+
+ThreatTable& UnitRegistry::get_threat_table() {
+  return threat_table;
+}
+
+const ThreatTable& UnitRegistry::get_threat_table() const {
+  return threat_table;
+}
+
+VisibilityGrid& UnitRegistry::get_visibility_grid() {
+  return visibility_grid;
+}
+
+const VisibilityGrid& UnitRegistry::get_visibility_grid() const {
+  return visibility_grid;
+}
+
+size_t UnitRegistry::get_memory_usage() const {
+  return capacity_bytes(units) + capacity_bytes(generations) +
+         capacity_bytes(positions) + capacity_bytes(yaws) +
+         capacity_bytes(transforms) +
+         capacity_bytes(visuals) + capacity_bytes(visuals_hidden) +
+         capacity_bytes(factions) + capacity_bytes(sight_radii) +
+         capacity_bytes(tints) + capacity_bytes(archetypes) +
+         capacity_bytes(individually_rendered) +
+         capacity_bytes(fogged_slots) + capacity_bytes(bot_controlled) +
+         capacity_bytes(archetype_names) +
+         capacity_bytes(archetype_renderer_counts) +
+         capacity_bytes(render_revisions) +
+         capacity_bytes(health_ratios) + capacity_bytes(resource_ratios) +
+         capacity_bytes(bar_log) + capacity_bytes(bar_logged_at) +
+         capacity_bytes(bar_readers) +
+         capacity_bytes(pose_queued) + capacity_bytes(queued_slots) +
+         capacity_bytes(free_slots) + spatial_grid.get_memory_usage() +
+         state_checksum.get_memory_usage() +
+         position_history.get_memory_usage() +
+         threat_table.get_memory_usage() +
+         visibility_grid.get_memory_usage();
+}
@@ -0,0 +1,215 @@
+#ifndef GDEXTENSION_UNIT_REGISTRY_H
+#define GDEXTENSION_UNIT_REGISTRY_H
+
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/color.hpp>
+#include <godot_cpp/variant/rid.hpp>
+#include <godot_cpp/variant/string_name.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+#include "position_history.hpp"
+#include "spatial_grid.hpp"
+#include "state_checksum.hpp"
+#include "threat_table.hpp"
+#include "visibility_grid.hpp"
+
+using godot::Color;
+using godot::RID;
+using godot::StringName;
+using godot::Transform3D;
+using godot::Vector3;
+
+class Unit;
+
+// Generational reference to a unit of a match: the registry slot in the low
+// 32 bits and the slot's generation in the high 32. The generation changes
+// whenever a slot's unit leaves, so a stale handle never resolves to the
+// slot's next occupant. 0 is never a valid handle. Scripts see handles as
+// ints.
+using UnitHandle = int64_t;
+constexpr UnitHandle INVALID_UNIT_HANDLE = 0;
+
+// Per-match table of live units. State that later stages read in bulk is kept
+// in flat arrays indexed by slot so those stages never walk the scene tree.
+class UnitRegistry {
+ public:
+  static constexpr int32_t INVALID_SLOT = -1;
+  static constexpr int32_t NO_ARCHETYPE = -1;
+  static constexpr int32_t MAX_VISUAL_PARTS = 4;
+
+  // RenderingServer instances drawn for a unit, with their offset from the
+  // unit origin.
+  struct VisualSet {
+    RID instances[MAX_VISUAL_PARTS];
+    Transform3D local_transforms[MAX_VISUAL_PARTS];
+    int32_t count = 0;
+  };
+
+  int32_t register_unit(Unit* unit);
+  void unregister_unit(int32_t slot);
+
+  Unit* get_unit(int32_t slot) const;
+  int32_t get_slot_count() const;
+
+  // Handle of the unit in the slot; INVALID_UNIT_HANDLE for a free slot.
+  UnitHandle get_handle(int32_t slot) const;
+  // Slot the handle was issued for, whether or not it is still valid.
+  static int32_t slot_of(UnitHandle handle) {
+    return static_cast<int32_t>(handle & 0xffffffff);
+  }
+  // The handle's slot, or INVALID_SLOT once its unit left. One compare.
+  int32_t resolve_slot(UnitHandle handle) const {
+    const int32_t slot = slot_of(handle);
+    const uint32_t generation = static_cast<uint32_t>(handle >> 32);
+    if (slot < 0 || slot >= static_cast<int32_t>(generations.size()) ||
+        generations[slot] != generation || units[slot] == nullptr) {
+      return INVALID_SLOT;
+    }
+    return slot;
+  }
+  Unit* resolve(UnitHandle handle) const;
+  // Resolves and has health left; dead units stay resolvable as corpses.
+  bool is_alive(UnitHandle handle) const;
+  int32_t get_unit_count() const;
+
+  void set_visuals(int32_t slot, const VisualSet& visual_set);
+
+  // Records the unit pose for this tick. Only poses that actually changed are
+  // queued for the next sync.
+  void set_pose(int32_t slot, const Vector3& position, float yaw);
+  const Vector3& get_position(int32_t slot) const;
+  float get_yaw(int32_t slot) const;
+  const Transform3D& get_transform(int32_t slot) const;
+
+  // Index of every registered unit by position, ids are registry slots.
+  const SpatialGrid& get_spatial_grid() const;
+
+  void set_faction(int32_t slot, int32_t faction_id);
+  int32_t get_faction(int32_t slot) const;
+
+  // Fog of war reveal radius; see VisibilityGrid.
+  void set_sight_radius(int32_t slot, float radius);
+  float get_sight_radius(int32_t slot) const;
+
+  void set_tint(int32_t slot, const Color& tint);
+  const Color& get_tint(int32_t slot) const;
+
+  // Visual archetypes group units that share one instanced renderer. A unit
+  // is drawn by its archetype renderer unless it is flagged as individually
+  // rendered (hero, selection) or no renderer for the archetype exists.
+  int32_t find_or_add_archetype(const StringName& archetype);
+  void set_archetype(int32_t slot, const StringName& archetype);
+  int32_t get_archetype(int32_t slot) const;
+  void add_archetype_renderer(int32_t archetype_id);
+  void remove_archetype_renderer(int32_t archetype_id);
+
+  void set_individually_rendered(int32_t slot, bool individual);
+  bool is_instanced(int32_t slot) const;
+
+  // Fogged units are not drawn at all, by any renderer or health bar.
+  void set_fogged(int32_t slot, bool fogged);
+  bool is_fogged(int32_t slot) const;
+
+  // Units driven by a bot of their own (TestMovement). Faction-wide AI such
+  // as UtilityAI leaves them alone, so two brains never fight over a unit.
+  void set_bot_controlled(int32_t slot, bool controlled);
+  bool is_bot_controlled(int32_t slot) const;
+
+  // Fill ratios shown by the health bar layer. A negative resource ratio
+  // means the unit has no resource bar.
+  void set_health_ratio(int32_t slot, float ratio);
+  float get_health_ratio(int32_t slot) const;
+  void set_resource_ratio(int32_t slot, float ratio);
+  float get_resource_ratio(int32_t slot) const;
+
+  // Slots whose bar needs redrawing (moved, ratio changed, added or removed)
+  // are logged for every bar reader. Each reader has its own cursor into the
+  // log, so several renderers can follow it; a new reader starts at the end
+  // and is expected to draw every slot once. A slot may repeat for a reader
+  // that fell behind.
+  int32_t add_bar_reader();
+  void remove_bar_reader(int32_t reader);
+  int32_t get_bar_update_count(int32_t reader) const;
+  const int32_t* get_bar_updates(int32_t reader) const;
+  // Moves the reader past everything returned by get_bar_updates().
+  void finish_bar_updates(int32_t reader);
+
+  // Bumped whenever anything the archetype's instanced renderer draws
+  // changes, so renderers can skip uploading identical buffers. Units of
+  // other archetypes do not bump it.
+  uint64_t get_render_revision(int32_t archetype_id) const;
+
+  // Pushes every queued transform to the RenderingServer in one pass.
+  void sync_visual_transforms();
+
+  // Per-slot simulation state words, hashed once per tick by the match.
+  StateChecksum& get_state_checksum();
+  const StateChecksum& get_state_checksum() const;
+
+  // Recent positions for lag-compensated hit checks. The match sets the
+  // capacity and records once per tick.
+  PositionHistory& get_position_history();
+  const PositionHistory& get_position_history() const;
+  void record_position_history(int64_t tick);
+
+  // Damage threat and attack engagements between slots. Cleared for a
+  // slot when it is unregistered.
+  ThreatTable& get_threat_table();
+  const ThreatTable& get_threat_table() const;
+
+  // Cells each faction sees. Disabled (everything visible) until a
+  // FogOfWar configures it; the match updates it once per tick.
+  VisibilityGrid& get_visibility_grid();
+  const VisibilityGrid& get_visibility_grid() const;
+
+  // Bytes held by the registry's tables, for per-match memory reports.
+  size_t get_memory_usage() const;
+
+ private:
+  void _queue_pose_sync(int32_t slot);
+  void _queue_bar_update(int32_t slot);
+  // Bumps the render revision of the slot's archetype, if it has one.
+  void _bump_render_revision(int32_t slot);
+  void _refresh_visual_mode(int32_t slot);
+
+  std::vector<Unit*> units;
+  std::vector<uint32_t> generations;  // Bumped when a slot is vacated
+  std::vector<Vector3> positions;
+  std::vector<float> yaws;
+  std::vector<Transform3D> transforms;
+  std::vector<VisualSet> visuals;
+  std::vector<uint8_t> visuals_hidden;
+  std::vector<int32_t> factions;
+  std::vector<float> sight_radii;
+  std::vector<Color> tints;
+  std::vector<int32_t> archetypes;
+  std::vector<uint8_t> individually_rendered;
+  std::vector<uint8_t> fogged_slots;
+  std::vector<uint8_t> bot_controlled;
+  std::vector<StringName> archetype_names;
+  std::vector<int32_t> archetype_renderer_counts;
+  std::vector<uint64_t> render_revisions;  // Per archetype
+
+  std::vector<float> health_ratios;
+  std::vector<float> resource_ratios;
+  std::vector<int32_t> bar_log;        // Slots, oldest first
+  int64_t bar_log_base = 0;            // Log position of bar_log[0]
+  std::vector<int64_t> bar_logged_at;  // Per slot, position of its newest
+  std::vector<int64_t> bar_readers;    // Per reader, next position; -1 free
+  int64_t bar_read_max = 0;            // Furthest reader cursor
+  std::vector<uint8_t> pose_queued;
+  std::vector<int32_t> queued_slots;
+  std::vector<int32_t> free_slots;
+  int32_t unit_count = 0;
+
+  SpatialGrid spatial_grid;
+  StateChecksum state_checksum;
+  PositionHistory position_history;
+  ThreatTable threat_table;
+  VisibilityGrid visibility_grid;
+};
+
+#endif  // GDEXTENSION_UNIT_REGISTRY_H
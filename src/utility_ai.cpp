@@ -0,0 +1,492 @@
+#include "utility_ai.hpp"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "frame_arena.hpp"
+#include "match_manager.hpp"
+#include "unit.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::PropertyInfo;
+using godot::Time;
+using godot::UtilityFunctions;
+using godot::Variant;
+
+namespace {
+
+// A move that ended this close to its destination does not need repeating.
+constexpr float ARRIVED_DISTANCE = 1.0f;
+
+float closer_is_better(float x) {
+  return 1.0f - x;
+}
+
+float weaker_is_better(float x) {
+  return 1.0f - 0.5f * x;
+}
+
+float healthier_is_bolder(float x) {
+  return 0.2f + 0.8f * x;
+}
+
+float flee_when_low(float x) {
+  const float missing = 1.0f - x;
+  return missing * missing * missing * missing;
+}
+
+}  // namespace
+
+UtilityAI::UtilityAI()
+    : distance_response(&closer_is_better),
+      target_health_response(&weaker_is_better),
+      own_health_response(&healthier_is_bolder),
+      retreat_response(&flee_when_low) {}
+
+UtilityAI::~UtilityAI() = default;
+
+void UtilityAI::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_controlled_factions", "factions"),
+                       &UtilityAI::set_controlled_factions);
+  ClassDB::bind_method(D_METHOD("get_controlled_factions"),
+                       &UtilityAI::get_controlled_factions);
+  ADD_PROPERTY(PropertyInfo(Variant::PACKED_INT32_ARRAY,
+                            "controlled_factions"),
+               "set_controlled_factions", "get_controlled_factions");
+
+  ClassDB::bind_method(D_METHOD("set_objectives", "positions"),
+                       &UtilityAI::set_objectives);
+  ClassDB::bind_method(D_METHOD("get_objectives"),
+                       &UtilityAI::get_objectives);
+  ADD_PROPERTY(PropertyInfo(Variant::PACKED_VECTOR3_ARRAY, "objectives"),
+               "set_objectives", "get_objectives");
+
+  ClassDB::bind_method(D_METHOD("set_retreat_points", "positions"),
+                       &UtilityAI::set_retreat_points);
+  ClassDB::bind_method(D_METHOD("get_retreat_points"),
+                       &UtilityAI::get_retreat_points);
+  ADD_PROPERTY(PropertyInfo(Variant::PACKED_VECTOR3_ARRAY, "retreat_points"),
+               "set_retreat_points", "get_retreat_points");
+
+  ClassDB::bind_method(D_METHOD("set_evaluation_interval", "ticks"),
+                       &UtilityAI::set_evaluation_interval);
+  ClassDB::bind_method(D_METHOD("get_evaluation_interval"),
+                       &UtilityAI::get_evaluation_interval);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "evaluation_interval",
+                            godot::PROPERTY_HINT_RANGE, "1,600,1"),
+               "set_evaluation_interval", "get_evaluation_interval");
+
+  ClassDB::bind_method(D_METHOD("set_aggro_radius", "radius"),
+                       &UtilityAI::set_aggro_radius);
+  ClassDB::bind_method(D_METHOD("get_aggro_radius"),
+                       &UtilityAI::get_aggro_radius);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "aggro_radius",
+                            godot::PROPERTY_HINT_RANGE, "1,100,0.5"),
+               "set_aggro_radius", "get_aggro_radius");
+
+  ClassDB::bind_method(D_METHOD("set_attack_weight", "weight"),
+                       &UtilityAI::set_attack_weight);
+  ClassDB::bind_method(D_METHOD("get_attack_weight"),
+                       &UtilityAI::get_attack_weight);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "attack_weight"),
+               "set_attack_weight", "get_attack_weight");
+
+  ClassDB::bind_method(D_METHOD("set_advance_weight", "weight"),
+                       &UtilityAI::set_advance_weight);
+  ClassDB::bind_method(D_METHOD("get_advance_weight"),
+                       &UtilityAI::get_advance_weight);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "advance_weight"),
+               "set_advance_weight", "get_advance_weight");
+
+  ClassDB::bind_method(D_METHOD("set_retreat_weight", "weight"),
+                       &UtilityAI::set_retreat_weight);
+  ClassDB::bind_method(D_METHOD("get_retreat_weight"),
+                       &UtilityAI::get_retreat_weight);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "retreat_weight"),
+               "set_retreat_weight", "get_retreat_weight");
+
+  ClassDB::bind_method(D_METHOD("set_distance_curve", "curve"),
+                       &UtilityAI::set_distance_curve);
+  ClassDB::bind_method(D_METHOD("get_distance_curve"),
+                       &UtilityAI::get_distance_curve);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "distance_curve",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "Curve"),
+               "set_distance_curve", "get_distance_curve");
+
+  ClassDB::bind_method(D_METHOD("set_target_health_curve", "curve"),
+                       &UtilityAI::set_target_health_curve);
+  ClassDB::bind_method(D_METHOD("get_target_health_curve"),
+                       &UtilityAI::get_target_health_curve);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "target_health_curve",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "Curve"),
+               "set_target_health_curve", "get_target_health_curve");
+
+  ClassDB::bind_method(D_METHOD("set_own_health_curve", "curve"),
+                       &UtilityAI::set_own_health_curve);
+  ClassDB::bind_method(D_METHOD("get_own_health_curve"),
+                       &UtilityAI::get_own_health_curve);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "own_health_curve",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "Curve"),
+               "set_own_health_curve", "get_own_health_curve");
+
+  ClassDB::bind_method(D_METHOD("set_retreat_curve", "curve"),
+                       &UtilityAI::set_retreat_curve);
+  ClassDB::bind_method(D_METHOD("get_retreat_curve"),
+                       &UtilityAI::get_retreat_curve);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "retreat_curve",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "Curve"),
+               "set_retreat_curve", "get_retreat_curve");
+
+  ClassDB::bind_method(D_METHOD("evaluate"), &UtilityAI::evaluate);
+  ClassDB::bind_method(D_METHOD("get_last_pass_usec"),
+                       &UtilityAI::get_last_pass_usec);
+  ClassDB::bind_method(D_METHOD("get_last_pass_agents"),
+                       &UtilityAI::get_last_pass_agents);
+  ClassDB::bind_method(D_METHOD("get_last_pass_pairs"),
+                       &UtilityAI::get_last_pass_pairs);
+}
+
+void UtilityAI::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    set_physics_process(false);
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+  if (match == nullptr) {
+    UtilityFunctions::push_warning("[UtilityAI] Not part of a match.");
+  }
+}
+
+void UtilityAI::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  if (tick++ % evaluation_interval == 0) {
+    evaluate();
+  }
+}
+
+void UtilityAI::set_controlled_factions(const PackedInt32Array& factions) {
+  controlled_factions = factions;
+}
+
+PackedInt32Array UtilityAI::get_controlled_factions() const {
+  return controlled_factions;
+}
+
+void UtilityAI::set_objectives(const PackedVector3Array& positions) {
+  objectives = positions;
+}
+
+PackedVector3Array UtilityAI::get_objectives() const {
+  return objectives;
+}
+
+void UtilityAI::set_retreat_points(const PackedVector3Array& positions) {
+  retreat_points = positions;
+}
+
+PackedVector3Array UtilityAI::get_retreat_points() const {
+  return retreat_points;
+}
+
+void UtilityAI::set_evaluation_interval(int32_t ticks) {
+  evaluation_interval = std::max(ticks, 1);
+}
+
+int32_t UtilityAI::get_evaluation_interval() const {
+  return evaluation_interval;
+}
+
+void UtilityAI::set_aggro_radius(float radius) {
+  aggro_radius = std::max(radius, 1.0f);
+}
+
+float UtilityAI::get_aggro_radius() const {
+  return aggro_radius;
+}
+
+void UtilityAI::set_attack_weight(float weight) {
+  attack_weight = std::max(weight, 0.0f);
+}
+
+float UtilityAI::get_attack_weight() const {
+  return attack_weight;
+}
+
+void UtilityAI::set_advance_weight(float weight) {
+  advance_weight = std::max(weight, 0.0f);
+}
+
+float UtilityAI::get_advance_weight() const {
+  return advance_weight;
+}
+
+void UtilityAI::set_retreat_weight(float weight) {
+  retreat_weight = std::max(weight, 0.0f);
+}
+
+float UtilityAI::get_retreat_weight() const {
+  return retreat_weight;
+}
+
+void UtilityAI::set_distance_curve(const Ref<Curve>& curve) {
+  distance_curve = curve;
+  distance_response.bake(curve);
+}
+
+Ref<Curve> UtilityAI::get_distance_curve() const {
+  return distance_curve;
+}
+
+void UtilityAI::set_target_health_curve(const Ref<Curve>& curve) {
+  target_health_curve = curve;
+  target_health_response.bake(curve);
+}
+
+Ref<Curve> UtilityAI::get_target_health_curve() const {
+  return target_health_curve;
+}
+
+void UtilityAI::set_own_health_curve(const Ref<Curve>& curve) {
+  own_health_curve = curve;
+  own_health_response.bake(curve);
+}
+
+Ref<Curve> UtilityAI::get_own_health_curve() const {
+  return own_health_curve;
+}
+
+void UtilityAI::set_retreat_curve(const Ref<Curve>& curve) {
+  retreat_curve = curve;
+  retreat_response.bake(curve);
+}
+
+Ref<Curve> UtilityAI::get_retreat_curve() const {
+  return retreat_curve;
+}
+
+// Everything is released when the match resets the arena after the tick.
+struct UtilityAI::Pass {
+  // Per agent, a controlled unit of the pass.
+  FrameVector<int32_t> agent_slots;
+  FrameVector<int32_t> agent_faction_indices;
+  FrameVector<float> agent_health;
+  FrameVector<float> agent_attack_factor;
+  FrameVector<float> agent_retreat_score;
+  // Agent a's candidate targets are pairs [pair_begin[a], pair_begin[a + 1]).
+  FrameVector<int32_t> pair_begin;
+  FrameVector<int32_t> pair_agent;
+  FrameVector<int32_t> pair_target;
+  FrameVector<float> pair_distance;  // Squared, then normalized
+  FrameVector<float> pair_target_health;
+  FrameVector<float> pair_score;
+};
+
+void UtilityAI::evaluate() {
+  if (match == nullptr || controlled_factions.is_empty()) {
+    return;
+  }
+
+  const uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+  Pass pass;
+  _gather(pass);
+  _score(pass);
+  _apply(pass);
+  last_pass_agents = static_cast<int32_t>(pass.agent_slots.size());
+  last_pass_pairs = static_cast<int32_t>(pass.pair_target.size());
+  last_pass_usec = static_cast<int64_t>(
+      Time::get_singleton()->get_ticks_usec() - start_usec);
+}
+
+int64_t UtilityAI::get_last_pass_usec() const {
+  return last_pass_usec;
+}
+
+int32_t UtilityAI::get_last_pass_agents() const {
+  return last_pass_agents;
+}
+
+int32_t UtilityAI::get_last_pass_pairs() const {
+  return last_pass_pairs;
+}
+
+void UtilityAI::_gather(Pass& pass) const {
+  const UnitRegistry& registry = match->get_unit_registry();
+  const VisibilityGrid& visibility = registry.get_visibility_grid();
+  const bool fogged = visibility.is_enabled();
+  const Unit* main_unit = match->get_main_unit();
+  const int32_t slot_count = registry.get_slot_count();
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    const Unit* unit = registry.get_unit(slot);
+    if (unit == nullptr || unit == main_unit ||
+        registry.is_bot_controlled(slot) ||
+        registry.get_health_ratio(slot) <= 0.0f) {
+      continue;
+    }
+    const int32_t faction = registry.get_faction(slot);
+    const int32_t faction_index = _faction_index(faction);
+    if (faction_index < 0) {
+      continue;
+    }
+    // Under fog of war a faction that sees nothing has no targets.
+    const int32_t layer = fogged ? visibility.find_layer(faction) : -1;
+
+    const int32_t agent = static_cast<int32_t>(pass.agent_slots.size());
+    pass.agent_slots.push_back(slot);
+    pass.agent_faction_indices.push_back(faction_index);
+    pass.agent_health.push_back(registry.get_health_ratio(slot));
+    pass.pair_begin.push_back(static_cast<int32_t>(pass.pair_target.size()));
+
+    const Vector3& position = registry.get_position(slot);
+    registry.get_spatial_grid().for_each_in_radius(
+        position, aggro_radius, [&](int32_t target) {
+          if (registry.get_faction(target) == faction ||
+              registry.get_health_ratio(target) <= 0.0f ||
+              (fogged &&
+               (layer < 0 || !visibility.is_slot_visible(layer, target)))) {
+            return;
+          }
+          const Vector3& target_position = registry.get_position(target);
+          const float dx = target_position.x - position.x;
+          const float dz = target_position.z - position.z;
+          pass.pair_agent.push_back(agent);
+          pass.pair_target.push_back(target);
+          pass.pair_distance.push_back(dx * dx + dz * dz);
+          pass.pair_target_health.push_back(registry.get_health_ratio(target));
+        });
+  }
+  pass.pair_begin.push_back(static_cast<int32_t>(pass.pair_target.size()));
+}
+
+void UtilityAI::_score(Pass& pass) const {
+  // Straight loops over flat arrays; the compiler vectorizes the
+  // arithmetic and the curves cost one table load each.
+  const size_t agent_count = pass.agent_slots.size();
+  pass.agent_attack_factor.resize(agent_count);
+  pass.agent_retreat_score.resize(agent_count);
+  for (size_t agent = 0; agent < agent_count; ++agent) {
+    pass.agent_attack_factor[agent] =
+        own_health_response.sample(pass.agent_health[agent]) * attack_weight;
+    pass.agent_retreat_score[agent] =
+        retreat_response.sample(pass.agent_health[agent]) * retreat_weight;
+  }
+
+  const size_t pair_count = pass.pair_target.size();
+  const float inverse_radius = 1.0f / aggro_radius;
+  for (size_t pair = 0; pair < pair_count; ++pair) {
+    pass.pair_distance[pair] =
+        std::sqrt(pass.pair_distance[pair]) * inverse_radius;
+  }
+
+  pass.pair_score.resize(pair_count);
+  for (size_t pair = 0; pair < pair_count; ++pair) {
+    pass.pair_score[pair] =
+        distance_response.sample(pass.pair_distance[pair]) *
+        target_health_response.sample(pass.pair_target_health[pair]);
+  }
+  for (size_t pair = 0; pair < pair_count; ++pair) {
+    pass.pair_score[pair] *= pass.agent_attack_factor[pass.pair_agent[pair]];
+  }
+}
+
+void UtilityAI::_apply(const Pass& pass) {
+  UnitRegistry& registry = match->get_unit_registry();
+  decisions.resize(registry.get_slot_count());
+
+  const int32_t agent_count = static_cast<int32_t>(pass.agent_slots.size());
+  for (int32_t agent = 0; agent < agent_count; ++agent) {
+    const int32_t faction_index = pass.agent_faction_indices[agent];
+    Action action = ACTION_NONE;
+    int32_t target_slot = -1;
+    float best = 0.0f;
+
+    // Pairs were gathered in grid order; ties go to the lower slot so
+    // deterministic matches agree.
+    const int32_t pair_end = pass.pair_begin[agent + 1];
+    for (int32_t pair = pass.pair_begin[agent]; pair < pair_end; ++pair) {
+      if (pass.pair_score[pair] > best ||
+          (action == ACTION_ATTACK && pass.pair_score[pair] == best &&
+           pass.pair_target[pair] < target_slot)) {
+        action = ACTION_ATTACK;
+        target_slot = pass.pair_target[pair];
+        best = pass.pair_score[pair];
+      }
+    }
+    if (faction_index < objectives.size() && advance_weight > best) {
+      action = ACTION_ADVANCE;
+      best = advance_weight;
+    }
+    if (faction_index < retreat_points.size() &&
+        pass.agent_retreat_score[agent] > best) {
+      action = ACTION_RETREAT;
+    }
+    if (action == ACTION_NONE) {
+      continue;
+    }
+    if (action != ACTION_ATTACK) {
+      target_slot = -1;
+    }
+
+    const int32_t slot = pass.agent_slots[agent];
+    Unit* unit = registry.get_unit(slot);
+    const UnitHandle handle = registry.get_handle(slot);
+    Decision& decision = decisions[slot];
+    const OrderType current = unit->get_current_order();
+    const bool unchanged = decision.handle == handle &&
+                           decision.action == action &&
+                           decision.target_slot == target_slot;
+    if (unchanged) {
+      if (action == ACTION_ATTACK) {
+        if (current == OrderType::ATTACK) {
+          continue;
+        }
+      } else if (current == OrderType::MOVE) {
+        continue;
+      } else if (current == OrderType::NONE) {
+        // Without an order the unit either arrived or lost its move (a
+        // respawn clears orders); only the latter needs the move again.
+        const Vector3& destination = action == ACTION_ADVANCE
+                                         ? objectives[faction_index]
+                                         : retreat_points[faction_index];
+        const Vector3& position = registry.get_position(slot);
+        const float dx = destination.x - position.x;
+        const float dz = destination.z - position.z;
+        if (dx * dx + dz * dz <= ARRIVED_DISTANCE * ARRIVED_DISTANCE) {
+          continue;
+        }
+      }
+    }
+
+    decision.handle = handle;
+    decision.action = action;
+    decision.target_slot = target_slot;
+    if (action == ACTION_ATTACK) {
+      unit->issue_attack_order(registry.get_unit(target_slot));
+    } else if (action == ACTION_ADVANCE) {
+      unit->issue_move_order(objectives[faction_index]);
+    } else {
+      unit->issue_move_order(retreat_points[faction_index]);
+    }
+  }
+}
+
+int32_t UtilityAI::_faction_index(int32_t faction) const {
+  const int64_t count = controlled_factions.size();
+  for (int64_t index = 0; index < count; ++index) {
+    if (controlled_factions[index] == faction) {
+      return static_cast<int32_t>(index);
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,148 @@
+#ifndef GDEXTENSION_UTILITY_AI_H
+#define GDEXTENSION_UTILITY_AI_H
+
+#include <godot_cpp/classes/curve.hpp>
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "response_curve.hpp"
+#include "unit_registry.hpp"
+
+using godot::Curve;
+using godot::Node;
+using godot::PackedInt32Array;
+using godot::PackedVector3Array;
+using godot::Ref;
+
+class MatchManager;
+class Unit;
+
+// Utility AI for the creeps of whole factions, evaluated for all of them in
+// one pass straight from the registry's arrays.
+//
+// Every evaluation_interval ticks the pass gathers each controlled unit and
+// the enemies within aggro_radius into flat arrays, then scores them with
+// plain loops over those arrays: distance to the enemy, the enemy's health
+// and the unit's own health, each through a response curve baked into a
+// lookup table. Every unit then takes its best action (attack an enemy,
+// advance to its faction's objective or retreat to its faction's retreat
+// point) through the usual Unit orders, which are only re-issued when the
+// decision changes. Under fog of war only enemies the unit's faction sees
+// are gathered.
+class UtilityAI : public Node {
+  GDCLASS(UtilityAI, Node)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  enum Action {
+    ACTION_NONE,
+    ACTION_ATTACK,
+    ACTION_ADVANCE,
+    ACTION_RETREAT,
+  };
+
+  UtilityAI();
+  ~UtilityAI();
+
+  void _ready() override;
+  void _physics_process(double delta) override;
+
+  // Factions whose units this AI drives, except the match's main unit and
+  // units with a bot of their own (see UnitRegistry::is_bot_controlled()).
+  // The objectives and retreat points line up with it; a faction without an
+  // entry does not advance or retreat.
+  void set_controlled_factions(const PackedInt32Array& factions);
+  PackedInt32Array get_controlled_factions() const;
+  void set_objectives(const PackedVector3Array& positions);
+  PackedVector3Array get_objectives() const;
+  void set_retreat_points(const PackedVector3Array& positions);
+  PackedVector3Array get_retreat_points() const;
+
+  void set_evaluation_interval(int32_t ticks);
+  int32_t get_evaluation_interval() const;
+
+  void set_aggro_radius(float radius);
+  float get_aggro_radius() const;
+
+  void set_attack_weight(float weight);
+  float get_attack_weight() const;
+  void set_advance_weight(float weight);
+  float get_advance_weight() const;
+  void set_retreat_weight(float weight);
+  float get_retreat_weight() const;
+
+  // Response curves over [0, 1]; the built-in shape is used when unset.
+  // Distance to the enemy over aggro_radius; defaults to 1 - x.
+  void set_distance_curve(const Ref<Curve>& curve);
+  Ref<Curve> get_distance_curve() const;
+  // Enemy health ratio; defaults to 1 - x / 2, finishing weak enemies.
+  void set_target_health_curve(const Ref<Curve>& curve);
+  Ref<Curve> get_target_health_curve() const;
+  // Own health ratio for attacking; defaults to 0.2 + 0.8 x.
+  void set_own_health_curve(const Ref<Curve>& curve);
+  Ref<Curve> get_own_health_curve() const;
+  // Own health ratio for retreating; defaults to (1 - x)^4.
+  void set_retreat_curve(const Ref<Curve>& curve);
+  Ref<Curve> get_retreat_curve() const;
+
+  // Runs a pass now.
+  void evaluate();
+
+  // Metrics of the last pass.
+  int64_t get_last_pass_usec() const;
+  int32_t get_last_pass_agents() const;
+  int32_t get_last_pass_pairs() const;
+
+ private:
+  // Last decision per registry slot, so unchanged decisions issue nothing.
+  // Keyed by handle: pooled units come back as the same object, often in
+  // the same slot, and must not inherit the previous life's decision.
+  struct Decision {
+    UnitHandle handle = INVALID_UNIT_HANDLE;
+    Action action = ACTION_NONE;
+    int32_t target_slot = -1;
+  };
+
+  // Flat arrays of one pass, drawn from the frame arena.
+  struct Pass;
+
+  void _gather(Pass& pass) const;
+  void _score(Pass& pass) const;
+  void _apply(const Pass& pass);
+  int32_t _faction_index(int32_t faction) const;
+
+  PackedInt32Array controlled_factions;
+  PackedVector3Array objectives;
+  PackedVector3Array retreat_points;
+  int32_t evaluation_interval = 15;
+  float aggro_radius = 15.0f;
+  float attack_weight = 1.0f;
+  float advance_weight = 0.05f;
+  float retreat_weight = 1.0f;
+
+  Ref<Curve> distance_curve;
+  Ref<Curve> target_health_curve;
+  Ref<Curve> own_health_curve;
+  Ref<Curve> retreat_curve;
+  ResponseCurve distance_response;
+  ResponseCurve target_health_response;
+  ResponseCurve own_health_response;
+  ResponseCurve retreat_response;
+
+  MatchManager* match = nullptr;
+  int64_t tick = 0;
+  std::vector<Decision> decisions;
+
+  int64_t last_pass_usec = 0;
+  int32_t last_pass_agents = 0;
+  int32_t last_pass_pairs = 0;
+};
+
+#endif  // GDEXTENSION_UTILITY_AI_H
@@ -0,0 +1,418 @@
+#include "visibility_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "unit_registry.hpp"
+
+void VisibilityGrid::configure(const Vector3& new_origin,
+                               int32_t new_width,
+                               int32_t new_depth,
+                               float new_cell_size) {
+  origin = new_origin;
+  width = std::max(new_width, 0);
+  depth = std::max(new_depth, 0);
+  cell_size = new_cell_size > 0.0f ? new_cell_size : 2.0f;
+  inverse_cell_size = 1.0f / cell_size;
+  cell_count = width * depth;
+  words_per_layer = (static_cast<size_t>(cell_count) + 63) / 64;
+
+  layer_factions.clear();
+  counts.clear();
+  bits.clear();
+  changed_bits.assign(words_per_layer, 0);
+  changed_words.clear();
+  footprints.clear();
+  viewers.clear();
+  slot_cells.clear();
+  occluders.reset(width, depth);
+  last_update_stamps = 0;
+  last_update_sight_passes = 0;
+}
+
+const Vector3& VisibilityGrid::get_origin() const {
+  return origin;
+}
+
+int32_t VisibilityGrid::get_width() const {
+  return width;
+}
+
+int32_t VisibilityGrid::get_depth() const {
+  return depth;
+}
+
+float VisibilityGrid::get_cell_size() const {
+  return cell_size;
+}
+
+int32_t VisibilityGrid::cell_of(const Vector3& position) const {
+  const int32_t x = static_cast<int32_t>(
+      std::floor((position.x - origin.x) * inverse_cell_size));
+  const int32_t z = static_cast<int32_t>(
+      std::floor((position.z - origin.z) * inverse_cell_size));
+  return std::clamp(z, 0, depth - 1) * width + std::clamp(x, 0, width - 1);
+}
+
+void VisibilityGrid::update(const UnitRegistry& registry) {
+  last_update_stamps = 0;
+  last_update_sight_passes = 0;
+  for (const int32_t word : changed_words) {
+    changed_bits[word] = 0;
+  }
+  changed_words.clear();
+  if (!is_enabled()) {
+    return;
+  }
+
+  const int32_t slot_count = registry.get_slot_count();
+  if (static_cast<int32_t>(viewers.size()) < slot_count) {
+    viewers.resize(slot_count);
+    slot_cells.resize(slot_count, -1);
+  }
+
+  for (int32_t slot = 0; slot < slot_count; ++slot) {
+    Viewer& viewer = viewers[slot];
+    if (registry.get_unit(slot) == nullptr) {
+      if (viewer.cell >= 0) {
+        _stamp(viewer, -1);
+        viewer.cell = -1;
+      }
+      slot_cells[slot] = -1;
+      continue;
+    }
+
+    const Vector3& position = registry.get_position(slot);
+    const int32_t cell = cell_of(position);
+    const float height = _viewer_height(cell, position);
+    slot_cells[slot] = cell;
+
+    // Most units stay in their cell; this is the whole cost for them.
+    const int64_t handle = registry.get_handle(slot);
+    const float radius = registry.get_health_ratio(slot) > 0.0f
+                             ? registry.get_sight_radius(slot)
+                             : 0.0f;
+    if (viewer.cell == cell && viewer.handle == handle &&
+        layer_factions[viewer.layer] == registry.get_faction(slot) &&
+        viewer.radius == radius && viewer.sight_height == height &&
+        viewer.sight_version == sight_version) {
+      continue;
+    }
+
+    if (viewer.cell >= 0) {
+      _stamp(viewer, -1);
+      viewer.cell = -1;
+    }
+    viewer.handle = handle;
+    if (radius <= 0.0f) {
+      continue;
+    }
+    // The cached sight survives faction changes and revivals in place.
+    if (viewer.sight_cell != cell || viewer.sight_radius != radius ||
+        viewer.sight_height != height ||
+        viewer.sight_version != sight_version) {
+      _compute_sight(viewer, cell, radius, height);
+      last_update_sight_passes++;
+    }
+    viewer.cell = cell;
+    viewer.layer = _layer_for(registry.get_faction(slot));
+    viewer.radius = radius;
+    _stamp(viewer, 1);
+    last_update_stamps++;
+  }
+}
+
+OccluderGrid& VisibilityGrid::get_occluders() {
+  return occluders;
+}
+
+const OccluderGrid& VisibilityGrid::get_occluders() const {
+  return occluders;
+}
+
+void VisibilityGrid::invalidate_sight() {
+  sight_version++;
+}
+
+int32_t VisibilityGrid::find_layer(int32_t faction) const {
+  const int32_t layer_count = static_cast<int32_t>(layer_factions.size());
+  for (int32_t layer = 0; layer < layer_count; ++layer) {
+    if (layer_factions[layer] == faction) {
+      return layer;
+    }
+  }
+  return -1;
+}
+
+bool VisibilityGrid::can_see(int32_t faction, int32_t slot) const {
+  if (!is_enabled()) {
+    return true;
+  }
+  const int32_t layer = find_layer(faction);
+  return layer >= 0 && is_slot_visible(layer, slot);
+}
+
+bool VisibilityGrid::can_see_position(int32_t faction,
+                                      const Vector3& position) const {
+  if (!is_enabled()) {
+    return true;
+  }
+  const int32_t layer = find_layer(faction);
+  return layer >= 0 && is_cell_visible(layer, cell_of(position));
+}
+
+int32_t VisibilityGrid::get_visible_cell_count(int32_t faction) const {
+  const int32_t layer = find_layer(faction);
+  if (layer < 0) {
+    return 0;
+  }
+  int32_t visible = 0;
+  const uint64_t* words = bits.data() + layer * words_per_layer;
+  for (size_t index = 0; index < words_per_layer; ++index) {
+    for (uint64_t word = words[index]; word != 0; word &= word - 1) {
+      visible++;
+    }
+  }
+  return visible;
+}
+
+int32_t VisibilityGrid::get_last_update_stamps() const {
+  return last_update_stamps;
+}
+
+int32_t VisibilityGrid::get_last_update_sight_passes() const {
+  return last_update_sight_passes;
+}
+
+size_t VisibilityGrid::get_memory_usage() const {
+  size_t footprint_bytes = footprints.capacity() * sizeof(Footprint);
+  for (const Footprint& footprint : footprints) {
+    footprint_bytes += footprint.half_widths.capacity() * sizeof(int32_t);
+  }
+  size_t sight_bytes = viewers.capacity() * sizeof(Viewer);
+  for (const Viewer& viewer : viewers) {
+    sight_bytes += viewer.sight.capacity() * sizeof(Run);
+  }
+  return layer_factions.capacity() * sizeof(int32_t) +
+         counts.capacity() * sizeof(uint16_t) +
+         bits.capacity() * sizeof(uint64_t) +
+         changed_bits.capacity() * sizeof(uint64_t) +
+         changed_words.capacity() * sizeof(int32_t) + footprint_bytes +
+         sight_bytes + slot_cells.capacity() * sizeof(int32_t) +
+         occluders.get_memory_usage() + window_opaque.capacity() +
+         window_opaque_transposed.capacity() + window_lit.capacity() +
+         window_lit_transposed.capacity() +
+         rows.capacity() * sizeof(SightRow);
+}
+
+int32_t VisibilityGrid::_layer_for(int32_t faction) {
+  const int32_t existing = find_layer(faction);
+  if (existing >= 0) {
+    return existing;
+  }
+  layer_factions.push_back(faction);
+  counts.resize(layer_factions.size() * cell_count, 0);
+  bits.resize(layer_factions.size() * words_per_layer, 0);
+  return static_cast<int32_t>(layer_factions.size()) - 1;
+}
+
+const VisibilityGrid::Footprint& VisibilityGrid::_footprint_for(
+    float radius) {
+  // Units of a match share a handful of sight radii.
+  for (const Footprint& footprint : footprints) {
+    if (footprint.radius == radius) {
+      return footprint;
+    }
+  }
+
+  Footprint footprint;
+  footprint.radius = radius;
+  const float cells = radius * inverse_cell_size;
+  footprint.reach = static_cast<int32_t>(std::floor(cells));
+  for (int32_t row = -footprint.reach; row <= footprint.reach; ++row) {
+    const float span = cells * cells - static_cast<float>(row * row);
+    footprint.half_widths.push_back(
+        static_cast<int32_t>(std::floor(std::sqrt(std::max(span, 0.0f)))));
+  }
+  footprints.push_back(std::move(footprint));
+  return footprints.back();
+}
+
+float VisibilityGrid::_viewer_height(int32_t cell,
+                                     const Vector3& position) const {
+  if (!occluders.is_baked()) {
+    return 0.0f;
+  }
+  const float ground = occluders.get_height(cell);
+  if (ground == OccluderGrid::WALL || ground == OccluderGrid::OPEN) {
+    return position.y;
+  }
+  return ground;
+}
+
+void VisibilityGrid::_compute_sight(Viewer& viewer,
+                                    int32_t cell,
+                                    float radius,
+                                    float height) {
+  const Footprint& footprint = _footprint_for(radius);
+  const int32_t reach = footprint.reach;
+  const int32_t center_x = cell % width;
+  const int32_t center_z = cell / width;
+  viewer.sight_cell = cell;
+  viewer.sight_radius = radius;
+  viewer.sight_height = height;
+  viewer.sight_version = sight_version;
+  viewer.sight.clear();
+
+  if (!occluders.is_baked()) {
+    // Nothing blocks: the clipped disc, one run per row.
+    const int32_t first_row = std::max(-reach, -center_z);
+    const int32_t last_row = std::min(reach, depth - 1 - center_z);
+    for (int32_t row = first_row; row <= last_row; ++row) {
+      const int32_t half_width = footprint.half_widths[row + reach];
+      const int32_t first_x = std::max(center_x - half_width, 0);
+      const int32_t last_x = std::min(center_x + half_width, width - 1);
+      viewer.sight.push_back(
+          {(center_z + row) * width + first_x, last_x - first_x + 1});
+    }
+    return;
+  }
+
+  // Shadowcast over a window of (2 reach + 1)^2 cells around the viewer.
+  const int32_t size = 2 * reach + 1;
+  const size_t area = static_cast<size_t>(size) * size;
+  window_opaque.resize(area);
+  window_opaque_transposed.resize(area);
+  window_lit.assign(area, 0);
+  window_lit_transposed.assign(area, 0);
+  const int32_t first_x = center_x - reach;
+  const int32_t first_z = center_z - reach;
+  occluders.fill_opacity(first_x, first_z, size, height, window_opaque.data());
+  for (int32_t z = 0; z < size; ++z) {
+    for (int32_t x = 0; x < size; ++x) {
+      window_opaque_transposed[static_cast<size_t>(x) * size + z] =
+          window_opaque[static_cast<size_t>(z) * size + x];
+    }
+  }
+
+  window_lit[static_cast<size_t>(reach) * size + reach] = 1;
+  _cast_quadrant(footprint, 0, window_opaque.data(), window_lit.data());
+  _cast_quadrant(footprint, 1, window_opaque.data(), window_lit.data());
+  _cast_quadrant(footprint, 2, window_opaque_transposed.data(),
+                 window_lit_transposed.data());
+  _cast_quadrant(footprint, 3, window_opaque_transposed.data(),
+                 window_lit_transposed.data());
+
+  // Merge the two orientations and emit runs, skipping cells off the map.
+  const int32_t begin_x = std::max(-first_x, 0);
+  const int32_t end_x = std::min(width - first_x, size);
+  for (int32_t z = 0; z < size; ++z) {
+    const int32_t grid_z = first_z + z;
+    if (grid_z < 0 || grid_z >= depth) {
+      continue;
+    }
+    uint8_t* line = window_lit.data() + static_cast<size_t>(z) * size;
+    for (int32_t x = 0; x < size; ++x) {
+      line[x] |= window_lit_transposed[static_cast<size_t>(x) * size + z];
+    }
+    int32_t x = begin_x;
+    while (x < end_x) {
+      if (line[x] == 0) {
+        ++x;
+        continue;
+      }
+      const int32_t run_begin = x;
+      while (x < end_x && line[x] != 0) {
+        ++x;
+      }
+      viewer.sight.push_back(
+          {grid_z * width + first_x + run_begin, x - run_begin});
+    }
+  }
+}
+
+void VisibilityGrid::_cast_quadrant(const Footprint& footprint,
+                                    int32_t direction,
+                                    const uint8_t* opaque,
+                                    uint8_t* lit) {
+  // Symmetric recursive shadowcasting, with the recursion on an explicit
+  // stack of rows. direction 0 and 1 walk rows up and down the window,
+  // 2 and 3 walk columns of the transposed window left and right; either
+  // way a row of the quadrant is one contiguous span.
+  const int32_t reach = footprint.reach;
+  const int32_t size = 2 * reach + 1;
+  const int32_t sign = direction == 0 || direction == 2 ? -1 : 1;
+
+  rows.clear();
+  rows.push_back({1, -1.0f, 1.0f});
+  while (!rows.empty()) {
+    SightRow row = rows.back();
+    rows.pop_back();
+    if (row.depth > reach) {
+      continue;
+    }
+
+    const size_t line = static_cast<size_t>(reach + sign * row.depth) * size;
+    const uint8_t* blocked = opaque + line + reach;
+    uint8_t* seen = lit + line + reach;
+    const int32_t half_width = footprint.half_widths[reach + row.depth];
+    const float depth_f = static_cast<float>(row.depth);
+    const int32_t min_column =
+        static_cast<int32_t>(std::floor(depth_f * row.start_slope + 0.5f));
+    const int32_t max_column =
+        static_cast<int32_t>(std::ceil(depth_f * row.end_slope - 0.5f));
+
+    int32_t previous = -1;  // Unknown, then 1 for a wall, 0 for floor
+    for (int32_t column = min_column; column <= max_column; ++column) {
+      const int32_t wall = blocked[column];
+      const float column_f = static_cast<float>(column);
+      // Walls are seen; floors only when the viewer would be seen back.
+      if ((wall != 0 || (column_f >= depth_f * row.start_slope &&
+                         column_f <= depth_f * row.end_slope)) &&
+          column >= -half_width && column <= half_width) {
+        seen[column] = 1;
+      }
+      const float slope = (2.0f * column_f - 1.0f) / (2.0f * depth_f);
+      if (previous == 1 && wall == 0) {
+        row.start_slope = slope;
+      } else if (previous == 0 && wall != 0) {
+        rows.push_back({row.depth + 1, row.start_slope, slope});
+      }
+      previous = wall;
+    }
+    if (previous == 0) {
+      rows.push_back({row.depth + 1, row.start_slope, row.end_slope});
+    }
+  }
+}
+
+void VisibilityGrid::_stamp(const Viewer& viewer, int32_t delta) {
+  uint16_t* layer_counts =
+      counts.data() + static_cast<size_t>(viewer.layer) * cell_count;
+  uint64_t* layer_bits = bits.data() + viewer.layer * words_per_layer;
+  for (const Run& run : viewer.sight) {
+    const int32_t end = run.begin + run.count;
+    for (int32_t cell = run.begin; cell < end; ++cell) {
+      // Only the first viewer in and the last one out touch the bitset.
+      const uint64_t mask = uint64_t(1) << (cell & 63);
+      bool flipped = false;
+      if (delta > 0) {
+        if (layer_counts[cell]++ == 0) {
+          layer_bits[cell >> 6] |= mask;
+          flipped = true;
+        }
+      } else if (--layer_counts[cell] == 0) {
+        layer_bits[cell >> 6] &= ~mask;
+        flipped = true;
+      }
+      if (flipped) {
+        uint64_t& changed = changed_bits[cell >> 6];
+        if (changed == 0) {
+          changed_words.push_back(cell >> 6);
+        }
+        changed |= mask;
+      }
+    }
+  }
+}
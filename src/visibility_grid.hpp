@@ -0,0 +1,180 @@
+#ifndef GDEXTENSION_VISIBILITY_GRID_H
+#define GDEXTENSION_VISIBILITY_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <godot_cpp/variant/vector3.hpp>
+
+#include "occluder_grid.hpp"
+
+using godot::Vector3;
+
+class UnitRegistry;
+
+// Fog of war: which cells of the map each faction currently sees.
+//
+// Every living unit with a sight radius reveals the cells it has line of
+// sight to within that radius, in its faction's layer. A layer counts the
+// viewers of every cell and mirrors "count > 0" into a packed bitset, so
+// whether a faction sees a cell, or the unit standing in it, is a single bit
+// test.
+//
+// Line of sight comes from shadowcasting against the OccluderGrid; without
+// baked occluders a unit sees the whole disc. The result depends only on
+// the viewer's cell, radius and height, so each viewer caches it as row
+// runs and recomputes it only after moving to a new cell. update() is
+// incremental: a unit is only re-stamped when its cell, faction, sight or
+// life changed.
+//
+// The grid is bounded. Positions outside it count as the nearest edge cell.
+// A grid without cells is disabled and sees everything.
+class VisibilityGrid {
+ public:
+  // Starts over with nothing seen and no occluders. width or depth of 0
+  // disables the grid.
+  void configure(const Vector3& origin,
+                 int32_t width,
+                 int32_t depth,
+                 float cell_size);
+  bool is_enabled() const { return cell_count > 0; }
+
+  const Vector3& get_origin() const;
+  int32_t get_width() const;
+  int32_t get_depth() const;
+  float get_cell_size() const;
+  int32_t cell_of(const Vector3& position) const;
+
+  // Re-stamps the units that changed since the last update.
+  void update(const UnitRegistry& registry);
+
+  // Bake into it, then call invalidate_sight() so every viewer recomputes
+  // its line of sight on the next update.
+  OccluderGrid& get_occluders();
+  const OccluderGrid& get_occluders() const;
+  void invalidate_sight();
+
+  // Layer of a faction, or -1 while it has never had a unit with sight.
+  // Look it up once per query loop, then test bits.
+  int32_t find_layer(int32_t faction) const;
+  bool is_cell_visible(int32_t layer, int32_t cell) const {
+    const uint64_t word =
+        bits[static_cast<size_t>(layer) * words_per_layer + (cell >> 6)];
+    return ((word >> (cell & 63)) & 1) != 0;
+  }
+  // As of the last update; slots registered since are not visible yet.
+  bool is_slot_visible(int32_t layer, int32_t slot) const {
+    return slot >= 0 && slot < static_cast<int32_t>(slot_cells.size()) &&
+           slot_cells[slot] >= 0 && is_cell_visible(layer, slot_cells[slot]);
+  }
+
+  // Cell of the slot as of the last update, -1 for free or new slots.
+  int32_t get_slot_cell(int32_t slot) const {
+    return slot >= 0 && slot < static_cast<int32_t>(slot_cells.size())
+               ? slot_cells[slot]
+               : -1;
+  }
+  // Whether any faction started or stopped seeing the cell during the last
+  // update. Lets users of the grid follow its changes instead of polling.
+  bool is_cell_changed(int32_t cell) const {
+    return ((changed_bits[cell >> 6] >> (cell & 63)) & 1) != 0;
+  }
+
+  // Convenience forms that look the layer up; true while disabled.
+  bool can_see(int32_t faction, int32_t slot) const;
+  bool can_see_position(int32_t faction, const Vector3& position) const;
+  int32_t get_visible_cell_count(int32_t faction) const;
+
+  // Units re-stamped by the last update, and how many of those had to
+  // recompute their line of sight, for profiling.
+  int32_t get_last_update_stamps() const;
+  int32_t get_last_update_sight_passes() const;
+
+  size_t get_memory_usage() const;
+
+ private:
+  // Disc of cells for one sight radius: the half width of each row, for
+  // rows -reach through reach around the center cell.
+  struct Footprint {
+    float radius = 0.0f;
+    int32_t reach = 0;
+    std::vector<int32_t> half_widths;
+  };
+
+  // Cells [begin, begin + count) of one grid row.
+  struct Run {
+    int32_t begin = 0;
+    int32_t count = 0;
+  };
+
+  // What a slot has stamped, so it can be taken back, and the cached line
+  // of sight it stamped.
+  struct Viewer {
+    int64_t handle = 0;
+    int32_t cell = -1;  // -1 when nothing is stamped
+    int32_t layer = -1;
+    float radius = 0.0f;
+    int32_t sight_cell = -1;  // Cache key: cell, radius, height, version
+    float sight_radius = 0.0f;
+    float sight_height = 0.0f;
+    uint32_t sight_version = 0;
+    std::vector<Run> sight;
+  };
+
+  // One row of a shadowcasting quadrant, between two slopes.
+  struct SightRow {
+    int32_t depth = 0;
+    float start_slope = 0.0f;
+    float end_slope = 0.0f;
+  };
+
+  int32_t _layer_for(int32_t faction);
+  const Footprint& _footprint_for(float radius);
+  // Height sight is cast from: the baked ground of the cell, or the unit's
+  // own height on a WALL or OPEN cell, which have no ground to stand on.
+  float _viewer_height(int32_t cell, const Vector3& position) const;
+  void _compute_sight(Viewer& viewer,
+                      int32_t cell,
+                      float radius,
+                      float height);
+  // Marks what one quadrant of the window sees. opaque and lit are the
+  // window, transposed for the east and west quadrants, so each row of a
+  // quadrant is contiguous in memory.
+  void _cast_quadrant(const Footprint& footprint,
+                      int32_t direction,
+                      const uint8_t* opaque,
+                      uint8_t* lit);
+  // Adds (+1) or removes (-1) the viewer's cells from its layer.
+  void _stamp(const Viewer& viewer, int32_t delta);
+
+  Vector3 origin;
+  int32_t width = 0;
+  int32_t depth = 0;
+  float cell_size = 2.0f;
+  float inverse_cell_size = 0.5f;
+  int32_t cell_count = 0;
+  size_t words_per_layer = 0;
+
+  std::vector<int32_t> layer_factions;
+  std::vector<uint16_t> counts;  // layer * cell_count + cell
+  std::vector<uint64_t> bits;    // layer * words_per_layer + cell / 64
+  std::vector<uint64_t> changed_bits;   // cell / 64, any layer
+  std::vector<int32_t> changed_words;   // Nonzero words of changed_bits
+  std::vector<Footprint> footprints;
+  std::vector<Viewer> viewers;     // Per slot
+  std::vector<int32_t> slot_cells;  // Per slot, -1 for free slots
+  OccluderGrid occluders;
+  uint32_t sight_version = 1;
+  int32_t last_update_stamps = 0;
+  int32_t last_update_sight_passes = 0;
+
+  // Shadowcasting scratch, reused by every viewer.
+  std::vector<uint8_t> window_opaque;
+  std::vector<uint8_t> window_opaque_transposed;
+  std::vector<uint8_t> window_lit;
+  std::vector<uint8_t> window_lit_transposed;
+  std::vector<SightRow> rows;
+};
+
+#endif  // GDEXTENSION_VISIBILITY_GRID_H
@@ -0,0 +1,347 @@
+#include "wave_spawner.hpp"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/navigation_server3d.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/world3d.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/core/object.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "match_manager.hpp"
+#include "movement_component.hpp"
+#include "unit.hpp"
+#include "unit_pool.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::MethodInfo;
+using godot::NavigationServer3D;
+using godot::ObjectDB;
+using godot::PropertyInfo;
+using godot::StringName;
+using godot::Time;
+using godot::Transform3D;
+using godot::UtilityFunctions;
+using godot::Variant;
+
+WaveSpawner::WaveSpawner() = default;
+
+WaveSpawner::~WaveSpawner() = default;
+
+void WaveSpawner::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("set_unit_scene", "scene"),
+                       &WaveSpawner::set_unit_scene);
+  ClassDB::bind_method(D_METHOD("get_unit_scene"),
+                       &WaveSpawner::get_unit_scene);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "unit_scene",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"),
+               "set_unit_scene", "get_unit_scene");
+
+  ClassDB::bind_method(D_METHOD("set_faction_id", "faction_id"),
+                       &WaveSpawner::set_faction_id);
+  ClassDB::bind_method(D_METHOD("get_faction_id"),
+                       &WaveSpawner::get_faction_id);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "faction_id"), "set_faction_id",
+               "get_faction_id");
+
+  ClassDB::bind_method(D_METHOD("set_wave_size", "size"),
+                       &WaveSpawner::set_wave_size);
+  ClassDB::bind_method(D_METHOD("get_wave_size"), &WaveSpawner::get_wave_size);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "wave_size",
+                            godot::PROPERTY_HINT_RANGE, "1,500,1"),
+               "set_wave_size", "get_wave_size");
+
+  ClassDB::bind_method(D_METHOD("set_wave_interval", "seconds"),
+                       &WaveSpawner::set_wave_interval);
+  ClassDB::bind_method(D_METHOD("get_wave_interval"),
+                       &WaveSpawner::get_wave_interval);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "wave_interval",
+                            godot::PROPERTY_HINT_RANGE, "0,300,0.5"),
+               "set_wave_interval", "get_wave_interval");
+
+  ClassDB::bind_method(D_METHOD("set_spacing", "distance"),
+                       &WaveSpawner::set_spacing);
+  ClassDB::bind_method(D_METHOD("get_spacing"), &WaveSpawner::get_spacing);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "spacing",
+                            godot::PROPERTY_HINT_RANGE, "0.1,10,0.1"),
+               "set_spacing", "get_spacing");
+
+  ClassDB::bind_method(D_METHOD("set_frame_budget_usec", "usec"),
+                       &WaveSpawner::set_frame_budget_usec);
+  ClassDB::bind_method(D_METHOD("get_frame_budget_usec"),
+                       &WaveSpawner::get_frame_budget_usec);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "frame_budget_usec",
+                            godot::PROPERTY_HINT_RANGE, "100,16000,100"),
+               "set_frame_budget_usec", "get_frame_budget_usec");
+
+  ClassDB::bind_method(D_METHOD("set_deterministic_spawns_per_tick", "count"),
+                       &WaveSpawner::set_deterministic_spawns_per_tick);
+  ClassDB::bind_method(D_METHOD("get_deterministic_spawns_per_tick"),
+                       &WaveSpawner::get_deterministic_spawns_per_tick);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "deterministic_spawns_per_tick",
+                            godot::PROPERTY_HINT_RANGE, "1,100,1"),
+               "set_deterministic_spawns_per_tick",
+               "get_deterministic_spawns_per_tick");
+
+  ClassDB::bind_method(D_METHOD("set_prewarm_count", "count"),
+                       &WaveSpawner::set_prewarm_count);
+  ClassDB::bind_method(D_METHOD("get_prewarm_count"),
+                       &WaveSpawner::get_prewarm_count);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "prewarm_count",
+                            godot::PROPERTY_HINT_RANGE, "-1,500,1"),
+               "set_prewarm_count", "get_prewarm_count");
+
+  ClassDB::bind_method(D_METHOD("spawn_wave", "count"),
+                       &WaveSpawner::spawn_wave);
+  ClassDB::bind_method(D_METHOD("get_pending_spawn_count"),
+                       &WaveSpawner::get_pending_spawn_count);
+
+  ADD_SIGNAL(MethodInfo("unit_spawned",
+                        PropertyInfo(Variant::OBJECT, "unit",
+                                     godot::PROPERTY_HINT_NODE_TYPE, "Unit")));
+  // Emitted once the last unit of a spawn_wave() call is in the match.
+  ADD_SIGNAL(
+      MethodInfo("wave_spawned", PropertyInfo(Variant::INT, "count")));
+}
+
+void WaveSpawner::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    set_physics_process(false);
+    return;
+  }
+
+  match = MatchManager::find_for(this);
+  if (match != nullptr) {
+    pool = match->get_unit_pool();
+  }
+  if (pool == nullptr) {
+    // No shared pool; keep one for this spawner's units.
+    pool = memnew(UnitPool);
+    pool->set_name("UnitPool");
+    add_child(pool);
+  }
+  time_until_wave = wave_interval;
+}
+
+void WaveSpawner::_physics_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  if (wave_interval > 0.0f) {
+    time_until_wave -= delta;
+    if (time_until_wave <= 0.0) {
+      spawn_wave(wave_size);
+      time_until_wave += wave_interval;
+    }
+  }
+
+  const uint64_t start_usec = Time::get_singleton()->get_ticks_usec();
+  _spawn_pending(start_usec);
+  _release_navigation();
+  if (pending_head == static_cast<int32_t>(pending.size())) {
+    _prewarm(start_usec);
+  }
+}
+
+void WaveSpawner::set_unit_scene(const Ref<PackedScene>& scene) {
+  unit_scene = scene;
+}
+
+Ref<PackedScene> WaveSpawner::get_unit_scene() const {
+  return unit_scene;
+}
+
+void WaveSpawner::set_faction_id(int32_t new_faction_id) {
+  faction_id = new_faction_id;
+}
+
+int32_t WaveSpawner::get_faction_id() const {
+  return faction_id;
+}
+
+void WaveSpawner::set_wave_size(int32_t size) {
+  wave_size = std::max(size, 1);
+}
+
+int32_t WaveSpawner::get_wave_size() const {
+  return wave_size;
+}
+
+void WaveSpawner::set_wave_interval(float seconds) {
+  wave_interval = std::max(seconds, 0.0f);
+}
+
+float WaveSpawner::get_wave_interval() const {
+  return wave_interval;
+}
+
+void WaveSpawner::set_spacing(float distance) {
+  spacing = std::max(distance, 0.1f);
+}
+
+float WaveSpawner::get_spacing() const {
+  return spacing;
+}
+
+void WaveSpawner::set_frame_budget_usec(int32_t usec) {
+  frame_budget_usec = std::max(usec, 100);
+}
+
+int32_t WaveSpawner::get_frame_budget_usec() const {
+  return frame_budget_usec;
+}
+
+void WaveSpawner::set_deterministic_spawns_per_tick(int32_t count) {
+  deterministic_spawns_per_tick = std::max(count, 1);
+}
+
+int32_t WaveSpawner::get_deterministic_spawns_per_tick() const {
+  return deterministic_spawns_per_tick;
+}
+
+void WaveSpawner::set_prewarm_count(int32_t count) {
+  prewarm_count = std::max(count, -1);
+}
+
+int32_t WaveSpawner::get_prewarm_count() const {
+  return prewarm_count;
+}
+
+void WaveSpawner::spawn_wave(int32_t count) {
+  if (count <= 0 || unit_scene.is_null() || !is_inside_tree()) {
+    return;
+  }
+
+  // Compact the queue before growing it so it never creeps.
+  if (pending_head > 0) {
+    pending.erase(pending.begin(), pending.begin() + pending_head);
+    pending_head = 0;
+  }
+
+  // Square grid centered on the spawner, in its orientation.
+  const Transform3D transform = get_global_transform();
+  const int32_t columns =
+      static_cast<int32_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+  const int32_t rows = (count + columns - 1) / columns;
+  const float x_offset = (columns - 1) * spacing * 0.5f;
+  const float z_offset = (rows - 1) * spacing * 0.5f;
+  for (int32_t i = 0; i < count; ++i) {
+    const Vector3 local((i % columns) * spacing - x_offset, 0.0f,
+                        (i / columns) * spacing - z_offset);
+    PendingSpawn spawn;
+    spawn.position = transform.xform(local);
+    pending.push_back(spawn);
+  }
+  pending.back().wave_count = count;
+}
+
+int32_t WaveSpawner::get_pending_spawn_count() const {
+  return static_cast<int32_t>(pending.size()) - pending_head;
+}
+
+void WaveSpawner::_spawn_pending(uint64_t start_usec) {
+  if (pool == nullptr) {
+    return;
+  }
+
+  const bool deterministic = match != nullptr && match->is_deterministic();
+  int32_t spawned = 0;
+  while (pending_head < static_cast<int32_t>(pending.size())) {
+    if (deterministic) {
+      // Count, not time, so every peer adds the same units on the same tick.
+      if (spawned == deterministic_spawns_per_tick) {
+        break;
+      }
+    } else if (spawned > 0 && !_has_budget(start_usec, spawn_cost_usec)) {
+      // At least one per frame so a tiny budget still makes progress.
+      break;
+    }
+
+    const PendingSpawn spawn = pending[pending_head++];
+    const uint64_t before_usec = Time::get_singleton()->get_ticks_usec();
+    Unit* unit = pool->spawn(unit_scene, spawn.position, faction_id);
+    _update_cost(spawn_cost_usec,
+                 Time::get_singleton()->get_ticks_usec() - before_usec);
+    spawned++;
+
+    if (unit != nullptr) {
+      awaiting_navigation.push_back(unit->get_instance_id());
+      emit_signal("unit_spawned", unit);
+    }
+    if (spawn.wave_count > 0) {
+      emit_signal("wave_spawned", spawn.wave_count);
+    }
+  }
+
+  if (pending_head == static_cast<int32_t>(pending.size())) {
+    pending.clear();
+    pending_head = 0;
+  }
+}
+
+void WaveSpawner::_prewarm(uint64_t start_usec) {
+  if (pool == nullptr || unit_scene.is_null()) {
+    return;
+  }
+
+  // One instance at a time, so instancing cost spreads over idle frames.
+  const int32_t target = prewarm_count < 0 ? wave_size : prewarm_count;
+  while (pool->get_free_count(unit_scene) < target &&
+         _has_budget(start_usec, instance_cost_usec)) {
+    const uint64_t before_usec = Time::get_singleton()->get_ticks_usec();
+    const int32_t free_before = pool->get_free_count(unit_scene);
+    pool->prewarm(unit_scene, 1);
+    _update_cost(instance_cost_usec,
+                 Time::get_singleton()->get_ticks_usec() - before_usec);
+    if (pool->get_free_count(unit_scene) == free_before) {
+      return;  // The scene does not instance a Unit
+    }
+  }
+}
+
+void WaveSpawner::_release_navigation() {
+  if (awaiting_navigation.empty()) {
+    return;
+  }
+
+  // One query for the whole batch: once the map has synced, paths can be
+  // requested right away and the per-agent warm-up is unnecessary.
+  const godot::RID map = get_world_3d()->get_navigation_map();
+  if (NavigationServer3D::get_singleton()->map_get_iteration_id(map) == 0) {
+    return;
+  }
+
+  const StringName movement_class("MovementComponent");
+  for (uint64_t instance_id : awaiting_navigation) {
+    auto unit = Object::cast_to<Unit>(ObjectDB::get_instance(instance_id));
+    if (unit == nullptr) {
+      continue;
+    }
+    auto movement = Object::cast_to<MovementComponent>(
+        unit->get_component_by_class(movement_class));
+    if (movement != nullptr) {
+      movement->set_navigation_ready();
+    }
+  }
+  awaiting_navigation.clear();
+}
+
+bool WaveSpawner::_has_budget(uint64_t start_usec, uint64_t cost_usec) const {
+  const uint64_t elapsed = Time::get_singleton()->get_ticks_usec() - start_usec;
+  return elapsed + cost_usec <= static_cast<uint64_t>(frame_budget_usec);
+}
+
+void WaveSpawner::_update_cost(uint64_t& average_usec, uint64_t sample_usec) {
+  // Leans towards the newest sample so the estimate follows scene changes.
+  average_usec =
+      average_usec == 0 ? sample_usec : (average_usec * 3 + sample_usec) / 4;
+}
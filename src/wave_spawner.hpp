@@ -0,0 +1,113 @@
+#ifndef GDEXTENSION_WAVE_SPAWNER_H
+#define GDEXTENSION_WAVE_SPAWNER_H
+
+#include <godot_cpp/classes/node3d.hpp>
+#include <godot_cpp/classes/packed_scene.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using godot::Node3D;
+using godot::PackedScene;
+using godot::Ref;
+using godot::Vector3;
+
+class MatchManager;
+class UnitPool;
+
+// Spawns waves of one unit scene in a grid around the spawner without
+// hitching the frame. Spawn requests are queued and worked off under a
+// per-frame time budget, and in idle frames the budget is spent
+// instancing units into the match's UnitPool ahead of the next wave, so a
+// wave mostly reuses ready-made instances.
+//
+// Deterministic matches cap spawns by count per tick instead of time, so
+// every peer adds units on the same tick.
+//
+// Navigation readiness is checked once per frame for the whole batch:
+// once the navigation map has synced, new units skip the per-agent warm-up
+// frames of MovementComponent.
+class WaveSpawner : public Node3D {
+  GDCLASS(WaveSpawner, Node3D)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  WaveSpawner();
+  ~WaveSpawner();
+
+  void _ready() override;
+  void _physics_process(double delta) override;
+
+  void set_unit_scene(const Ref<PackedScene>& scene);
+  Ref<PackedScene> get_unit_scene() const;
+
+  void set_faction_id(int32_t new_faction_id);
+  int32_t get_faction_id() const;
+
+  void set_wave_size(int32_t size);
+  int32_t get_wave_size() const;
+
+  // Seconds between automatic waves; 0 spawns only on spawn_wave().
+  void set_wave_interval(float seconds);
+  float get_wave_interval() const;
+
+  // Distance between units of the spawn grid.
+  void set_spacing(float distance);
+  float get_spacing() const;
+
+  // Time per frame spent spawning and prewarming.
+  void set_frame_budget_usec(int32_t usec);
+  int32_t get_frame_budget_usec() const;
+
+  // Spawns per tick in deterministic matches.
+  void set_deterministic_spawns_per_tick(int32_t count);
+  int32_t get_deterministic_spawns_per_tick() const;
+
+  // Idle instances kept in the pool; -1 keeps one wave's worth.
+  void set_prewarm_count(int32_t count);
+  int32_t get_prewarm_count() const;
+
+  // Queues count units in a grid around the spawner.
+  void spawn_wave(int32_t count);
+  int32_t get_pending_spawn_count() const;
+
+ private:
+  struct PendingSpawn {
+    Vector3 position;  // Global
+    int32_t wave_count = 0;  // Set on the last unit of a wave
+  };
+
+  // Spawns queued units while the budget allows.
+  void _spawn_pending(uint64_t start_usec);
+  void _prewarm(uint64_t start_usec);
+  void _release_navigation();
+  bool _has_budget(uint64_t start_usec, uint64_t cost_usec) const;
+  static void _update_cost(uint64_t& average_usec, uint64_t sample_usec);
+
+  Ref<PackedScene> unit_scene;
+  int32_t faction_id = 0;
+  int32_t wave_size = 20;
+  float wave_interval = 30.0f;
+  float spacing = 1.5f;
+  int32_t frame_budget_usec = 2000;
+  int32_t deterministic_spawns_per_tick = 10;
+  int32_t prewarm_count = -1;
+
+  MatchManager* match = nullptr;
+  UnitPool* pool = nullptr;
+  double time_until_wave = 0.0;
+
+  std::vector<PendingSpawn> pending;  // Spawned front first
+  int32_t pending_head = 0;
+  std::vector<uint64_t> awaiting_navigation;  // Instance ids of units
+
+  // Running averages used to stop before the budget is exceeded.
+  uint64_t spawn_cost_usec = 0;
+  uint64_t instance_cost_usec = 0;
+};
+
+#endif  // GDEXTENSION_WAVE_SPAWNER_H
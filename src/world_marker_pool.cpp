@@ -0,0 +1,306 @@
+#include "world_marker_pool.hpp"
+
+#include <algorithm>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/geometry_instance3d.hpp>
+#include <godot_cpp/classes/gpu_particles3d.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/property_info.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "match_manager.hpp"
+
+using godot::ClassDB;
+using godot::D_METHOD;
+using godot::Engine;
+using godot::GeometryInstance3D;
+using godot::GPUParticles3D;
+using godot::Node;
+using godot::PropertyInfo;
+using godot::UtilityFunctions;
+using godot::Variant;
+
+WorldMarkerPool::WorldMarkerPool() {
+  sets[static_cast<int32_t>(MarkerKind::CLICK)].lifetime = 2.0f;
+  sets[static_cast<int32_t>(MarkerKind::HIT_SPARK)].lifetime = 0.3f;
+  sets[static_cast<int32_t>(MarkerKind::IMPACT)].lifetime = 0.5f;
+}
+
+WorldMarkerPool::~WorldMarkerPool() = default;
+
+void WorldMarkerPool::_bind_methods() {
+  ClassDB::bind_method(D_METHOD("spawn_click_marker", "position"),
+                       &WorldMarkerPool::spawn_click_marker);
+  ClassDB::bind_method(D_METHOD("spawn_hit_spark", "position"),
+                       &WorldMarkerPool::spawn_hit_spark);
+  ClassDB::bind_method(D_METHOD("spawn_impact", "position"),
+                       &WorldMarkerPool::spawn_impact);
+
+  ClassDB::bind_method(D_METHOD("set_click_marker_scene", "scene"),
+                       &WorldMarkerPool::set_click_marker_scene);
+  ClassDB::bind_method(D_METHOD("get_click_marker_scene"),
+                       &WorldMarkerPool::get_click_marker_scene);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "click_marker_scene",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"),
+               "set_click_marker_scene", "get_click_marker_scene");
+  ClassDB::bind_method(D_METHOD("set_click_marker_lifetime", "lifetime"),
+                       &WorldMarkerPool::set_click_marker_lifetime);
+  ClassDB::bind_method(D_METHOD("get_click_marker_lifetime"),
+                       &WorldMarkerPool::get_click_marker_lifetime);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "click_marker_lifetime"),
+               "set_click_marker_lifetime", "get_click_marker_lifetime");
+
+  ClassDB::bind_method(D_METHOD("set_hit_spark_scene", "scene"),
+                       &WorldMarkerPool::set_hit_spark_scene);
+  ClassDB::bind_method(D_METHOD("get_hit_spark_scene"),
+                       &WorldMarkerPool::get_hit_spark_scene);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "hit_spark_scene",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"),
+               "set_hit_spark_scene", "get_hit_spark_scene");
+  ClassDB::bind_method(D_METHOD("set_hit_spark_lifetime", "lifetime"),
+                       &WorldMarkerPool::set_hit_spark_lifetime);
+  ClassDB::bind_method(D_METHOD("get_hit_spark_lifetime"),
+                       &WorldMarkerPool::get_hit_spark_lifetime);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "hit_spark_lifetime"),
+               "set_hit_spark_lifetime", "get_hit_spark_lifetime");
+
+  ClassDB::bind_method(D_METHOD("set_impact_scene", "scene"),
+                       &WorldMarkerPool::set_impact_scene);
+  ClassDB::bind_method(D_METHOD("get_impact_scene"),
+                       &WorldMarkerPool::get_impact_scene);
+  ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "impact_scene",
+                            godot::PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"),
+               "set_impact_scene", "get_impact_scene");
+  ClassDB::bind_method(D_METHOD("set_impact_lifetime", "lifetime"),
+                       &WorldMarkerPool::set_impact_lifetime);
+  ClassDB::bind_method(D_METHOD("get_impact_lifetime"),
+                       &WorldMarkerPool::get_impact_lifetime);
+  ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "impact_lifetime"),
+               "set_impact_lifetime", "get_impact_lifetime");
+
+  ClassDB::bind_method(D_METHOD("set_markers_per_kind", "count"),
+                       &WorldMarkerPool::set_markers_per_kind);
+  ClassDB::bind_method(D_METHOD("get_markers_per_kind"),
+                       &WorldMarkerPool::get_markers_per_kind);
+  ADD_PROPERTY(PropertyInfo(Variant::INT, "markers_per_kind"),
+               "set_markers_per_kind", "get_markers_per_kind");
+
+  ClassDB::bind_method(D_METHOD("get_active_marker_count"),
+                       &WorldMarkerPool::get_active_marker_count);
+}
+
+void WorldMarkerPool::_ready() {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  for (int32_t kind = 0; kind < static_cast<int32_t>(MarkerKind::COUNT);
+       ++kind) {
+    _warm_up(static_cast<MarkerKind>(kind));
+  }
+  set_process(false);
+}
+
+void WorldMarkerPool::_process(double delta) {
+  if (Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  for (MarkerSet& set : sets) {
+    for (Marker& marker : set.markers) {
+      if (!marker.active) {
+        continue;
+      }
+
+      marker.age += static_cast<float>(delta);
+      if (marker.age >= set.lifetime) {
+        marker.active = false;
+        marker.node->set_visible(false);
+        active_count--;
+        continue;
+      }
+      _set_fade(marker, marker.age / set.lifetime);
+    }
+  }
+
+  if (active_count == 0) {
+    set_process(false);
+  }
+}
+
+void WorldMarkerPool::spawn(MarkerKind kind, const Vector3& position) {
+  MarkerSet& set = sets[static_cast<int32_t>(kind)];
+  if (set.markers.empty()) {
+    return;  // No scene configured for this kind.
+  }
+
+  // Round robin: with one lifetime per kind the next slot is always the
+  // oldest marker.
+  Marker& marker = set.markers[set.next];
+  set.next = (set.next + 1) % static_cast<int32_t>(set.markers.size());
+
+  if (!marker.active) {
+    marker.active = true;
+    active_count++;
+  }
+  marker.age = 0.0f;
+  _set_fade(marker, 0.0f);
+  marker.node->set_global_position(position);
+  marker.node->set_visible(true);
+
+  if (auto particles = Object::cast_to<GPUParticles3D>(marker.node)) {
+    particles->restart();
+  }
+  set_process(true);
+}
+
+void WorldMarkerPool::spawn_click_marker(const Vector3& position) {
+  spawn(MarkerKind::CLICK, position);
+}
+
+void WorldMarkerPool::spawn_hit_spark(const Vector3& position) {
+  spawn(MarkerKind::HIT_SPARK, position);
+}
+
+void WorldMarkerPool::spawn_impact(const Vector3& position) {
+  spawn(MarkerKind::IMPACT, position);
+}
+
+void WorldMarkerPool::spawn_for(const Node* node,
+                                MarkerKind kind,
+                                const Vector3& position) {
+  MatchManager* match = MatchManager::find_for(node);
+  if (match != nullptr && match->get_marker_pool() != nullptr) {
+    match->get_marker_pool()->spawn(kind, position);
+  }
+}
+
+void WorldMarkerPool::set_click_marker_scene(const Ref<PackedScene>& scene) {
+  sets[static_cast<int32_t>(MarkerKind::CLICK)].scene = scene;
+  _warm_up(MarkerKind::CLICK);
+}
+
+Ref<PackedScene> WorldMarkerPool::get_click_marker_scene() const {
+  return sets[static_cast<int32_t>(MarkerKind::CLICK)].scene;
+}
+
+void WorldMarkerPool::set_click_marker_lifetime(float lifetime) {
+  sets[static_cast<int32_t>(MarkerKind::CLICK)].lifetime =
+      std::max(0.01f, lifetime);
+}
+
+float WorldMarkerPool::get_click_marker_lifetime() const {
+  return sets[static_cast<int32_t>(MarkerKind::CLICK)].lifetime;
+}
+
+void WorldMarkerPool::set_hit_spark_scene(const Ref<PackedScene>& scene) {
+  sets[static_cast<int32_t>(MarkerKind::HIT_SPARK)].scene = scene;
+  _warm_up(MarkerKind::HIT_SPARK);
+}
+
+Ref<PackedScene> WorldMarkerPool::get_hit_spark_scene() const {
+  return sets[static_cast<int32_t>(MarkerKind::HIT_SPARK)].scene;
+}
+
+void WorldMarkerPool::set_hit_spark_lifetime(float lifetime) {
+  sets[static_cast<int32_t>(MarkerKind::HIT_SPARK)].lifetime =
+      std::max(0.01f, lifetime);
+}
+
+float WorldMarkerPool::get_hit_spark_lifetime() const {
+  return sets[static_cast<int32_t>(MarkerKind::HIT_SPARK)].lifetime;
+}
+
+void WorldMarkerPool::set_impact_scene(const Ref<PackedScene>& scene) {
+  sets[static_cast<int32_t>(MarkerKind::IMPACT)].scene = scene;
+  _warm_up(MarkerKind::IMPACT);
+}
+
+Ref<PackedScene> WorldMarkerPool::get_impact_scene() const {
+  return sets[static_cast<int32_t>(MarkerKind::IMPACT)].scene;
+}
+
+void WorldMarkerPool::set_impact_lifetime(float lifetime) {
+  sets[static_cast<int32_t>(MarkerKind::IMPACT)].lifetime =
+      std::max(0.01f, lifetime);
+}
+
+float WorldMarkerPool::get_impact_lifetime() const {
+  return sets[static_cast<int32_t>(MarkerKind::IMPACT)].lifetime;
+}
+
+void WorldMarkerPool::set_markers_per_kind(int32_t count) {
+  markers_per_kind = std::max(1, count);
+  for (int32_t kind = 0; kind < static_cast<int32_t>(MarkerKind::COUNT);
+       ++kind) {
+    _warm_up(static_cast<MarkerKind>(kind));
+  }
+}
+
+int32_t WorldMarkerPool::get_markers_per_kind() const {
+  return markers_per_kind;
+}
+
+int32_t WorldMarkerPool::get_active_marker_count() const {
+  return active_count;
+}
+
+void WorldMarkerPool::_warm_up(MarkerKind kind) {
+  // Scenes set from the inspector are instanced once the pool is ready.
+  if (!is_node_ready() || Engine::get_singleton()->is_editor_hint()) {
+    return;
+  }
+
+  MarkerSet& set = sets[static_cast<int32_t>(kind)];
+  _release(set);
+  if (set.scene.is_null()) {
+    return;
+  }
+
+  set.markers.resize(markers_per_kind);
+  for (Marker& marker : set.markers) {
+    Node* instance = set.scene->instantiate();
+    marker.node = Object::cast_to<Node3D>(instance);
+    if (marker.node == nullptr) {
+      UtilityFunctions::push_error(
+          "[WorldMarkerPool] Marker scene root must be a Node3D");
+      instance->queue_free();
+      set.markers.clear();
+      return;
+    }
+
+    add_child(marker.node);
+    marker.node->set_as_top_level(true);
+    marker.node->set_visible(false);
+    _collect_geometry(marker.node, marker);
+  }
+}
+
+void WorldMarkerPool::_release(MarkerSet& set) {
+  for (Marker& marker : set.markers) {
+    if (marker.node != nullptr) {
+      marker.node->queue_free();
+    }
+    if (marker.active) {
+      active_count--;
+    }
+  }
+  set.markers.clear();
+  set.next = 0;
+}
+
+void WorldMarkerPool::_set_fade(Marker& marker, float transparency) {
+  for (GeometryInstance3D* geometry : marker.geometry) {
+    geometry->set_transparency(transparency);
+  }
+}
+
+void WorldMarkerPool::_collect_geometry(Node* node, Marker& marker) {
+  if (auto geometry = Object::cast_to<GeometryInstance3D>(node)) {
+    marker.geometry.push_back(geometry);
+  }
+  const int32_t child_count = node->get_child_count();
+  for (int32_t i = 0; i < child_count; ++i) {
+    _collect_geometry(node->get_child(i), marker);
+  }
+}
@@ -0,0 +1,102 @@
+#ifndef GDEXTENSION_WORLD_MARKER_POOL_H
+#define GDEXTENSION_WORLD_MARKER_POOL_H
+
+#include <godot_cpp/classes/node3d.hpp>
+#include <godot_cpp/classes/packed_scene.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+#include <vector>
+
+namespace godot {
+class GeometryInstance3D;
+}  // namespace godot
+
+using godot::Node3D;
+using godot::PackedScene;
+using godot::Ref;
+using godot::Vector3;
+
+enum class MarkerKind {
+  CLICK,
+  HIT_SPARK,
+  IMPACT,
+  COUNT,
+};
+
+// Fixed set of pre-instanced short-lived world markers (click indicators,
+// hit sparks, projectile impacts). Spawning reuses the oldest node of the
+// kind and restarts its fade, so nothing is instanced or freed after the
+// pool is warmed up in _ready().
+class WorldMarkerPool : public Node3D {
+  GDCLASS(WorldMarkerPool, Node3D)
+
+ protected:
+  static void _bind_methods();
+
+ public:
+  WorldMarkerPool();
+  ~WorldMarkerPool();
+
+  void _ready() override;
+  void _process(double delta) override;
+
+  void spawn(MarkerKind kind, const Vector3& position);
+  void spawn_click_marker(const Vector3& position);
+  void spawn_hit_spark(const Vector3& position);
+  void spawn_impact(const Vector3& position);
+
+  // Spawns through the marker pool of the node's match, if it has one.
+  static void spawn_for(const godot::Node* node,
+                        MarkerKind kind,
+                        const Vector3& position);
+
+  void set_click_marker_scene(const Ref<PackedScene>& scene);
+  Ref<PackedScene> get_click_marker_scene() const;
+  void set_click_marker_lifetime(float lifetime);
+  float get_click_marker_lifetime() const;
+
+  void set_hit_spark_scene(const Ref<PackedScene>& scene);
+  Ref<PackedScene> get_hit_spark_scene() const;
+  void set_hit_spark_lifetime(float lifetime);
+  float get_hit_spark_lifetime() const;
+
+  void set_impact_scene(const Ref<PackedScene>& scene);
+  Ref<PackedScene> get_impact_scene() const;
+  void set_impact_lifetime(float lifetime);
+  float get_impact_lifetime() const;
+
+  // Nodes kept per kind; the oldest live marker is recycled when all are in
+  // use.
+  void set_markers_per_kind(int32_t count);
+  int32_t get_markers_per_kind() const;
+
+  int32_t get_active_marker_count() const;
+
+ private:
+  struct Marker {
+    Node3D* node = nullptr;
+    // Collected once at warm-up, faded through their transparency.
+    std::vector<godot::GeometryInstance3D*> geometry;
+    float age = 0.0f;
+    bool active = false;
+  };
+
+  struct MarkerSet {
+    Ref<PackedScene> scene;
+    float lifetime = 1.0f;
+    std::vector<Marker> markers;
+    int32_t next = 0;
+  };
+
+  void _warm_up(MarkerKind kind);
+  void _release(MarkerSet& set);
+  void _set_fade(Marker& marker, float transparency);
+  static void _collect_geometry(godot::Node* node, Marker& marker);
+
+  MarkerSet sets[static_cast<int32_t>(MarkerKind::COUNT)];
+  int32_t markers_per_kind = 8;
+  int32_t active_count = 0;
+};
+
+#endif  // GDEXTENSION_WORLD_MARKER_POOL_H
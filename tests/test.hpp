@@ -0,0 +1,41 @@
+#ifndef GDEXTENSION_TEST_H
+#define GDEXTENSION_TEST_H
+
+#include <cstdint>
+
+// Minimal test harness: TEST_CASE functions register themselves and
+// test_main.cpp runs them all. A failed CHECK reports its location and the
+// run goes on, so one pass shows every failure; main() then exits nonzero.
+void register_test(const char* name, void (*run)());
+void report_failure(const char* file, int line, const char* expression);
+
+#define TEST_CASE(name)                                  \
+  static void name();                                    \
+  static const bool name##_registered =                  \
+      (register_test(#name, name), true);                \
+  static void name()
+
+#define CHECK(expression)                                \
+  do {                                                   \
+    if (!(expression)) {                                 \
+      report_failure(__FILE__, __LINE__, #expression);   \
+    }                                                    \
+  } while (false)
+
+// Xorshift generator for randomized cases; a fixed seed keeps failures
+// reproducible.
+struct TestRandom {
+  uint32_t state;
+
+  explicit TestRandom(uint32_t seed) : state(seed != 0 ? seed : 1) {}
+  uint32_t next() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+  // Uniform enough in [0, bound) for test data.
+  uint32_t below(uint32_t bound) { return next() % bound; }
+};
+
+#endif  // GDEXTENSION_TEST_H
@@ -0,0 +1,92 @@
+#include <cstdint>
+
+#include "frame_arena.hpp"
+#include "test.hpp"
+
+namespace {
+
+bool is_aligned(const void* pointer, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+}
+
+}  // namespace
+
+TEST_CASE(frame_arena_reset_reuses_memory) {
+  FrameArena arena(1024);
+  CHECK(arena.get_heap_allocation_count() == 1);
+
+  uint8_t* bytes = arena.allocate_array<uint8_t>(3);
+  double* values = arena.allocate_array<double>(4);
+  CHECK(is_aligned(values, alignof(double)));
+  CHECK(reinterpret_cast<uint8_t*>(values) > bytes);
+  CHECK(arena.get_used() >= 3 + 4 * sizeof(double));
+
+  arena.reset();
+  CHECK(arena.get_used() == 0);
+  CHECK(arena.get_last_tick_used() >= 3 + 4 * sizeof(double));
+  // Same sequence after a reset, same addresses: nothing was freed.
+  CHECK(arena.allocate_array<uint8_t>(3) == bytes);
+  CHECK(arena.allocate_array<double>(4) == values);
+  arena.reset();
+  CHECK(arena.get_heap_allocation_count() == 1);
+}
+
+TEST_CASE(frame_arena_grows_after_overflow) {
+  FrameArena arena(256);
+  for (int32_t index = 0; index < 10; ++index) {
+    CHECK(is_aligned(arena.allocate(100, 16), 16));
+  }
+  CHECK(arena.get_used() >= 1000);
+  CHECK(arena.get_heap_allocation_count() > 1);
+
+  arena.reset();
+  CHECK(arena.get_capacity() >= arena.get_high_water_mark());
+  CHECK(arena.get_high_water_mark() >= 1000);
+
+  // After warm-up the same tick fits and allocates nothing.
+  const int64_t allocations = arena.get_heap_allocation_count();
+  for (int32_t tick = 0; tick < 5; ++tick) {
+    for (int32_t index = 0; index < 10; ++index) {
+      arena.allocate(100, 16);
+    }
+    arena.reset();
+  }
+  CHECK(arena.get_heap_allocation_count() == allocations);
+}
+
+TEST_CASE(frame_vector_keeps_values_when_growing) {
+  FrameArena arena(512);
+  FrameVector<int32_t> values(2, arena);
+  for (int32_t index = 0; index < 300; ++index) {
+    values.push_back(index * 3);
+  }
+  bool kept = values.size() == 300;
+  for (int32_t index = 0; index < 300; ++index) {
+    kept = kept && values[index] == index * 3;
+  }
+  CHECK(kept);
+
+  values.resize(310);
+  CHECK(values[299] == 897);
+  CHECK(values[309] == 0);
+  arena.reset();
+}
+
+#ifdef DEBUG_ENABLED
+TEST_CASE(frame_arena_poisons_released_memory) {
+  FrameArena arena(1024);
+  uint32_t* values = arena.allocate_array<uint32_t>(16);
+  for (int32_t index = 0; index < 16; ++index) {
+    values[index] = 0x12345678u;
+  }
+  arena.reset();
+
+  // A stale pointer now reads the poison pattern, not the old values.
+  const uint8_t* stale = reinterpret_cast<const uint8_t*>(values);
+  bool poisoned = true;
+  for (size_t index = 0; index < 16 * sizeof(uint32_t); ++index) {
+    poisoned = poisoned && stale[index] == FrameArena::POISON;
+  }
+  CHECK(poisoned);
+}
+#endif
@@ -0,0 +1,45 @@
+#include <cstdio>
+#include <vector>
+
+#include "test.hpp"
+
+namespace {
+
+struct TestCase {
+  const char* name;
+  void (*run)();
+};
+
+// Function-local so registration from other files' static initializers
+// never sees it unconstructed.
+std::vector<TestCase>& get_tests() {
+  static std::vector<TestCase> tests;
+  return tests;
+}
+
+int failure_count = 0;
+
+}  // namespace
+
+void register_test(const char* name, void (*run)()) {
+  get_tests().push_back({name, run});
+}
+
+void report_failure(const char* file, int line, const char* expression) {
+  std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+  failure_count++;
+}
+
+int main() {
+  int failed_tests = 0;
+  for (const TestCase& test : get_tests()) {
+    const int failures_before = failure_count;
+    test.run();
+    const bool passed = failure_count == failures_before;
+    std::printf("%s %s\n", passed ? "PASS" : "FAIL", test.name);
+    failed_tests += passed ? 0 : 1;
+  }
+  std::printf("%d of %d tests failed\n", failed_tests,
+              static_cast<int>(get_tests().size()));
+  return failed_tests == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include "position_history.hpp"
+#include "test.hpp"
+
+namespace {
+
+// Slot s sits at x = tick * 10 + s on tick.
+void record_ticks(PositionHistory& history,
+                  int64_t first,
+                  int64_t last,
+                  int32_t slots) {
+  for (int64_t tick = first; tick <= last; ++tick) {
+    history.begin_tick(tick, slots);
+    for (int32_t slot = 0; slot < slots; ++slot) {
+      history.write(slot, Vector3(static_cast<float>(tick * 10 + slot), 0, 0),
+                    true);
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE(position_history_wraps_around) {
+  PositionHistory history;
+  history.set_capacity(8);
+  CHECK(history.get_oldest_tick() == -1);
+  CHECK(history.rewind(3) == -1);
+
+  record_ticks(history, 0, 3, 2);
+  CHECK(history.get_oldest_tick() == 0);
+  CHECK(history.sample(1, 0) != nullptr);
+
+  record_ticks(history, 4, 29, 2);
+  CHECK(history.get_newest_tick() == 29);
+  CHECK(history.get_oldest_tick() == 22);
+  CHECK(history.sample(0, 21) == nullptr);
+  CHECK(history.sample(0, 30) == nullptr);
+  bool positions_match = true;
+  for (int64_t tick = 22; tick <= 29; ++tick) {
+    for (int32_t slot = 0; slot < 2; ++slot) {
+      const PositionHistory::Sample* past = history.sample(slot, tick);
+      positions_match = positions_match && past != nullptr &&
+                        past->position.x ==
+                            static_cast<float>(tick * 10 + slot);
+    }
+  }
+  CHECK(positions_match);
+
+  CHECK(history.rewind(3) == 26);
+  CHECK(history.rewind(100) == 22);
+  history.set_view_delay(1, 5);
+  CHECK(history.get_view_tick(1) == 24);
+  CHECK(history.was_within_range(1, 24, Vector3(241.0f, 0, 1.0f), 1.5f));
+  CHECK(!history.was_within_range(1, 24, Vector3(241.0f, 0, 2.0f), 1.5f));
+  CHECK(!history.was_within_range(1, 21, Vector3(211.0f, 0, 0), 1.5f));
+}
+
+TEST_CASE(position_history_new_occupant_has_no_past) {
+  PositionHistory history;
+  history.set_capacity(8);
+  record_ticks(history, 0, 11, 2);
+  history.set_view_delay(1, 4);
+
+  history.reset_slot(1);
+  CHECK(history.get_view_delay(1) == 0);
+  CHECK(history.sample(1, 11) == nullptr);
+  CHECK(history.sample(0, 11) != nullptr);
+
+  record_ticks(history, 12, 13, 2);
+  CHECK(history.sample(1, 11) == nullptr);
+  CHECK(history.sample(1, 12) != nullptr);
+
+  // A slot that first appears now has no past either, even though its
+  // ring reaches back through the wraparound.
+  record_ticks(history, 14, 14, 3);
+  CHECK(history.sample(2, 13) == nullptr);
+  CHECK(history.sample(2, 14) != nullptr);
+  CHECK(history.sample(2, 14)->position.x == 142.0f);
+}
+
+TEST_CASE(position_history_capacity_change_forgets) {
+  PositionHistory history;
+  history.set_capacity(4);
+  record_ticks(history, 0, 9, 1);
+  history.set_capacity(16);
+  CHECK(history.get_oldest_tick() == -1);
+  CHECK(history.sample(0, 9) == nullptr);
+  record_ticks(history, 10, 40, 1);
+  CHECK(history.get_oldest_tick() == 25);
+  CHECK(history.sample(0, 25)->position.x == 250.0f);
+}
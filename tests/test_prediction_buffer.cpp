@@ -0,0 +1,95 @@
+#include "prediction_buffer.hpp"
+#include "test.hpp"
+
+namespace {
+
+UnitOrder move_order(float x) {
+  UnitOrder order;
+  order.type = OrderType::MOVE;
+  order.position = Vector3(x, 0, 0);
+  return order;
+}
+
+void record_steps(PredictionBuffer& buffer, int32_t steps, float& x) {
+  for (int32_t step = 0; step < steps; ++step) {
+    buffer.record_state(Vector3(x, 0, 0), OrderType::MOVE, Vector3());
+    x += 1.0f;
+  }
+}
+
+}  // namespace
+
+TEST_CASE(prediction_inputs_wrap_and_drop_oldest) {
+  PredictionBuffer buffer;
+  const int32_t total = PredictionBuffer::INPUT_CAPACITY * 2 + 5;
+  for (int32_t index = 0; index < total; ++index) {
+    CHECK(buffer.add_input(move_order(static_cast<float>(index)), false) ==
+          static_cast<uint32_t>(index + 1));
+  }
+
+  // Only the newest INPUT_CAPACITY survive, oldest first.
+  CHECK(buffer.get_pending_input_count() == PredictionBuffer::INPUT_CAPACITY);
+  const uint32_t oldest = total - PredictionBuffer::INPUT_CAPACITY + 1;
+  bool in_order = true;
+  for (int32_t index = 0; index < PredictionBuffer::INPUT_CAPACITY; ++index) {
+    const PredictionBuffer::Input& input = buffer.get_pending_input(index);
+    in_order = in_order && input.sequence == oldest + index &&
+               input.order.position.x == static_cast<float>(oldest + index - 1);
+  }
+  CHECK(in_order);
+
+  buffer.acknowledge(oldest + 9);
+  CHECK(buffer.get_pending_input_count() ==
+        PredictionBuffer::INPUT_CAPACITY - 10);
+  CHECK(buffer.get_pending_input(0).sequence == oldest + 10);
+  // Stale and repeated acknowledgements change nothing.
+  buffer.acknowledge(oldest);
+  CHECK(buffer.get_pending_input(0).sequence == oldest + 10);
+
+  buffer.acknowledge(total);
+  CHECK(buffer.get_pending_input_count() == 0);
+  CHECK(buffer.add_input(move_order(0.0f), true) ==
+        static_cast<uint32_t>(total + 1));
+  CHECK(buffer.get_pending_input(0).queued);
+}
+
+TEST_CASE(prediction_states_wrap_and_keep_tags) {
+  PredictionBuffer buffer;
+  float x = 0.0f;
+  const uint32_t first = buffer.add_input(move_order(1.0f), false);
+  record_steps(buffer, 100, x);
+  const uint32_t second = buffer.add_input(move_order(2.0f), false);
+  record_steps(buffer, 100, x);
+
+  // 200 states through a 128 ring: the first 72 are gone.
+  CHECK(buffer.get_state_count() == PredictionBuffer::STATE_CAPACITY);
+  const int32_t dropped = 200 - PredictionBuffer::STATE_CAPACITY;
+  CHECK(buffer.get_state(0).position.x == static_cast<float>(dropped));
+  CHECK(buffer.find_state(first, 0) == -1);
+  CHECK(buffer.find_state(first, dropped - 1) == -1);
+  CHECK(buffer.find_state(first, dropped) == 0);
+  CHECK(buffer.find_state(first, 99) == 99 - dropped);
+
+  const int32_t index = buffer.find_state(second, 37);
+  CHECK(index == 100 - dropped + 37);
+  CHECK(buffer.get_state(index).position.x == 137.0f);
+  CHECK(buffer.find_state(second, 100) == -1);
+
+  buffer.discard_states_before(index);
+  CHECK(buffer.get_state_count() == PredictionBuffer::STATE_CAPACITY - index);
+  CHECK(buffer.find_state(second, 37) == 0);
+  CHECK(buffer.find_state(second, 36) == -1);
+
+  // Keeps wrapping after a discard moved the head.
+  record_steps(buffer, PredictionBuffer::STATE_CAPACITY, x);
+  CHECK(buffer.get_state_count() == PredictionBuffer::STATE_CAPACITY);
+  const PredictionBuffer::State& newest =
+      buffer.get_state(PredictionBuffer::STATE_CAPACITY - 1);
+  CHECK(newest.input_sequence == second);
+  CHECK(newest.steps_since_input ==
+        static_cast<uint32_t>(100 + PredictionBuffer::STATE_CAPACITY - 1));
+  CHECK(newest.position.x == x - 1.0f);
+
+  buffer.discard_states_before(PredictionBuffer::STATE_CAPACITY + 10);
+  CHECK(buffer.get_state_count() == 0);
+}
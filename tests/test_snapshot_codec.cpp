@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <vector>
+
+#include "bit_stream.hpp"
+#include "match_snapshot.hpp"
+#include "test.hpp"
+
+namespace {
+
+constexpr int32_t AXIS_BITS[3] = {SnapshotCodec::POSITION_BITS,
+                                  SnapshotCodec::HEIGHT_BITS,
+                                  SnapshotCodec::POSITION_BITS};
+
+uint32_t random_bits(TestRandom& random, int32_t bit_count) {
+  return random.next() & ((1u << bit_count) - 1u);
+}
+
+void randomize_unit(TestRandom& random, UnitSnapshot& unit) {
+  unit.present = true;
+  for (int32_t axis = 0; axis < 3; ++axis) {
+    unit.position[axis] = random_bits(random, AXIS_BITS[axis]);
+  }
+  unit.yaw = random_bits(random, SnapshotCodec::YAW_BITS);
+  unit.health = random_bits(random, SnapshotCodec::HEALTH_BITS);
+  unit.order = random_bits(random, SnapshotCodec::ORDER_BITS);
+  unit.target = random.below(3) == 0 ? 0 : random.next() % 100000;
+}
+
+bool same_unit(const UnitSnapshot& a, const UnitSnapshot& b) {
+  if (a.present != b.present) {
+    return false;
+  }
+  if (!a.present) {
+    return true;
+  }
+  return a.position[0] == b.position[0] && a.position[1] == b.position[1] &&
+         a.position[2] == b.position[2] && a.yaw == b.yaw &&
+         a.health == b.health && a.order == b.order && a.target == b.target;
+}
+
+bool same_snapshot(const MatchSnapshot& a, const MatchSnapshot& b) {
+  if (a.tick != b.tick || a.units.size() != b.units.size()) {
+    return false;
+  }
+  for (size_t slot = 0; slot < a.units.size(); ++slot) {
+    if (!same_unit(a.units[slot], b.units[slot])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool round_trip(const MatchSnapshot& snapshot,
+                const MatchSnapshot* baseline,
+                MatchSnapshot& out) {
+  BitWriter writer;
+  SnapshotCodec::encode(snapshot, baseline, writer);
+  const std::vector<uint8_t>& bytes = writer.get_bytes();
+  BitReader reader(bytes.data(), static_cast<int64_t>(bytes.size()));
+  return SnapshotCodec::decode(reader, snapshot.tick, baseline, out);
+}
+
+// Moves a few units a little, some far, changes other fields, and frees
+// and fills slots, so every delta path is taken.
+void mutate(TestRandom& random, MatchSnapshot& snapshot) {
+  snapshot.tick++;
+  for (UnitSnapshot& unit : snapshot.units) {
+    const uint32_t roll = random.below(8);
+    if (!unit.present || roll == 0) {
+      if (random.below(2) == 0) {
+        randomize_unit(random, unit);
+      } else {
+        unit = UnitSnapshot();
+      }
+    } else if (roll <= 3) {
+      for (int32_t axis = 0; axis < 3; ++axis) {
+        const int32_t step = static_cast<int32_t>(random.below(64)) - 32;
+        const int32_t limit = (1 << AXIS_BITS[axis]) - 1;
+        const int32_t moved = static_cast<int32_t>(unit.position[axis]) + step;
+        unit.position[axis] =
+            static_cast<uint32_t>(std::clamp(moved, 0, limit));
+      }
+    } else if (roll == 4) {
+      unit.position[0] = random_bits(random, AXIS_BITS[0]);
+    } else if (roll == 5) {
+      unit.yaw = random_bits(random, SnapshotCodec::YAW_BITS);
+      unit.health = random_bits(random, SnapshotCodec::HEALTH_BITS);
+    } else if (roll == 6) {
+      unit.order = random_bits(random, SnapshotCodec::ORDER_BITS);
+      unit.target = random.next() % 100000;
+    }
+  }
+  if (random.below(4) == 0) {
+    snapshot.units.resize(snapshot.units.size() + random.below(4));
+  }
+}
+
+}  // namespace
+
+TEST_CASE(bit_stream_round_trip) {
+  TestRandom random(17);
+  std::vector<uint32_t> values;
+  std::vector<int32_t> widths;
+  BitWriter writer;
+  for (int32_t index = 0; index < 2000; ++index) {
+    const int32_t width = 1 + static_cast<int32_t>(random.below(32));
+    const uint32_t value =
+        width == 32 ? random.next() : random_bits(random, width);
+    writer.write_bits(value, width);
+    values.push_back(value);
+    widths.push_back(width);
+  }
+  const uint32_t varuints[] = {0, 1, 127, 128, 300, 16384, 0xFFFFFFFFu};
+  for (uint32_t value : varuints) {
+    writer.write_varuint(value);
+  }
+  writer.write_bool(true);
+  writer.write_quantized(1.25f, -4.0f, 4.0f, 12);
+
+  const std::vector<uint8_t>& bytes = writer.get_bytes();
+  BitReader reader(bytes.data(), static_cast<int64_t>(bytes.size()));
+  bool bits_match = true;
+  for (size_t index = 0; index < values.size(); ++index) {
+    bits_match = bits_match && reader.read_bits(widths[index]) == values[index];
+  }
+  CHECK(bits_match);
+  for (uint32_t value : varuints) {
+    CHECK(reader.read_varuint() == value);
+  }
+  CHECK(reader.read_bool());
+  const float quantized = reader.read_quantized(-4.0f, 4.0f, 12);
+  CHECK(quantized > 1.25f - 0.002f && quantized < 1.25f + 0.002f);
+  CHECK(!reader.is_overflowed());
+
+  // Only the zero padding of the last byte is left.
+  reader.read_bits(8);
+  CHECK(reader.is_overflowed());
+}
+
+TEST_CASE(snapshot_full_round_trip) {
+  TestRandom random(29);
+  MatchSnapshot snapshot;
+  snapshot.tick = 40;
+  snapshot.units.resize(64);
+  for (UnitSnapshot& unit : snapshot.units) {
+    if (random.below(5) != 0) {
+      randomize_unit(random, unit);
+    }
+  }
+
+  MatchSnapshot decoded;
+  CHECK(round_trip(snapshot, nullptr, decoded));
+  CHECK(same_snapshot(snapshot, decoded));
+}
+
+TEST_CASE(snapshot_delta_round_trip) {
+  TestRandom random(31);
+  MatchSnapshot baseline;
+  baseline.tick = 1;
+  baseline.units.resize(48);
+  for (UnitSnapshot& unit : baseline.units) {
+    randomize_unit(random, unit);
+  }
+
+  // Chains deltas the way a client does, each against the last decoded
+  // snapshot, so an error anywhere compounds into a mismatch.
+  MatchSnapshot decoded_baseline = baseline;
+  for (int32_t step = 0; step < 200; ++step) {
+    MatchSnapshot next = baseline;
+    mutate(random, next);
+    MatchSnapshot decoded;
+    CHECK(round_trip(next, &decoded_baseline, decoded));
+    CHECK(same_snapshot(next, decoded));
+    baseline = next;
+    decoded_baseline = decoded;
+  }
+
+  // A baseline shorter than the snapshot sends the extra slots in full.
+  MatchSnapshot shorter = baseline;
+  shorter.units.resize(baseline.units.size() / 2);
+  MatchSnapshot grown = baseline;
+  mutate(random, grown);
+  MatchSnapshot decoded;
+  CHECK(round_trip(grown, &shorter, decoded));
+  CHECK(same_snapshot(grown, decoded));
+}
+
+TEST_CASE(snapshot_unchanged_units_cost_two_bits) {
+  TestRandom random(37);
+  MatchSnapshot snapshot;
+  snapshot.tick = 5;
+  snapshot.units.resize(100);
+  for (UnitSnapshot& unit : snapshot.units) {
+    randomize_unit(random, unit);
+  }
+  BitWriter writer;
+  SnapshotCodec::encode(snapshot, &snapshot, writer);
+  // The slot count varint, then present and changed per unit.
+  CHECK(writer.get_bit_count() == 8 + 100 * 2);
+}
+
+TEST_CASE(snapshot_truncated_stream_fails) {
+  TestRandom random(41);
+  MatchSnapshot snapshot;
+  snapshot.tick = 9;
+  snapshot.units.resize(16);
+  for (UnitSnapshot& unit : snapshot.units) {
+    randomize_unit(random, unit);
+  }
+  BitWriter writer;
+  SnapshotCodec::encode(snapshot, nullptr, writer);
+  const std::vector<uint8_t>& bytes = writer.get_bytes();
+
+  BitReader reader(bytes.data(), static_cast<int64_t>(bytes.size()) / 2);
+  MatchSnapshot decoded;
+  CHECK(!SnapshotCodec::decode(reader, snapshot.tick, nullptr, decoded));
+}
@@ -0,0 +1,87 @@
+#include <vector>
+
+#include "test.hpp"
+#include "unit_registry.hpp"
+
+namespace {
+
+// The registry only stores unit pointers, so tests hand it addresses that
+// are never dereferenced.
+char unit_storage[8];
+
+Unit* fake_unit(int32_t index) {
+  return reinterpret_cast<Unit*>(&unit_storage[index]);
+}
+
+}  // namespace
+
+TEST_CASE(unit_handle_goes_stale_when_slot_is_reused) {
+  UnitRegistry registry;
+  const int32_t first_slot = registry.register_unit(fake_unit(0));
+  const int32_t other_slot = registry.register_unit(fake_unit(1));
+  const UnitHandle first = registry.get_handle(first_slot);
+  const UnitHandle other = registry.get_handle(other_slot);
+  CHECK(first != INVALID_UNIT_HANDLE);
+  CHECK(first != other);
+  CHECK(registry.resolve(first) == fake_unit(0));
+  CHECK(registry.resolve_slot(first) == first_slot);
+  CHECK(registry.is_alive(first));
+
+  registry.unregister_unit(first_slot);
+  CHECK(registry.get_handle(first_slot) == INVALID_UNIT_HANDLE);
+  CHECK(registry.resolve(first) == nullptr);
+  CHECK(registry.resolve_slot(first) == UnitRegistry::INVALID_SLOT);
+  CHECK(!registry.is_alive(first));
+
+  // The next unit takes the freed slot under a new generation; the old
+  // handle must not resolve to it.
+  const int32_t reused_slot = registry.register_unit(fake_unit(2));
+  CHECK(reused_slot == first_slot);
+  const UnitHandle reused = registry.get_handle(reused_slot);
+  CHECK(reused != first);
+  CHECK(registry.resolve(first) == nullptr);
+  CHECK(registry.resolve(reused) == fake_unit(2));
+  CHECK(registry.resolve(other) == fake_unit(1));
+}
+
+TEST_CASE(unit_handle_rejects_invalid_values) {
+  UnitRegistry registry;
+  const int32_t slot = registry.register_unit(fake_unit(0));
+  const UnitHandle handle = registry.get_handle(slot);
+  CHECK(registry.resolve(INVALID_UNIT_HANDLE) == nullptr);
+  CHECK(registry.resolve(-1) == nullptr);
+  // Right generation, slot out of range.
+  CHECK(registry.resolve(handle + 5) == nullptr);
+  CHECK(registry.get_handle(-1) == INVALID_UNIT_HANDLE);
+  CHECK(registry.get_handle(7) == INVALID_UNIT_HANDLE);
+}
+
+TEST_CASE(unit_handle_alive_follows_health) {
+  UnitRegistry registry;
+  const int32_t slot = registry.register_unit(fake_unit(0));
+  const UnitHandle handle = registry.get_handle(slot);
+  registry.set_health_ratio(slot, 0.0f);
+  CHECK(registry.resolve(handle) == fake_unit(0));
+  CHECK(!registry.is_alive(handle));
+  registry.set_health_ratio(slot, 0.5f);
+  CHECK(registry.is_alive(handle));
+}
+
+TEST_CASE(unit_handle_survives_many_reuses) {
+  UnitRegistry registry;
+  std::vector<UnitHandle> retired;
+  int32_t slot = registry.register_unit(fake_unit(0));
+  for (int32_t round = 0; round < 1000; ++round) {
+    retired.push_back(registry.get_handle(slot));
+    registry.unregister_unit(slot);
+    slot = registry.register_unit(fake_unit(round % 8));
+  }
+  const UnitHandle current = registry.get_handle(slot);
+  bool all_stale = true;
+  for (UnitHandle handle : retired) {
+    all_stale = all_stale && handle != current &&
+                registry.resolve(handle) == nullptr;
+  }
+  CHECK(all_stale);
+  CHECK(registry.resolve(current) == fake_unit(999 % 8));
+}
@@ -0,0 +1,105 @@
+#include <cmath>
+#include <vector>
+
+#include "test.hpp"
+#include "unit_registry.hpp"
+#include "visibility_grid.hpp"
+
+namespace {
+
+constexpr int32_t GRID_SIZE = 32;
+constexpr float SIGHT_RADIUS = 11.0f;
+
+char unit_storage[16];
+
+Unit* fake_unit(int32_t index) {
+  return reinterpret_cast<Unit*>(&unit_storage[index]);
+}
+
+Vector3 cell_center(int32_t x, int32_t z) {
+  return Vector3(static_cast<float>(x) + 0.5f, 0.0f,
+                 static_cast<float>(z) + 0.5f);
+}
+
+}  // namespace
+
+TEST_CASE(visibility_without_occluders_is_a_disc) {
+  VisibilityGrid grid;
+  grid.configure(Vector3(), GRID_SIZE, GRID_SIZE, 1.0f);
+  UnitRegistry registry;
+  const int32_t slot = registry.register_unit(fake_unit(0));
+  registry.set_pose(slot, cell_center(16, 16), 0.0f);
+  registry.set_sight_radius(slot, 5.0f);
+  grid.update(registry);
+
+  const int32_t layer = grid.find_layer(0);
+  CHECK(layer >= 0);
+  CHECK(grid.is_cell_visible(layer, 16 * GRID_SIZE + 20));
+  CHECK(!grid.is_cell_visible(layer, 16 * GRID_SIZE + 22));
+  CHECK(grid.is_cell_visible(layer, 12 * GRID_SIZE + 17));
+  CHECK(!grid.is_cell_visible(layer, 12 * GRID_SIZE + 20));
+}
+
+// Shadowcasting between viewers on level ground is symmetric: if a sees b,
+// b sees a. Each unit is its own faction so every pair can be compared.
+TEST_CASE(visibility_shadowcast_is_symmetric) {
+  TestRandom random(53);
+  constexpr int32_t UNIT_COUNT = 12;
+  int32_t asymmetric_pairs = 0;
+  int32_t visible_pairs = 0;
+  int32_t hidden_pairs = 0;
+
+  for (int32_t layout = 0; layout < 40; ++layout) {
+    VisibilityGrid grid;
+    grid.configure(Vector3(), GRID_SIZE, GRID_SIZE, 1.0f);
+    OccluderGrid& occluders = grid.get_occluders();
+    occluders.fill(0.0f);
+    std::vector<bool> blocked(GRID_SIZE * GRID_SIZE, false);
+    const uint32_t density = 4 + layout % 12;
+    for (int32_t cell = 0; cell < GRID_SIZE * GRID_SIZE; ++cell) {
+      if (random.below(100) < density) {
+        occluders.set_height(cell, 5.0f);
+        blocked[cell] = true;
+      }
+    }
+    grid.invalidate_sight();
+
+    UnitRegistry registry;
+    for (int32_t index = 0; index < UNIT_COUNT; ++index) {
+      int32_t x = 0;
+      int32_t z = 0;
+      do {
+        x = static_cast<int32_t>(random.below(GRID_SIZE));
+        z = static_cast<int32_t>(random.below(GRID_SIZE));
+      } while (blocked[z * GRID_SIZE + x]);
+      const int32_t slot = registry.register_unit(fake_unit(index));
+      registry.set_pose(slot, cell_center(x, z), 0.0f);
+      registry.set_faction(slot, index);
+      registry.set_sight_radius(slot, SIGHT_RADIUS);
+    }
+    grid.update(registry);
+
+    for (int32_t a = 0; a < UNIT_COUNT; ++a) {
+      const int32_t layer_a = grid.find_layer(a);
+      for (int32_t b = a + 1; b < UNIT_COUNT; ++b) {
+        const int32_t layer_b = grid.find_layer(b);
+        const bool a_sees_b = grid.is_slot_visible(layer_a, b);
+        const bool b_sees_a = grid.is_slot_visible(layer_b, a);
+        asymmetric_pairs += a_sees_b != b_sees_a ? 1 : 0;
+        const Vector3 offset =
+            registry.get_position(a) - registry.get_position(b);
+        if (std::sqrt(offset.x * offset.x + offset.z * offset.z) <
+            SIGHT_RADIUS - 1.0f) {
+          visible_pairs += a_sees_b ? 1 : 0;
+          hidden_pairs += a_sees_b ? 0 : 1;
+        }
+      }
+    }
+  }
+
+  CHECK(asymmetric_pairs == 0);
+  // Guards against a vacuous pass: the layouts must both reveal and hide
+  // pairs that are within range of each other.
+  CHECK(visible_pairs > 50);
+  CHECK(hidden_pairs > 50);
+}